@@ -0,0 +1,748 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Name.h"
+#include "Containers/FlatMap.h"
+#include "Containers/HashMap.h"
+#include "Containers/RadixSort.h"
+#include "Containers/SlotMap.h"
+#include "Containers/SoAArray.h"
+#include "Ecs/EntityRegistry.h"
+#include "Jobs/JobSystem.h"
+#include "Math/TransformBatch.h"
+#include "Memory/MemoryPool.h"
+
+using namespace frt;
+using namespace frt::memory;
+using namespace frt::memory::literals;
+
+
+namespace
+{
+template <typename TFunction>
+double MeasureNs(uint64 OperationCount, TFunction&& Function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    Function();
+    const auto end = std::chrono::steady_clock::now();
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (double)OperationCount;
+}
+
+// Looks like the names lookups are done with: a common prefix and a short distinct tail
+std::vector<std::string> MakeNames(uint32 Count, const char* Prefix)
+{
+    std::vector<std::string> names;
+    names.reserve(Count);
+    for (uint32 i = 0u; i < Count; ++i)
+    {
+        names.push_back(std::string(Prefix) + std::to_string(i * 7919u));
+    }
+    return names;
+}
+
+// About the size of what the scene keeps per entity
+struct SBenchEntity
+{
+    float Transform[16] = {};
+    float Speed = 1.f;
+};
+
+struct SBenchVector
+{
+    float X = 0.f;
+    float Y = 0.f;
+    float Z = 0.f;
+};
+
+// Same layout CEntity had: cached matrix, translation/rotation/scale, rotation speed
+struct SBenchTransformEntity
+{
+    float Matrix[16] = {};
+    SBenchVector Translation;
+    SBenchVector Rotation;
+    SBenchVector Scale;
+    SBenchVector RotationSpeed;
+};
+
+// The same entity split into components
+struct SBenchRotation
+{
+    SBenchVector Value;
+};
+
+struct SBenchRotationSpeed
+{
+    SBenchVector Value;
+};
+}
+
+
+TEST(ContainerHashMap, IntegerKeyBenchmark)
+{
+    CMemoryPool pool(256_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    static constexpr uint32 sizes[] = { 64u, 4096u, 262144u };
+    static constexpr uint32 lookupsPerRound = 1u << 20u;
+
+    for (const uint32 size : sizes)
+    {
+        std::mt19937_64 rng(size);
+        std::vector<uint64> keys(size);
+        std::vector<uint64> misses(size);
+        for (uint32 i = 0u; i < size; ++i)
+        {
+            keys[i] = rng();
+            misses[i] = rng();
+        }
+
+        THashMap<uint64, uint64> map;
+        std::unordered_map<uint64, uint64> stdMap;
+
+        const double mapInsertNs = MeasureNs(size, [&] ()
+        {
+            for (const uint64 key : keys)
+            {
+                map.Add(key, key);
+            }
+        });
+        const double stdInsertNs = MeasureNs(size, [&] ()
+        {
+            for (const uint64 key : keys)
+            {
+                stdMap.emplace(key, key);
+            }
+        });
+
+        uint64 mapSum = 0ull;
+        uint64 stdSum = 0ull;
+        const double mapHitNs = MeasureNs(lookupsPerRound, [&] ()
+        {
+            for (uint32 i = 0u; i < lookupsPerRound; ++i)
+            {
+                mapSum += *map.Find(keys[i & (size - 1u)]);
+            }
+        });
+        const double stdHitNs = MeasureNs(lookupsPerRound, [&] ()
+        {
+            for (uint32 i = 0u; i < lookupsPerRound; ++i)
+            {
+                stdSum += stdMap.find(keys[i & (size - 1u)])->second;
+            }
+        });
+        EXPECT_EQ(mapSum, stdSum);
+
+        uint32 mapFound = 0u;
+        uint32 stdFound = 0u;
+        const double mapMissNs = MeasureNs(lookupsPerRound, [&] ()
+        {
+            for (uint32 i = 0u; i < lookupsPerRound; ++i)
+            {
+                mapFound += map.Contains(misses[i & (size - 1u)]) ? 1u : 0u;
+            }
+        });
+        const double stdMissNs = MeasureNs(lookupsPerRound, [&] ()
+        {
+            for (uint32 i = 0u; i < lookupsPerRound; ++i)
+            {
+                stdFound += stdMap.contains(misses[i & (size - 1u)]) ? 1u : 0u;
+            }
+        });
+        EXPECT_EQ(mapFound, stdFound);
+
+        std::printf("[ BENCH    ] uint64 keys, %6u elements: insert %6.1f / %6.1f ns, hit %5.1f / %5.1f ns, "
+            "miss %5.1f / %5.1f ns (THashMap / std::unordered_map)\n",
+            size, mapInsertNs, stdInsertNs, mapHitNs, stdHitNs, mapMissNs, stdMissNs);
+    }
+}
+
+TEST(ContainerHashMap, StringKeyBenchmark)
+{
+    CMemoryPool pool(256_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    static constexpr uint32 sizes[] = { 16u, 256u, 4096u };
+    static constexpr uint32 lookupsPerRound = 1u << 18u;
+
+    for (const uint32 size : sizes)
+    {
+        const std::vector<std::string> names = MakeNames(size, "IA_Action_");
+        const std::vector<std::string> misses = MakeNames(size, "IA_Missing_");
+
+        // Lookups come in as views, the way callers hand them over; std::unordered_map needs a std::string built
+        std::vector<std::string_view> views(names.begin(), names.end());
+        std::vector<std::string_view> missViews(misses.begin(), misses.end());
+
+        THashMap<std::string, uint32> map;
+        std::unordered_map<std::string, uint32> stdMap;
+        for (uint32 i = 0u; i < size; ++i)
+        {
+            map.Add(names[i], i);
+            stdMap.emplace(names[i], i);
+        }
+
+        uint64 mapSum = 0ull;
+        uint64 stdSum = 0ull;
+        const double mapHitNs = MeasureNs(lookupsPerRound, [&] ()
+        {
+            for (uint32 i = 0u; i < lookupsPerRound; ++i)
+            {
+                mapSum += *map.Find(views[i & (size - 1u)]);
+            }
+        });
+        const double stdHitNs = MeasureNs(lookupsPerRound, [&] ()
+        {
+            for (uint32 i = 0u; i < lookupsPerRound; ++i)
+            {
+                stdSum += stdMap.find(std::string(views[i & (size - 1u)]))->second;
+            }
+        });
+        EXPECT_EQ(mapSum, stdSum);
+
+        uint32 mapFound = 0u;
+        uint32 stdFound = 0u;
+        const double mapMissNs = MeasureNs(lookupsPerRound, [&] ()
+        {
+            for (uint32 i = 0u; i < lookupsPerRound; ++i)
+            {
+                mapFound += map.Contains(missViews[i & (size - 1u)]) ? 1u : 0u;
+            }
+        });
+        const double stdMissNs = MeasureNs(lookupsPerRound, [&] ()
+        {
+            for (uint32 i = 0u; i < lookupsPerRound; ++i)
+            {
+                stdFound += stdMap.contains(std::string(missViews[i & (size - 1u)])) ? 1u : 0u;
+            }
+        });
+        EXPECT_EQ(mapFound, stdFound);
+
+        std::printf("[ BENCH    ] string keys, %4u elements: hit %5.1f / %5.1f ns, miss %5.1f / %5.1f ns "
+            "(THashMap by view / std::unordered_map)\n",
+            size, mapHitNs, stdHitNs, mapMissNs, stdMissNs);
+    }
+}
+
+TEST(ContainerHashMap, NameKeyBenchmark)
+{
+    CMemoryPool pool(256_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    static constexpr uint32 sizes[] = { 16u, 256u, 4096u };
+    static constexpr uint32 lookupsPerRound = 1u << 18u;
+
+    for (const uint32 size : sizes)
+    {
+        const std::vector<std::string> names = MakeNames(size, "IA_Action_");
+        std::vector<std::string_view> views(names.begin(), names.end());
+        std::vector<SName> interned(names.begin(), names.end());
+
+        THashMap<std::string, uint32> stringMap;
+        THashMap<SName, uint32> nameMap;
+        for (uint32 i = 0u; i < size; ++i)
+        {
+            stringMap.Add(names[i], i);
+            nameMap.Add(interned[i], i);
+        }
+
+        uint64 stringSum = 0ull;
+        uint64 nameSum = 0ull;
+        const double stringHitNs = MeasureNs(lookupsPerRound, [&] ()
+        {
+            for (uint32 i = 0u; i < lookupsPerRound; ++i)
+            {
+                stringSum += *stringMap.Find(views[i & (size - 1u)]);
+            }
+        });
+        const double nameHitNs = MeasureNs(lookupsPerRound, [&] ()
+        {
+            for (uint32 i = 0u; i < lookupsPerRound; ++i)
+            {
+                nameSum += *nameMap.Find(interned[i & (size - 1u)]);
+            }
+        });
+        EXPECT_EQ(stringSum, nameSum);
+
+        std::printf("[ BENCH    ] name keys, %4u elements: hit %5.1f / %5.1f ns (SName / std::string by view)\n",
+            size, nameHitNs, stringHitNs);
+    }
+}
+
+TEST(ContainerSlotMap, EntityChurnBenchmark)
+{
+    CMemoryPool pool(256_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    static constexpr uint32 entityCount = 100000u;
+    static constexpr uint32 churnPerRound = 1u << 18u;
+    static constexpr uint32 iterationRounds = 64u;
+
+    // Each entity in its own block, the way the scene kept them before
+    TArray<TRefShared<SBenchEntity>> refs;
+    TSlotMap<SBenchEntity> map;
+    TArray<TSlotHandle<SBenchEntity>> handles;
+    map.Reserve(entityCount);
+    for (uint32 i = 0u; i < entityCount; ++i)
+    {
+        refs.Add(pool.NewShared<SBenchEntity>());
+        handles.Add(map.Emplace());
+    }
+
+    // Despawn a random entity and spawn a new one in its place
+    std::mt19937 rng(entityCount);
+    const double refChurnNs = MeasureNs(churnPerRound, [&] ()
+    {
+        for (uint32 i = 0u; i < churnPerRound; ++i)
+        {
+            const uint32 index = rng() % entityCount;
+            refs.RemoveAt<false>(index);
+            refs.Add(pool.NewShared<SBenchEntity>());
+        }
+    });
+    uint32 removed = 0u;
+    const double mapChurnNs = MeasureNs(churnPerRound, [&] ()
+    {
+        for (uint32 i = 0u; i < churnPerRound; ++i)
+        {
+            const uint32 index = rng() % entityCount;
+            removed += map.Remove(handles[index]) ? 1u : 0u;
+            handles[index] = map.Emplace();
+        }
+    });
+    EXPECT_EQ(removed, churnPerRound);
+
+    float refSum = 0.f;
+    float mapSum = 0.f;
+    const double refIterateNs = MeasureNs(entityCount * iterationRounds, [&] ()
+    {
+        for (uint32 round = 0u; round < iterationRounds; ++round)
+        {
+            for (TRefShared<SBenchEntity>& entity : refs)
+            {
+                entity->Transform[0] += entity->Speed;
+                refSum += entity->Transform[0];
+            }
+        }
+    });
+    const double mapIterateNs = MeasureNs(entityCount * iterationRounds, [&] ()
+    {
+        for (uint32 round = 0u; round < iterationRounds; ++round)
+        {
+            for (SBenchEntity& entity : map)
+            {
+                entity.Transform[0] += entity.Speed;
+                mapSum += entity.Transform[0];
+            }
+        }
+    });
+    EXPECT_EQ(map.Count(), entityCount);
+    EXPECT_GT(refSum, 0.f);
+    EXPECT_GT(mapSum, 0.f);
+
+    std::printf("[ BENCH    ] %u entities after churn: despawn+spawn %6.1f / %6.1f ns, iterate %5.2f / %5.2f ns "
+        "(TSlotMap / TArray<TRefShared>)\n",
+        entityCount, mapChurnNs, refChurnNs, mapIterateNs, refIterateNs);
+}
+
+TEST(ContainerSoAArray, RotationUpdateBenchmark)
+{
+    CMemoryPool pool(256_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    static constexpr uint32 entityCount = 100000u;
+    static constexpr uint32 rounds = 64u;
+    static constexpr float deltaSeconds = 1.f / 60.f;
+
+    TArray<SBenchTransformEntity> entities;
+    TSoAArray<SBenchVector, SBenchVector, SBenchVector, SBenchVector> columns;
+    columns.SetCapacity(entityCount);
+    for (uint32 i = 0u; i < entityCount; ++i)
+    {
+        SBenchTransformEntity& entity = entities.Add();
+        entity.RotationSpeed = { 1.f, (float)(i % 7u), 0.5f };
+        columns.Add(entity.Translation, entity.Rotation, entity.Scale, entity.RotationSpeed);
+    }
+
+    // Only rotation and its speed are touched, the rest of the entity comes along with them in the AoS case
+    const double aosNs = MeasureNs(entityCount * rounds, [&] ()
+    {
+        for (uint32 round = 0u; round < rounds; ++round)
+        {
+            for (SBenchTransformEntity& entity : entities)
+            {
+                entity.Rotation.X += entity.RotationSpeed.X * deltaSeconds;
+                entity.Rotation.Y += entity.RotationSpeed.Y * deltaSeconds;
+                entity.Rotation.Z += entity.RotationSpeed.Z * deltaSeconds;
+            }
+        }
+    });
+    const double soaNs = MeasureNs(entityCount * rounds, [&] ()
+    {
+        for (uint32 round = 0u; round < rounds; ++round)
+        {
+            SBenchVector* rotations = columns.GetColumn<1>();
+            const SBenchVector* speeds = columns.GetColumn<3>();
+            for (uint32 i = 0u; i < columns.Count(); ++i)
+            {
+                rotations[i].X += speeds[i].X * deltaSeconds;
+                rotations[i].Y += speeds[i].Y * deltaSeconds;
+                rotations[i].Z += speeds[i].Z * deltaSeconds;
+            }
+        }
+    });
+
+    for (uint32 i = 0u; i < entityCount; i += 997u)
+    {
+        EXPECT_FLOAT_EQ(columns.Get<1>(i).Y, entities[i].Rotation.Y);
+    }
+
+    std::printf("[ BENCH    ] %u entities: rotation update %5.2f / %5.2f ns (TSoAArray columns / TArray of structs)\n",
+        entityCount, soaNs, aosNs);
+}
+
+TEST(ContainerRadixSort, DrawKeyBenchmark)
+{
+    CMemoryPool pool(256_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    static constexpr uint32 packetCount = 100000u;
+    using SDrawKey = TSortKey<uint64, 8, 16, 32>;
+
+    // A handful of pipelines, a few hundred materials, random depths: what a frame of draw packets looks like
+    std::mt19937 random(42u);
+    std::uniform_real_distribution<float> depth(0.1f, 1000.f);
+    std::vector<uint64> baseKeys(packetCount);
+    for (uint32 i = 0u; i < packetCount; ++i)
+    {
+        baseKeys[i] = SDrawKey::Pack(random() % 6u, random() % 300u, sort::FloatToKey(depth(random)));
+    }
+
+    std::vector<std::pair<uint64, uint32>> stdPackets(packetCount);
+    TArray<uint64> keys(packetCount);
+    TArray<uint32> indices(packetCount);
+    TArray<uint64> parallelKeys(packetCount);
+    TArray<uint32> parallelIndices(packetCount);
+    auto reset = [&] ()
+    {
+        keys.Clear();
+        indices.Clear();
+        parallelKeys.Clear();
+        parallelIndices.Clear();
+        for (uint32 i = 0u; i < packetCount; ++i)
+        {
+            stdPackets[i] = { baseKeys[i], i };
+            keys.Add(baseKeys[i]);
+            indices.Add(i);
+            parallelKeys.Add(baseKeys[i]);
+            parallelIndices.Add(i);
+        }
+    };
+    reset();
+
+    const double stdNs = MeasureNs(packetCount, [&] ()
+    {
+        std::stable_sort(stdPackets.begin(), stdPackets.end(),
+            [] (const auto& Lhs, const auto& Rhs) { return Lhs.first < Rhs.first; });
+    });
+    const double radixNs = MeasureNs(packetCount, [&] ()
+    {
+        RadixSortPairs(keys, indices);
+    });
+    const double parallelNs = MeasureNs(packetCount, [&] ()
+    {
+        ParallelRadixSortPairs(parallelKeys, parallelIndices);
+    });
+
+    for (uint32 i = 0u; i < packetCount; ++i)
+    {
+        ASSERT_EQ(keys[i], stdPackets[i].first);
+        ASSERT_EQ(indices[i], stdPackets[i].second);
+        ASSERT_EQ(parallelIndices[i], stdPackets[i].second);
+    }
+
+    std::printf("[ BENCH    ] %u draw keys: sort %5.2f / %5.2f / %5.2f ns per key (radix / parallel radix / std::stable_sort)\n",
+        packetCount, radixNs, parallelNs, stdNs);
+}
+
+TEST(ContainerFlatMap, LookupBySizeBenchmark)
+{
+    CMemoryPool pool(256_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    static constexpr uint32 lookupsPerSize = 1u << 20;
+
+    // Linear and binary searches are timed on their own on the same keys, to see where TFlatMap should switch
+    auto linearLowerBound = [] (const uint32* Keys, uint32 Count, uint32 Key)
+    {
+        uint32 index = 0u;
+        for (uint32 i = 0u; i < Count; ++i)
+        {
+            index += Keys[i] < Key ? 1u : 0u;
+        }
+        return index;
+    };
+    auto binaryLowerBound = [] (const uint32* Keys, uint32 Count, uint32 Key)
+    {
+        const uint32* base = Keys;
+        while (Count > 1u)
+        {
+            const uint32 half = Count / 2u;
+            base = base[half] < Key ? base + half : base;
+            Count -= half;
+        }
+        return (uint32)(base - Keys) + (*base < Key ? 1u : 0u);
+    };
+
+    std::mt19937 random(7u);
+    for (uint32 size = 1u; size <= 1024u; size *= 2u)
+    {
+        TFlatMap<uint32, uint32> flatMap;
+        THashMap<uint32, uint32> hashMap;
+        std::vector<uint32> lookups(lookupsPerSize);
+        for (uint32 i = 0u; i < size; ++i)
+        {
+            flatMap.AddUnsorted(i * 3u, i);
+            hashMap.Add(i * 3u, i);
+        }
+        flatMap.Sort();
+        for (uint32& key : lookups)
+        {
+            key = (uint32)(random() % size) * 3u;
+        }
+        const uint32* keys = flatMap.GetKeys().GetData();
+
+        uint64 checksum[4] = {};
+        const double linearNs = MeasureNs(lookupsPerSize, [&] ()
+        {
+            for (uint32 key : lookups)
+            {
+                checksum[0] += linearLowerBound(keys, size, key);
+            }
+        });
+        const double binaryNs = MeasureNs(lookupsPerSize, [&] ()
+        {
+            for (uint32 key : lookups)
+            {
+                checksum[1] += binaryLowerBound(keys, size, key);
+            }
+        });
+        const double flatNs = MeasureNs(lookupsPerSize, [&] ()
+        {
+            for (uint32 key : lookups)
+            {
+                checksum[2] += *flatMap.Find(key);
+            }
+        });
+        const double hashNs = MeasureNs(lookupsPerSize, [&] ()
+        {
+            for (uint32 key : lookups)
+            {
+                checksum[3] += *hashMap.Find(key);
+            }
+        });
+
+        EXPECT_EQ(checksum[0], checksum[1]);
+        EXPECT_EQ(checksum[1], checksum[2]);
+        EXPECT_EQ(checksum[2], checksum[3]);
+
+        std::printf("[ BENCH    ] %4u keys: lookup %5.2f / %5.2f / %5.2f / %5.2f ns (linear / binary / TFlatMap / THashMap)\n",
+            size, linearNs, binaryNs, flatNs, hashNs);
+    }
+}
+
+TEST(EcsRegistry, RotationUpdateBenchmark)
+{
+    CMemoryPool pool(512_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    static constexpr uint32 entityCount = 200000u;
+    static constexpr uint32 rounds = 16u;
+    static constexpr float deltaSeconds = 1.f / 60.f;
+
+    // Spawned interleaved with other allocations, the way a running game gets them
+    TArray<TRefShared<SBenchTransformEntity>> refs;
+    TArray<TRefShared<SBenchEntity>> noise;
+    ecs::CEntityRegistry registry;
+    TArray<EntityHandle> handles;
+    for (uint32 i = 0u; i < entityCount; ++i)
+    {
+        TRefShared<SBenchTransformEntity>& entity = refs.Add(pool.NewShared<SBenchTransformEntity>());
+        entity->RotationSpeed = { 1.f, (float)(i % 7u), 0.5f };
+        noise.Add(pool.NewShared<SBenchEntity>());
+
+        handles.Add(registry.Create(SBenchEntity(), SBenchRotation(), SBenchRotationSpeed { entity->RotationSpeed }));
+    }
+    noise.Clear();
+
+    const double refNs = MeasureNs(entityCount * rounds, [&] ()
+    {
+        for (uint32 round = 0u; round < rounds; ++round)
+        {
+            for (TRefShared<SBenchTransformEntity>& entity : refs)
+            {
+                entity->Rotation.X += entity->RotationSpeed.X * deltaSeconds;
+                entity->Rotation.Y += entity->RotationSpeed.Y * deltaSeconds;
+                entity->Rotation.Z += entity->RotationSpeed.Z * deltaSeconds;
+            }
+        }
+    });
+    const double ecsNs = MeasureNs(entityCount * rounds, [&] ()
+    {
+        for (uint32 round = 0u; round < rounds; ++round)
+        {
+            registry.ForEach<SBenchRotation, const SBenchRotationSpeed>(
+                [] (SBenchRotation& Rotation, const SBenchRotationSpeed& Speed)
+                {
+                    Rotation.Value.X += Speed.Value.X * deltaSeconds;
+                    Rotation.Value.Y += Speed.Value.Y * deltaSeconds;
+                    Rotation.Value.Z += Speed.Value.Z * deltaSeconds;
+                });
+        }
+    });
+
+    for (uint32 i = 0u; i < entityCount; i += 997u)
+    {
+        EXPECT_FLOAT_EQ(registry.Get<SBenchRotation>(handles[i]).Value.Y, refs[i]->Rotation.Y);
+    }
+
+    // Despawning a random entity and spawning a new one in its place
+    std::mt19937 rng(entityCount);
+    static constexpr uint32 churnCount = 1u << 16u;
+    const double churnNs = MeasureNs(churnCount, [&] ()
+    {
+        for (uint32 i = 0u; i < churnCount; ++i)
+        {
+            const uint32 index = rng() % entityCount;
+            registry.Destroy(handles[index]);
+            handles[index] = registry.Create(SBenchEntity(), SBenchRotation(), SBenchRotationSpeed());
+        }
+    });
+    EXPECT_EQ(registry.Count(), entityCount);
+
+    std::printf("[ BENCH    ] %u entities: rotation update %5.2f / %5.2f ns (CEntityRegistry / TArray<TRefShared>), "
+        "despawn+spawn %6.1f ns\n",
+        entityCount, ecsNs, refNs, churnNs);
+}
+
+TEST(JobSystem, ParallelForEachBenchmark)
+{
+    CMemoryPool pool(512_Mb, EMemoryPoolFlags::ThreadSafe);
+    pool.MakeThisPrimaryInstance();
+    jobs::CJobSystem jobSystem;
+    jobSystem.MakeThisPrimaryInstance();
+
+    static constexpr uint32 entityCount = 200000u;
+    static constexpr uint32 rounds = 16u;
+    static constexpr float deltaSeconds = 1.f / 60.f;
+
+    ecs::CEntityRegistry registry;
+    for (uint32 i = 0u; i < entityCount; ++i)
+    {
+        registry.Create(SBenchEntity(), SBenchRotation(), SBenchRotationSpeed { { 1.f, (float)(i % 7u), 0.5f } });
+    }
+
+    // Rotation update plus the sines and cosines of a rotation matrix, about what RunFrame does per entity
+    const auto update = [] (SBenchRotation& Rotation, SBenchEntity& Entity, const SBenchRotationSpeed& Speed)
+    {
+        Rotation.Value.X += Speed.Value.X * deltaSeconds;
+        Rotation.Value.Y += Speed.Value.Y * deltaSeconds;
+        Rotation.Value.Z += Speed.Value.Z * deltaSeconds;
+        Entity.Transform[0] = std::cos(Rotation.Value.Y) * std::cos(Rotation.Value.Z);
+        Entity.Transform[5] = std::sin(Rotation.Value.X) * std::sin(Rotation.Value.Y);
+        Entity.Transform[10] = std::cos(Rotation.Value.X) * std::sin(Rotation.Value.Z);
+    };
+
+    const double serialNs = MeasureNs(entityCount * rounds, [&] ()
+    {
+        for (uint32 round = 0u; round < rounds; ++round)
+        {
+            registry.ForEach<SBenchRotation, SBenchEntity, const SBenchRotationSpeed>(update);
+        }
+    });
+    const double parallelNs = MeasureNs(entityCount * rounds, [&] ()
+    {
+        for (uint32 round = 0u; round < rounds; ++round)
+        {
+            registry.ParallelForEach<SBenchRotation, SBenchEntity, const SBenchRotationSpeed>(update);
+        }
+    });
+
+    float expectedY = 0.f;
+    for (uint32 round = 0u; round < rounds * 2u; ++round)
+    {
+        expectedY += 6.f * deltaSeconds;
+    }
+    uint32 wrongCount = 0u;
+    registry.ForEach<const SBenchRotation, const SBenchRotationSpeed>(
+        [&] (const SBenchRotation& Rotation, const SBenchRotationSpeed& Speed)
+        {
+            wrongCount += Speed.Value.Y == 6.f && Rotation.Value.Y != expectedY;
+        });
+    EXPECT_EQ(wrongCount, 0u);
+
+    std::printf("[ BENCH    ] %u entities, %u threads: update %5.2f / %5.2f ns (ParallelForEach / ForEach)\n",
+        entityCount, jobSystem.GetThreadCount(), parallelNs, serialNs);
+}
+
+TEST(TransformBatch, ComposeMatricesBenchmark)
+{
+    static constexpr uint32 transformCount = 100000u;
+    static constexpr uint32 rounds = 8u;
+
+    std::mt19937 random(11u);
+    std::uniform_real_distribution<float> values(-3.f, 3.f);
+    std::vector<float> components[9];
+    for (std::vector<float>& component : components)
+    {
+        component.resize(transformCount);
+        for (float& value : component)
+        {
+            value = values(random);
+        }
+    }
+
+    math::STransformArrays arrays;
+    arrays.TranslationX = components[0].data();
+    arrays.TranslationY = components[1].data();
+    arrays.TranslationZ = components[2].data();
+    arrays.RotationX = components[3].data();
+    arrays.RotationY = components[4].data();
+    arrays.RotationZ = components[5].data();
+    arrays.ScaleX = components[6].data();
+    arrays.ScaleY = components[7].data();
+    arrays.ScaleZ = components[8].data();
+    arrays.Count = transformCount;
+
+    std::vector<DirectX::XMFLOAT4X4> scalarMatrices(transformCount);
+    std::vector<DirectX::XMFLOAT4X4> batchedMatrices(transformCount);
+
+    const double scalarNs = MeasureNs(transformCount * rounds, [&] ()
+    {
+        for (uint32 round = 0u; round < rounds; ++round)
+        {
+            math::ComposeMatricesScalar(arrays, scalarMatrices.data());
+        }
+    });
+    const double batchedNs = MeasureNs(transformCount * rounds, [&] ()
+    {
+        for (uint32 round = 0u; round < rounds; ++round)
+        {
+            math::ComposeMatrices(arrays, batchedMatrices.data());
+        }
+    });
+
+    EXPECT_EQ(std::memcmp(scalarMatrices.data(), batchedMatrices.data(), transformCount * sizeof(DirectX::XMFLOAT4X4)), 0);
+
+    std::printf("[ BENCH    ] %u transforms: compose %5.2f / %5.2f ns (%s / scalar)\n",
+        transformCount, batchedNs, scalarNs, math::GetTransformBatchInstructionSet());
+}
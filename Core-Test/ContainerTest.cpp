@@ -1,6 +1,25 @@
-﻿#include <gtest/gtest.h>
+﻿#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
 
 #include "Containers/Array.h"
+#include "Containers/BitArray.h"
+#include "Containers/ChunkedArray.h"
+#include "Containers/FlatMap.h"
+#include "Containers/HashMap.h"
+#include "Containers/HashSet.h"
+#include "Containers/InlineArray.h"
+#include "Containers/MpscRingBuffer.h"
+#include "Containers/RadixSort.h"
+#include "Containers/RingBuffer.h"
+#include "Containers/SlotMap.h"
+#include "Containers/SoAArray.h"
+#include "Memory/FrameArena.h"
 
 
 using uint32 = uint32_t;
@@ -15,6 +34,57 @@ using namespace frt::memory::literals;
     testAllocator.MakeThisPrimaryInstance();
 
 
+namespace
+{
+// Stateful allocator that counts the blocks it holds
+class CCountingAllocator
+{
+public:
+    static CCountingAllocator* GetPrimaryInstance() { return PrimaryInstance; }
+
+    void* ReAllocate(void* Memory, uint64 Size)
+    {
+        LiveCount += Memory ? 0 : 1;
+        return std::realloc(Memory, Size);
+    }
+
+    void Free(void* Memory)
+    {
+        LiveCount -= Memory ? 1 : 0;
+        std::free(Memory);
+    }
+
+    int LiveCount = 0;
+
+    static inline CCountingAllocator* PrimaryInstance = nullptr;
+};
+
+struct SMallocAllocator
+{
+    void* ReAllocate(void* Memory, uint64 Size) { return std::realloc(Memory, Size); }
+    void Free(void* Memory) { std::free(Memory); }
+};
+
+// Knows its own address, so a bitwise relocation is caught
+struct SSelfAware
+{
+    SSelfAware(int InValue = 0) : Value(InValue) {}
+    SSelfAware(const SSelfAware& Other) : Value(Other.Value) {}
+    SSelfAware(SSelfAware&& Other) noexcept : Value(Other.Value) {}
+    SSelfAware& operator=(const SSelfAware& Other) { Value = Other.Value; return *this; }
+    ~SSelfAware() { EXPECT_EQ(Self, this); }
+
+    SSelfAware* Self = this;
+    int Value = 0;
+};
+
+struct SRefCounted
+{
+    int Value = 0;
+};
+}
+
+
 TEST(TArrayTest, DefaultConstructor)
 {
     PREPARE_ALLOCATOR()
@@ -159,6 +229,36 @@ TEST(TArrayTest, CopyAssignmentOperator)
     EXPECT_EQ(copy[1], 20);
 }
 
+TEST(TArrayTest, CopyAssignmentNonTrivialTest)
+{
+    PREPARE_ALLOCATOR()
+
+    // Targets are filled first, so the larger sources behind them keep their buffers from growing in place
+    TArray<std::string> strings;
+    strings.Add(std::string(40, 'x'));
+    TArray<SSelfAware> selfAware;
+    selfAware.Add(SSelfAware(-1));
+
+    TArray<std::string> otherStrings;
+    TArray<SSelfAware> otherSelfAware;
+    for (int i = 0; i < 20; ++i)
+    {
+        otherStrings.Add(std::string(40, (char)('a' + i)));
+        otherSelfAware.Add(SSelfAware(i));
+    }
+
+    strings = otherStrings;
+    selfAware = otherSelfAware;
+    ASSERT_EQ(strings.Count(), 20u);
+    ASSERT_EQ(selfAware.Count(), 20u);
+    for (int i = 0; i < 20; ++i)
+    {
+        EXPECT_EQ(strings[i], std::string(40, (char)('a' + i)));
+        EXPECT_EQ(selfAware[i].Value, i);
+    }
+    EXPECT_EQ(otherStrings[19], std::string(40, 't'));
+}
+
 TEST(TArrayTest, MoveAssignmentOperator)
 {
     PREPARE_ALLOCATOR()
@@ -357,3 +457,1435 @@ TEST(TArrayTest, InsertWithMoveTest)
     EXPECT_EQ(arr.GetSize(), 2);
     EXPECT_EQ(arr[1], 2);
 }
+
+TEST(TArrayTest, AllocatorInstanceTest)
+{
+    CCountingAllocator primary;
+    CCountingAllocator other;
+    CCountingAllocator::PrimaryInstance = &primary;
+
+    {
+        TArray<int, CCountingAllocator> defaultArr;
+        TArray<int, CCountingAllocator> otherArr(&other);
+        EXPECT_EQ(defaultArr.GetAllocator(), &primary);
+        EXPECT_EQ(otherArr.GetAllocator(), &other);
+
+        defaultArr.Add(1);
+        otherArr.Add(2);
+        EXPECT_EQ(primary.LiveCount, 1);
+        EXPECT_EQ(other.LiveCount, 1);
+
+        // Bound on first allocation, so later primary changes don't matter
+        CCountingAllocator::PrimaryInstance = &other;
+        EXPECT_EQ(defaultArr.GetAllocator(), &primary);
+        defaultArr.SetCapacity(100);
+        EXPECT_EQ(primary.LiveCount, 1);
+        EXPECT_EQ(other.LiveCount, 1);
+    }
+
+    EXPECT_EQ(primary.LiveCount, 0);
+    EXPECT_EQ(other.LiveCount, 0);
+    CCountingAllocator::PrimaryInstance = nullptr;
+}
+
+TEST(TArrayTest, AllocatorCopyMoveSwapTest)
+{
+    CCountingAllocator first;
+    CCountingAllocator second;
+
+    {
+        TArray<int, CCountingAllocator> a(&first);
+        a.Add(1);
+        a.Add(2);
+
+        TArray<int, CCountingAllocator> copied(a);
+        EXPECT_EQ(copied.GetAllocator(), &first);
+        EXPECT_EQ(first.LiveCount, 2);
+
+        // Assignment keeps the allocator of the destination
+        TArray<int, CCountingAllocator> b(&second);
+        b = a;
+        EXPECT_EQ(b.GetAllocator(), &second);
+        EXPECT_EQ(b.GetSize(), 2);
+        EXPECT_EQ(second.LiveCount, 1);
+
+        // Different instances, so elements are moved and the source buffer is freed
+        b = std::move(copied);
+        EXPECT_EQ(b.GetAllocator(), &second);
+        EXPECT_EQ(b[1], 2);
+        EXPECT_TRUE(copied.IsEmpty());
+        EXPECT_EQ(first.LiveCount, 1);
+        EXPECT_EQ(second.LiveCount, 1);
+
+        // Same instance, so the buffer changes hands
+        TArray<int, CCountingAllocator> c(&first);
+        c.Add(3);
+        const int* buffer = a.GetData();
+        c = std::move(a);
+        EXPECT_EQ(c.GetData(), buffer);
+        EXPECT_EQ(first.LiveCount, 1);
+
+        TArray<int, CCountingAllocator> moved(std::move(c));
+        EXPECT_EQ(moved.GetAllocator(), &first);
+        EXPECT_EQ(moved.GetData(), buffer);
+
+        moved.Swap(b);
+        EXPECT_EQ(moved.GetAllocator(), &second);
+        EXPECT_EQ(b.GetAllocator(), &first);
+        EXPECT_EQ(b.GetData(), buffer);
+    }
+
+    EXPECT_EQ(first.LiveCount, 0);
+    EXPECT_EQ(second.LiveCount, 0);
+}
+
+TEST(TArrayTest, AllocatorPoolInstanceTest)
+{
+    PREPARE_ALLOCATOR()
+
+    CMemoryPool otherPool(10_Mb);
+
+    TArray<int> arr(16u, &otherPool);
+    EXPECT_EQ(arr.GetAllocator(), &otherPool);
+    for (int i = 0; i < 100; i++)
+    {
+        arr.Add(i);
+    }
+    EXPECT_EQ(arr[99], 99);
+
+    TArray<int> primaryArr;
+    EXPECT_EQ(primaryArr.GetAllocator(), &testAllocator);
+}
+
+TEST(TArrayTest, StatelessAllocatorTest)
+{
+    static_assert(sizeof(TArray<int, SMallocAllocator>) == sizeof(int*) + 2 * sizeof(uint32));
+
+    TArray<int, SMallocAllocator> arr;
+    for (int i = 0; i < 10; i++)
+    {
+        arr.Add(i);
+    }
+
+    TArray<int, SMallocAllocator> moved;
+    moved = std::move(arr);
+    EXPECT_EQ(moved.GetSize(), 10);
+    EXPECT_TRUE(arr.IsEmpty());
+}
+
+TEST(TInlineArrayTest, InlineStorageTest)
+{
+    CCountingAllocator allocator;
+
+    TInlineArray<int, 4, CCountingAllocator> arr(&allocator);
+    for (int i = 0; i < 4; i++)
+    {
+        arr.Add(i);
+    }
+    EXPECT_TRUE(arr.IsInline());
+    EXPECT_EQ(arr.GetCapacity(), 4);
+    EXPECT_EQ(allocator.LiveCount, 0);
+
+    arr.Add(4);
+    EXPECT_FALSE(arr.IsInline());
+    EXPECT_EQ(allocator.LiveCount, 1);
+    for (int i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(arr[i], i);
+    }
+
+    arr.RemoveAt(0);
+    arr.ShrinkToFit();
+    EXPECT_TRUE(arr.IsInline());
+    EXPECT_EQ(allocator.LiveCount, 0);
+    EXPECT_EQ(arr.First(), 1);
+    EXPECT_EQ(arr.Last(), 4);
+}
+
+TEST(TInlineArrayTest, NonTrivialElementsTest)
+{
+    CCountingAllocator allocator;
+
+    {
+        TInlineArray<std::string, 2, CCountingAllocator> arr(&allocator);
+        arr.Add("first string that is long enough to live on the heap");
+        arr.Add("second");
+        arr.Insert(std::string("zero"), 0);
+        arr.Insert(std::string("last"), 3);
+        ASSERT_EQ(arr.GetSize(), 4);
+        EXPECT_EQ(arr[0], "zero");
+        EXPECT_EQ(arr[1], "first string that is long enough to live on the heap");
+        EXPECT_EQ(arr[3], "last");
+
+        // Argument referencing an element that moves during growth
+        arr.Add(arr[1]);
+        EXPECT_EQ(arr.Last(), arr[1]);
+
+        TInlineArray<std::string, 2, CCountingAllocator> copied(arr);
+        EXPECT_EQ(copied.GetAllocator(), &allocator);
+        EXPECT_EQ(copied.GetSize(), arr.GetSize());
+        EXPECT_EQ(copied[4], arr[4]);
+
+        const std::string duplicate = arr[1];
+        EXPECT_EQ(arr.RemoveAll(duplicate), 2);
+        EXPECT_EQ(arr.GetSize(), 3);
+        EXPECT_EQ(arr[1], "second");
+
+        TInlineArray<std::string, 2, CCountingAllocator> moved(std::move(copied));
+        EXPECT_TRUE(copied.IsEmpty());
+        EXPECT_TRUE(copied.IsInline());
+        EXPECT_EQ(moved.GetSize(), 5);
+    }
+
+    EXPECT_EQ(allocator.LiveCount, 0);
+}
+
+TEST(TInlineArrayTest, SwapTest)
+{
+    CCountingAllocator allocator;
+
+    {
+        TInlineArray<std::string, 2, CCountingAllocator> small(&allocator);
+        small.Add("a");
+
+        TInlineArray<std::string, 2, CCountingAllocator> large(&allocator);
+        large = { "b", "c", "d" };
+        EXPECT_FALSE(large.IsInline());
+
+        small.Swap(large);
+        EXPECT_FALSE(small.IsInline());
+        EXPECT_TRUE(large.IsInline());
+        EXPECT_EQ(small.GetSize(), 3);
+        EXPECT_EQ(small[2], "d");
+        EXPECT_EQ(large.GetSize(), 1);
+        EXPECT_EQ(large[0], "a");
+
+        TInlineArray<std::string, 2, CCountingAllocator> other(&allocator);
+        other = { "e", "f" };
+        large.Swap(other);
+        EXPECT_EQ(large.GetSize(), 2);
+        EXPECT_EQ(large[1], "f");
+        EXPECT_EQ(other.GetSize(), 1);
+        EXPECT_EQ(other[0], "a");
+    }
+
+    EXPECT_EQ(allocator.LiveCount, 0);
+}
+
+TEST(TInlineArrayTest, IndexStrategyTest)
+{
+    TInlineArray<int, 4, SMallocAllocator> arr = { 1, 2, 3 };
+
+    EXPECT_FALSE(arr.IsIndexValid(3));
+    EXPECT_TRUE(arr.IsIndexValid<ArrayIndexStrategy::IS_Circular>(3));
+    EXPECT_EQ(arr.Get<ArrayIndexStrategy::IS_Circular>(-1), 3);
+    EXPECT_EQ(arr.Get<ArrayIndexStrategy::IS_Circular>(4), 2);
+
+    arr.RemoveAt<false>(0);
+    EXPECT_EQ(arr[0], 3);
+
+    TInlineArray<int, 4, SMallocAllocator> empty;
+    EXPECT_FALSE(empty.IsIndexValid(0));
+    EXPECT_FALSE(empty.IsIndexValid<ArrayIndexStrategy::IS_Circular>(0));
+}
+
+TEST(TArrayTest, MoveAwareGrowthTest)
+{
+    PREPARE_ALLOCATOR()
+
+    static_assert(!IsTriviallyRelocatable<SSelfAware>);
+
+    TArray<SSelfAware> arr;
+    TArray<int> neighbour;
+    for (int i = 0; i < 1000; i++)
+    {
+        arr.Add(SSelfAware(i));
+        neighbour.Add(i);
+    }
+
+    for (int i = 0; i < 1000; i++)
+    {
+        EXPECT_EQ(arr[i].Self, &arr[i]);
+        EXPECT_EQ(arr[i].Value, i);
+    }
+
+    arr.SetSize(10);
+    arr.ShrinkToFit();
+    EXPECT_EQ(arr.GetCapacity(), 10);
+    EXPECT_EQ(arr[9].Self, &arr[9]);
+}
+
+TEST(TArrayTest, ShrinkToFitReleasesMemoryTest)
+{
+    PREPARE_ALLOCATOR()
+
+    TArray<int> arr;
+    for (int i = 0; i < 10000; i++)
+    {
+        arr.Add(i);
+    }
+    const uint64 usedBefore = testAllocator.GetHeapReport().UsedBytes;
+
+    arr.SetSize(10);
+    arr.ShrinkToFit();
+    EXPECT_EQ(arr.GetCapacity(), 10);
+    EXPECT_EQ(arr[9], 9);
+    EXPECT_LT(testAllocator.GetHeapReport().UsedBytes, usedBefore);
+
+    arr.Clear();
+    arr.ShrinkToFit();
+    EXPECT_EQ(arr.GetCapacity(), 0);
+    EXPECT_EQ(arr.GetData(), nullptr);
+}
+
+TEST(TArrayTest, RelocatedRefsTest)
+{
+    PREPARE_ALLOCATOR()
+
+    static_assert(IsTriviallyRelocatable<TRefShared<SRefCounted>>);
+    static_assert(IsTriviallyRelocatable<TArray<std::string>>);
+    static_assert(!IsTriviallyRelocatable<TInlineArray<std::string, 2>>);
+
+    TRefShared<SRefCounted> ref = testAllocator.NewShared<SRefCounted>();
+    const TRefWeak<SRefCounted> weak = ref.GetWeak();
+
+    {
+        TArray<TRefShared<SRefCounted>> arr;
+        TArray<int> neighbour;
+        for (int i = 0; i < 1000; i++)
+        {
+            arr.Add(ref);
+            neighbour.Add(i);
+        }
+        EXPECT_EQ(arr[999].GetRawIgnoringLifetime(), ref.GetRawIgnoringLifetime());
+    }
+
+    ref.Release();
+    EXPECT_FALSE(weak);
+}
+
+TEST(THashMapTest, AddFindRemoveTest)
+{
+    PREPARE_ALLOCATOR()
+
+    THashMap<int, int> map;
+    EXPECT_TRUE(map.IsEmpty());
+    EXPECT_EQ(map.Find(1), nullptr);
+    EXPECT_EQ(map.GetCapacity(), 0);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        map.Add(i, i * 10);
+    }
+    EXPECT_EQ(map.Count(), 1000);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        ASSERT_NE(map.Find(i), nullptr);
+        EXPECT_EQ(*map.Find(i), i * 10);
+    }
+    EXPECT_EQ(map.Find(1000), nullptr);
+
+    for (int i = 0; i < 1000; i += 2)
+    {
+        EXPECT_TRUE(map.Remove(i));
+    }
+    EXPECT_FALSE(map.Remove(0));
+    EXPECT_EQ(map.Count(), 500);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        EXPECT_EQ(map.Contains(i), i % 2 == 1);
+    }
+
+    // Add replaces the value, Emplace keeps it
+    map.Add(1, -1);
+    map.Emplace(3, -3);
+    EXPECT_EQ(*map.Find(1), -1);
+    EXPECT_EQ(*map.Find(3), 30);
+    EXPECT_EQ(map.FindOrAdd(4), 0);
+    EXPECT_EQ(map.Count(), 501);
+
+    int sum = 0;
+    uint32 visited = 0;
+    for (const auto& [key, value] : map)
+    {
+        sum += key;
+        ++visited;
+    }
+    EXPECT_EQ(visited, map.Count());
+    EXPECT_EQ(sum, 250000 + 4);
+
+    map.Clear();
+    EXPECT_TRUE(map.IsEmpty());
+    EXPECT_GT(map.GetCapacity(), 0);
+    EXPECT_EQ(map.Find(1), nullptr);
+}
+
+TEST(THashMapTest, StringKeysTest)
+{
+    PREPARE_ALLOCATOR()
+
+    THashMap<std::string, uint32> map;
+    map.Add(std::string("Jump"), 0u);
+    map.Add("Crouch", 1u);
+
+    const std::string_view jump = "Jump";
+    ASSERT_NE(map.Find(jump), nullptr);
+    EXPECT_EQ(*map.Find(jump), 0u);
+    EXPECT_EQ(*map.Find("Crouch"), 1u);
+    EXPECT_EQ(*map.Find(std::string("Crouch")), 1u);
+    EXPECT_EQ(map.Find("Fire"), nullptr);
+
+    map.FindOrAdd(std::string_view("Fire")) = 2u;
+    EXPECT_EQ(*map.Find("Fire"), 2u);
+    EXPECT_TRUE(map.Remove(jump));
+    EXPECT_FALSE(map.Contains("Jump"));
+    EXPECT_EQ(map.Count(), 2);
+}
+
+TEST(THashMapTest, TombstoneChurnTest)
+{
+    PREPARE_ALLOCATOR()
+
+    // Keys never repeat, so every removal leaves a tombstone or an empty slot behind
+    THashMap<uint64, uint64> map;
+    for (uint64 i = 0; i < 100000; i++)
+    {
+        map.Add(i, i);
+        if (i >= 8)
+        {
+            EXPECT_TRUE(map.Remove(i - 8));
+        }
+    }
+
+    EXPECT_EQ(map.Count(), 8);
+    EXPECT_LE(map.GetCapacity(), 32);
+    for (uint64 i = 100000 - 8; i < 100000; i++)
+    {
+        EXPECT_EQ(*map.Find(i), i);
+    }
+}
+
+TEST(THashMapTest, AllocatorCopyMoveTest)
+{
+    CCountingAllocator first;
+    CCountingAllocator second;
+
+    {
+        THashMap<std::string, std::string, CCountingAllocator> a(&first);
+        for (int i = 0; i < 100; i++)
+        {
+            a.Add(std::to_string(i), std::string(40, (char)('a' + i % 26)));
+        }
+        EXPECT_EQ(first.LiveCount, 1);
+
+        THashMap<std::string, std::string, CCountingAllocator> copied(a);
+        EXPECT_EQ(copied.GetAllocator(), &first);
+        EXPECT_EQ(copied.Count(), 100);
+        EXPECT_EQ(*copied.Find("42"), std::string(40, 'q'));
+
+        // Different instances, so pairs are moved and the source block is freed
+        THashMap<std::string, std::string, CCountingAllocator> b(&second);
+        b = std::move(copied);
+        EXPECT_EQ(b.GetAllocator(), &second);
+        EXPECT_TRUE(copied.IsEmpty());
+        EXPECT_EQ(*b.Find("99"), std::string(40, 'v'));
+        EXPECT_EQ(first.LiveCount, 1);
+        EXPECT_EQ(second.LiveCount, 1);
+
+        THashMap<std::string, std::string, CCountingAllocator> moved(std::move(a));
+        EXPECT_EQ(moved.GetAllocator(), &first);
+        EXPECT_EQ(moved.Count(), 100);
+
+        moved.Swap(b);
+        EXPECT_EQ(moved.GetAllocator(), &second);
+        EXPECT_EQ(b.GetAllocator(), &first);
+    }
+
+    EXPECT_EQ(first.LiveCount, 0);
+    EXPECT_EQ(second.LiveCount, 0);
+}
+
+TEST(THashMapTest, FrameArenaTest)
+{
+    PREPARE_ALLOCATOR()
+
+    CFrameArena arena(&testAllocator, 64_Kb, 2u);
+
+    THashMap<const SRefCounted*, uint32, CFrameArena> map(&arena);
+    map.Reserve(100);
+    const uint32 capacity = map.GetCapacity();
+    EXPECT_GE(capacity, 100);
+
+    SRefCounted objects[100];
+    for (uint32 i = 0; i < 100; i++)
+    {
+        map.Add(&objects[i], i);
+    }
+    EXPECT_EQ(map.GetCapacity(), capacity);
+    EXPECT_EQ(*map.Find(&objects[57]), 57);
+    EXPECT_GT(arena.GetUsedSize(), 0);
+}
+
+TEST(THashSetTest, AddContainsRemoveTest)
+{
+    PREPARE_ALLOCATOR()
+
+    THashSet<std::string> set;
+    EXPECT_TRUE(set.Add(std::string("a")));
+    EXPECT_TRUE(set.Add("b"));
+    EXPECT_FALSE(set.Add(std::string_view("a")));
+    EXPECT_EQ(set.Count(), 2);
+
+    EXPECT_TRUE(set.Contains("a"));
+    ASSERT_NE(set.Find(std::string_view("b")), nullptr);
+    EXPECT_EQ(*set.Find("b"), "b");
+
+    EXPECT_TRUE(set.Remove("a"));
+    EXPECT_FALSE(set.Contains("a"));
+
+    THashSet<int> ints;
+    for (int i = 0; i < 100; i++)
+    {
+        ints.Add(i % 10);
+    }
+    EXPECT_EQ(ints.Count(), 10);
+}
+
+TEST(TSlotMapTest, AddFindRemoveTest)
+{
+    PREPARE_ALLOCATOR()
+
+    TSlotMap<std::string> map;
+    const auto a = map.Add("a");
+    const auto b = map.Add("b");
+    const auto c = map.Emplace(3, 'c');
+    EXPECT_EQ(map.Count(), 3);
+    EXPECT_TRUE(a.IsValid());
+    EXPECT_FALSE(TSlotHandle<std::string>().IsValid());
+
+    EXPECT_EQ(map.Get(a), "a");
+    ASSERT_NE(map.Find(c), nullptr);
+    EXPECT_EQ(*map.Find(c), "ccc");
+
+    // Removal moves the last element into the hole, handles keep pointing at their elements
+    EXPECT_TRUE(map.Remove(a));
+    EXPECT_FALSE(map.Remove(a));
+    EXPECT_FALSE(map.Contains(a));
+    EXPECT_EQ(map.Find(a), nullptr);
+    EXPECT_EQ(map.Count(), 2);
+    EXPECT_EQ(map.IndexOf(c), 0);
+    EXPECT_EQ(map.GetHandle(0), c);
+    EXPECT_EQ(map.Get(b), "b");
+    EXPECT_EQ(map.Get(c), "ccc");
+    EXPECT_EQ(map.IndexOf(a), map.Count());
+
+    // Slot of a is reused, but its old handle stays stale
+    const auto d = map.Add("d");
+    EXPECT_EQ(d.GetIndex(), a.GetIndex());
+    EXPECT_NE(d, a);
+    EXPECT_FALSE(map.Contains(a));
+    EXPECT_EQ(map.Get(d), "d");
+
+    map.Clear();
+    EXPECT_TRUE(map.IsEmpty());
+    EXPECT_FALSE(map.Contains(b));
+    EXPECT_FALSE(map.Contains(d));
+}
+
+TEST(TSlotMapTest, ChurnKeepsElementsDenseTest)
+{
+    PREPARE_ALLOCATOR()
+
+    TSlotMap<SSelfAware> map;
+    TArray<TSlotHandle<SSelfAware>> handles;
+    for (int i = 0; i < 1000; i++)
+    {
+        handles.Add(map.Emplace(i));
+    }
+
+    // Remove every other one, the rest must still be found by their handles
+    for (int i = 0; i < 1000; i += 2)
+    {
+        EXPECT_TRUE(map.Remove(handles[i]));
+    }
+    EXPECT_EQ(map.Count(), 500);
+    for (int i = 1; i < 1000; i += 2)
+    {
+        EXPECT_EQ(map.Get(handles[i]).Value, i);
+    }
+
+    int sum = 0;
+    for (const SSelfAware& element : map)
+    {
+        sum += element.Value;
+    }
+    EXPECT_EQ(sum, 250000);
+
+    for (uint32 i = 0; i < map.Count(); i++)
+    {
+        EXPECT_EQ(map.IndexOf(map.GetHandle(i)), i);
+        EXPECT_EQ(&map.Get(map.GetHandle(i)), map.GetData() + i);
+    }
+}
+
+TEST(TSlotMapTest, GenerationRetireTest)
+{
+    PREPARE_ALLOCATOR()
+
+    using HandleType = TSlotHandle<int>;
+
+    // A single slot goes through all its generations, then a new one has to be taken
+    TSlotMap<int> map;
+    const HandleType first = map.Add(0);
+    HandleType last = first;
+    for (uint32 i = 1; i < HandleType::MaxGeneration; i++)
+    {
+        EXPECT_TRUE(map.Remove(last));
+        last = map.Add((int)i);
+        EXPECT_EQ(last.GetIndex(), first.GetIndex());
+        EXPECT_EQ(last.GetGeneration(), i);
+    }
+    EXPECT_FALSE(map.Contains(first));
+
+    EXPECT_TRUE(map.Remove(last));
+    const HandleType next = map.Add(42);
+    EXPECT_NE(next.GetIndex(), first.GetIndex());
+    EXPECT_EQ(next.GetGeneration(), 0);
+    EXPECT_FALSE(map.Contains(first));
+    EXPECT_FALSE(map.Contains(last));
+    EXPECT_EQ(map.Get(next), 42);
+}
+
+TEST(TSoAArrayTest, AddRemoveIterateTest)
+{
+    PREPARE_ALLOCATOR()
+
+    TSoAArray<float, int, std::string> array;
+    EXPECT_TRUE(array.IsEmpty());
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(array.Add((float)i * 0.5f, i, std::to_string(i)), (uint32)i);
+    }
+    EXPECT_EQ(array.Count(), 10);
+    EXPECT_EQ(array.Get<1>(3), 3);
+    EXPECT_EQ(array.Get<2>(7), "7");
+
+    // Ordered removal shifts the tail, swap removal brings the last row in
+    array.RemoveAt(2);
+    EXPECT_EQ(array.Get<1>(2), 3);
+    EXPECT_EQ(array.Get<2>(8), "9");
+    array.RemoveAt<false>(0);
+    EXPECT_EQ(array.Count(), 8);
+    EXPECT_EQ(array.Get<1>(0), 9);
+    EXPECT_EQ(array.Get<2>(0), "9");
+    EXPECT_FLOAT_EQ(array.Get<0>(0), 4.5f);
+
+    int sum = 0;
+    for (auto [value, index, text] : array)
+    {
+        EXPECT_FLOAT_EQ(value, (float)index * 0.5f);
+        EXPECT_EQ(text, std::to_string(index));
+        sum += index;
+        value += 1.f;
+    }
+    EXPECT_EQ(sum, 9 + 1 + 3 + 4 + 5 + 6 + 7 + 8);
+    EXPECT_FLOAT_EQ(std::get<0>(array[0]), 5.5f);
+
+    array.SwapElements(0, 1);
+    EXPECT_EQ(array.Get<1>(0), 1);
+    EXPECT_EQ(array.Get<2>(1), "9");
+
+    array.Clear();
+    EXPECT_TRUE(array.IsEmpty());
+    EXPECT_GE(array.GetCapacity(), 10u);
+}
+
+TEST(TSoAArrayTest, ColumnAlignmentTest)
+{
+    PREPARE_ALLOCATOR()
+
+    struct SVector { float X, Y, Z; };
+    using ArrayType = TSoAArray<uint8_t, float, double, SVector>;
+
+    ArrayType array;
+    EXPECT_EQ(array.GetColumn<1>(), nullptr);
+    for (uint32 i = 0; i < 1000; i++)
+    {
+        array.Add((uint8_t)i, (float)i, (double)i, SVector { (float)i, (float)i, (float)i });
+
+        EXPECT_EQ(array.GetCapacity() % ArrayType::CapacityGranularity, 0u);
+        EXPECT_EQ((uint64)array.GetColumn<0>() % ArrayType::ColumnAlignment, 0u);
+        EXPECT_EQ((uint64)array.GetColumn<1>() % ArrayType::ColumnAlignment, 0u);
+        EXPECT_EQ((uint64)array.GetColumn<2>() % ArrayType::ColumnAlignment, 0u);
+        EXPECT_EQ((uint64)array.GetColumn<3>() % ArrayType::ColumnAlignment, 0u);
+    }
+
+    // Columns must not overlap after all the regrowing
+    const float* floats = array.GetColumn<1>();
+    const double* doubles = array.GetColumn<2>();
+    const SVector* vectors = array.GetColumn<3>();
+    for (uint32 i = 0; i < array.Count(); i++)
+    {
+        EXPECT_EQ(array.GetColumn<0>()[i], (uint8_t)i);
+        EXPECT_EQ(floats[i], (float)i);
+        EXPECT_EQ(doubles[i], (double)i);
+        EXPECT_EQ(vectors[i].Z, (float)i);
+    }
+
+    array.SetSize(3);
+    array.ShrinkToFit();
+    EXPECT_EQ(array.GetCapacity(), ArrayType::CapacityGranularity);
+    EXPECT_EQ(array.Get<2>(2), 2.0);
+    EXPECT_EQ((uint64)array.GetColumn<3>() % ArrayType::ColumnAlignment, 0u);
+}
+
+TEST(TSoAArrayTest, NonTrivialFieldsTest)
+{
+    PREPARE_ALLOCATOR()
+
+    {
+        TSoAArray<SSelfAware, int> array;
+        for (int i = 0; i < 100; i++)
+        {
+            array.Add(SSelfAware(i), i);
+        }
+        for (int i = 0; i < 50; i++)
+        {
+            array.RemoveAt<false>((uint32)i);
+        }
+
+        TSoAArray<SSelfAware, int> copy(array);
+        TSoAArray<SSelfAware, int> moved(std::move(copy));
+        EXPECT_TRUE(copy.IsEmpty());
+        ASSERT_EQ(moved.Count(), array.Count());
+        for (const auto [element, value] : moved)
+        {
+            EXPECT_EQ(element.Value, value);
+        }
+
+        array.SetSize(10);
+        array.SetSize(20);
+        EXPECT_EQ(array.Get<0>(19).Value, 0);
+    }
+
+    CCountingAllocator counting;
+    {
+        TAllocatedSoAArray<CCountingAllocator, SSelfAware, float> array(&counting);
+        array.Add();
+        EXPECT_EQ(counting.LiveCount, 1);
+
+        // Growing takes a new block and gives the old one back
+        array.SetCapacity(100);
+        EXPECT_EQ(counting.LiveCount, 1);
+        EXPECT_EQ(array.GetAllocator(), &counting);
+
+        TAllocatedSoAArray<CCountingAllocator, SSelfAware, float> other;
+        other = std::move(array);
+        EXPECT_EQ(other.GetAllocator(), &counting);
+        EXPECT_EQ(counting.LiveCount, 1);
+        EXPECT_EQ(other.Count(), 1);
+    }
+    EXPECT_EQ(counting.LiveCount, 0);
+}
+
+TEST(TMpscRingBufferTest, PushDrainOverflowTest)
+{
+    TMpscRingBuffer<int, 8> ring;
+    EXPECT_EQ(ring.Drain([] (const int&) { ADD_FAILURE(); }), 0);
+
+    // Several laps, so sequence wrap-around is exercised
+    int next = 0;
+    for (int lap = 0; lap < 5; lap++)
+    {
+        for (int i = 0; i < 5; i++)
+        {
+            EXPECT_TRUE(ring.TryPush(lap * 5 + i));
+        }
+        EXPECT_EQ(ring.CountApprox(), 5);
+        EXPECT_EQ(ring.Drain([&next] (const int& InValue) { EXPECT_EQ(InValue, next++); }), 5);
+    }
+
+    for (int i = 0; i < 8; i++)
+    {
+        EXPECT_TRUE(ring.TryPush(i));
+    }
+    EXPECT_FALSE(ring.TryPush(100));
+    EXPECT_FALSE(ring.TryPush(101));
+    EXPECT_EQ(ring.GetDroppedCount(), 2);
+
+    // Slots visited so far are free again, elements pushed into them wait for the next drain
+    int sum = 0;
+    EXPECT_EQ(ring.Drain([&] (const int& InValue)
+    {
+        sum += InValue;
+        if (InValue == 3)
+        {
+            EXPECT_TRUE(ring.TryPush(1000));
+        }
+    }), 8);
+    EXPECT_EQ(sum, 28);
+    EXPECT_EQ(ring.Clear(), 1);
+    EXPECT_EQ(ring.CountApprox(), 0);
+}
+
+TEST(TMpscRingBufferTest, ConcurrentProducersTest)
+{
+    static constexpr uint32 producerCount = 4;
+    static constexpr uint32 pushesPerProducer = 20000;
+
+    struct SMessage
+    {
+        uint32 Producer = 0;
+        uint32 Sequence = 0;
+    };
+
+    // Small enough for producers to run into a full queue now and then
+    TMpscRingBuffer<SMessage, 256> ring;
+    std::vector<std::thread> producers;
+    for (uint32 p = 0; p < producerCount; p++)
+    {
+        producers.emplace_back([p, &ring] ()
+        {
+            for (uint32 i = 0; i < pushesPerProducer; i++)
+            {
+                while (!ring.TryPush(SMessage { p, i }))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Every producer's messages must arrive complete and in its own order
+    std::vector<uint32> nextSequence(producerCount, 0);
+    uint32 received = 0;
+    while (received < producerCount * pushesPerProducer)
+    {
+        received += ring.Drain([&nextSequence] (const SMessage& InMessage)
+        {
+            EXPECT_EQ(InMessage.Sequence, nextSequence[InMessage.Producer]);
+            nextSequence[InMessage.Producer] = InMessage.Sequence + 1;
+        });
+    }
+    for (std::thread& producer : producers)
+    {
+        producer.join();
+    }
+
+    for (uint32 p = 0; p < producerCount; p++)
+    {
+        EXPECT_EQ(nextSequence[p], pushesPerProducer);
+    }
+    EXPECT_EQ(ring.Drain([] (const SMessage&) {}), 0);
+}
+
+TEST(TChunkedArrayTest, StableAddressesTest)
+{
+    PREPARE_ALLOCATOR()
+
+    TChunkedArray<SSelfAware> array;
+    TArray<const SSelfAware*> addresses;
+    for (int i = 0; i < 1000; i++)
+    {
+        const uint32 index = array.Add(SSelfAware(i));
+        EXPECT_EQ(index, (uint32)i);
+        addresses.Add(&array[index]);
+    }
+    EXPECT_EQ(array.Count(), 1000);
+    EXPECT_EQ(array.GetChunkCount(), (1000 + 63) / 64);
+
+    // Growth never moved anything
+    for (uint32 i = 0; i < 1000; i++)
+    {
+        EXPECT_EQ(&array[i], addresses[i]);
+        EXPECT_EQ(array[i].Value, (int)i);
+        EXPECT_EQ(array.IndexOf(addresses[i]), i);
+    }
+
+    // Freed slots are reused, the rest stay where they were
+    for (uint32 i = 0; i < 1000; i += 3)
+    {
+        array.RemoveAt(i);
+    }
+    EXPECT_FALSE(array.IsIndexValid(3));
+    EXPECT_EQ(array.Find(3), nullptr);
+    EXPECT_EQ(array.IndexOf(addresses[3]), TChunkedArray<SSelfAware>::InvalidIndex);
+
+    const uint32 chunkCount = array.GetChunkCount();
+    const uint32 reused = array.Emplace(-1);
+    EXPECT_EQ(reused % 3, 0);
+    EXPECT_EQ(&array[reused], addresses[reused]);
+    EXPECT_EQ(array.GetChunkCount(), chunkCount);
+
+    int sum = 0;
+    uint32 visited = 0;
+    for (const SSelfAware& element : array)
+    {
+        sum += element.Value;
+        visited++;
+    }
+    EXPECT_EQ(visited, array.Count());
+
+    int expected = -1;
+    for (uint32 i = 0; i < 1000; i++)
+    {
+        if (i % 3 != 0)
+        {
+            expected += (int)i;
+            EXPECT_EQ(&array[i], addresses[i]);
+        }
+    }
+    EXPECT_EQ(sum, expected);
+}
+
+TEST(TChunkedArrayTest, IterationSkipsFreeWordsTest)
+{
+    PREPARE_ALLOCATOR()
+
+    TChunkedArray<int, 7> array;
+    array.Reserve(1000);
+    EXPECT_EQ(array.GetCapacity(), 1024);
+    EXPECT_TRUE(array.begin() == array.end());
+
+    for (int i = 0; i < 1024; i++)
+    {
+        array.Add(i);
+    }
+    // Leave a handful of elements spread over whole empty words and chunks
+    for (uint32 i = 0; i < 1024; i++)
+    {
+        if (i != 5 && i != 64 && i != 700 && i != 1023)
+        {
+            array.RemoveAt(i);
+        }
+    }
+
+    TArray<int> values;
+    for (auto it = array.begin(); it != array.end(); ++it)
+    {
+        EXPECT_EQ(*it, (int)it.GetIndex());
+        values.Add(*it);
+    }
+    ASSERT_EQ(values.Count(), 4);
+    EXPECT_EQ(values[0], 5);
+    EXPECT_EQ(values[1], 64);
+    EXPECT_EQ(values[2], 700);
+    EXPECT_EQ(values[3], 1023);
+
+    array.Clear();
+    EXPECT_TRUE(array.IsEmpty());
+    EXPECT_EQ(array.Add(42), 0);
+    EXPECT_EQ(array.GetCapacity(), 1024);
+}
+
+TEST(TChunkedArrayTest, AllocatorAndMoveTest)
+{
+    CCountingAllocator counting;
+    {
+        TChunkedArray<std::string, 6, CCountingAllocator> array(&counting);
+        for (int i = 0; i < 100; i++)
+        {
+            array.Add(std::to_string(i));
+        }
+        const std::string* address = &array[70];
+
+        TChunkedArray<std::string, 6, CCountingAllocator> moved(std::move(array));
+        EXPECT_TRUE(array.IsEmpty());
+        EXPECT_EQ(&moved[70], address);
+        EXPECT_EQ(moved[70], "70");
+
+        TChunkedArray<std::string, 6, CCountingAllocator> assigned;
+        assigned = std::move(moved);
+        EXPECT_EQ(&assigned[70], address);
+        EXPECT_EQ(assigned.GetAllocator(), &counting);
+
+        assigned.Free();
+        EXPECT_EQ(counting.LiveCount, 0);
+        assigned.Add("again");
+    }
+    EXPECT_EQ(counting.LiveCount, 0);
+}
+
+TEST(TBitArrayTest, SetTestCountTest)
+{
+    PREPARE_ALLOCATOR()
+
+    TBitArray<> bits;
+    bits.SetSize(200);
+    EXPECT_EQ(bits.Count(), 200);
+    EXPECT_EQ(bits.GetWordCount(), 4);
+    EXPECT_FALSE(bits.IsAnySet());
+
+    bits.SetBit(0);
+    bits.SetBit(63);
+    bits.SetBit(64);
+    bits.SetBit(199);
+    bits.SetBit(100, true);
+    bits.SetBit(100, false);
+    EXPECT_TRUE(bits[63]);
+    EXPECT_FALSE(bits.TestBit(100));
+    EXPECT_EQ(bits.CountSetBits(), 4);
+
+    EXPECT_EQ(bits.FindFirstSetBit(), 0);
+    EXPECT_EQ(bits.FindFirstSetBit(1), 63);
+    EXPECT_EQ(bits.FindFirstSetBit(65), 199);
+    EXPECT_EQ(bits.FindFirstClearBit(), 1);
+    EXPECT_EQ(bits.FindFirstClearBit(63), 65);
+
+    // Tail bits of the last word stay clear, so a full array has no clear bit
+    bits.SetAll(true);
+    EXPECT_EQ(bits.CountSetBits(), 200);
+    EXPECT_EQ(bits.FindFirstClearBit(), TBitArray<>::InvalidIndex);
+    EXPECT_EQ(bits.GetWords()[3], (1ull << 8) - 1u);
+
+    // Growing with ones fills the rest of the old last word too
+    bits.SetSize(130);
+    bits.SetSize(300, true);
+    EXPECT_EQ(bits.CountSetBits(), 300);
+    bits.SetSize(310);
+    EXPECT_EQ(bits.CountSetBits(), 300);
+    EXPECT_EQ(bits.FindFirstClearBit(), 300);
+
+    bits.Clear();
+    EXPECT_TRUE(bits.IsEmpty());
+    EXPECT_EQ(bits.FindFirstSetBit(), TBitArray<>::InvalidIndex);
+}
+
+TEST(TBitArrayTest, ForEachAndRemoveTest)
+{
+    PREPARE_ALLOCATOR()
+
+    TBitArray<> bits;
+    for (uint32 i = 0; i < 150; i++)
+    {
+        EXPECT_EQ(bits.Add(i % 7 == 0), i);
+    }
+
+    TArray<uint32> visited;
+    bits.ForEachSetBit([&] (uint32 InIndex)
+    {
+        visited.Add(InIndex);
+        bits.ClearBit(InIndex);
+    });
+    ASSERT_EQ(visited.Count(), 22);
+    for (uint32 i = 0; i < visited.Count(); i++)
+    {
+        EXPECT_EQ(visited[i], i * 7);
+    }
+    EXPECT_FALSE(bits.IsAnySet());
+
+    // Ordered removal shifts bits across word boundaries
+    bits.SetBit(62);
+    bits.SetBit(64);
+    bits.SetBit(128);
+    bits.SetBit(149);
+    bits.RemoveAt(10);
+    EXPECT_EQ(bits.Count(), 149);
+    EXPECT_TRUE(bits[61]);
+    EXPECT_TRUE(bits[63]);
+    EXPECT_TRUE(bits[127]);
+    EXPECT_TRUE(bits[148]);
+    EXPECT_EQ(bits.CountSetBits(), 4);
+
+    // Swap removal brings the last bit in
+    bits.RemoveAt<false>(0);
+    EXPECT_TRUE(bits[0]);
+    EXPECT_EQ(bits.Count(), 148);
+    EXPECT_EQ(bits.CountSetBits(), 4);
+    bits.RemoveAt<false>(147);
+    EXPECT_EQ(bits.CountSetBits(), 4);
+}
+
+TEST(TBitArrayTest, CombineTest)
+{
+    PREPARE_ALLOCATOR()
+
+    // Odd word count, so the scalar tail after the SIMD loop runs too
+    static constexpr uint32 bitCount = 64 * 7 + 13;
+
+    TBitArray<> dirty;
+    TBitArray<> visible;
+    dirty.SetSize(bitCount);
+    visible.SetSize(bitCount);
+    for (uint32 i = 0; i < bitCount; i++)
+    {
+        dirty.SetBit(i, i % 3 == 0);
+        visible.SetBit(i, i % 2 == 0);
+    }
+
+    TBitArray<> both = dirty;
+    both.AndWith(visible);
+    TBitArray<> either = dirty;
+    either.OrWith(visible);
+    TBitArray<> hidden = dirty;
+    hidden.AndNotWith(visible);
+
+    for (uint32 i = 0; i < bitCount; i++)
+    {
+        EXPECT_EQ(both[i], i % 6 == 0);
+        EXPECT_EQ(either[i], i % 3 == 0 || i % 2 == 0);
+        EXPECT_EQ(hidden[i], i % 3 == 0 && i % 2 != 0);
+    }
+    EXPECT_EQ(both.CountSetBits() + hidden.CountSetBits(), dirty.CountSetBits());
+}
+
+TEST(RadixSortTest, KeysTest)
+{
+    PREPARE_ALLOCATOR()
+
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    auto next = [&seed] ()
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    };
+
+    TArray<uint32> keys32;
+    TArray<uint64_t> keys64;
+    std::vector<uint32> expected32;
+    std::vector<uint64_t> expected64;
+    for (uint32 i = 0; i < 5000; i++)
+    {
+        const uint64_t value = next();
+        keys32.Add((uint32)value);
+        keys64.Add(value);
+        expected32.push_back((uint32)value);
+        expected64.push_back(value);
+    }
+    std::sort(expected32.begin(), expected32.end());
+    std::sort(expected64.begin(), expected64.end());
+
+    RadixSort(keys32);
+    RadixSort(keys64);
+    for (uint32 i = 0; i < 5000; i++)
+    {
+        EXPECT_EQ(keys32[i], expected32[i]);
+        EXPECT_EQ(keys64[i], expected64[i]);
+    }
+
+    // Only the low byte varies, so all but one pass is skipped
+    TArray<uint32> small = { 0x1000005, 0x1000001, 0x1000003, 0x1000001 };
+    RadixSort(small);
+    EXPECT_EQ(small[0], 0x1000001);
+    EXPECT_EQ(small[1], 0x1000001);
+    EXPECT_EQ(small[2], 0x1000003);
+    EXPECT_EQ(small[3], 0x1000005);
+
+    TArray<uint32> empty;
+    RadixSort(empty);
+    EXPECT_EQ(empty.Count(), 0);
+}
+
+TEST(RadixSortTest, PairsStableTest)
+{
+    PREPARE_ALLOCATOR()
+
+    // Few distinct keys: equal keys must keep the order of their payloads
+    static constexpr uint32 count = 100000;
+    TArray<uint32> keys;
+    TArray<uint32> values;
+    TArray<uint32> parallelKeys;
+    TArray<uint32> parallelValues;
+    for (uint32 i = 0; i < count; i++)
+    {
+        const uint32 key = (i * 2654435761u) % 37 << 12;
+        keys.Add(key);
+        values.Add(i);
+        parallelKeys.Add(key);
+        parallelValues.Add(i);
+    }
+
+    RadixSortPairs(keys, values);
+    ParallelRadixSortPairs(parallelKeys, parallelValues, 4);
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        EXPECT_EQ(parallelKeys[i], keys[i]);
+        EXPECT_EQ(parallelValues[i], values[i]);
+        EXPECT_EQ(keys[i], (values[i] * 2654435761u) % 37 << 12);
+        if (i > 0)
+        {
+            ASSERT_LE(keys[i - 1], keys[i]);
+            if (keys[i - 1] == keys[i])
+            {
+                ASSERT_LT(values[i - 1], values[i]);
+            }
+        }
+    }
+
+    TArray<uint64_t> parallel64;
+    for (uint32 i = 0; i < count; i++)
+    {
+        parallel64.Add((uint64_t)(count - i) << 40 | i);
+    }
+    ParallelRadixSort(parallel64, 3);
+    for (uint32 i = 0; i < count; i++)
+    {
+        EXPECT_EQ(parallel64[i], (uint64_t)(i + 1) << 40 | (count - 1 - i));
+    }
+}
+
+TEST(RadixSortTest, SortKeyTest)
+{
+    using SDrawKey = TSortKey<uint64_t, 12, 20, 32>;
+    static_assert(SDrawKey::FieldShift<0> == 52);
+    static_assert(SDrawKey::FieldShift<2> == 0);
+    static_assert(SDrawKey::Pack(1, 2, 3) == (1ull << 52 | 2ull << 32 | 3ull));
+
+    const uint64_t key = SDrawKey::Pack(0xABC, 0xFFFFF, sort::FloatToKey(2.5f));
+    EXPECT_EQ(SDrawKey::Get<0>(key), 0xABC);
+    EXPECT_EQ(SDrawKey::Get<1>(key), 0xFFFFF);
+    EXPECT_EQ(sort::KeyToFloat((uint32)SDrawKey::Get<2>(key)), 2.5f);
+
+    // Pipeline first, then material, then depth
+    EXPECT_LT(SDrawKey::Pack(1, 9, sort::FloatToKey(100.f)), SDrawKey::Pack(2, 0, sort::FloatToKey(1.f)));
+    EXPECT_LT(SDrawKey::Pack(1, 2, sort::FloatToKey(100.f)), SDrawKey::Pack(1, 3, sort::FloatToKey(1.f)));
+    EXPECT_LT(SDrawKey::Pack(1, 2, sort::FloatToKey(1.f)), SDrawKey::Pack(1, 2, sort::FloatToKey(100.f)));
+
+    EXPECT_LT(sort::FloatToKey(-3.f), sort::FloatToKey(-1.f));
+    EXPECT_LT(sort::FloatToKey(-1.f), sort::FloatToKey(0.f));
+    EXPECT_LT(sort::FloatToKey(0.5f), sort::FloatToKey(0.75f));
+    EXPECT_LE(sort::FloatToKey(0.5f, 16), sort::FloatToKey(0.75f, 16));
+    EXPECT_EQ(sort::KeyToFloat(sort::FloatToKey(-7.25f)), -7.25f);
+}
+
+TEST(TFlatMapTest, AddFindRemoveTest)
+{
+    PREPARE_ALLOCATOR()
+
+    // Past LinearSearchMaxCount, so both the linear and the binary search run
+    TFlatMap<uint32, std::string> map;
+    for (uint32 i = 0; i < 100; i++)
+    {
+        const uint32 key = (i * 37) % 100 * 2;
+        map.Add(key, std::to_string(key));
+        EXPECT_EQ(map.Count(), i + 1);
+        for (uint32 j = 0; j <= i; j++)
+        {
+            const uint32 added = (j * 37) % 100 * 2;
+            ASSERT_NE(map.Find(added), nullptr);
+            EXPECT_EQ(*map.Find(added), std::to_string(added));
+        }
+        EXPECT_FALSE(map.Contains(key + 1));
+    }
+
+    uint32 previous = 0;
+    uint32 visited = 0;
+    for (auto [key, value] : map)
+    {
+        EXPECT_TRUE(visited == 0 || key > previous);
+        EXPECT_EQ(value, std::to_string(key));
+        value += "!";
+        previous = key;
+        visited++;
+    }
+    EXPECT_EQ(visited, 100);
+    EXPECT_EQ(*map.Find(10u), "10!");
+
+    map.Add(10u, "ten");
+    EXPECT_EQ(*map.Find(10u), "ten");
+    EXPECT_EQ(map.Emplace(10u, "kept?"), "ten");
+    EXPECT_EQ(map.FindOrAdd(11u), "");
+    EXPECT_EQ(map.Count(), 101);
+
+    EXPECT_TRUE(map.Remove(11u));
+    EXPECT_FALSE(map.Remove(11u));
+    for (uint32 key = 0; key < 200; key += 4)
+    {
+        EXPECT_TRUE(map.Remove(key));
+    }
+    EXPECT_EQ(map.Count(), 50);
+    for (uint32 i = 0; i < map.Count(); i++)
+    {
+        EXPECT_EQ(map.GetKeyAt(i), i * 4 + 2);
+        EXPECT_EQ(map.FindIndex(i * 4 + 2), i);
+    }
+}
+
+TEST(TFlatMapTest, BuildThenSortTest)
+{
+    CCountingAllocator allocator;
+    {
+        TFlatMap<std::string, uint32, CCountingAllocator> map(&allocator);
+        map.Reserve(8);
+        map.AddUnsorted("gamma", 1u);
+        map.AddUnsorted("alpha", 2u);
+        map.AddUnsorted("beta", 3u);
+        map.AddUnsorted("alpha", 4u);
+        EXPECT_FALSE(map.IsSorted());
+        map.Sort();
+        EXPECT_TRUE(map.IsSorted());
+        EXPECT_EQ(map.GetAllocator(), &allocator);
+
+        ASSERT_EQ(map.Count(), 3);
+        EXPECT_EQ(map.GetKeyAt(0), "alpha");
+        EXPECT_EQ(map.GetKeyAt(1), "beta");
+        EXPECT_EQ(map.GetKeyAt(2), "gamma");
+        // Repeated keys: the last one appended wins
+        EXPECT_EQ(*map.Find(std::string_view("alpha")), 4u);
+        EXPECT_EQ(map.Find("delta"), nullptr);
+        EXPECT_GT(allocator.LiveCount, 0);
+    }
+    EXPECT_EQ(allocator.LiveCount, 0);
+
+    PREPARE_ALLOCATOR()
+
+    TFlatMap<int64, float> table = { { 5, 0.5f }, { -1, -0.1f }, { 3, 0.3f } };
+    EXPECT_EQ(table.GetKeyAt(0), -1);
+    EXPECT_EQ(table.GetKeyAt(2), 5);
+    EXPECT_FLOAT_EQ(*table.Find(3), 0.3f);
+}
+
+TEST(TRingBufferTest, BothEndsAndGrowTest)
+{
+    PREPARE_ALLOCATOR()
+
+    // SSelfAware checks it's moved with its constructor, never bit-copied, when the buffer grows around the wrap
+    TRingBuffer<SSelfAware> ring;
+    ring.Reserve(3);
+    EXPECT_EQ(ring.GetCapacity(), 4);
+
+    ring.PushBack(SSelfAware(1));
+    ring.PushBack(SSelfAware(2));
+    ring.PushFront(SSelfAware(0));
+    ring.EmplaceFront(-1);
+    EXPECT_TRUE(ring.IsFull());
+    EXPECT_EQ(ring.First().Value, -1);
+    EXPECT_EQ(ring.Last().Value, 2);
+
+    ring.EmplaceBack(3);
+    EXPECT_EQ(ring.GetCapacity(), 8);
+    for (int i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(ring[i].Value, i - 1);
+    }
+
+    EXPECT_EQ(ring.PopFront().Value, -1);
+    EXPECT_EQ(ring.PopBack().Value, 3);
+    EXPECT_EQ(ring.Count(), 3);
+
+    // FIFO use keeps cycling through the same buffer
+    for (int i = 0; i < 100; i++)
+    {
+        ring.EmplaceBack(i + 3);
+        EXPECT_EQ(ring.PopFront().Value, i);
+    }
+    EXPECT_EQ(ring.GetCapacity(), 8);
+
+    TRingBuffer<SSelfAware> copy = ring;
+    TRingBuffer<SSelfAware> moved = std::move(ring);
+    EXPECT_TRUE(ring.IsEmpty());
+    int expected = 100;
+    for (const SSelfAware& element : moved)
+    {
+        EXPECT_EQ(element.Value, expected);
+        EXPECT_EQ(copy[expected - 100].Value, expected);
+        expected++;
+    }
+    EXPECT_EQ(expected, 103);
+}
+
+TEST(TRingBufferTest, OverwriteAndSpansTest)
+{
+    CCountingAllocator allocator;
+    {
+        TRingBuffer<std::string, CCountingAllocator> history(&allocator);
+        history.Reserve(8);
+        history.SetOverwriteOldest(true);
+        for (int i = 0; i < 13; i++)
+        {
+            history.PushBack(std::to_string(i));
+        }
+        EXPECT_EQ(history.Count(), 8);
+        EXPECT_EQ(history.GetCapacity(), 8);
+        EXPECT_EQ(history.First(), "5");
+        EXPECT_EQ(history.Last(), "12");
+
+        // Front sits at slot 5: three elements before the wrap, five after it
+        std::span<std::string> first = history.GetFirstSpan();
+        std::span<std::string> second = history.GetSecondSpan();
+        ASSERT_EQ(first.size(), 3);
+        ASSERT_EQ(second.size(), 5);
+        EXPECT_EQ(first[0], "5");
+        EXPECT_EQ(second[0], "8");
+        EXPECT_EQ(second[4], "12");
+
+        history.RemoveFront(first.size());
+        EXPECT_EQ(history.GetFirstSpan().size(), 5);
+        EXPECT_TRUE(history.GetSecondSpan().empty());
+
+        history.PushFront("front");
+        EXPECT_EQ(history.First(), "front");
+        EXPECT_EQ(history.GetAllocator(), &allocator);
+    }
+    EXPECT_EQ(allocator.LiveCount, 0);
+
+    TInlineRingBuffer<float, 4> frameTimes;
+    frameTimes.SetOverwriteOldest(true);
+    for (int i = 0; i < 6; i++)
+    {
+        frameTimes.PushBack((float)i);
+    }
+    EXPECT_EQ(frameTimes.GetCapacity(), 4);
+    EXPECT_EQ(frameTimes.First(), 2.f);
+    EXPECT_EQ(frameTimes.GetFirstSpan().size() + frameTimes.GetSecondSpan().size(), 4);
+
+    TInlineRingBuffer<float, 4> frameTimesCopy = std::move(frameTimes);
+    EXPECT_TRUE(frameTimes.IsEmpty());
+    EXPECT_EQ(frameTimesCopy.Last(), 5.f);
+}
+
+TEST(TRingBufferTest, SelfPushWhenFullTest)
+{
+    PREPARE_ALLOCATOR()
+
+    // Long enough to live on the heap, so reading a dropped or moved element shows
+    const auto makeName = [] (int Index) { return std::string(32, 'a') + std::to_string(Index); };
+
+    // Pushing the element that is about to be dropped
+    TRingBuffer<std::string> history;
+    history.Reserve(4);
+    history.SetOverwriteOldest(true);
+    for (int i = 0; i < 4; i++)
+    {
+        history.PushBack(makeName(i));
+    }
+    history.PushBack(history.First());
+    EXPECT_EQ(history.First(), makeName(1));
+    EXPECT_EQ(history.Last(), makeName(0));
+
+    history.PushFront(history.Last());
+    EXPECT_EQ(history.First(), makeName(0));
+    EXPECT_EQ(history.Last(), makeName(3));
+
+    history.PushFront(history[2]);
+    EXPECT_EQ(history.First(), makeName(2));
+    EXPECT_EQ(history.Count(), 4);
+    EXPECT_EQ(history.GetCapacity(), 4);
+
+    // Pushing an element the growth moves away
+    TRingBuffer<std::string> queue;
+    queue.Reserve(4);
+    for (int i = 0; i < 4; i++)
+    {
+        queue.PushBack(makeName(i));
+    }
+    queue.PushBack(queue.First());
+    EXPECT_EQ(queue.GetCapacity(), 8);
+    EXPECT_EQ(queue.Last(), makeName(0));
+
+    for (int i = 0; i < 3; i++)
+    {
+        queue.PushBack(makeName(i + 4));
+    }
+    EXPECT_TRUE(queue.IsFull());
+    queue.PushFront(queue[2]);
+    EXPECT_EQ(queue.GetCapacity(), 16);
+    EXPECT_EQ(queue.First(), makeName(2));
+    EXPECT_EQ(queue[1], makeName(0));
+    EXPECT_EQ(queue.Last(), makeName(6));
+}
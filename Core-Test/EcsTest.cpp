@@ -0,0 +1,286 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "Ecs/EntityRegistry.h"
+#include "Jobs/JobSystem.h"
+#include "Memory/MemoryPool.h"
+
+using namespace frt;
+using namespace frt::ecs;
+using namespace frt::memory;
+using namespace frt::memory::literals;
+
+
+namespace
+{
+struct SPosition
+{
+    float X = 0.f;
+    float Y = 0.f;
+    float Z = 0.f;
+};
+
+struct SVelocity
+{
+    float X = 0.f;
+    float Y = 0.f;
+    float Z = 0.f;
+};
+
+// Checks it's relocated with its move constructor and destroyed exactly once
+struct STracked
+{
+    STracked(int InValue = 0) : Value(InValue) { ++LiveCount; }
+    STracked(STracked&& Other) noexcept : Value(Other.Value) { ++LiveCount; }
+    ~STracked() { EXPECT_EQ(Self, this); --LiveCount; }
+
+    STracked* Self = this;
+    int Value = 0;
+
+    static inline int LiveCount = 0;
+};
+
+struct SSpawnPoint
+{
+    SSpawnPoint() = default;
+    explicit SSpawnPoint(const SPosition& InPosition) : Position(InPosition) {}
+
+    SPosition Position;
+};
+}
+
+// Defined in SystemSchedulerTest.cpp for the SPosition of that file
+uint32 GetSchedulerTestPositionId();
+
+
+TEST(CEntityRegistryTest, SameNameComponentTest)
+{
+    // Both are SPosition in an anonymous namespace, but this one is 12 bytes and the other 4
+    const uint32 positionId = GetComponentId<SPosition>();
+    const uint32 schedulerPositionId = GetSchedulerTestPositionId();
+    EXPECT_NE(positionId, schedulerPositionId);
+    EXPECT_EQ(GetComponentTypeInfo(positionId).Size, sizeof(SPosition));
+    EXPECT_EQ(GetComponentTypeInfo(schedulerPositionId).Size, sizeof(float));
+
+    // Registering again finds the same ids
+    EXPECT_EQ(RegisterComponentType(MakeComponentTypeInfo<SPosition>()), positionId);
+    EXPECT_EQ(GetComponentId<const SPosition>(), positionId);
+}
+
+
+TEST(CEntityRegistryTest, CreateFindDestroyTest)
+{
+    CMemoryPool pool(64_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    {
+        CEntityRegistry registry;
+        const EntityHandle a = registry.Create(SPosition { 1.f, 0.f, 0.f });
+        const EntityHandle b = registry.Create(SPosition { 2.f, 0.f, 0.f }, STracked(20));
+        const EntityHandle c = registry.Create<SPosition, STracked>();
+        registry.Get<STracked>(c).Value = 30;
+
+        EXPECT_EQ(registry.Count(), 3u);
+        EXPECT_EQ(registry.GetArchetypeCount(), 2u);
+        EXPECT_EQ(STracked::LiveCount, 2);
+
+        EXPECT_TRUE(registry.Has<SPosition>(a));
+        EXPECT_FALSE(registry.Has<STracked>(a));
+        EXPECT_EQ(registry.Find<STracked>(a), nullptr);
+        EXPECT_FLOAT_EQ(registry.Get<SPosition>(b).X, 2.f);
+
+        // c takes the row of b
+        EXPECT_TRUE(registry.Destroy(b));
+        EXPECT_FALSE(registry.Destroy(b));
+        EXPECT_FALSE(registry.IsAlive(b));
+        EXPECT_EQ(registry.Find<SPosition>(b), nullptr);
+        EXPECT_EQ(registry.Get<STracked>(c).Value, 30);
+        EXPECT_EQ(STracked::LiveCount, 1);
+
+        // Slot of b is reused with a new generation
+        const EntityHandle d = registry.Create(STracked(40));
+        EXPECT_NE(d, b);
+        EXPECT_FALSE(registry.IsAlive(b));
+        EXPECT_EQ(registry.Get<STracked>(d).Value, 40);
+        EXPECT_EQ(registry.CountMatching<STracked>(), 2u);
+        EXPECT_EQ(registry.CountMatching<SPosition>(), 2u);
+        EXPECT_EQ((registry.CountMatching<SPosition, STracked>()), 1u);
+    }
+    EXPECT_EQ(STracked::LiveCount, 0);
+}
+
+TEST(CEntityRegistryTest, AddRemoveComponentTest)
+{
+    CMemoryPool pool(64_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    {
+        CEntityRegistry registry;
+        std::vector<EntityHandle> entities;
+        for (int i = 0; i < 1000; ++i)
+        {
+            entities.push_back(registry.Create(SPosition { (float)i, 0.f, 0.f }, STracked(i)));
+        }
+
+        // Every other entity moves to another archetype and back, others fill the holes it leaves
+        for (int i = 0; i < 1000; i += 2)
+        {
+            registry.Add<SVelocity>(entities[i], SVelocity { 0.f, (float)i, 0.f });
+        }
+        EXPECT_EQ(registry.CountMatching<SVelocity>(), 500u);
+        EXPECT_EQ(STracked::LiveCount, 1000);
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            EXPECT_FLOAT_EQ(registry.Get<SPosition>(entities[i]).X, (float)i);
+            EXPECT_EQ(registry.Get<STracked>(entities[i]).Value, i);
+            EXPECT_EQ(registry.Has<SVelocity>(entities[i]), i % 2 == 0);
+        }
+
+        for (int i = 0; i < 1000; i += 4)
+        {
+            EXPECT_TRUE(registry.Remove<SVelocity>(entities[i]));
+            EXPECT_FALSE(registry.Remove<SVelocity>(entities[i]));
+            EXPECT_TRUE(registry.Remove<STracked>(entities[i]));
+        }
+        EXPECT_EQ(STracked::LiveCount, 750);
+        EXPECT_EQ(registry.CountMatching<SVelocity>(), 250u);
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            EXPECT_FLOAT_EQ(registry.Get<SPosition>(entities[i]).X, (float)i);
+            EXPECT_EQ(registry.Has<STracked>(entities[i]), i % 4 != 0);
+            if (const SVelocity* velocity = registry.Find<SVelocity>(entities[i]))
+            {
+                EXPECT_FLOAT_EQ(velocity->Y, (float)i);
+            }
+        }
+
+        registry.Clear();
+        EXPECT_TRUE(registry.IsEmpty());
+        EXPECT_EQ(STracked::LiveCount, 0);
+        EXPECT_FALSE(registry.IsAlive(entities[1]));
+    }
+    EXPECT_EQ(STracked::LiveCount, 0);
+}
+
+TEST(CEntityRegistryTest, AddFromOwnComponentTest)
+{
+    CMemoryPool pool(64_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    CEntityRegistry registry;
+    const EntityHandle a = registry.Create(SPosition { 1.f, 2.f, 3.f }, STracked(1));
+    const EntityHandle b = registry.Create(SPosition { 4.f, 5.f, 6.f }, STracked(2));
+
+    // a leaves its row for another archetype and b fills it, the argument still has to be the one of a
+    const SSpawnPoint& spawnPoint = registry.Add<SSpawnPoint>(a, registry.Get<SPosition>(a));
+    EXPECT_FLOAT_EQ(spawnPoint.Position.X, 1.f);
+    EXPECT_FLOAT_EQ(spawnPoint.Position.Z, 3.f);
+
+    registry.Add<SVelocity>(b, SVelocity { 7.f, 8.f, 9.f });
+    const SSpawnPoint& otherSpawnPoint = registry.Add<SSpawnPoint>(b, registry.Get<SPosition>(b));
+    EXPECT_FLOAT_EQ(otherSpawnPoint.Position.X, 4.f);
+    EXPECT_FLOAT_EQ(registry.Get<SSpawnPoint>(a).Position.Y, 2.f);
+}
+
+TEST(CEntityRegistryTest, QueryTest)
+{
+    CMemoryPool pool(64_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    CEntityRegistry registry;
+    static constexpr uint32 entityCount = 10000u;
+    for (uint32 i = 0; i < entityCount; ++i)
+    {
+        if (i % 3u == 0u)
+        {
+            registry.Create(SPosition { (float)i, 0.f, 0.f });
+        }
+        else
+        {
+            registry.Create(SPosition { (float)i, 0.f, 0.f }, SVelocity { 1.f, 2.f, 3.f });
+        }
+    }
+
+    registry.ForEach<SPosition, const SVelocity>([] (SPosition& InPosition, const SVelocity& InVelocity)
+    {
+        InPosition.Y += InVelocity.Y;
+    });
+
+    uint32 visited = 0u;
+    float sum = 0.f;
+    registry.ForEach<const SPosition>([&] (EntityHandle InEntity, const SPosition& InPosition)
+    {
+        EXPECT_EQ(&registry.Get<SPosition>(InEntity), &InPosition);
+        EXPECT_FLOAT_EQ(InPosition.Y, registry.Has<SVelocity>(InEntity) ? 2.f : 0.f);
+        sum += InPosition.X;
+        ++visited;
+    });
+    EXPECT_EQ(visited, entityCount);
+    EXPECT_FLOAT_EQ(sum, (float)(entityCount * (entityCount - 1u) / 2u));
+
+    // Chunks are full but the last one of each archetype, columns are aligned for AVX2
+    uint32 chunkRows = 0u;
+    registry.ForEachChunk<SVelocity>(
+        [&] (uint32 InRowCount, const EntityHandle* InHandles, SVelocity* InVelocities)
+        {
+            EXPECT_EQ((uintptr_t)InVelocities % CArchetype::ColumnAlignment, 0u);
+            EXPECT_EQ(registry.Find<SVelocity>(InHandles[InRowCount - 1u]), InVelocities + InRowCount - 1u);
+            chunkRows += InRowCount;
+        });
+    EXPECT_EQ(chunkRows, registry.CountMatching<SVelocity>());
+
+    for (uint32 i = 0; i < registry.GetArchetypeCount(); ++i)
+    {
+        const CArchetype& archetype = registry.GetArchetype(i);
+        EXPECT_GT(archetype.GetChunkCount(), 1u);
+        EXPECT_EQ(archetype.GetChunkRowCount(0u), archetype.GetRowsPerChunk());
+    }
+}
+
+TEST(CEntityRegistryTest, ParallelQueryTest)
+{
+    CMemoryPool pool(64_Mb, EMemoryPoolFlags::ThreadSafe);
+    pool.MakeThisPrimaryInstance();
+    jobs::CJobSystem jobSystem(3u);
+    jobSystem.MakeThisPrimaryInstance();
+
+    CEntityRegistry registry;
+    static constexpr uint32 entityCount = 20000u;
+    for (uint32 i = 0; i < entityCount; ++i)
+    {
+        if (i % 3u == 0u)
+        {
+            registry.Create(SPosition { (float)i, 0.f, 0.f });
+        }
+        else
+        {
+            registry.Create(SPosition { (float)i, 0.f, 0.f }, SVelocity { 1.f, 2.f, 3.f });
+        }
+    }
+
+    registry.ParallelForEach<SPosition, const SVelocity>([] (SPosition& InPosition, const SVelocity& InVelocity)
+    {
+        InPosition.Y += InVelocity.Y;
+    });
+
+    // Rows are numbered in the same order ForEach visits them
+    std::vector<EntityHandle> order;
+    registry.ForEach<const SPosition>([&order] (EntityHandle InEntity, const SPosition&) { order.push_back(InEntity); });
+    ASSERT_EQ(order.size(), entityCount);
+
+    std::vector<EntityHandle> parallelOrder(entityCount);
+    registry.ParallelForEachChunk<const SPosition>(
+        [&] (uint32 InFirstIndex, uint32 InRowCount, const EntityHandle* InHandles, const SPosition* InPositions)
+        {
+            for (uint32 row = 0; row < InRowCount; ++row)
+            {
+                parallelOrder[InFirstIndex + row] = InHandles[row];
+                EXPECT_FLOAT_EQ(InPositions[row].Y, registry.Has<SVelocity>(InHandles[row]) ? 2.f : 0.f);
+            }
+        });
+    EXPECT_EQ(parallelOrder, order);
+}
@@ -0,0 +1,331 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "Containers/WorkStealingDeque.h"
+#include "Jobs/JobSystem.h"
+#include "Jobs/ParallelFor.h"
+#include "Memory/MemoryPool.h"
+
+using namespace frt;
+using namespace frt::jobs;
+using namespace frt::memory;
+using namespace frt::memory::literals;
+
+
+TEST(TWorkStealingDequeTest, SingleThreadTest)
+{
+    TWorkStealingDeque<uint32, 8> deque;
+    uint32 value = 0u;
+    EXPECT_FALSE(deque.TryPop(value));
+    EXPECT_FALSE(deque.TrySteal(value));
+
+    for (uint32 i = 0; i < 8u; ++i)
+    {
+        EXPECT_TRUE(deque.TryPush(i));
+    }
+    EXPECT_FALSE(deque.TryPush(8u));
+    EXPECT_EQ(deque.CountApprox(), 8u);
+
+    // The owner takes the newest, thieves the oldest
+    EXPECT_TRUE(deque.TryPop(value));
+    EXPECT_EQ(value, 7u);
+    EXPECT_TRUE(deque.TrySteal(value));
+    EXPECT_EQ(value, 0u);
+    EXPECT_TRUE(deque.TrySteal(value));
+    EXPECT_EQ(value, 1u);
+
+    // Wraps around
+    EXPECT_TRUE(deque.TryPush(8u));
+    EXPECT_TRUE(deque.TryPush(9u));
+    EXPECT_TRUE(deque.TryPush(10u));
+    EXPECT_FALSE(deque.TryPush(11u));
+
+    for (uint32 expected : { 10u, 9u, 8u, 6u, 5u, 4u, 3u, 2u })
+    {
+        EXPECT_TRUE(deque.TryPop(value));
+        EXPECT_EQ(value, expected);
+    }
+    EXPECT_FALSE(deque.TryPop(value));
+    EXPECT_EQ(deque.CountApprox(), 0u);
+}
+
+TEST(TWorkStealingDequeTest, ConcurrentStealTest)
+{
+    static constexpr uint32 itemCount = 200000u;
+    static constexpr uint32 thiefCount = 3u;
+
+    TWorkStealingDeque<uint32, 256> deque;
+    std::vector<std::atomic<uint32>> taken(itemCount);
+    std::atomic<bool> bDone = false;
+
+    std::vector<std::thread> thieves;
+    for (uint32 i = 0; i < thiefCount; ++i)
+    {
+        thieves.emplace_back([&]
+        {
+            uint32 value = 0u;
+            while (!bDone.load())
+            {
+                if (deque.TrySteal(value))
+                {
+                    taken[value].fetch_add(1u);
+                }
+            }
+        });
+    }
+
+    // The owner pops every other round, so it keeps racing the thieves for the last elements.
+    // A failed pop must not hand out the element a thief won
+    static constexpr uint32 untouched = ~0u;
+    uint32 failedPopWrites = 0u;
+    uint32 value = 0u;
+    const auto pop = [&]
+    {
+        value = untouched;
+        if (deque.TryPop(value))
+        {
+            taken[value].fetch_add(1u);
+        }
+        else
+        {
+            failedPopWrites += value != untouched;
+        }
+    };
+    for (uint32 i = 0; i < itemCount; ++i)
+    {
+        while (!deque.TryPush(i))
+        {
+            pop();
+        }
+        if (i % 2u == 0u)
+        {
+            pop();
+        }
+    }
+    while (deque.TryPop(value))
+    {
+        taken[value].fetch_add(1u);
+    }
+
+    bDone.store(true);
+    for (std::thread& thief : thieves)
+    {
+        thief.join();
+    }
+
+    uint32 wrongCount = 0u;
+    for (const std::atomic<uint32>& count : taken)
+    {
+        wrongCount += count.load() != 1u;
+    }
+    EXPECT_EQ(wrongCount, 0u);
+    EXPECT_EQ(failedPopWrites, 0u);
+}
+
+TEST(CJobSystemTest, RunWaitTest)
+{
+    CMemoryPool pool(64_Mb, EMemoryPoolFlags::ThreadSafe);
+    pool.MakeThisPrimaryInstance();
+
+    CJobSystem jobSystem(4u);
+    EXPECT_EQ(jobSystem.GetWorkerCount(), 4u);
+    EXPECT_EQ(jobSystem.GetCurrentThreadIndex(), 0u);
+
+    struct SContext
+    {
+        CJobSystem* JobSystem;
+        std::atomic<uint32> Sum = 0u;
+        std::atomic<uint32> WorkerRuns = 0u;
+    };
+    SContext context;
+    context.JobSystem = &jobSystem;
+
+    static constexpr uint32 jobCount = 500u;
+    std::vector<SJob> jobs(jobCount);
+    for (SJob& job : jobs)
+    {
+        job.Function = [] (void* InData)
+        {
+            SContext& context = *static_cast<SContext*>(InData);
+            context.Sum.fetch_add(1u);
+            context.WorkerRuns.fetch_add(context.JobSystem->GetCurrentThreadIndex() != 0u);
+        };
+        job.Data = &context;
+    }
+
+    CJobCounter counter;
+    EXPECT_TRUE(counter.IsDone());
+    jobSystem.Run(jobs.data(), jobCount, counter);
+    jobSystem.Wait(counter);
+    EXPECT_TRUE(counter.IsDone());
+    EXPECT_EQ(context.Sum.load(), jobCount);
+
+    // Jobs that run and wait for jobs of their own
+    struct SNestedContext
+    {
+        CJobSystem* JobSystem;
+        std::atomic<uint32> LeafCount = 0u;
+    };
+    SNestedContext nestedContext;
+    nestedContext.JobSystem = &jobSystem;
+
+    static constexpr uint32 parentCount = 64u;
+    static constexpr uint32 childCount = 16u;
+    std::vector<SJob> parents(parentCount);
+    for (SJob& parent : parents)
+    {
+        parent.Function = [] (void* InData)
+        {
+            SNestedContext& context = *static_cast<SNestedContext*>(InData);
+            SJob children[childCount];
+            for (SJob& child : children)
+            {
+                child.Function = [] (void* InChildData)
+                {
+                    static_cast<SNestedContext*>(InChildData)->LeafCount.fetch_add(1u);
+                };
+                child.Data = InData;
+            }
+
+            CJobCounter childCounter;
+            context.JobSystem->Run(children, childCount, childCounter);
+            context.JobSystem->Wait(childCounter);
+            EXPECT_TRUE(childCounter.IsDone());
+        };
+        parent.Data = &nestedContext;
+    }
+
+    jobSystem.Run(parents.data(), parentCount, counter);
+    jobSystem.Wait(counter);
+    EXPECT_EQ(nestedContext.LeafCount.load(), parentCount * childCount);
+}
+
+TEST(CJobSystemTest, ExecutionCountTest)
+{
+    CMemoryPool pool(64_Mb, EMemoryPoolFlags::ThreadSafe);
+    pool.MakeThisPrimaryInstance();
+
+    CJobSystem jobSystem(3u);
+
+    // Few jobs per round, so the waiting owner and the workers keep racing for the last one in the queue
+    static constexpr uint32 roundCount = 20000u;
+    static constexpr uint32 maxJobsPerRound = 3u;
+    std::vector<std::atomic<uint32>> runCounts(roundCount * maxJobsPerRound);
+    std::vector<SJob> jobs(maxJobsPerRound);
+
+    uint32 wrongCounterCount = 0u;
+    for (uint32 round = 0; round < roundCount; ++round)
+    {
+        const uint32 jobCount = round % maxJobsPerRound + 1u;
+        for (uint32 i = 0; i < jobCount; ++i)
+        {
+            jobs[i].Function = [] (void* InData)
+            {
+                static_cast<std::atomic<uint32>*>(InData)->fetch_add(1u);
+            };
+            jobs[i].Data = &runCounts[round * maxJobsPerRound + i];
+        }
+
+        CJobCounter counter;
+        jobSystem.Run(jobs.data(), jobCount, counter);
+        jobSystem.Wait(counter);
+        wrongCounterCount += !counter.IsDone();
+
+        // Every job has run exactly once by the time Wait returns
+        for (uint32 i = 0; i < jobCount; ++i)
+        {
+            wrongCounterCount += runCounts[round * maxJobsPerRound + i].load() != 1u;
+        }
+    }
+    EXPECT_EQ(wrongCounterCount, 0u);
+
+    // Nothing ran late either
+    uint32 wrongRunCount = 0u;
+    for (uint32 round = 0; round < roundCount; ++round)
+    {
+        for (uint32 i = 0; i < maxJobsPerRound; ++i)
+        {
+            const uint32 expected = i < round % maxJobsPerRound + 1u ? 1u : 0u;
+            wrongRunCount += runCounts[round * maxJobsPerRound + i].load() != expected;
+        }
+    }
+    EXPECT_EQ(wrongRunCount, 0u);
+}
+
+TEST(CJobSystemTest, ParallelForTest)
+{
+    CMemoryPool pool(64_Mb, EMemoryPoolFlags::ThreadSafe);
+    pool.MakeThisPrimaryInstance();
+
+    TArray<uint32> values;
+    for (uint32 i = 0; i < 100000u; ++i)
+    {
+        values.Add(i);
+    }
+
+    // Without a job system everything runs inline
+    ParallelFor(values, 1000u, [] (uint32& InValue) { InValue *= 2u; });
+    EXPECT_EQ(values[99999], 199998u);
+
+    {
+        CJobSystem jobSystem(3u);
+        jobSystem.MakeThisPrimaryInstance();
+
+        ParallelFor(values, 1000u, [] (uint32& InValue) { InValue /= 2u; });
+        for (uint32 i = 0; i < values.Count(); ++i)
+        {
+            EXPECT_EQ(values[i], i);
+        }
+
+        // Every index is visited exactly once, batches never exceed the grain size
+        std::vector<std::atomic<uint32>> visits(12345u);
+        std::atomic<uint32> oversizedBatches = 0u;
+        ParallelFor((uint32)visits.size(), 100u, [&] (uint32 InBegin, uint32 InEnd)
+        {
+            oversizedBatches.fetch_add(InEnd - InBegin > 100u);
+            for (uint32 i = InBegin; i < InEnd; ++i)
+            {
+                visits[i].fetch_add(1u);
+            }
+        });
+        EXPECT_EQ(oversizedBatches.load(), 0u);
+        for (const std::atomic<uint32>& count : visits)
+        {
+            EXPECT_EQ(count.load(), 1u);
+        }
+
+        // Threads outside of the system run it inline
+        std::thread foreignThread([&values]
+        {
+            const std::thread::id threadId = std::this_thread::get_id();
+            ParallelFor(std::span<uint32>(values.GetData(), values.Count()), 10u,
+                [threadId] (uint32& InValue)
+                {
+                    EXPECT_EQ(std::this_thread::get_id(), threadId);
+                    ++InValue;
+                });
+        });
+        foreignThread.join();
+        EXPECT_EQ(values[0], 1u);
+    }
+    EXPECT_EQ(CJobSystem::GetPrimaryInstance(), nullptr);
+
+    {
+        // Same code path on a single core
+        CJobSystem jobSystem(0u);
+        jobSystem.MakeThisPrimaryInstance();
+
+        uint32 sum = 0u;
+        ParallelFor(100u, 7u, [&sum] (uint32 InBegin, uint32 InEnd)
+        {
+            for (uint32 i = InBegin; i < InEnd; ++i)
+            {
+                sum += i;
+            }
+        });
+        EXPECT_EQ(sum, 4950u);
+    }
+}
@@ -0,0 +1,627 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Containers/Array.h"
+#include "Graphics/Render/GraphicsCoreTypes.h"
+#include "Memory/Memory.h"
+#include "Memory/MemoryPool.h"
+#include "Memory/ThreadCache.h"
+#include "Memory/TraceReplay.h"
+
+using namespace frt::memory;
+using namespace frt::memory::literals;
+
+
+struct SSharedRefObject
+{
+    std::atomic<uint32>* Destructions = nullptr;
+    uint64 Payload = 0ull;
+
+    ~SSharedRefObject()
+    {
+        if (Destructions)
+        {
+            Destructions->fetch_add(1u);
+        }
+    }
+};
+FRT_DECLARE_THREAD_SAFE_REFS(SSharedRefObject)
+
+
+struct SConfinedRefObject
+{
+    uint64 Payload = 0ull;
+};
+
+
+// Same payload as a TRefShared, but with a move constructor of its own, so it can't be relocated by copying bytes
+struct SMovedRef
+{
+    SMovedRef() = default;
+    SMovedRef(const TRefShared<SConfinedRefObject>& InRef) : Ref(InRef) {}
+    SMovedRef(const SMovedRef& Other) = default;
+    SMovedRef(SMovedRef&& Other) noexcept : Ref(std::move(Other.Ref)) {}
+
+    TRefShared<SConfinedRefObject> Ref;
+};
+
+
+namespace
+{
+struct SSharedBlocks
+{
+    std::mutex Mutex;
+    std::vector<std::pair<uint8*, uint32>> Blocks;
+};
+
+uint64 RandomSize(std::mt19937& Rng)
+{
+    // Mostly small, cache-served sizes with an occasional big one that goes straight to TLSF
+    const uint32 roll = Rng() % 100u;
+    if (roll < 90u)
+    {
+        return 1u + Rng() % 256u;
+    }
+    if (roll < 99u)
+    {
+        return 257u + Rng() % 768u;
+    }
+    return 1025u + Rng() % 16384u;
+}
+
+bool CheckPattern(const uint8* Data, uint32 Size, uint8 Pattern)
+{
+    for (uint32 i = 0u; i < Size; ++i)
+    {
+        if (Data[i] != Pattern)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+double RunChurn(CMemoryPool& Pool, uint32 ThreadCount, uint32 OpsPerThread)
+{
+    std::atomic<bool> bStart = false;
+    std::vector<std::thread> threads;
+
+    for (uint32 t = 0u; t < ThreadCount; ++t)
+    {
+        threads.emplace_back(
+            [&Pool, &bStart, t, OpsPerThread] ()
+            {
+                std::mt19937 rng(t + 1u);
+                std::vector<void*> live(256u, nullptr);
+                while (!bStart.load())
+                {}
+
+                for (uint32 i = 0u; i < OpsPerThread; ++i)
+                {
+                    void*& slot = live[rng() % live.size()];
+                    Pool.Free(slot);
+                    slot = Pool.Allocate(RandomSize(rng));
+                }
+
+                for (void* memory : live)
+                {
+                    Pool.Free(memory);
+                }
+            });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    bStart = true;
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    return ns / ((double)ThreadCount * OpsPerThread);
+}
+}
+
+
+TEST(MemoryThreadCache, SizeClasses)
+{
+    for (uint64 size = 1u; size <= CThreadCachedHeap::MaxCachedSize; ++size)
+    {
+        const uint32 sizeClass = CThreadCachedHeap::GetSizeClass(size);
+        ASSERT_LT(sizeClass, CThreadCachedHeap::SizeClassCount);
+        EXPECT_GE(CThreadCachedHeap::GetSizeClassSize(sizeClass), size);
+        if (sizeClass > 0u)
+        {
+            EXPECT_LT(CThreadCachedHeap::GetSizeClassSize(sizeClass - 1u), size);
+        }
+    }
+}
+
+TEST(MemoryThreadCache, ReAllocateKeepsContent)
+{
+    CMemoryPool pool(16_Mb, EMemoryPoolFlags::ThreadSafe);
+    ASSERT_TRUE(pool.IsThreadSafe());
+
+    auto* data = static_cast<uint8*>(pool.Allocate(24));
+    std::memset(data, 0x5A, 24);
+
+    data = static_cast<uint8*>(pool.ReAllocate(data, 700));
+    EXPECT_TRUE(CheckPattern(data, 24, 0x5A));
+    std::memset(data, 0x3C, 700);
+
+    data = static_cast<uint8*>(pool.ReAllocate(data, 64_Kb));
+    EXPECT_TRUE(CheckPattern(data, 700, 0x3C));
+
+    data = static_cast<uint8*>(pool.ReAllocate(data, 128_Kb));
+    EXPECT_TRUE(CheckPattern(data, 700, 0x3C));
+
+    pool.Free(data);
+}
+
+TEST(MemoryThreadCache, CrossThreadFree)
+{
+    CMemoryPool pool(256_Mb, EMemoryPoolFlags::ThreadSafe);
+
+    constexpr uint32 producerCount = 4u;
+    constexpr uint32 blocksPerProducer = 20'000u;
+
+    SSharedBlocks shared;
+    std::atomic<uint32> producersDone = 0u;
+    std::atomic<uint32> corrupted = 0u;
+
+    std::vector<std::thread> threads;
+    for (uint32 t = 0u; t < producerCount; ++t)
+    {
+        threads.emplace_back(
+            [&, t] ()
+            {
+                std::mt19937 rng(t + 1u);
+                const uint8 pattern = (uint8)(t + 1u);
+                for (uint32 i = 0u; i < blocksPerProducer; ++i)
+                {
+                    const uint32 size = (uint32)RandomSize(rng);
+                    auto* data = static_cast<uint8*>(pool.Allocate(size));
+                    ASSERT_NE(data, nullptr);
+                    std::memset(data, pattern, size);
+
+                    std::scoped_lock lock(shared.Mutex);
+                    shared.Blocks.emplace_back(data, size);
+                }
+                ++producersDone;
+            });
+    }
+
+    // Consumers free everything the producers allocated, so most frees go through the remote-free lists
+    for (uint32 t = 0u; t < 2u; ++t)
+    {
+        threads.emplace_back(
+            [&] ()
+            {
+                while (true)
+                {
+                    std::pair<uint8*, uint32> block = { nullptr, 0u };
+                    {
+                        std::scoped_lock lock(shared.Mutex);
+                        if (!shared.Blocks.empty())
+                        {
+                            block = shared.Blocks.back();
+                            shared.Blocks.pop_back();
+                        }
+                    }
+
+                    if (!block.first)
+                    {
+                        if (producersDone.load() == producerCount)
+                        {
+                            std::scoped_lock lock(shared.Mutex);
+                            if (shared.Blocks.empty())
+                            {
+                                break;
+                            }
+                        }
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    if (!CheckPattern(block.first, block.second, block.first[0]) || block.first[0] == 0u)
+                    {
+                        ++corrupted;
+                    }
+                    pool.Free(block.first);
+                }
+            });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(corrupted.load(), 0u);
+
+    // Caches of the exited threads get adopted and keep serving allocations
+    std::vector<void*> more;
+    for (uint32 i = 0u; i < 10'000u; ++i)
+    {
+        more.push_back(pool.Allocate(64));
+        ASSERT_NE(more.back(), nullptr);
+    }
+    for (void* memory : more)
+    {
+        pool.Free(memory);
+    }
+}
+
+TEST(MemoryThreadCache, MultiThreadedAllocationBenchmark)
+{
+    constexpr uint32 opsPerThread = 200'000u;
+
+    {
+        CMemoryPool pool(512_Mb);
+        const double ns = RunChurn(pool, 1u, opsPerThread);
+        std::printf("[ BENCH    ] TLSF, no thread cache, 1 thread: %.1f ns/op\n", ns);
+    }
+
+    const uint32 hardwareThreads = std::thread::hardware_concurrency();
+    for (uint32 threadCount = 1u; threadCount <= 8u; threadCount *= 2u)
+    {
+        if (threadCount > 1u && threadCount > hardwareThreads)
+        {
+            break;
+        }
+
+        CMemoryPool pool(512_Mb, EMemoryPoolFlags::ThreadSafe);
+        const double ns = RunChurn(pool, threadCount, opsPerThread);
+        std::printf("[ BENCH    ] thread cache, %u thread(s): %.1f ns/op\n", threadCount, ns);
+    }
+}
+
+TEST(MemorySlab, SpawnDestroyBenchmark)
+{
+    constexpr uint32 entityCount = 4096u;
+    constexpr uint32 rounds = 200u;
+    constexpr uint64 blockSize = 208u;
+
+    CMemoryPool pool(256_Mb);
+    CSlabAllocator slab(&pool, (uint32)blockSize, false);
+
+    // Same churn for both: fill, then free and reallocate a random half every round
+    auto churn = [&] (IAllocator& Allocator)
+    {
+        std::vector<void*> live(entityCount, nullptr);
+        std::mt19937 rng(7u);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32 round = 0u; round < rounds; ++round)
+        {
+            for (void*& memory : live)
+            {
+                if (!memory || (rng() & 1u))
+                {
+                    Allocator.Free(memory);
+                    memory = Allocator.Allocate(blockSize);
+                }
+            }
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        for (void* memory : live)
+        {
+            Allocator.Free(memory);
+        }
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1e6;
+    };
+
+    const double tlsfMs = churn(pool);
+    const double slabMs = churn(slab);
+    std::printf("[ BENCH    ] spawn/destroy through TLSF: %.2f ms, through slab: %.2f ms\n", tlsfMs, slabMs);
+
+    EXPECT_EQ(slab.GetStats().LiveCount, 0u);
+}
+
+namespace
+{
+std::vector<STraceEvent> MakeFrameTrace(uint32 FrameCount)
+{
+    // Long-lived assets, per-frame scratch that dies at the end of the frame, and a few arrays growing by reallocation
+    std::vector<STraceEvent> events;
+    std::vector<std::pair<uint32, uint64>> persistent;
+    std::mt19937 rng(11u);
+    uint32 nextId = 0u;
+
+    auto push = [&events] (ETraceOp Op, uint32 Id, uint64 Size)
+    {
+        STraceEvent& event = events.emplace_back();
+        event.Op = Op;
+        event.AddressId = Id;
+        event.Size = Size;
+    };
+
+    for (uint32 frame = 0u; frame < FrameCount; ++frame)
+    {
+        for (uint32 i = 0u; i < 8u; ++i)
+        {
+            const uint64 size = (rng() % 10u == 0u) ? 16u * 1024u + rng() % (128u * 1024u) : RandomSize(rng);
+            persistent.emplace_back(nextId, size);
+            push(ETraceOp::Allocate, nextId++, size);
+        }
+        for (uint32 i = 0u; i < 4u && !persistent.empty(); ++i)
+        {
+            const uint32 index = rng() % (uint32)persistent.size();
+            push(ETraceOp::Free, persistent[index].first, persistent[index].second);
+            persistent[index] = persistent.back();
+            persistent.pop_back();
+        }
+
+        std::vector<std::pair<uint32, uint64>> scratch;
+        for (uint32 i = 0u; i < 64u; ++i)
+        {
+            const uint64 size = RandomSize(rng);
+            scratch.emplace_back(nextId, size);
+            push(ETraceOp::Allocate, nextId++, size);
+        }
+
+        const uint32 arrayId = nextId++;
+        uint64 arraySize = 16u;
+        push(ETraceOp::Allocate, arrayId, arraySize);
+        for (uint32 i = 0u; i < 8u; ++i)
+        {
+            arraySize *= 2u;
+            push(ETraceOp::ReAllocate, arrayId, arraySize);
+        }
+        scratch.emplace_back(arrayId, arraySize);
+
+        for (const auto& [id, size] : scratch)
+        {
+            push(ETraceOp::Free, id, size);
+        }
+    }
+
+    return events;
+}
+
+void PrintReplayResult(const char* Name, const SReplayResult& Result)
+{
+    std::printf("[ BENCH    ] %-18s %7.1f ns/op, peak live %7.2f Mb, footprint ",
+        Name, Result.NanosecondsPerOperation, (double)Result.PeakLiveBytes / (1024.0 * 1024.0));
+    if (Result.PeakFootprint)
+    {
+        std::printf("%7.2f Mb", (double)Result.PeakFootprint / (1024.0 * 1024.0));
+    }
+    else
+    {
+        std::printf("%10s", "n/a");
+    }
+    if (Result.FragmentationAtPeak >= 0.f)
+    {
+        std::printf(", fragmentation at peak %.3f\n", Result.FragmentationAtPeak);
+    }
+    else
+    {
+        std::printf("\n");
+    }
+}
+}
+
+TEST(MemoryTrace, ReplayBenchmark)
+{
+    // A capture from a game session can be replayed instead of the synthetic trace
+    std::vector<STraceEvent> events;
+    if (const char* tracePath = std::getenv("FRT_REPLAY_TRACE"))
+    {
+        ASSERT_TRUE(CAllocationTraceRecorder::Load(tracePath, events));
+    }
+    else
+    {
+        events = MakeFrameTrace(1000u);
+    }
+
+    std::printf("[ BENCH    ] replaying %llu events\n", (unsigned long long)events.size());
+
+    {
+        CTlsfReplayTarget target(4_Gb);
+        const SReplayResult result = ReplayTrace(events, target);
+        EXPECT_EQ(result.FailedCount, 0u);
+        EXPECT_GE(result.PeakFootprint, result.PeakLiveBytes);
+        PrintReplayResult(target.GetName(), result);
+    }
+    {
+        CMallocReplayTarget target;
+        const SReplayResult result = ReplayTrace(events, target);
+        EXPECT_EQ(result.FailedCount, 0u);
+        PrintReplayResult(target.GetName(), result);
+    }
+    {
+        CMemoryPool pool(256_Mb);
+        CMemoryPoolReplayTarget target(pool, "CMemoryPool");
+        const SReplayResult result = ReplayTrace(events, target);
+        EXPECT_EQ(result.FailedCount, 0u);
+        PrintReplayResult(target.GetName(), result);
+    }
+    {
+        CMemoryPool pool(256_Mb, EMemoryPoolFlags::ThreadSafe);
+        CAllocatorReplayTarget target(pool, "thread cache");
+        const SReplayResult result = ReplayTrace(events, target);
+        EXPECT_EQ(result.FailedCount, 0u);
+        PrintReplayResult(target.GetName(), result);
+    }
+}
+
+TEST(MemoryRefs, WeakLockRacesWithLastRelease)
+{
+    CMemoryPool pool(16_Mb, EMemoryPoolFlags::ThreadSafe);
+
+    constexpr uint32 rounds = 2000u;
+    constexpr uint32 lockerCount = 3u;
+    std::atomic<uint32> destructions = 0u;
+    std::atomic<uint32> lockedAfterDestruction = 0u;
+
+    for (uint32 round = 0u; round < rounds; ++round)
+    {
+        TRefShared<SSharedRefObject> shared = pool.NewShared<SSharedRefObject>();
+        shared->Destructions = &destructions;
+        shared->Payload = round;
+
+        std::atomic<bool> bStart = false;
+        std::vector<std::thread> lockers;
+        for (uint32 t = 0u; t < lockerCount; ++t)
+        {
+            lockers.emplace_back(
+                [weak = shared.GetWeak(), &bStart, &destructions, &lockedAfterDestruction, round] ()
+                {
+                    while (!bStart.load())
+                    {}
+
+                    for (uint32 i = 0u; i < 64u; ++i)
+                    {
+                        const uint32 before = destructions.load();
+                        TRefShared<SSharedRefObject> locked = weak.Lock();
+                        if (!locked)
+                        {
+                            break;
+                        }
+                        // Holding a strong ref, so this round's object can't be destroyed under us
+                        if (locked->Payload != round || destructions.load() > round || before > round)
+                        {
+                            lockedAfterDestruction.fetch_add(1u);
+                        }
+                    }
+                });
+        }
+
+        bStart = true;
+        shared.Release();
+        for (std::thread& locker : lockers)
+        {
+            locker.join();
+        }
+        ASSERT_EQ(destructions.load(), round + 1u);
+    }
+
+    EXPECT_EQ(lockedAfterDestruction.load(), 0u);
+}
+
+TEST(MemoryRefs, ContentionBenchmark)
+{
+    constexpr uint32 opsPerThread = 1'000'000u;
+    CMemoryPool pool(16_Mb, EMemoryPoolFlags::ThreadSafe);
+
+    // Copy and release the same object over and over, as systems passing a shared asset around would
+    auto churn = [] (uint32 ThreadCount, const auto& Op)
+    {
+        std::atomic<bool> bStart = false;
+        std::vector<std::thread> threads;
+        for (uint32 t = 0u; t < ThreadCount; ++t)
+        {
+            threads.emplace_back(
+                [&Op, &bStart] ()
+                {
+                    while (!bStart.load())
+                    {}
+
+                    uint64 sum = 0ull;
+                    for (uint32 i = 0u; i < opsPerThread; ++i)
+                    {
+                        sum += Op();
+                    }
+                    EXPECT_EQ(sum, 0ull);
+                });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        bStart = true;
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / opsPerThread;
+    };
+
+    {
+        const TRefShared<SConfinedRefObject> confined = pool.NewShared<SConfinedRefObject>();
+        const double ns = churn(1u, [&confined] () { return TRefShared<SConfinedRefObject>(confined)->Payload; });
+        std::printf("[ BENCH    ] single-thread refs, 1 thread: %.2f ns/copy\n", ns);
+    }
+
+    const TRefShared<SSharedRefObject> shared = pool.NewShared<SSharedRefObject>();
+    const uint32 hardwareThreads = std::thread::hardware_concurrency();
+    for (uint32 threadCount = 1u; threadCount <= 8u; threadCount *= 2u)
+    {
+        if (threadCount > 1u && threadCount > hardwareThreads)
+        {
+            break;
+        }
+        const double ns = churn(threadCount, [&shared] () { return TRefShared<SSharedRefObject>(shared)->Payload; });
+        std::printf("[ BENCH    ] thread-safe refs, %u thread(s): %.2f ns/copy\n", threadCount, ns);
+    }
+
+    const TRefWeak<SSharedRefObject> weak = shared.GetWeak();
+    for (uint32 threadCount = 1u; threadCount <= 4u; threadCount *= 4u)
+    {
+        if (threadCount > 1u && threadCount > hardwareThreads)
+        {
+            break;
+        }
+        const double ns = churn(threadCount, [&weak] () { return weak.Lock()->Payload; });
+        std::printf("[ BENCH    ] thread-safe weak lock, %u thread(s): %.2f ns/lock\n", threadCount, ns);
+    }
+}
+
+TEST(MemoryArrayGrowth, Benchmark)
+{
+    static_assert(IsTriviallyRelocatable<frt::graphics::SVertex>);
+    static_assert(IsTriviallyRelocatable<TRefShared<SConfinedRefObject>>);
+    static_assert(!IsTriviallyRelocatable<SMovedRef>);
+
+    static constexpr uint32 elementCount = 100'000u;
+    static constexpr uint32 rounds = 20u;
+
+    CMemoryPool pool(256_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    // Each round grows from empty, with another array growing alongside, so some reallocations can't happen in place
+    auto grow = [] <typename T> (const char* Name, const T& Value)
+    {
+        double ns = 0.0;
+        for (uint32 round = 0u; round < rounds; ++round)
+        {
+            frt::TArray<T> arr;
+            frt::TArray<uint64> neighbour;
+
+            const auto start = std::chrono::steady_clock::now();
+            for (uint32 i = 0u; i < elementCount; ++i)
+            {
+                arr.Add(Value);
+                if (i % 8u == 0u)
+                {
+                    neighbour.Add(i);
+                }
+            }
+            const auto end = std::chrono::steady_clock::now();
+            ns += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+            EXPECT_EQ(arr.GetSize(), elementCount);
+        }
+
+        std::printf("[ BENCH    ] %-32s %6.2f ns/add (%zu bytes, %s)\n",
+            Name, ns / ((double)rounds * elementCount), sizeof(T), IsTriviallyRelocatable<T> ? "relocated" : "moved");
+    };
+
+    grow("uint32", 7u);
+    grow("SVertex", frt::graphics::SVertex {});
+
+    const TRefShared<SConfinedRefObject> ref = pool.NewShared<SConfinedRefObject>();
+    grow("TRefShared", ref);
+    grow("TRefShared with move constructor", SMovedRef(ref));
+}
@@ -1,5 +1,14 @@
 #include <gtest/gtest.h>
 
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "Containers/Array.h"
+#include "Memory/AllocationTrace.h"
+#include "Memory/FrameArena.h"
 #include "Memory/Memory.h"
 #include "Memory/MemoryPool.h"
 
@@ -24,6 +33,20 @@ struct TestDestruct
     ~TestDestruct() { if (Flag) *Flag = true; }
 };
 
+struct TestSlabType
+{
+    char Payload[200] = {};
+    int Value = 0;
+    explicit TestSlabType(int InValue) : Value(InValue) {}
+};
+FRT_DECLARE_SLAB_POOL(TestSlabType)
+
+struct TestThreadSafeRefs
+{
+    int Value = 0;
+};
+FRT_DECLARE_THREAD_SAFE_REFS(TestThreadSafeRefs)
+
 
 TEST(MemoryAllocation, BasicAllocation)
 {
@@ -119,3 +142,452 @@ TEST(MemoryAllocation, ReallocateMemory)
 
     pool.Free(data);
 }
+
+TEST(MemoryAllocation, CommitsOnDemand)
+{
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    CMemoryPool pool(1_Gb);
+    EXPECT_TRUE(pool.IsGrowable());
+    EXPECT_EQ(pool.GetReservedSize(), 1_Gb);
+    EXPECT_LT(pool.GetCommittedSize(), 8_Mb);
+
+    void* big = pool.Allocate(64_Mb);
+    ASSERT_NE(big, nullptr);
+    std::memset(big, 0xAB, 64_Mb);
+    EXPECT_GE(pool.GetCommittedSize(), 64_Mb);
+    EXPECT_LT(pool.GetCommittedSize(), 128_Mb);
+    EXPECT_EQ(pool.GetReservedSize(), 1_Gb);
+
+    pool.Free(big);
+}
+
+TEST(MemoryAllocation, GrowsPastReservation)
+{
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    CMemoryPool pool(4_Mb);
+
+    std::vector<char*> blocks;
+    for (int i = 0; i < 64; ++i)
+    {
+        auto* block = static_cast<char*>(pool.Allocate(1_Mb));
+        ASSERT_NE(block, nullptr);
+        block[0] = static_cast<char>(i);
+        block[1_Mb - 1] = static_cast<char>(i);
+        blocks.push_back(block);
+    }
+    EXPECT_GT(pool.GetReservedSize(), 4_Mb);
+
+    for (int i = 0; i < 64; ++i)
+    {
+        EXPECT_EQ(blocks[i][0], static_cast<char>(i));
+        EXPECT_EQ(blocks[i][1_Mb - 1], static_cast<char>(i));
+        pool.Free(blocks[i]);
+    }
+
+    // Freed memory is reused instead of growing further
+    const uint64 reserved = pool.GetReservedSize();
+    void* again = pool.Allocate(2_Mb);
+    EXPECT_NE(again, nullptr);
+    EXPECT_EQ(pool.GetReservedSize(), reserved);
+    pool.Free(again);
+}
+
+TEST(MemoryAllocation, HugePages)
+{
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    CMemoryPool pool(256_Mb, EMemoryPoolFlags::HugePages);
+    auto* data = static_cast<char*>(pool.Allocate(16_Mb));
+    ASSERT_NE(data, nullptr);
+    std::memset(data, 1, 16_Mb);
+    pool.Free(data);
+}
+
+TEST(MemoryFrameArena, BumpAndReset)
+{
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    CMemoryPool pool(16_Mb);
+    CFrameArena arena(&pool, 64_Kb, 2u);
+
+    auto* first = static_cast<uint8*>(arena.Allocate(3));
+    auto* second = static_cast<uint8*>(arena.Allocate(100));
+    EXPECT_EQ(reinterpret_cast<uint64>(first) % CFrameArena::Alignment, 0u);
+    EXPECT_EQ(reinterpret_cast<uint64>(second) % CFrameArena::Alignment, 0u);
+    EXPECT_GT(second, first);
+
+    // Only the latest allocation is rolled back
+    const uint64 used = arena.GetUsedSize();
+    arena.Free(first);
+    EXPECT_EQ(arena.GetUsedSize(), used);
+    arena.Free(second);
+    EXPECT_LT(arena.GetUsedSize(), used);
+
+    arena.BeginFrame();
+    arena.BeginFrame();
+    EXPECT_EQ(arena.GetUsedSize(), 0u);
+    EXPECT_EQ(arena.Allocate(3), first);
+}
+
+TEST(MemoryFrameArena, PreviousFrameSurvives)
+{
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    CMemoryPool pool(16_Mb);
+    CFrameArena arena(&pool, 64_Kb, 2u);
+
+    auto* data = static_cast<char*>(arena.Allocate(64));
+    std::memset(data, 7, 64);
+
+    arena.BeginFrame();
+    auto* other = static_cast<char*>(arena.Allocate(64));
+    std::memset(other, 9, 64);
+
+    for (int i = 0; i < 64; ++i)
+    {
+        EXPECT_EQ(data[i], 7);
+    }
+}
+
+TEST(MemoryFrameArena, OverflowGrowsBuffer)
+{
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    CMemoryPool pool(16_Mb);
+    CFrameArena arena(&pool, 4_Kb, 2u);
+
+    std::vector<char*> blocks;
+    for (int i = 0; i < 64; ++i)
+    {
+        auto* block = static_cast<char*>(arena.Allocate(1_Kb));
+        ASSERT_NE(block, nullptr);
+        std::memset(block, i, 1_Kb);
+        blocks.push_back(block);
+    }
+    for (int i = 0; i < 64; ++i)
+    {
+        EXPECT_EQ(blocks[i][0], static_cast<char>(i));
+        EXPECT_EQ(blocks[i][1_Kb - 1], static_cast<char>(i));
+    }
+    const uint64 peak = arena.GetUsedSize();
+
+    // Next time this buffer is used it's big enough for the whole frame
+    arena.BeginFrame();
+    arena.BeginFrame();
+    EXPECT_GE(arena.GetFrameBufferSize(), peak);
+}
+
+TEST(MemoryFrameArena, Containers)
+{
+    using namespace frt;
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    CMemoryPool pool(16_Mb);
+    CFrameArena arena(&pool, 64_Kb, 2u);
+    arena.MakeThisPrimaryInstance();
+
+    TArray<int, CFrameArena> values;
+    for (int i = 0; i < 10000; ++i)
+    {
+        values.Add(i);
+    }
+    for (int i = 0; i < 10000; ++i)
+    {
+        EXPECT_EQ(values[i], i);
+    }
+
+    std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, TFrameArenaStlAllocator<std::pair<const int, int>>>
+        map;
+    for (int i = 0; i < 1000; ++i)
+    {
+        map.emplace(i, i * 2);
+    }
+    EXPECT_EQ(map.size(), 1000u);
+    EXPECT_EQ(map.at(500), 1000);
+}
+
+TEST(MemorySlab, ManagedAllocationsUseSlabs)
+{
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    CMemoryPool pool(16_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    bool destroyed = false;
+    {
+        auto shared = pool.NewShared<TestDestruct>(&destroyed);
+        uint32 liveCount = 0u;
+        pool.GetSlabPools().ForEachSlab([&liveCount] (const CSlabAllocator& Slab)
+        {
+            liveCount += Slab.GetStats().LiveCount;
+        });
+        EXPECT_EQ(liveCount, 1u);
+    }
+    EXPECT_TRUE(destroyed);
+
+    pool.GetSlabPools().ForEachSlab([] (const CSlabAllocator& Slab)
+    {
+        EXPECT_EQ(Slab.GetStats().LiveCount, 0u);
+        EXPECT_EQ(Slab.GetStats().AllocationCount, 1u);
+    });
+}
+
+TEST(MemorySlab, DedicatedSlabIsContiguousAndReused)
+{
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    EXPECT_TRUE(IsDedicatedSlabType<TestSlabType>);
+    EXPECT_FALSE(IsDedicatedSlabType<TestStruct>);
+
+    CMemoryPool pool(16_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    std::vector<TRefShared<TestSlabType>> objects;
+    for (int i = 0; i < 100; ++i)
+    {
+        objects.push_back(pool.NewShared<TestSlabType>(i));
+    }
+
+    // The first chunk holds them all, one block after another
+    const auto* first = reinterpret_cast<const uint8*>(objects[0].GetRawIgnoringLifetime());
+    const auto* second = reinterpret_cast<const uint8*>(objects[1].GetRawIgnoringLifetime());
+    const uint64 stride = second - first;
+    EXPECT_GE(stride, sizeof(TestSlabType));
+    EXPECT_LT(stride, sizeof(TestSlabType) + 64u);
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(objects[i]->Value, i);
+        EXPECT_EQ(reinterpret_cast<const uint8*>(objects[i].GetRawIgnoringLifetime()), first + stride * i);
+    }
+
+    const TestSlabType* released = objects[42].GetRawIgnoringLifetime();
+    objects[42].Reset();
+    auto reused = pool.NewShared<TestSlabType>(1000);
+    EXPECT_EQ(reused.GetRawIgnoringLifetime(), released);
+
+    SSlabStats stats;
+    pool.GetSlabPools().ForEachSlab([&stats] (const CSlabAllocator& Slab)
+    {
+        if (Slab.GetStats().LiveCount == 100u)
+        {
+            stats = Slab.GetStats();
+        }
+    });
+    EXPECT_EQ(stats.ChunkCount, 1u);
+    EXPECT_EQ(stats.PeakLiveCount, 100u);
+    EXPECT_EQ(stats.AllocationCount, 101u);
+    EXPECT_GT(stats.GetOccupancy(), 0.f);
+}
+
+TEST(MemoryTracking, TagStats)
+{
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    CMemoryPool pool(16_Mb);
+    if (!pool.IsTrackingEnabled())
+    {
+        GTEST_SKIP() << "FRT_MEMORY_TRACKING is off";
+    }
+
+    EXPECT_EQ(GetCurrentMemoryTag(), EMemoryTag::Untagged);
+
+    void* renderer = nullptr;
+    void* world = nullptr;
+    {
+        FRT_MEMORY_TAG_SCOPE(Renderer);
+        renderer = pool.Allocate(1000);
+        {
+            FRT_MEMORY_TAG_SCOPE(World);
+            EXPECT_EQ(GetCurrentMemoryTag(), EMemoryTag::World);
+            world = pool.Allocate(300);
+        }
+        EXPECT_EQ(GetCurrentMemoryTag(), EMemoryTag::Renderer);
+    }
+    EXPECT_EQ(GetCurrentMemoryTag(), EMemoryTag::Untagged);
+
+    SMemoryTagStats rendererStats = pool.GetTagStats(EMemoryTag::Renderer);
+    EXPECT_EQ(rendererStats.LiveBytes, 1000u);
+    EXPECT_EQ(rendererStats.LiveCount, 1u);
+    EXPECT_EQ(pool.GetTagStats(EMemoryTag::World).LiveBytes, 300u);
+
+    // Reallocation stays under the original tag
+    renderer = pool.ReAllocate(renderer, 4000);
+    rendererStats = pool.GetTagStats(EMemoryTag::Renderer);
+    EXPECT_EQ(rendererStats.LiveBytes, 4000u);
+    EXPECT_EQ(rendererStats.PeakBytes, 4000u);
+    EXPECT_EQ(rendererStats.LiveCount, 1u);
+
+    pool.Free(renderer);
+    pool.Free(world);
+
+    rendererStats = pool.GetTagStats(EMemoryTag::Renderer);
+    EXPECT_EQ(rendererStats.LiveBytes, 0u);
+    EXPECT_EQ(rendererStats.LiveCount, 0u);
+    EXPECT_EQ(rendererStats.PeakBytes, 4000u);
+    EXPECT_EQ(pool.GetTagStats(EMemoryTag::World).LiveBytes, 0u);
+    EXPECT_EQ(pool.GetTagStats(EMemoryTag::World).AllocationCount, 1u);
+}
+
+TEST(MemoryTracking, HeapReport)
+{
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    std::vector<uint64> buffer(1_Mb / sizeof(uint64));
+    CMemoryPool pool(buffer.data(), buffer.size() * sizeof(uint64));
+
+    const SHeapReport fresh = pool.GetHeapReport();
+    EXPECT_EQ(fresh.PoolCount, 1u);
+    EXPECT_EQ(fresh.FreeBlockCount, 1u);
+    EXPECT_EQ(fresh.LargestFreeBlock, fresh.FreeBytes);
+    EXPECT_FLOAT_EQ(fresh.GetFragmentation(), 0.f);
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 64; ++i)
+    {
+        blocks.push_back(pool.Allocate(1000));
+    }
+    // Every other block freed leaves holes that can't merge
+    for (int i = 0; i < 64; i += 2)
+    {
+        pool.Free(blocks[i]);
+    }
+
+    const SHeapReport report = pool.GetHeapReport();
+    EXPECT_EQ(report.FreeBlockCount, 33u);
+    EXPECT_GT(report.GetFragmentation(), 0.f);
+    EXPECT_LT(report.LargestFreeBlock, report.FreeBytes);
+    EXPECT_EQ(report.UsedBytes + report.FreeBytes + (report.UsedBlockCount + report.FreeBlockCount) * TLSF::Overhead,
+        fresh.UsedBytes + fresh.FreeBytes + (fresh.UsedBlockCount + fresh.FreeBlockCount) * TLSF::Overhead);
+
+    uint64 histogramCount = 0ull;
+    for (uint32 fl = 0u; fl < TLSF::FirstLevelIndexCount; ++fl)
+    {
+        for (uint32 sl = 0u; sl < TLSF::SecondLevelIndexCount; ++sl)
+        {
+            histogramCount += report.FreeBlockHistogram[fl][sl];
+            if (report.FreeBlockHistogram[fl][sl])
+            {
+                uint32 mappedFl, mappedSl;
+                TLSF::MappingInsert(TLSF::GetBinMinSize(fl, sl), mappedFl, mappedSl);
+                EXPECT_EQ(mappedFl, fl);
+                EXPECT_EQ(mappedSl, sl);
+            }
+        }
+    }
+    EXPECT_EQ(histogramCount, report.FreeBlockCount);
+
+    testing::internal::CaptureStdout();
+    pool.PrintReport();
+    EXPECT_NE(testing::internal::GetCapturedStdout().find("fragmentation"), std::string::npos);
+
+    for (int i = 1; i < 64; i += 2)
+    {
+        pool.Free(blocks[i]);
+    }
+    EXPECT_EQ(pool.GetHeapReport().FreeBlockCount, 1u);
+}
+
+TEST(MemoryTracking, TraceRecordAndLoad)
+{
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    CMemoryPool pool(16_Mb);
+    if (!pool.IsTrackingEnabled())
+    {
+        GTEST_SKIP() << "FRT_MEMORY_TRACKING is off";
+    }
+
+    // Allocated before the recording, so its free is not traced
+    void* early = pool.Allocate(32);
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "frt_trace_test.bin";
+    CAllocationTraceRecorder recorder;
+    ASSERT_TRUE(recorder.Start(path));
+    pool.SetTraceRecorder(&recorder);
+
+    void* a = pool.Allocate(100);
+    void* b = pool.Allocate(200);
+    a = pool.ReAllocate(a, 5000);
+    pool.Free(b);
+    pool.Free(a);
+    pool.Free(early);
+
+    pool.SetTraceRecorder(nullptr);
+    recorder.Stop();
+    EXPECT_EQ(recorder.GetEventCount(), 5u);
+
+    std::vector<STraceEvent> events;
+    ASSERT_TRUE(CAllocationTraceRecorder::Load(path, events));
+    std::filesystem::remove(path);
+
+    ASSERT_EQ(events.size(), 5u);
+    EXPECT_EQ(events[0].Op, ETraceOp::Allocate);
+    EXPECT_EQ(events[0].Size, 100u);
+    EXPECT_EQ(events[1].Op, ETraceOp::Allocate);
+    EXPECT_EQ(events[1].Size, 200u);
+    EXPECT_NE(events[0].AddressId, events[1].AddressId);
+    EXPECT_EQ(events[2].Op, ETraceOp::ReAllocate);
+    EXPECT_EQ(events[2].AddressId, events[0].AddressId);
+    EXPECT_EQ(events[2].Size, 5000u);
+    EXPECT_EQ(events[3].Op, ETraceOp::Free);
+    EXPECT_EQ(events[3].AddressId, events[1].AddressId);
+    EXPECT_EQ(events[3].Size, 200u);
+    EXPECT_EQ(events[4].Op, ETraceOp::Free);
+    EXPECT_EQ(events[4].Size, 5000u);
+    EXPECT_LE(events[0].Timestamp, events[4].Timestamp);
+    EXPECT_EQ(events[0].ThreadId, events[4].ThreadId);
+}
+
+TEST(MemoryRefs, CountPolicy)
+{
+    using namespace frt::memory;
+
+    static_assert(std::is_same_v<TRefCountPolicy<TestStruct>, SRefCountSingleThread>);
+    static_assert(std::is_same_v<TRefCountPolicy<TestThreadSafeRefs>, SRefCountThreadSafe>);
+    static_assert(std::is_same_v<TRefCountPolicy<const TestThreadSafeRefs>, SRefCountThreadSafe>);
+    static_assert(sizeof(TRefControlBlock<TestStruct>) == sizeof(TRefControlBlock<TestThreadSafeRefs>));
+}
+
+TEST(MemoryRefs, WeakLock)
+{
+    using namespace frt::memory;
+    using namespace frt::memory::literals;
+
+    CMemoryPool pool(1_Mb);
+
+    bool destroyed = false;
+    auto shared = pool.NewShared<TestDestruct>(&destroyed);
+    TRefWeak<TestDestruct> weak = shared.GetWeak();
+    EXPECT_TRUE(weak);
+    {
+        TRefShared<TestDestruct> locked = weak.Lock();
+        EXPECT_TRUE(locked);
+        shared.Release();
+        EXPECT_FALSE(destroyed);
+    }
+    EXPECT_TRUE(destroyed);
+
+    // Expired weak refs can still be copied, but never locked
+    EXPECT_FALSE(weak);
+    EXPECT_FALSE(weak.Lock());
+    TRefWeak<TestDestruct> copy = weak;
+    EXPECT_FALSE(copy);
+
+    TRefShared<TestDestruct> empty;
+    TRefShared<TestDestruct> emptyCopy = empty;
+    EXPECT_FALSE(emptyCopy);
+}
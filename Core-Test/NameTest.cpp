@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Name.h"
+#include "Containers/HashMap.h"
+#include "Memory/MemoryPool.h"
+
+using namespace frt;
+using namespace frt::memory;
+using namespace frt::memory::literals;
+
+
+TEST(SNameTest, InternTest)
+{
+    const SName a("IA_MoveForward");
+    const SName b(std::string("IA_MoveForward"));
+    const SName c("IA_MoveLeft");
+
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.GetId(), b.GetId());
+    EXPECT_NE(a, c);
+    EXPECT_EQ(a.ToString(), "IA_MoveForward");
+    EXPECT_STREQ(c.GetDebugString(), "IA_MoveLeft");
+
+    // Text is owned by the table, not by whatever the name was made from
+    std::string source = "PixelShader_perm_0123456789abcdef";
+    const SName fromTemporary(source);
+    const char* text = fromTemporary.GetDebugString();
+    source.assign(source.size(), 'x');
+    EXPECT_STREQ(text, "PixelShader_perm_0123456789abcdef");
+    EXPECT_EQ(SName("PixelShader_perm_0123456789abcdef").GetDebugString(), text);
+}
+
+TEST(SNameTest, NoneTest)
+{
+    const SName none;
+    EXPECT_TRUE(none.IsNone());
+    EXPECT_EQ(SName(""), none);
+    EXPECT_EQ(none.ToString(), "");
+    EXPECT_STREQ(none.GetDebugString(), "");
+    EXPECT_FALSE(SName("None").IsNone());
+
+    EXPECT_TRUE(SName::Find("SNameTest_NeverInterned").IsNone());
+    const SName added("SNameTest_Interned");
+    EXPECT_EQ(SName::Find("SNameTest_Interned"), added);
+}
+
+TEST(SNameTest, IgnoreCaseTest)
+{
+    const SName mixed("VertexShader");
+    const SName upper("VERTEXSHADER");
+    const SName lower("vertexshader");
+
+    EXPECT_NE(mixed, upper);
+    EXPECT_TRUE(mixed.EqualsIgnoreCase(upper));
+    EXPECT_TRUE(upper.EqualsIgnoreCase(lower));
+    EXPECT_FALSE(mixed.EqualsIgnoreCase(SName("PixelShader")));
+    EXPECT_EQ(mixed.GetLowercase(), lower);
+    EXPECT_EQ(lower.GetLowercase(), lower);
+    EXPECT_EQ(mixed.ToString(), "VertexShader");
+
+    // Longer than what is lowercased on the stack
+    const std::string longText = std::string(300, 'A') + "b";
+    const std::string longLower = std::string(300, 'a') + "b";
+    EXPECT_TRUE(SName(longText).EqualsIgnoreCase(SName(longLower)));
+}
+
+TEST(SNameTest, HashMapKeyTest)
+{
+    CMemoryPool pool(16_Mb);
+    pool.MakeThisPrimaryInstance();
+
+    THashMap<SName, int> map;
+    map.Add(SName("Diffuse"), 1);
+    map.Add(SName("Normal"), 2);
+    EXPECT_EQ(*map.Find(SName("Diffuse")), 1);
+    EXPECT_EQ(map.Find(SName("diffuse")), nullptr);
+
+    THashMap<SName, int, CMemoryPool, SNameHashIgnoreCase, SNameEqualIgnoreCase> noCase;
+    noCase.Add(SName("Diffuse"), 1);
+    noCase.Add(SName("DIFFUSE"), 2);
+    EXPECT_EQ(noCase.Count(), 1);
+    EXPECT_EQ(*noCase.Find(SName("diffuse")), 2);
+}
+
+TEST(SNameTest, ConcurrentInternTest)
+{
+    static constexpr uint32 threadCount = 8u;
+    static constexpr uint32 namesPerThread = 2000u;
+
+    // All threads intern the same names in different orders, every one must get the same ids
+    std::vector<std::vector<SName>> results(threadCount);
+    std::vector<std::thread> threads;
+    for (uint32 t = 0u; t < threadCount; ++t)
+    {
+        threads.emplace_back([t, &results] ()
+        {
+            results[t].resize(namesPerThread);
+            for (uint32 i = 0u; i < namesPerThread; ++i)
+            {
+                const uint32 index = (i * 7u + t * 131u) % namesPerThread;
+                results[t][index] = SName("SNameTest_Concurrent_" + std::to_string(index));
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (uint32 i = 0u; i < namesPerThread; ++i)
+    {
+        EXPECT_EQ(results[0][i].ToString(), "SNameTest_Concurrent_" + std::to_string(i));
+        for (uint32 t = 1u; t < threadCount; ++t)
+        {
+            EXPECT_EQ(results[t][i], results[0][i]);
+        }
+    }
+}
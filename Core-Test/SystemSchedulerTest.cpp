@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "SystemScheduler.h"
+#include "Jobs/JobSystem.h"
+#include "Memory/MemoryPool.h"
+
+using namespace frt;
+using namespace frt::memory;
+using namespace frt::memory::literals;
+
+
+namespace
+{
+struct SPosition
+{
+    float X = 0.f;
+};
+
+struct SVelocity
+{
+    float X = 0.f;
+};
+
+struct SHealth
+{
+    float Value = 0.f;
+};
+
+// Records when it started and finished on a shared sequence, so the order systems ran in can be checked
+class STestSystem : public ISystem
+{
+public:
+    STestSystem(SFlags<EUpdatePhase> InPhases, SSystemAccess InAccess, std::atomic<uint32>& InSequence)
+        : Phases(InPhases)
+        , Access(InAccess)
+        , Sequence(InSequence)
+    {}
+
+    virtual SFlags<EUpdatePhase>& GetPhases() override { return Phases; }
+    virtual const char* GetName() const override { return "Test"; }
+    virtual SSystemAccess GetAccess() const override { return Access; }
+
+    virtual void Update(const SUpdateContext& Context) override { Run(); }
+    virtual void Finalize(const SUpdateContext& Context) override { Run(); }
+
+    void Run()
+    {
+        Start = Sequence.fetch_add(1u);
+        ThreadIndex = jobs::CJobSystem::GetPrimaryInstance()
+            ? jobs::CJobSystem::GetPrimaryInstance()->GetCurrentThreadIndex()
+            : 0u;
+        if (Body)
+        {
+            Body();
+        }
+        ++RunCount;
+        End = Sequence.fetch_add(1u);
+    }
+
+    SFlags<EUpdatePhase> Phases;
+    SSystemAccess Access;
+    std::atomic<uint32>& Sequence;
+    std::function<void()> Body;
+
+    uint32 Start = 0u;
+    uint32 End = 0u;
+    uint32 ThreadIndex = 0u;
+    uint32 RunCount = 0u;
+};
+}
+
+
+// EcsTest.cpp has an SPosition of its own, they must not share a component id
+uint32 GetSchedulerTestPositionId()
+{
+    return ecs::GetComponentId<SPosition>();
+}
+
+
+TEST(CSystemSchedulerTest, DependencyOrderTest)
+{
+    CMemoryPool pool(64_Mb, EMemoryPoolFlags::ThreadSafe);
+    pool.MakeThisPrimaryInstance();
+
+    for (const uint32 workerCount : { 0u, 3u })
+    {
+        jobs::CJobSystem jobSystem(workerCount);
+        jobSystem.MakeThisPrimaryInstance();
+
+        std::atomic<uint32> sequence = 0u;
+        const SFlags<EUpdatePhase> update = EUpdatePhase::Update;
+        STestSystem writePosition(update, SSystemAccess().Write<SPosition>(), sequence);
+        STestSystem readPosition(update, SSystemAccess().Read<SPosition>(), sequence);
+        STestSystem writeVelocity(update, SSystemAccess().Write<SVelocity>(), sequence);
+        STestSystem readBoth(update, SSystemAccess().Read<SPosition, SVelocity>(), sequence);
+        STestSystem exclusive(update, SSystemAccess::Exclusive(), sequence);
+        STestSystem writePositionAgain(update, SSystemAccess().Write<SPosition>(), sequence);
+        STestSystem readHealth(update, SSystemAccess().Read<SHealth>(), sequence);
+        STestSystem finalizeOnly(EUpdatePhase::Finalize, SSystemAccess().Write<SPosition>(), sequence);
+
+        // Gives the systems that don't wait for it a chance to start first
+        writePosition.Body = [] { std::this_thread::sleep_for(std::chrono::milliseconds(2)); };
+
+        STestSystem* systems[] = {
+            &writePosition, &readPosition, &writeVelocity, &readBoth,
+            &exclusive, &writePositionAgain, &readHealth, &finalizeOnly };
+
+        CSystemScheduler scheduler;
+        for (STestSystem* system : systems)
+        {
+            scheduler.AddSystem(*system);
+        }
+
+        SUpdateContext context;
+        scheduler.RunPhase(EUpdatePhase::Update, context);
+
+        for (uint32 i = 0; i < 7u; ++i)
+        {
+            EXPECT_EQ(systems[i]->RunCount, 1u);
+        }
+        EXPECT_EQ(finalizeOnly.RunCount, 0u);
+
+        EXPECT_GT(readPosition.Start, writePosition.End);
+        EXPECT_GT(readBoth.Start, writePosition.End);
+        EXPECT_GT(readBoth.Start, writeVelocity.End);
+
+        // Exclusive systems run alone on the calling thread
+        EXPECT_EQ(exclusive.ThreadIndex, 0u);
+        for (uint32 i = 0; i < 4u; ++i)
+        {
+            EXPECT_GT(exclusive.Start, systems[i]->End);
+        }
+        EXPECT_GT(writePositionAgain.Start, exclusive.End);
+        EXPECT_GT(readHealth.Start, exclusive.End);
+
+        scheduler.RunPhase(EUpdatePhase::Finalize, context);
+        EXPECT_EQ(finalizeOnly.RunCount, 1u);
+        EXPECT_EQ(writePosition.RunCount, 1u);
+
+        EXPECT_TRUE(scheduler.RemoveSystem(exclusive));
+        EXPECT_FALSE(scheduler.RemoveSystem(exclusive));
+        EXPECT_EQ(scheduler.GetSystemCount(), 7u);
+    }
+}
+
+TEST(CSystemSchedulerTest, StatsTest)
+{
+    CMemoryPool pool(64_Mb, EMemoryPoolFlags::ThreadSafe);
+    pool.MakeThisPrimaryInstance();
+
+    std::atomic<uint32> sequence = 0u;
+    STestSystem slow(
+        SFlags<EUpdatePhase>(EUpdatePhase::Update).AddFlag(EUpdatePhase::Finalize),
+        SSystemAccess().Write<SPosition>(),
+        sequence);
+    slow.Body = [] { std::this_thread::sleep_for(std::chrono::milliseconds(2)); };
+
+    CSystemScheduler scheduler;
+    scheduler.AddSystem(slow);
+
+    SUpdateContext context;
+    scheduler.BeginFrame();
+    scheduler.RunPhase(EUpdatePhase::Update, context);
+    scheduler.RunPhase(EUpdatePhase::Finalize, context);
+    EXPECT_EQ(scheduler.GetStats(0u).LastMilliseconds, 0.f);
+
+    // Both phases count towards the frame
+    scheduler.BeginFrame();
+    EXPECT_GE(scheduler.GetStats(0u).LastMilliseconds, 4.f);
+    EXPECT_GT(scheduler.GetStats(0u).AverageMilliseconds, 0.f);
+    EXPECT_LT(scheduler.GetStats(0u).AverageMilliseconds, scheduler.GetStats(0u).LastMilliseconds);
+}
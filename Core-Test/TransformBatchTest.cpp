@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Math/Transform.h"
+#include "Math/TransformBatch.h"
+
+using namespace frt;
+using namespace frt::math;
+
+
+namespace
+{
+// Owns the arrays behind an STransformArrays, one entry per STransform
+struct STestTransforms
+{
+    explicit STestTransforms(const std::vector<STransform>& InTransforms)
+    {
+        for (const STransform& transform : InTransforms)
+        {
+            TranslationX.push_back(transform.GetTranslation().x);
+            TranslationY.push_back(transform.GetTranslation().y);
+            TranslationZ.push_back(transform.GetTranslation().z);
+            RotationX.push_back(transform.GetRotation().x);
+            RotationY.push_back(transform.GetRotation().y);
+            RotationZ.push_back(transform.GetRotation().z);
+            ScaleX.push_back(transform.GetScale().x);
+            ScaleY.push_back(transform.GetScale().y);
+            ScaleZ.push_back(transform.GetScale().z);
+        }
+    }
+
+    STransformArrays GetArrays() const
+    {
+        STransformArrays arrays;
+        arrays.TranslationX = TranslationX.data();
+        arrays.TranslationY = TranslationY.data();
+        arrays.TranslationZ = TranslationZ.data();
+        arrays.RotationX = RotationX.data();
+        arrays.RotationY = RotationY.data();
+        arrays.RotationZ = RotationZ.data();
+        arrays.ScaleX = ScaleX.data();
+        arrays.ScaleY = ScaleY.data();
+        arrays.ScaleZ = ScaleZ.data();
+        arrays.Count = static_cast<uint32>(TranslationX.size());
+        return arrays;
+    }
+
+    std::vector<float> TranslationX, TranslationY, TranslationZ;
+    std::vector<float> RotationX, RotationY, RotationZ;
+    std::vector<float> ScaleX, ScaleY, ScaleZ;
+};
+
+std::vector<STransform> MakeRandomTransforms(uint32 Count, uint32 Seed)
+{
+    std::mt19937 random(Seed);
+    std::uniform_real_distribution<float> translation(-100.f, 100.f);
+    std::uniform_real_distribution<float> rotation(-20.f, 20.f);
+    std::uniform_real_distribution<float> scale(0.1f, 3.f);
+
+    std::vector<STransform> transforms(Count);
+    for (STransform& transform : transforms)
+    {
+        transform.SetTranslation(translation(random), translation(random), translation(random));
+        transform.SetRotation(rotation(random), rotation(random), rotation(random));
+        transform.SetScale(Vector3f(scale(random), scale(random), scale(random)));
+    }
+    return transforms;
+}
+}
+
+
+TEST(TransformBatchTest, BitwiseEqualToComputeMatrixTest)
+{
+    // Counts around every lane width, so full batches and the scalar tail both run
+    for (const uint32 count : { 1u, 3u, 4u, 7u, 8u, 15u, 16u, 17u, 63u, 64u, 1001u })
+    {
+        std::vector<STransform> transforms = MakeRandomTransforms(count, count);
+
+        // Angles where the range reduction switches branches
+        const float edges[] = { 0.f, 1.5707964f, -1.5707964f, 3.1415927f, -3.1415927f, 6.2831855f };
+        for (uint32 i = 0; i < count && i < 6u; ++i)
+        {
+            transforms[i].SetRotation(edges[i], edges[(i + 1u) % 6u], edges[(i + 2u) % 6u]);
+        }
+
+        const STestTransforms arrays(transforms);
+        std::vector<DirectX::XMFLOAT4X4> batched(count);
+        std::vector<DirectX::XMFLOAT4X4> scalar(count);
+        ComposeMatrices(arrays.GetArrays(), batched.data());
+        ComposeMatricesScalar(arrays.GetArrays(), scalar.data());
+
+        uint32 mismatchCount = 0u;
+        for (uint32 i = 0; i < count; ++i)
+        {
+            const DirectX::XMFLOAT4X4 expected = transforms[i].ComputeMatrix();
+            mismatchCount += std::memcmp(&batched[i], &expected, sizeof(expected)) != 0;
+            mismatchCount += std::memcmp(&scalar[i], &expected, sizeof(expected)) != 0;
+        }
+        EXPECT_EQ(mismatchCount, 0u) << "count " << count << ", " << GetTransformBatchInstructionSet();
+    }
+}
+
+TEST(TransformBatchTest, MatchesDirectXMathTest)
+{
+    using namespace DirectX;
+
+    const std::vector<STransform> transforms = MakeRandomTransforms(256u, 7u);
+    for (const STransform& transform : transforms)
+    {
+        const Vector3f& t = transform.GetTranslation();
+        const Vector3f& r = transform.GetRotation();
+        const Vector3f& s = transform.GetScale();
+
+        const XMMATRIX engineMatrix = XMMatrixMultiply(
+            XMMatrixMultiply(XMMatrixRotationRollPitchYaw(r.x, r.y, r.z), XMMatrixScaling(s.x, s.y, s.z)),
+            XMMatrixTranslation(t.x, t.y, t.z));
+        XMFLOAT4X4 expected;
+        XMStoreFloat4x4(&expected, XMMatrixMultiply(XMMatrixScaling(-1.f, 1.f, 1.f), engineMatrix));
+
+        const XMFLOAT4X4 actual = transform.ComputeMatrix();
+        for (uint32 row = 0; row < 4u; ++row)
+        {
+            for (uint32 column = 0; column < 4u; ++column)
+            {
+                EXPECT_NEAR(actual.m[row][column], expected.m[row][column], 1e-5f);
+            }
+        }
+    }
+}
+
+TEST(TransformBatchTest, TransformBlockTest)
+{
+    const std::vector<STransform> transforms = MakeRandomTransforms(10u, 3u);
+
+    TTransformBlock<16> block;
+    EXPECT_TRUE(block.IsEmpty());
+    for (uint32 i = 0; i < transforms.size(); ++i)
+    {
+        EXPECT_EQ(block.Add(transforms[i].GetTranslation(), transforms[i].GetRotation(), transforms[i].GetScale()), i);
+    }
+    EXPECT_FALSE(block.IsFull());
+
+    DirectX::XMFLOAT4X4 matrices[16];
+    ComposeMatrices(block.GetArrays(), matrices);
+    for (uint32 i = 0; i < transforms.size(); ++i)
+    {
+        const DirectX::XMFLOAT4X4 expected = transforms[i].ComputeMatrix();
+        EXPECT_EQ(std::memcmp(&matrices[i], &expected, sizeof(expected)), 0);
+    }
+
+    block.Clear();
+    EXPECT_TRUE(block.IsEmpty());
+}
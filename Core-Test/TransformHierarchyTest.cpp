@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include "Sys_TransformHierarchy.h"
+#include "Ecs/EntityRegistry.h"
+#include "Jobs/JobSystem.h"
+#include "Memory/MemoryPool.h"
+
+using namespace frt;
+using namespace frt::ecs;
+using namespace frt::memory;
+using namespace frt::memory::literals;
+
+
+namespace
+{
+EntityHandle SpawnAt(CEntityRegistry& Registry, float X, float Y, float Z)
+{
+    const EntityHandle entity = Registry.Create<math::STransform, Comp_WorldTransform>();
+    Registry.Get<math::STransform>(entity).SetTranslation(X, Y, Z);
+    return entity;
+}
+
+void ExpectWorldTranslation(CEntityRegistry& Registry, EntityHandle Entity, float X, float Y, float Z)
+{
+    const Comp_WorldTransform& world = Registry.Get<Comp_WorldTransform>(Entity);
+    EXPECT_FLOAT_EQ(world.Matrix._41, X);
+    EXPECT_FLOAT_EQ(world.Matrix._42, Y);
+    EXPECT_FLOAT_EQ(world.Matrix._43, Z);
+}
+
+uint64 GetChangedFrame(CEntityRegistry& Registry, EntityHandle Entity)
+{
+    return Registry.Get<Comp_WorldTransform>(Entity).ChangedFrame;
+}
+}
+
+
+TEST(Sys_TransformHierarchyTest, ChainTest)
+{
+    CMemoryPool pool(64_Mb, EMemoryPoolFlags::ThreadSafe);
+    pool.MakeThisPrimaryInstance();
+    jobs::CJobSystem jobSystem(2u);
+    jobSystem.MakeThisPrimaryInstance();
+
+    // Created deepest first, the update still has to see every parent before its children
+    CEntityRegistry registry;
+    const EntityHandle grandchild = SpawnAt(registry, 0.f, 0.f, 3.f);
+    const EntityHandle child = SpawnAt(registry, 0.f, 2.f, 0.f);
+    const EntityHandle parent = SpawnAt(registry, 1.f, 0.f, 0.f);
+    registry.Add<Comp_Parent>(grandchild).Parent = child;
+    registry.Add<Comp_Parent>(child).Parent = parent;
+    registry.Get<math::STransform>(parent).SetScale(2.f);
+
+    Sys_TransformHierarchy hierarchy;
+    hierarchy.UpdateWorldTransforms(registry);
+    EXPECT_EQ(hierarchy.GetFrameIndex(), 1u);
+
+    ExpectWorldTranslation(registry, parent, 1.f, 0.f, 0.f);
+    ExpectWorldTranslation(registry, child, 1.f, 4.f, 0.f);
+    ExpectWorldTranslation(registry, grandchild, 1.f, 4.f, 6.f);
+
+    // Handedness flip is applied once, not once per level
+    EXPECT_FLOAT_EQ(registry.Get<Comp_WorldTransform>(grandchild).Matrix._11, -2.f);
+    EXPECT_FLOAT_EQ(registry.Get<Comp_WorldTransform>(grandchild).Matrix._22, 2.f);
+
+    for (const EntityHandle entity : { parent, child, grandchild })
+    {
+        EXPECT_FALSE(registry.Get<math::STransform>(entity).IsDirty());
+        EXPECT_EQ(GetChangedFrame(registry, entity), 1u);
+    }
+}
+
+TEST(Sys_TransformHierarchyTest, DirtyPropagationTest)
+{
+    CMemoryPool pool(64_Mb, EMemoryPoolFlags::ThreadSafe);
+    pool.MakeThisPrimaryInstance();
+
+    CEntityRegistry registry;
+    const EntityHandle parent = SpawnAt(registry, 1.f, 0.f, 0.f);
+    const EntityHandle child = SpawnAt(registry, 0.f, 1.f, 0.f);
+    const EntityHandle grandchild = SpawnAt(registry, 0.f, 0.f, 1.f);
+    const EntityHandle unrelated = SpawnAt(registry, 5.f, 5.f, 5.f);
+    registry.Add<Comp_Parent>(child).Parent = parent;
+    registry.Add<Comp_Parent>(grandchild).Parent = child;
+
+    Sys_TransformHierarchy hierarchy;
+    hierarchy.UpdateWorldTransforms(registry);
+
+    // Nothing moved
+    hierarchy.UpdateWorldTransforms(registry);
+    for (const EntityHandle entity : { parent, child, grandchild, unrelated })
+    {
+        EXPECT_EQ(GetChangedFrame(registry, entity), 1u);
+    }
+
+    // A leaf only changes itself
+    registry.Get<math::STransform>(grandchild).MoveBy(Vector3f(0.f, 0.f, 1.f));
+    hierarchy.UpdateWorldTransforms(registry);
+    EXPECT_EQ(GetChangedFrame(registry, parent), 1u);
+    EXPECT_EQ(GetChangedFrame(registry, child), 1u);
+    EXPECT_EQ(GetChangedFrame(registry, grandchild), 3u);
+    ExpectWorldTranslation(registry, grandchild, 1.f, 1.f, 2.f);
+
+    // A parent changes everything below it
+    registry.Get<math::STransform>(parent).SetTranslation(2.f, 0.f, 0.f);
+    hierarchy.UpdateWorldTransforms(registry);
+    EXPECT_EQ(GetChangedFrame(registry, parent), 4u);
+    EXPECT_EQ(GetChangedFrame(registry, child), 4u);
+    EXPECT_EQ(GetChangedFrame(registry, grandchild), 4u);
+    EXPECT_EQ(GetChangedFrame(registry, unrelated), 1u);
+    ExpectWorldTranslation(registry, child, 2.f, 1.f, 0.f);
+    ExpectWorldTranslation(registry, grandchild, 2.f, 1.f, 2.f);
+}
+
+TEST(Sys_TransformHierarchyTest, StructuralChangeTest)
+{
+    CMemoryPool pool(64_Mb, EMemoryPoolFlags::ThreadSafe);
+    pool.MakeThisPrimaryInstance();
+
+    CEntityRegistry registry;
+    const EntityHandle parent = SpawnAt(registry, 1.f, 0.f, 0.f);
+    const EntityHandle otherParent = SpawnAt(registry, 0.f, 0.f, 7.f);
+    const EntityHandle child = SpawnAt(registry, 0.f, 1.f, 0.f);
+    registry.Add<Comp_Parent>(child).Parent = parent;
+
+    Sys_TransformHierarchy hierarchy;
+    hierarchy.UpdateWorldTransforms(registry);
+    ExpectWorldTranslation(registry, child, 1.f, 1.f, 0.f);
+
+    // Changed in place, the registry doesn't see it
+    registry.Get<Comp_Parent>(child).Parent = otherParent;
+    hierarchy.InvalidateOrder();
+    hierarchy.UpdateWorldTransforms(registry);
+    ExpectWorldTranslation(registry, child, 0.f, 1.f, 7.f);
+
+    // New entities move components around, pointers kept by the hierarchy have to be gathered again
+    for (int i = 0; i < 100; ++i)
+    {
+        const EntityHandle sibling = SpawnAt(registry, 0.f, 0.f, float(i));
+        registry.Add<Comp_Parent>(sibling).Parent = otherParent;
+    }
+    registry.Get<math::STransform>(otherParent).SetTranslation(0.f, 0.f, 8.f);
+    hierarchy.UpdateWorldTransforms(registry);
+    ExpectWorldTranslation(registry, child, 0.f, 1.f, 8.f);
+
+    // Children of a destroyed parent fall back to the world origin
+    registry.Destroy(otherParent);
+    hierarchy.UpdateWorldTransforms(registry);
+    ExpectWorldTranslation(registry, child, 0.f, 1.f, 0.f);
+    EXPECT_EQ(GetChangedFrame(registry, child), hierarchy.GetFrameIndex());
+}
@@ -13,24 +13,31 @@ namespace frt
 *	- IndexStrategy is used for convenient getters for i-th element counting backwards, or for circular indexing
 *	- Until element is added, or unless specified otherwise, no memory is allocated (on the contrary to std::vector)
 *	- Compatible with STL
+*	- Holds the allocator instance it was given (see memory::TAllocatorRef), the primary one by default
+*	- Copy construction and move construction take the allocator of the source, assignments keep their own;
+*	  move assignment steals the buffer only if it can be freed through the same instance
+*	- Swap exchanges allocators together with buffers
+*	- Growing and shrinking try to resize the block in place first; if it has to move, elements are
+*	  moved with their move constructors unless the type is trivially relocatable (see memory::TIsTriviallyRelocatable)
 *
 * @TODO:
-*	- Allocator
 *	- Convertion from and to std::vector
-*	- Swap functions
 *
 * @tparam TElementType 
 * @tparam TAllocator
 */
 template <typename TElementType, typename TAllocator = memory::DefaultPool>
-class TArray
+class TArray : private memory::TAllocatorRef<TAllocator>
 {
+	using AllocatorRefType = memory::TAllocatorRef<TAllocator>;
+
 public:
 	using IndexType = int64;
 
 	using IndexStrategy = math::SIndexStrategy;
 
 	TArray ();
+	explicit TArray (TAllocator* InAllocator);
 	TArray (const TArray& Other);
 	TArray (TArray&& Other) noexcept;
 	TArray& operator= (const TArray& Other);
@@ -43,10 +50,17 @@ public:
 	TArray& operator= (std::initializer_list<TElementType> InList);
 	TArray& operator= (const std::vector<TElementType>& InVector);
 
+	/** Copy from an array that lives in another allocator, e.g. to keep per-frame data past its frame. */
+	template <typename TOtherAllocator>
+	TArray& operator= (const TArray<TElementType, TOtherAllocator>& Other);
+
 	// Allocators
 	TArray (uint32 InCapacity);
+	TArray (uint32 InCapacity, TAllocator* InAllocator);
 	void SetCapacity (uint32 InCapacity);
 
+	TAllocator* GetAllocator () const { return AllocatorRefType::GetAllocator(); }
+
 	template <bool bExtendIfNeeded = true>
 	uint32 SetSize (uint32 InSize);
 
@@ -61,6 +75,8 @@ public:
 
 	void ReAlloc (uint32 InCapacity);
 	void Free ();
+
+	void Swap (TArray& Other) noexcept;
 	// ~Allocators
 
 	// Adders
@@ -153,12 +169,18 @@ public:
 
 	size_type size () const { return Size; }
 	bool empty () const { return Size == 0; }
+
+	friend void swap (TArray& A, TArray& B) noexcept { A.Swap(B); }
 	// ~STL
 
 public:
 	static constexpr float GrowthFactor = 1.5f;
 	static constexpr uint32 MinAllocation = 2u;
 
+private:
+	AllocatorRefType& GetAllocatorRef () { return *this; }
+	const AllocatorRefType& GetAllocatorRef () const { return *this; }
+
 private:
 	TElementType* Data;
 	uint32 Size;
@@ -178,9 +200,18 @@ TArray<ElementType, TAllocator>::TArray ()
 	, Capacity(0u)
 {}
 
+template <typename ElementType, typename TAllocator>
+TArray<ElementType, TAllocator>::TArray (TAllocator* InAllocator)
+	: AllocatorRefType(InAllocator)
+	, Data(nullptr)
+	, Size(0u)
+	, Capacity(0u)
+{}
+
 template <typename ElementType, typename TAllocator>
 TArray<ElementType, TAllocator>::TArray (const TArray& Other)
-	: Data(nullptr)
+	: AllocatorRefType(Other.GetAllocatorRef())
+	, Data(nullptr)
 	, Size(0u)
 	, Capacity(0u)
 {
@@ -189,7 +220,8 @@ TArray<ElementType, TAllocator>::TArray (const TArray& Other)
 
 template <typename ElementType, typename TAllocator>
 TArray<ElementType, TAllocator>::TArray (TArray&& Other) noexcept
-	: Data(Other.Data)
+	: AllocatorRefType(Other.GetAllocatorRef())
+	, Data(Other.Data)
 	, Size(Other.Size)
 	, Capacity(Other.Capacity)
 {
@@ -211,8 +243,9 @@ TArray<ElementType, TAllocator>& TArray<ElementType, TAllocator>::operator= (con
 		Clear();
 	}
 
-	Size = Other.Size;
+	// Cleared slots hold nothing, growing must not relocate them
 	ReAlloc(Other.Capacity);
+	Size = Other.Size;
 
 	for (uint32 i = 0; i < Size; i++)
 	{
@@ -225,7 +258,27 @@ TArray<ElementType, TAllocator>& TArray<ElementType, TAllocator>::operator= (con
 template <typename ElementType, typename TAllocator>
 TArray<ElementType, TAllocator>& TArray<ElementType, TAllocator>::operator= (TArray&& Other) noexcept
 {
-	Clear();
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	if (!GetAllocatorRef().CanAdopt(Other.GetAllocatorRef()))
+	{
+		// Buffer belongs to another instance, so elements are moved into ours instead
+		Reset(Other.Size);
+		for (uint32 i = 0u; i < Other.Size; ++i)
+		{
+			new(Data + i) ElementType(std::move(*(Other.Data + i)));
+		}
+		Size = Other.Size;
+
+		Other.Free();
+		return *this;
+	}
+
+	Free();
+	GetAllocatorRef().Adopt(Other.GetAllocatorRef());
 
 	Data = Other.Data;
 	Size = Other.Size;
@@ -306,6 +359,27 @@ TArray<TElementType, TAllocator>& TArray<TElementType, TAllocator>::operator= (
 	return *this;
 }
 
+template <typename TElementType, typename TAllocator>
+template <typename TOtherAllocator>
+TArray<TElementType, TAllocator>& TArray<TElementType, TAllocator>::operator= (
+	const TArray<TElementType, TOtherAllocator>& Other)
+{
+	Clear();
+
+	if (Other.Count() > Capacity)
+	{
+		ReAlloc(Other.Count());
+	}
+
+	for (const auto& elem : Other)
+	{
+		new(Data + Size) TElementType(elem);
+		++Size;
+	}
+
+	return *this;
+}
+
 template <typename ElementType, typename TAllocator>
 TArray<ElementType, TAllocator>::TArray (uint32 InCapacity)
 	: Data(nullptr)
@@ -315,6 +389,16 @@ TArray<ElementType, TAllocator>::TArray (uint32 InCapacity)
 	ReAlloc(InCapacity);
 }
 
+template <typename ElementType, typename TAllocator>
+TArray<ElementType, TAllocator>::TArray (uint32 InCapacity, TAllocator* InAllocator)
+	: AllocatorRefType(InAllocator)
+	, Data(nullptr)
+	, Size(0u)
+	, Capacity(InCapacity)
+{
+	ReAlloc(InCapacity);
+}
+
 template <typename ElementType, typename TAllocator>
 void TArray<ElementType, TAllocator>::SetCapacity (uint32 InCapacity)
 {
@@ -359,6 +443,12 @@ uint32 TArray<ElementType, TAllocator>::SetSizeUninitialized (uint32 InSize)
 template <typename ElementType, typename TAllocator>
 void TArray<ElementType, TAllocator>::ShrinkToFit ()
 {
+	if (Size == 0u)
+	{
+		Free();
+		return;
+	}
+
 	ReAlloc(Size);
 }
 
@@ -367,14 +457,28 @@ void TArray<ElementType, TAllocator>::ReAlloc (uint32 InCapacity)
 {
 	frt_assert(InCapacity >= Size);
 
-	// As a quick first implementation, we rely on allocator/pool to realloc.
-	// It does the job, and, in fact, it may avoid reallocation and just merge our block with the next one if it's available.
-	// This potentially gives some efficiency, but it has its flaws:
-	// * We can't shrink
-	// * Move-constructors aren't called which may be or not be a problem depending on the type
+	const uint32 newCapacity = math::Max(InCapacity, MinAllocation);
+	const uint64 newSize = sizeof(ElementType) * newCapacity;
 
-	Capacity = math::Max(InCapacity, MinAllocation);
-	Data = (ElementType*)TAllocator::GetPrimaryInstance()->ReAllocate(Data, sizeof(ElementType) * Capacity);
+	if (!Data || memory::IsTriviallyRelocatable<ElementType>)
+	{
+		// Allocator resizes in place when it can and copies the bytes otherwise, which is all these types need
+		Data = (ElementType*)GetAllocatorRef().ReAllocate(Data, newSize);
+	}
+	else if (newCapacity != Capacity && !GetAllocatorRef().ResizeInPlace(Data, newSize))
+	{
+		auto* newData = (ElementType*)GetAllocatorRef().ReAllocate(nullptr, newSize);
+		for (uint32 i = 0u; i < Size; ++i)
+		{
+			new(newData + i) ElementType(std::move(*(Data + i)));
+			(Data + i)->~ElementType();
+		}
+
+		GetAllocatorRef().Free(Data);
+		Data = newData;
+	}
+
+	Capacity = newCapacity;
 }
 
 template <typename ElementType, typename TAllocator>
@@ -385,8 +489,18 @@ void TArray<ElementType, TAllocator>::Free ()
 		Clear();
 	}
 
-	TAllocator::GetPrimaryInstance()->Free(Data);
+	GetAllocatorRef().Free(Data);
 	Data = nullptr;
+	Capacity = 0u;
+}
+
+template <typename ElementType, typename TAllocator>
+void TArray<ElementType, TAllocator>::Swap (TArray& Other) noexcept
+{
+	GetAllocatorRef().Swap(Other.GetAllocatorRef());
+	std::swap(Data, Other.Data);
+	std::swap(Size, Other.Size);
+	std::swap(Capacity, Other.Capacity);
 }
 
 template <typename ElementType, typename TAllocator>
@@ -635,11 +749,13 @@ void TArray<ElementType, TAllocator>::RemoveAt (IndexType InIndex)
 		for (uint32 i = InIndex + 1u; i < Size; ++i)
 		{
 			new(Data + i - 1u) ElementType(std::move(*(Data + i)));
+			(Data + i)->~ElementType();
 		}
 	}
-	else
+	else if ((uint32)InIndex != Size - 1u)
 	{
 		new(Data + InIndex) ElementType(std::move(*(Data + Size - 1u)));
+		(Data + Size - 1u)->~ElementType();
 	}
 
 	--Size;
@@ -794,7 +910,13 @@ const ElementType& TArray<ElementType, TAllocator>::Last () const
 }
 
 
-template <typename T>
-struct concepts::SIsIndexable<TArray<T>> : std::true_type
+template <typename T, typename TAllocator>
+struct concepts::SIsIndexable<TArray<T, TAllocator>> : std::true_type
+{};
+
+
+// Nothing in TArray points back at it, so an array of arrays can grow by copying bytes
+template <typename T, typename TAllocator>
+struct memory::TIsTriviallyRelocatable<TArray<T, TAllocator>> : std::true_type
 {};
 }
@@ -0,0 +1,414 @@
+#pragma once
+
+#include <bit>
+#include <utility>
+
+#include "Asserts.h"
+#include "Containers/Array.h"
+
+#if defined(__AVX2__)
+#define FRT_BIT_ARRAY_SIMD_WORDS 4
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRT_BIT_ARRAY_SIMD_WORDS 2
+#include <emmintrin.h>
+#else
+#define FRT_BIT_ARRAY_SIMD_WORDS 1
+#endif
+
+
+namespace frt
+{
+/**
+* Dynamic array of bits packed into 64-bit words, for per-element flags such as visibility or dirty state
+* that are mostly scanned for the few bits that are set. Key points:
+*	- Single bits are set, cleared and tested with a shift and a mask
+*	- Counting and searching go a word at a time (popcount, count trailing zeros), ForEachSetBit costs
+*	  O(words + set bits) rather than O(bits)
+*	- AndWith/OrWith/AndNotWith combine whole arrays 128 or 256 bits at a time with SSE2/AVX2
+*	- Bits past Count() in the last word are always zero, so whole-word operations never see garbage
+*	- Holds the allocator instance the same way TArray does (see memory::TAllocatorRef)
+*
+* @tparam TAllocator
+*/
+template <typename TAllocator = memory::DefaultPool>
+class TBitArray
+{
+public:
+	static constexpr uint32 BitsPerWord = 64u;
+	static constexpr uint32 InvalidIndex = ~0u;
+
+	TBitArray () = default;
+	explicit TBitArray (TAllocator* InAllocator) : Words(InAllocator) {}
+
+	// Allocators
+	/** New bits are set to bInValue, bits past InSize are dropped. */
+	void SetSize (uint32 InSize, bool bInValue = false);
+
+	void SetCapacity (uint32 InCapacity) { Words.SetCapacity(WordCount(InCapacity)); }
+
+	TAllocator* GetAllocator () const { return Words.GetAllocator(); }
+
+	void Free ();
+
+	void Swap (TBitArray& Other) noexcept;
+	// ~Allocators
+
+	// Adders
+	/** Appends a bit, returns its index. */
+	uint32 Add (bool bInValue);
+	// ~Adders
+
+	// Removers
+	/** Without keeping order the last bit is moved into the hole, the same way TArray::RemoveAt<false> moves elements. */
+	template <bool bKeepOrder = true>
+	void RemoveAt (uint32 InIndex);
+
+	/**
+	* Drop all bits, but do not free memory.
+	*/
+	void Clear ();
+	// ~Removers
+
+	// Bits
+	void SetBit (uint32 InIndex) { frt_assert(InIndex < Size); Words[InIndex / BitsPerWord] |= GetBitMask(InIndex); }
+	void ClearBit (uint32 InIndex) { frt_assert(InIndex < Size); Words[InIndex / BitsPerWord] &= ~GetBitMask(InIndex); }
+	void SetBit (uint32 InIndex, bool bInValue) { bInValue ? SetBit(InIndex) : ClearBit(InIndex); }
+
+	bool TestBit (uint32 InIndex) const
+	{
+		frt_assert(InIndex < Size);
+		return (Words.GetData()[InIndex / BitsPerWord] & GetBitMask(InIndex)) != 0u;
+	}
+
+	bool operator[] (uint32 InIndex) const { return TestBit(InIndex); }
+
+	/** Sets every bit to bInValue. */
+	void SetAll (bool bInValue);
+	// ~Bits
+
+	// Whole array
+	/** this &= Other; both must have the same size. */
+	void AndWith (const TBitArray& Other) { Combine<EOperation::And>(Other); }
+
+	/** this |= Other; both must have the same size. */
+	void OrWith (const TBitArray& Other) { Combine<EOperation::Or>(Other); }
+
+	/** this &= ~Other, e.g. dirty bits minus the ones already handled; both must have the same size. */
+	void AndNotWith (const TBitArray& Other) { Combine<EOperation::AndNot>(Other); }
+	// ~Whole array
+
+	// Getters
+	uint32 Count () const { return Size; }
+	bool IsEmpty () const { return Size == 0u; }
+
+	uint32 CountSetBits () const;
+	bool IsAnySet () const;
+
+	/** First set bit at or after InFrom, InvalidIndex if there is none. */
+	uint32 FindFirstSetBit (uint32 InFrom = 0u) const;
+
+	/** First clear bit at or after InFrom, InvalidIndex if there is none. */
+	uint32 FindFirstClearBit (uint32 InFrom = 0u) const;
+
+	/** Calls InFunction(uint32 Index) for every set bit in ascending order; bits may be changed from inside. */
+	template <typename TFunction>
+	void ForEachSetBit (TFunction&& InFunction) const;
+
+	const uint64* GetWords () const { return Words.GetData(); }
+	uint32 GetWordCount () const { return Words.Count(); }
+	// ~Getters
+
+	friend void swap (TBitArray& A, TBitArray& B) noexcept { A.Swap(B); }
+
+private:
+	enum class EOperation : uint8
+	{
+		And,
+		Or,
+		AndNot
+	};
+
+	static constexpr uint32 WordCount (uint32 InBitCount) { return (InBitCount + BitsPerWord - 1u) / BitsPerWord; }
+	static constexpr uint64 GetBitMask (uint32 InIndex) { return 1ull << (InIndex % BitsPerWord); }
+
+	template <EOperation TOperation>
+	void Combine (const TBitArray& Other);
+
+	/** Zeroes the bits of the last word past Size. */
+	void ClearTail ();
+
+private:
+	TArray<uint64, TAllocator> Words;
+	uint32 Size = 0u;
+};
+}
+
+
+namespace frt
+{
+template <typename TAllocator>
+void TBitArray<TAllocator>::SetSize (uint32 InSize, bool bInValue)
+{
+	// Bits above Size in the last word are zero already
+	if (InSize > Size && bInValue && Size % BitsPerWord != 0u)
+	{
+		Words.Last() |= ~0ull << (Size % BitsPerWord);
+	}
+	Words.SetSize(WordCount(InSize), bInValue ? ~0ull : 0ull);
+
+	Size = InSize;
+	ClearTail();
+}
+
+template <typename TAllocator>
+void TBitArray<TAllocator>::Free ()
+{
+	Words.Free();
+	Size = 0u;
+}
+
+template <typename TAllocator>
+void TBitArray<TAllocator>::Swap (TBitArray& Other) noexcept
+{
+	Words.Swap(Other.Words);
+	std::swap(Size, Other.Size);
+}
+
+template <typename TAllocator>
+uint32 TBitArray<TAllocator>::Add (bool bInValue)
+{
+	const uint32 index = Size;
+	if (index % BitsPerWord == 0u)
+	{
+		Words.Add(0ull);
+	}
+	++Size;
+
+	if (bInValue)
+	{
+		SetBit(index);
+	}
+	return index;
+}
+
+template <typename TAllocator>
+template <bool bKeepOrder>
+void TBitArray<TAllocator>::RemoveAt (uint32 InIndex)
+{
+	frt_assert(InIndex < Size);
+
+	const uint32 lastIndex = Size - 1u;
+	if constexpr (bKeepOrder)
+	{
+		// Shift everything above InIndex down by one, a word at a time
+		uint64* words = Words.GetData();
+		const uint32 firstWord = InIndex / BitsPerWord;
+		const uint64 lowMask = GetBitMask(InIndex) - 1u;
+		const uint64 first = words[firstWord];
+		words[firstWord] = (first & lowMask) | ((first >> 1u) & ~lowMask);
+		for (uint32 word = firstWord + 1u; word < Words.Count(); ++word)
+		{
+			words[word - 1u] |= words[word] << (BitsPerWord - 1u);
+			words[word] >>= 1u;
+		}
+	}
+	else if (InIndex != lastIndex)
+	{
+		SetBit(InIndex, TestBit(lastIndex));
+	}
+
+	SetSize(lastIndex);
+}
+
+template <typename TAllocator>
+void TBitArray<TAllocator>::Clear ()
+{
+	Words.Clear();
+	Size = 0u;
+}
+
+template <typename TAllocator>
+void TBitArray<TAllocator>::SetAll (bool bInValue)
+{
+	const uint64 value = bInValue ? ~0ull : 0ull;
+	for (uint64& word : Words)
+	{
+		word = value;
+	}
+	ClearTail();
+}
+
+template <typename TAllocator>
+uint32 TBitArray<TAllocator>::CountSetBits () const
+{
+	uint32 count = 0u;
+	for (const uint64 word : Words)
+	{
+		count += (uint32)std::popcount(word);
+	}
+	return count;
+}
+
+template <typename TAllocator>
+bool TBitArray<TAllocator>::IsAnySet () const
+{
+	for (const uint64 word : Words)
+	{
+		if (word != 0u)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+template <typename TAllocator>
+uint32 TBitArray<TAllocator>::FindFirstSetBit (uint32 InFrom) const
+{
+	if (InFrom >= Size)
+	{
+		return InvalidIndex;
+	}
+
+	const uint64* words = Words.GetData();
+	uint32 wordIndex = InFrom / BitsPerWord;
+	uint64 word = words[wordIndex] & (~0ull << (InFrom % BitsPerWord));
+	while (word == 0u)
+	{
+		if (++wordIndex == Words.Count())
+		{
+			return InvalidIndex;
+		}
+		word = words[wordIndex];
+	}
+
+	return wordIndex * BitsPerWord + (uint32)std::countr_zero(word);
+}
+
+template <typename TAllocator>
+uint32 TBitArray<TAllocator>::FindFirstClearBit (uint32 InFrom) const
+{
+	if (InFrom >= Size)
+	{
+		return InvalidIndex;
+	}
+
+	const uint64* words = Words.GetData();
+	uint32 wordIndex = InFrom / BitsPerWord;
+	uint64 word = ~words[wordIndex] & (~0ull << (InFrom % BitsPerWord));
+	while (word == 0u)
+	{
+		if (++wordIndex == Words.Count())
+		{
+			return InvalidIndex;
+		}
+		word = ~words[wordIndex];
+	}
+
+	// Tail bits are zero, so they look clear here
+	const uint32 index = wordIndex * BitsPerWord + (uint32)std::countr_zero(word);
+	return index < Size ? index : InvalidIndex;
+}
+
+template <typename TAllocator>
+template <typename TFunction>
+void TBitArray<TAllocator>::ForEachSetBit (TFunction&& InFunction) const
+{
+	for (uint32 wordIndex = 0u; wordIndex < Words.Count(); ++wordIndex)
+	{
+		// Copy of the word, so the callback may clear the bit it was called for
+		uint64 word = Words.GetData()[wordIndex];
+		while (word != 0u)
+		{
+			const uint32 bit = (uint32)std::countr_zero(word);
+			word &= word - 1u;
+			InFunction(wordIndex * BitsPerWord + bit);
+		}
+	}
+}
+
+template <typename TAllocator>
+template <typename TBitArray<TAllocator>::EOperation TOperation>
+void TBitArray<TAllocator>::Combine (const TBitArray& Other)
+{
+	frt_assert(Size == Other.Size);
+
+	uint64* words = Words.GetData();
+	const uint64* otherWords = Other.Words.GetData();
+	const uint32 wordCount = Words.Count();
+	uint32 i = 0u;
+
+#if FRT_BIT_ARRAY_SIMD_WORDS == 4
+	for (; i + 4u <= wordCount; i += 4u)
+	{
+		const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+		const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(otherWords + i));
+		__m256i result;
+		if constexpr (TOperation == EOperation::And)
+		{
+			result = _mm256_and_si256(a, b);
+		}
+		else if constexpr (TOperation == EOperation::Or)
+		{
+			result = _mm256_or_si256(a, b);
+		}
+		else
+		{
+			result = _mm256_andnot_si256(b, a);
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(words + i), result);
+	}
+#elif FRT_BIT_ARRAY_SIMD_WORDS == 2
+	for (; i + 2u <= wordCount; i += 2u)
+	{
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(otherWords + i));
+		__m128i result;
+		if constexpr (TOperation == EOperation::And)
+		{
+			result = _mm_and_si128(a, b);
+		}
+		else if constexpr (TOperation == EOperation::Or)
+		{
+			result = _mm_or_si128(a, b);
+		}
+		else
+		{
+			result = _mm_andnot_si128(b, a);
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(words + i), result);
+	}
+#endif
+
+	for (; i < wordCount; ++i)
+	{
+		if constexpr (TOperation == EOperation::And)
+		{
+			words[i] &= otherWords[i];
+		}
+		else if constexpr (TOperation == EOperation::Or)
+		{
+			words[i] |= otherWords[i];
+		}
+		else
+		{
+			words[i] &= ~otherWords[i];
+		}
+	}
+}
+
+template <typename TAllocator>
+void TBitArray<TAllocator>::ClearTail ()
+{
+	if (Size % BitsPerWord != 0u)
+	{
+		Words.Last() &= (1ull << (Size % BitsPerWord)) - 1u;
+	}
+}
+
+
+template <typename TAllocator>
+struct memory::TIsTriviallyRelocatable<TBitArray<TAllocator>> : std::true_type
+{};
+}
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <bit>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Asserts.h"
+#include "CoreUtils.h"
+#include "Containers/Array.h"
+
+
+namespace frt
+{
+/**
+* Array of fixed-size chunks whose elements never move, for long-lived objects that other code keeps raw pointers to.
+* Key points:
+*	- Element addresses are stable from Add to RemoveAt, no matter how much the array grows;
+*	  growing allocates one more chunk and never touches the existing ones
+*	- Indexing is O(1): chunk by shift, slot by mask
+*	- Removed slots are reused (most recently freed first) before untouched ones, so indices of live elements
+*	  don't change either and the array stays as compact as churn allows
+*	- Iteration walks chunk by chunk and skips free slots by the occupancy bits, 64 at a time
+*	- Chunks come from the allocator instance the array holds (see memory::TAllocatorRef), the primary pool by default;
+*	  memory is only given back by Free
+*	- Not copyable, a copy couldn't keep the addresses anyway; moving the array keeps them
+*
+* @tparam TElementType
+* @tparam TChunkSizeLog2 Elements per chunk as a power of two, at least 64
+* @tparam TAllocator
+*/
+template <typename TElementType, uint32 TChunkSizeLog2 = 6u, typename TAllocator = memory::DefaultPool>
+class TChunkedArray : private memory::TAllocatorRef<TAllocator>
+{
+	static_assert(TChunkSizeLog2 >= 6u && TChunkSizeLog2 < 24u);
+	static_assert(alignof(TElementType) <= 8u, "Pool blocks are only guaranteed to be 8-byte aligned");
+
+	using AllocatorRefType = memory::TAllocatorRef<TAllocator>;
+
+public:
+	static constexpr uint32 ChunkSize = 1u << TChunkSizeLog2;
+	static constexpr uint32 ChunkMask = ChunkSize - 1u;
+	static constexpr uint32 WordsPerChunk = ChunkSize / 64u;
+	static constexpr uint32 InvalidIndex = ~0u;
+
+	template <bool bConst>
+	class TIterator;
+	using Iterator = TIterator<false>;
+	using ConstIterator = TIterator<true>;
+
+	FRT_DELETE_COPY_OPS(TChunkedArray);
+
+	TChunkedArray () = default;
+	explicit TChunkedArray (TAllocator* InAllocator);
+	TChunkedArray (TChunkedArray&& Other) noexcept;
+	TChunkedArray& operator= (TChunkedArray&& Other) noexcept;
+	~TChunkedArray ();
+
+	// Allocators
+	/** Allocates chunks until InCapacity elements fit. */
+	void Reserve (uint32 InCapacity);
+
+	TAllocator* GetAllocator () const { return AllocatorRefType::GetAllocator(); }
+
+	/** Destroys all elements and gives the chunks back. */
+	void Free ();
+	// ~Allocators
+
+	// Adders
+	/** Constructs an element in a free slot, returns its index. */
+	template <typename... Args>
+	uint32 Emplace (Args&&... InArgs);
+
+	uint32 Add (const TElementType& InElement) { return Emplace(InElement); }
+	uint32 Add (TElementType&& InElement) { return Emplace(std::move(InElement)); }
+	// ~Adders
+
+	// Removers
+	void RemoveAt (uint32 InIndex);
+
+	/**
+	* Destruct all elements, but keep the chunks.
+	*/
+	void Clear ();
+	// ~Removers
+
+	// Getters
+	bool IsIndexValid (uint32 InIndex) const;
+
+	TElementType& operator[] (uint32 InIndex);
+	const TElementType& operator[] (uint32 InIndex) const;
+
+	/** Null if there is no element at InIndex. */
+	TElementType* Find (uint32 InIndex);
+	const TElementType* Find (uint32 InIndex) const;
+
+	/** Index of an element of this array by its address, InvalidIndex if it's not one; O(chunk count). */
+	uint32 IndexOf (const TElementType* InElement) const;
+
+	uint32 Count () const { return Size; }
+	bool IsEmpty () const { return Size == 0u; }
+	uint32 GetCapacity () const { return Chunks.Count() * ChunkSize; }
+	uint32 GetChunkCount () const { return Chunks.Count(); }
+
+	/** Slots of a chunk, free ones included; see IsIndexValid. */
+	TElementType* GetChunkData (uint32 InChunkIndex) { return Chunks[InChunkIndex]; }
+	const TElementType* GetChunkData (uint32 InChunkIndex) const { return Chunks[InChunkIndex]; }
+	// ~Getters
+
+	// STL compatibility
+	Iterator begin () { return Iterator(this, 0u); }
+	ConstIterator begin () const { return ConstIterator(this, 0u); }
+	Iterator end () { return Iterator(this, UsedCount); }
+	ConstIterator end () const { return ConstIterator(this, UsedCount); }
+
+	uint32 size () const { return Size; }
+	bool empty () const { return Size == 0u; }
+	// ~STL
+
+public:
+	template <bool bConst>
+	class TIterator
+	{
+	public:
+		using ArrayType = std::conditional_t<bConst, const TChunkedArray, TChunkedArray>;
+		using value_type = TElementType;
+		using reference = std::conditional_t<bConst, const TElementType&, TElementType&>;
+		using difference_type = int64;
+
+		TIterator () = default;
+		TIterator (ArrayType* InArray, uint32 InIndex) : Array(InArray), Index(InIndex) { SkipFree(); }
+
+		reference operator* () const { return Array->Chunks.GetData()[Index >> TChunkSizeLog2][Index & ChunkMask]; }
+		auto* operator-> () const { return &**this; }
+
+		TIterator& operator++ () { ++Index; SkipFree(); return *this; }
+		TIterator operator++ (int) { TIterator old = *this; ++*this; return old; }
+
+		bool operator== (const TIterator& Other) const { return Index == Other.Index; }
+
+		uint32 GetIndex () const { return Index; }
+
+	private:
+		void SkipFree ()
+		{
+			const uint32 used = Array->UsedCount;
+			while (Index < used)
+			{
+				const uint64 word = Array->Occupancy.GetData()[Index >> 6u] >> (Index & 63u);
+				if (word != 0u)
+				{
+					Index += (uint32)std::countr_zero(word);
+					return;
+				}
+				Index = (Index | 63u) + 1u;
+			}
+			Index = used;
+		}
+
+	private:
+		ArrayType* Array = nullptr;
+		uint32 Index = 0u;
+	};
+
+private:
+	AllocatorRefType& GetAllocatorRef () { return *this; }
+	const AllocatorRefType& GetAllocatorRef () const { return *this; }
+
+	TElementType* GetSlot (uint32 InIndex) const { return Chunks.GetData()[InIndex >> TChunkSizeLog2] + (InIndex & ChunkMask); }
+
+	void AddChunk ();
+
+private:
+	TArray<TElementType*, TAllocator> Chunks;
+	/** One bit per slot, set while the slot holds an element */
+	TArray<uint64, TAllocator> Occupancy;
+	/** Slots freed by RemoveAt, below UsedCount */
+	TArray<uint32, TAllocator> FreeIndices;
+	/** Slots from here on were never taken since the last Clear */
+	uint32 UsedCount = 0u;
+	uint32 Size = 0u;
+};
+}
+
+
+namespace frt
+{
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::TChunkedArray (TAllocator* InAllocator)
+	: AllocatorRefType(InAllocator)
+	, Chunks(InAllocator)
+	, Occupancy(InAllocator)
+	, FreeIndices(InAllocator)
+{}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::TChunkedArray (TChunkedArray&& Other) noexcept
+	: AllocatorRefType(Other.GetAllocatorRef())
+	, Chunks(std::move(Other.Chunks))
+	, Occupancy(std::move(Other.Occupancy))
+	, FreeIndices(std::move(Other.FreeIndices))
+	, UsedCount(Other.UsedCount)
+	, Size(Other.Size)
+{
+	Other.UsedCount = 0u;
+	Other.Size = 0u;
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>& TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::operator= (
+	TChunkedArray&& Other) noexcept
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	// Chunks can't be moved element by element without breaking the addresses, so they always change hands
+	Free();
+	GetAllocatorRef() = Other.GetAllocatorRef();
+	Chunks = std::move(Other.Chunks);
+	Occupancy = std::move(Other.Occupancy);
+	FreeIndices = std::move(Other.FreeIndices);
+	UsedCount = Other.UsedCount;
+	Size = Other.Size;
+	Other.UsedCount = 0u;
+	Other.Size = 0u;
+
+	return *this;
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::~TChunkedArray ()
+{
+	Free();
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+void TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::Reserve (uint32 InCapacity)
+{
+	while (GetCapacity() < InCapacity)
+	{
+		AddChunk();
+	}
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+void TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::Free ()
+{
+	Clear();
+
+	for (TElementType* chunk : Chunks)
+	{
+		GetAllocatorRef().Free(chunk);
+	}
+	Chunks.Free();
+	Occupancy.Free();
+	FreeIndices.Free();
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+template <typename... Args>
+uint32 TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::Emplace (Args&&... InArgs)
+{
+	uint32 index;
+	if (!FreeIndices.IsEmpty())
+	{
+		index = FreeIndices.Last();
+		FreeIndices.template RemoveAt<false>(FreeIndices.Count() - 1u);
+	}
+	else
+	{
+		if (UsedCount == GetCapacity())
+		{
+			AddChunk();
+		}
+		index = UsedCount++;
+	}
+
+	new(GetSlot(index)) TElementType(std::forward<Args>(InArgs)...);
+	Occupancy[index >> 6u] |= 1ull << (index & 63u);
+	++Size;
+
+	return index;
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+void TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::RemoveAt (uint32 InIndex)
+{
+	frt_assert(IsIndexValid(InIndex));
+
+	GetSlot(InIndex)->~TElementType();
+	Occupancy[InIndex >> 6u] &= ~(1ull << (InIndex & 63u));
+	FreeIndices.Add(InIndex);
+	--Size;
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+void TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::Clear ()
+{
+	if constexpr (!std::is_trivially_destructible_v<TElementType>)
+	{
+		for (TElementType& element : *this)
+		{
+			element.~TElementType();
+		}
+	}
+
+	FreeIndices.Clear();
+	for (uint64& word : Occupancy)
+	{
+		word = 0u;
+	}
+	UsedCount = 0u;
+	Size = 0u;
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+bool TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::IsIndexValid (uint32 InIndex) const
+{
+	return InIndex < GetCapacity() && (Occupancy.GetData()[InIndex >> 6u] & (1ull << (InIndex & 63u))) != 0u;
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+TElementType& TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::operator[] (uint32 InIndex)
+{
+	frt_assert(IsIndexValid(InIndex));
+	return *GetSlot(InIndex);
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+const TElementType& TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::operator[] (uint32 InIndex) const
+{
+	frt_assert(IsIndexValid(InIndex));
+	return *GetSlot(InIndex);
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+TElementType* TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::Find (uint32 InIndex)
+{
+	return IsIndexValid(InIndex) ? GetSlot(InIndex) : nullptr;
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+const TElementType* TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::Find (uint32 InIndex) const
+{
+	return IsIndexValid(InIndex) ? GetSlot(InIndex) : nullptr;
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+uint32 TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::IndexOf (const TElementType* InElement) const
+{
+	for (uint32 chunkIndex = 0u; chunkIndex < Chunks.Count(); ++chunkIndex)
+	{
+		const TElementType* chunk = Chunks.GetData()[chunkIndex];
+		if (InElement >= chunk && InElement < chunk + ChunkSize)
+		{
+			const uint32 index = (chunkIndex << TChunkSizeLog2) + (uint32)(InElement - chunk);
+			return IsIndexValid(index) ? index : InvalidIndex;
+		}
+	}
+
+	return InvalidIndex;
+}
+
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+void TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>::AddChunk ()
+{
+	frt_assert(GetCapacity() < InvalidIndex - ChunkSize);
+
+	auto* chunk = (TElementType*)GetAllocatorRef().ReAllocate(nullptr, sizeof(TElementType) * ChunkSize);
+	Chunks.Add(chunk);
+	for (uint32 i = 0u; i < WordsPerChunk; ++i)
+	{
+		Occupancy.Add(0ull);
+	}
+}
+
+
+// Elements live in the chunks, so the array object itself can be bit-copied
+template <typename TElementType, uint32 TChunkSizeLog2, typename TAllocator>
+struct memory::TIsTriviallyRelocatable<TChunkedArray<TElementType, TChunkSizeLog2, TAllocator>> : std::true_type
+{};
+}
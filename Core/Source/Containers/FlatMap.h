@@ -0,0 +1,417 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+
+#include "Asserts.h"
+#include "Containers/Array.h"
+#include "Containers/HashMap.h"
+
+
+namespace frt
+{
+/**
+* Map kept as two sorted arrays, one of keys and one of values, for small tables that are mostly read,
+* e.g. per-window state or per-build remapping tables. Key points:
+*	- No nodes, no hashing: a lookup scans or bisects a contiguous array of keys only, values are touched
+*	  once the key is found
+*	- Up to LinearSearchMaxCount keys the search is a branchless count over all keys, past that it's
+*	  a branchless binary search; see the ContainerFlatMap benchmark for where the crossover comes from
+*	  (around 8 keys when the count isn't vectorized, around 32-64 when it is)
+*	- Beats THashMap up to a few dozen keys; for larger tables that are looked up often, use THashMap
+*	- Add/Remove keep the arrays sorted and so cost O(n); a table filled in one go should use AddUnsorted
+*	  for every pair and Sort once at the end
+*	- Any insertion or removal invalidates pointers to keys and values
+*	- Iteration goes in key order and yields TKeyValuePair<const TKeyType&, TValueType&> by value
+*	- Holds the allocator instance the same way TArray does (see memory::TAllocatorRef)
+*
+* @tparam TKeyType
+* @tparam TValueType
+* @tparam TAllocator
+* @tparam TLess Strict weak ordering of keys; transparent by default, so lookups by a compatible type don't convert
+*/
+template <typename TKeyType, typename TValueType, typename TAllocator = memory::DefaultPool, typename TLess = std::less<>>
+class TFlatMap
+{
+public:
+	using PairType = TKeyValuePair<TKeyType, TValueType>;
+
+	static constexpr uint32 LinearSearchMaxCount = 16u;
+	static constexpr uint32 InvalidIndex = ~0u;
+
+	template <bool bConst>
+	class TIterator
+	{
+		using TMapType = std::conditional_t<bConst, const TFlatMap, TFlatMap>;
+		using TIteratedValue = std::conditional_t<bConst, const TValueType, TValueType>;
+
+	public:
+		TIterator (TMapType* InMap, uint32 InIndex) : Map(InMap), Index(InIndex) {}
+
+		TKeyValuePair<const TKeyType&, TIteratedValue&> operator* () const
+		{
+			return { Map->Keys[Index], Map->Values[Index] };
+		}
+
+		TIterator& operator++ ()
+		{
+			++Index;
+			return *this;
+		}
+
+		bool operator== (const TIterator& Other) const { return Index == Other.Index; }
+
+	private:
+		TMapType* Map;
+		uint32 Index;
+	};
+
+	using Iterator = TIterator<false>;
+	using ConstIterator = TIterator<true>;
+
+	TFlatMap () = default;
+	explicit TFlatMap (TAllocator* InAllocator) : Keys(InAllocator), Values(InAllocator) {}
+
+	/** Pairs may come in any order; for repeated keys the last one wins, same as with Add. */
+	TFlatMap (std::initializer_list<PairType> InList);
+
+	// Allocators
+	void Reserve (uint32 InCount);
+
+	TAllocator* GetAllocator () const { return Keys.GetAllocator(); }
+
+	void ShrinkToFit ();
+	void Free ();
+
+	void Swap (TFlatMap& Other) noexcept;
+	// ~Allocators
+
+	// Adders
+	/** Sets the value of InKey, replacing the existing one. */
+	template <typename TLookup, typename TValueArg>
+	TValueType& Add (TLookup&& InKey, TValueArg&& InValue);
+
+	/** Constructs the value of InKey from InArgs, unless it's in the map already; the existing value is kept then. */
+	template <typename TLookup, typename... Args>
+	TValueType& Emplace (TLookup&& InKey, Args&&... InArgs);
+
+	/** Value of InKey, default-constructed if it's not in the map. */
+	template <typename TLookup>
+	TValueType& FindOrAdd (TLookup&& InKey) { return Emplace(std::forward<TLookup>(InKey)); }
+
+	/**
+	* Appends a pair without keeping the order. The map can't be searched or changed otherwise until Sort is called;
+	* for repeated keys the last one appended wins.
+	*/
+	template <typename TLookup, typename TValueArg>
+	void AddUnsorted (TLookup&& InKey, TValueArg&& InValue);
+
+	/** Orders the pairs appended with AddUnsorted and drops repeated keys. */
+	void Sort ();
+	// ~Adders
+
+	// Removers
+	template <typename TLookup>
+	bool Remove (const TLookup& InKey);
+
+	void RemoveAt (uint32 InIndex);
+
+	/** Destroys all pairs, keeps the memory. */
+	void Clear ();
+	// ~Removers
+
+	// Getters
+	template <typename TLookup>
+	TValueType* Find (const TLookup& InKey);
+
+	template <typename TLookup>
+	const TValueType* Find (const TLookup& InKey) const;
+
+	/** Position of InKey in key order, or InvalidIndex. */
+	template <typename TLookup>
+	uint32 FindIndex (const TLookup& InKey) const;
+
+	template <typename TLookup>
+	bool Contains (const TLookup& InKey) const { return FindIndex(InKey) != InvalidIndex; }
+
+	const TKeyType& GetKeyAt (uint32 InIndex) const { return Keys[InIndex]; }
+	TValueType& GetValueAt (uint32 InIndex) { return Values[InIndex]; }
+	const TValueType& GetValueAt (uint32 InIndex) const { return Values[InIndex]; }
+
+	/** Keys in ascending order, for callers that want to scan them directly. */
+	const TArray<TKeyType, TAllocator>& GetKeys () const { return Keys; }
+	const TArray<TValueType, TAllocator>& GetValues () const { return Values; }
+
+	uint32 Count () const { return Keys.Count(); }
+	bool IsEmpty () const { return Keys.IsEmpty(); }
+	bool IsSorted () const { return bSorted; }
+	// ~Getters
+
+	// STL compatibility
+	using size_type = uint32;
+
+	Iterator begin () { return Iterator(this, 0u); }
+	ConstIterator begin () const { return ConstIterator(this, 0u); }
+	Iterator end () { return Iterator(this, Count()); }
+	ConstIterator end () const { return ConstIterator(this, Count()); }
+
+	size_type size () const { return Count(); }
+	bool empty () const { return IsEmpty(); }
+
+	friend void swap (TFlatMap& A, TFlatMap& B) noexcept { A.Swap(B); }
+	// ~STL
+
+private:
+	/** Index of the first key not less than InKey. */
+	template <typename TLookup>
+	uint32 LowerBound (const TLookup& InKey) const;
+
+	template <typename TLookup>
+	bool IsEqual (const TKeyType& InKey, const TLookup& InLookup) const { return !TLess {}(InLookup, InKey); }
+
+	/** Moves the last pair down to InIndex. */
+	void RotateLastTo (uint32 InIndex);
+
+private:
+	TArray<TKeyType, TAllocator> Keys;
+	TArray<TValueType, TAllocator> Values;
+	bool bSorted = true;
+};
+}
+
+
+namespace frt
+{
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+TFlatMap<TKeyType, TValueType, TAllocator, TLess>::TFlatMap (std::initializer_list<PairType> InList)
+{
+	Reserve((uint32)InList.size());
+	for (const PairType& pair : InList)
+	{
+		AddUnsorted(pair.Key, pair.Value);
+	}
+	Sort();
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+void TFlatMap<TKeyType, TValueType, TAllocator, TLess>::Reserve (uint32 InCount)
+{
+	if (InCount > Keys.GetCapacity())
+	{
+		Keys.SetCapacity(InCount);
+		Values.SetCapacity(InCount);
+	}
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+void TFlatMap<TKeyType, TValueType, TAllocator, TLess>::ShrinkToFit ()
+{
+	Keys.ShrinkToFit();
+	Values.ShrinkToFit();
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+void TFlatMap<TKeyType, TValueType, TAllocator, TLess>::Free ()
+{
+	Keys.Free();
+	Values.Free();
+	bSorted = true;
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+void TFlatMap<TKeyType, TValueType, TAllocator, TLess>::Swap (TFlatMap& Other) noexcept
+{
+	Keys.Swap(Other.Keys);
+	Values.Swap(Other.Values);
+	std::swap(bSorted, Other.bSorted);
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+template <typename TLookup, typename TValueArg>
+TValueType& TFlatMap<TKeyType, TValueType, TAllocator, TLess>::Add (TLookup&& InKey, TValueArg&& InValue)
+{
+	frt_assert(bSorted);
+
+	const uint32 index = LowerBound(InKey);
+	if (index < Count() && IsEqual(Keys[index], InKey))
+	{
+		Values[index] = std::forward<TValueArg>(InValue);
+		return Values[index];
+	}
+
+	Keys.Add(TKeyType(std::forward<TLookup>(InKey)));
+	Values.Add(TValueType(std::forward<TValueArg>(InValue)));
+	RotateLastTo(index);
+	return Values[index];
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+template <typename TLookup, typename... Args>
+TValueType& TFlatMap<TKeyType, TValueType, TAllocator, TLess>::Emplace (TLookup&& InKey, Args&&... InArgs)
+{
+	frt_assert(bSorted);
+
+	const uint32 index = LowerBound(InKey);
+	if (index < Count() && IsEqual(Keys[index], InKey))
+	{
+		return Values[index];
+	}
+
+	Keys.Add(TKeyType(std::forward<TLookup>(InKey)));
+	Values.Add(TValueType(std::forward<Args>(InArgs)...));
+	RotateLastTo(index);
+	return Values[index];
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+template <typename TLookup, typename TValueArg>
+void TFlatMap<TKeyType, TValueType, TAllocator, TLess>::AddUnsorted (TLookup&& InKey, TValueArg&& InValue)
+{
+	Keys.Add(TKeyType(std::forward<TLookup>(InKey)));
+	Values.Add(TValueType(std::forward<TValueArg>(InValue)));
+	bSorted = false;
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+void TFlatMap<TKeyType, TValueType, TAllocator, TLess>::Sort ()
+{
+	if (bSorted)
+	{
+		return;
+	}
+	bSorted = true;
+
+	const uint32 count = Count();
+	TArray<uint32, TAllocator> order(count, Keys.GetAllocator());
+	for (uint32 i = 0u; i < count; ++i)
+	{
+		order.Add(i);
+	}
+
+	// Stable, so among repeated keys the one appended last ends up last and is the one kept
+	std::stable_sort(order.begin(), order.end(), [this] (uint32 Lhs, uint32 Rhs)
+	{
+		return TLess {}(Keys[Lhs], Keys[Rhs]);
+	});
+
+	TArray<TKeyType, TAllocator> sortedKeys(count, Keys.GetAllocator());
+	TArray<TValueType, TAllocator> sortedValues(count, Values.GetAllocator());
+	for (uint32 i = 0u; i < count; ++i)
+	{
+		const uint32 source = order[i];
+		const bool bRepeatedNext = i + 1u < count && !TLess {}(Keys[source], Keys[order[i + 1u]]);
+		if (!bRepeatedNext)
+		{
+			sortedKeys.Add(std::move(Keys[source]));
+			sortedValues.Add(std::move(Values[source]));
+		}
+	}
+
+	Keys.Swap(sortedKeys);
+	Values.Swap(sortedValues);
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+template <typename TLookup>
+bool TFlatMap<TKeyType, TValueType, TAllocator, TLess>::Remove (const TLookup& InKey)
+{
+	const uint32 index = FindIndex(InKey);
+	if (index == InvalidIndex)
+	{
+		return false;
+	}
+
+	RemoveAt(index);
+	return true;
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+void TFlatMap<TKeyType, TValueType, TAllocator, TLess>::RemoveAt (uint32 InIndex)
+{
+	frt_assert(bSorted && InIndex < Count());
+
+	Keys.template RemoveAt<true>(InIndex);
+	Values.template RemoveAt<true>(InIndex);
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+void TFlatMap<TKeyType, TValueType, TAllocator, TLess>::Clear ()
+{
+	Keys.Clear();
+	Values.Clear();
+	bSorted = true;
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+template <typename TLookup>
+TValueType* TFlatMap<TKeyType, TValueType, TAllocator, TLess>::Find (const TLookup& InKey)
+{
+	const uint32 index = FindIndex(InKey);
+	return index != InvalidIndex ? Values.GetData() + index : nullptr;
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+template <typename TLookup>
+const TValueType* TFlatMap<TKeyType, TValueType, TAllocator, TLess>::Find (const TLookup& InKey) const
+{
+	const uint32 index = FindIndex(InKey);
+	return index != InvalidIndex ? Values.GetData() + index : nullptr;
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+template <typename TLookup>
+uint32 TFlatMap<TKeyType, TValueType, TAllocator, TLess>::FindIndex (const TLookup& InKey) const
+{
+	frt_assert(bSorted);
+
+	const uint32 index = LowerBound(InKey);
+	return index < Count() && IsEqual(Keys.GetData()[index], InKey) ? index : InvalidIndex;
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+template <typename TLookup>
+uint32 TFlatMap<TKeyType, TValueType, TAllocator, TLess>::LowerBound (const TLookup& InKey) const
+{
+	const TKeyType* keys = Keys.GetData();
+	uint32 count = Keys.Count();
+
+	if (count <= LinearSearchMaxCount)
+	{
+		// Keys are sorted, so the number of keys less than InKey is the index; no early exit, nothing to mispredict
+		uint32 index = 0u;
+		for (uint32 i = 0u; i < count; ++i)
+		{
+			index += TLess {}(keys[i], InKey) ? 1u : 0u;
+		}
+		return index;
+	}
+
+	const TKeyType* base = keys;
+	while (count > 1u)
+	{
+		const uint32 half = count / 2u;
+		base = TLess {}(base[half], InKey) ? base + half : base;
+		count -= half;
+	}
+	return (uint32)(base - keys) + (TLess {}(*base, InKey) ? 1u : 0u);
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+void TFlatMap<TKeyType, TValueType, TAllocator, TLess>::RotateLastTo (uint32 InIndex)
+{
+	TKeyType* keys = Keys.GetData();
+	TValueType* values = Values.GetData();
+	for (uint32 i = Count() - 1u; i > InIndex; --i)
+	{
+		std::swap(keys[i], keys[i - 1u]);
+		std::swap(values[i], values[i - 1u]);
+	}
+}
+
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename TLess>
+struct memory::TIsTriviallyRelocatable<TFlatMap<TKeyType, TValueType, TAllocator, TLess>> : std::true_type
+{};
+}
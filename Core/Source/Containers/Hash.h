@@ -0,0 +1,55 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "CoreTypes.h"
+
+
+namespace frt
+{
+/** Murmur3 finalizer; spreads the entropy of Value over all bits, which open addressing relies on. */
+constexpr uint64 MixHash (uint64 Value)
+{
+	Value ^= Value >> 33u;
+	Value *= 0xff51afd7ed558ccdull;
+	Value ^= Value >> 33u;
+	Value *= 0xc4ceb9fe1a85ec53ull;
+	Value ^= Value >> 33u;
+	return Value;
+}
+
+
+/** Default hasher of THashMap/THashSet, std::hash with the result mixed */
+template <typename T>
+struct THash
+{
+	uint64 operator() (const T& Value) const noexcept
+	{
+		return MixHash((uint64)std::hash<T> {}(Value));
+	}
+};
+
+
+/** Transparent string hasher, so tables keyed by std::string can be searched with std::string_view or literals */
+struct SStringHash
+{
+	using is_transparent = void;
+
+	uint64 operator() (std::string_view Value) const noexcept
+	{
+		return MixHash((uint64)std::hash<std::string_view> {}(Value));
+	}
+};
+
+
+template <>
+struct THash<std::string> : SStringHash
+{};
+
+
+template <>
+struct THash<std::string_view> : SStringHash
+{};
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Containers/HashTable.h"
+
+
+namespace frt
+{
+template <typename TKeyType, typename TValueType>
+struct TKeyValuePair
+{
+	TKeyType Key;
+	TValueType Value;
+};
+
+
+/**
+* Hash map that stores its pairs in place, replacement for std::unordered_map on lookups that matter. Key points:
+*	- See THashTable for the layout and what invalidates pointers to the values
+*	- Iteration yields TKeyValuePair, its Key must not be changed
+*	- Keys are only constructed on insertion, so with a transparent hasher a lookup by std::string_view
+*	  or a literal never allocates
+*	- Allocator is the second parameter, since it's changed much more often than the hasher,
+*	  e.g. to CFrameArena for maps that only live through a frame
+*
+* @tparam TKeyType
+* @tparam TValueType
+* @tparam TAllocator
+* @tparam THasher
+* @tparam TKeyEqual
+*/
+template <typename TKeyType, typename TValueType, typename TAllocator = memory::DefaultPool,
+	typename THasher = THash<TKeyType>, typename TKeyEqual = std::equal_to<>>
+class THashMap : public THashTable<TKeyValuePair<TKeyType, TValueType>, TKeyType, SPairKeyOf, TAllocator, THasher, TKeyEqual>
+{
+	using SuperType = THashTable<TKeyValuePair<TKeyType, TValueType>, TKeyType, SPairKeyOf, TAllocator, THasher, TKeyEqual>;
+
+public:
+	using PairType = TKeyValuePair<TKeyType, TValueType>;
+
+	using SuperType::SuperType;
+
+	// Adders
+	/** Sets the value of InKey, replacing the existing one. */
+	template <typename TLookup, typename TValueArg>
+	TValueType& Add (TLookup&& InKey, TValueArg&& InValue);
+
+	/** Constructs the value of InKey from InArgs, unless it's in the map already; the existing value is kept then. */
+	template <typename TLookup, typename... Args>
+	TValueType& Emplace (TLookup&& InKey, Args&&... InArgs);
+
+	/** Value of InKey, default-constructed if it's not in the map. */
+	template <typename TLookup>
+	TValueType& FindOrAdd (TLookup&& InKey) { return Emplace(std::forward<TLookup>(InKey)); }
+	// ~Adders
+
+	// Getters
+	template <typename TLookup>
+	TValueType* Find (const TLookup& InKey);
+
+	template <typename TLookup>
+	const TValueType* Find (const TLookup& InKey) const;
+	// ~Getters
+
+	friend void swap (THashMap& A, THashMap& B) noexcept { A.Swap(B); }
+};
+}
+
+
+namespace frt
+{
+template <typename TKeyType, typename TValueType, typename TAllocator, typename THasher, typename TKeyEqual>
+template <typename TLookup, typename TValueArg>
+TValueType& THashMap<TKeyType, TValueType, TAllocator, THasher, TKeyEqual>::Add (TLookup&& InKey, TValueArg&& InValue)
+{
+	const auto [index, bAdded] = SuperType::FindOrPrepareInsert(InKey);
+	PairType* pair = SuperType::GetSlot(index);
+	if (bAdded)
+	{
+		new(pair) PairType { TKeyType(std::forward<TLookup>(InKey)), TValueType(std::forward<TValueArg>(InValue)) };
+	}
+	else
+	{
+		pair->Value = std::forward<TValueArg>(InValue);
+	}
+
+	return pair->Value;
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename THasher, typename TKeyEqual>
+template <typename TLookup, typename... Args>
+TValueType& THashMap<TKeyType, TValueType, TAllocator, THasher, TKeyEqual>::Emplace (TLookup&& InKey, Args&&... InArgs)
+{
+	const auto [index, bAdded] = SuperType::FindOrPrepareInsert(InKey);
+	PairType* pair = SuperType::GetSlot(index);
+	if (bAdded)
+	{
+		new(pair) PairType { TKeyType(std::forward<TLookup>(InKey)), TValueType(std::forward<Args>(InArgs)...) };
+	}
+
+	return pair->Value;
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename THasher, typename TKeyEqual>
+template <typename TLookup>
+TValueType* THashMap<TKeyType, TValueType, TAllocator, THasher, TKeyEqual>::Find (const TLookup& InKey)
+{
+	const uint32 index = SuperType::FindIndex(InKey);
+	return index != SuperType::InvalidIndex ? &SuperType::GetSlot(index)->Value : nullptr;
+}
+
+template <typename TKeyType, typename TValueType, typename TAllocator, typename THasher, typename TKeyEqual>
+template <typename TLookup>
+const TValueType* THashMap<TKeyType, TValueType, TAllocator, THasher, TKeyEqual>::Find (const TLookup& InKey) const
+{
+	const uint32 index = SuperType::FindIndex(InKey);
+	return index != SuperType::InvalidIndex ? &SuperType::GetSlot(index)->Value : nullptr;
+}
+
+
+// Pairs live in the allocated block, the map itself only points at it
+template <typename TKeyType, typename TValueType, typename TAllocator, typename THasher, typename TKeyEqual>
+struct memory::TIsTriviallyRelocatable<THashMap<TKeyType, TValueType, TAllocator, THasher, TKeyEqual>> : std::true_type
+{};
+}
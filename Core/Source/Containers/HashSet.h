@@ -0,0 +1,77 @@
+#pragma once
+
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Containers/HashTable.h"
+
+
+namespace frt
+{
+/**
+* Hash set that stores its elements in place, replacement for std::unordered_set. Key points:
+*	- See THashTable for the layout and what invalidates pointers to the elements
+*	- Elements must not be changed through iteration, since their hash would go stale
+*	- Same template parameter order and heterogeneous lookup as THashMap
+*
+* @tparam TElementType
+* @tparam TAllocator
+* @tparam THasher
+* @tparam TKeyEqual
+*/
+template <typename TElementType, typename TAllocator = memory::DefaultPool,
+	typename THasher = THash<TElementType>, typename TKeyEqual = std::equal_to<>>
+class THashSet : public THashTable<TElementType, TElementType, SIdentityKeyOf, TAllocator, THasher, TKeyEqual>
+{
+	using SuperType = THashTable<TElementType, TElementType, SIdentityKeyOf, TAllocator, THasher, TKeyEqual>;
+
+public:
+	using SuperType::SuperType;
+
+	// Adders
+	/** Returns false if an equal element is in the set already, InElement is not used then. */
+	template <typename TArg>
+	bool Add (TArg&& InElement);
+	// ~Adders
+
+	// Getters
+	template <typename TLookup>
+	const TElementType* Find (const TLookup& InKey) const;
+	// ~Getters
+
+	friend void swap (THashSet& A, THashSet& B) noexcept { A.Swap(B); }
+};
+}
+
+
+namespace frt
+{
+template <typename TElementType, typename TAllocator, typename THasher, typename TKeyEqual>
+template <typename TArg>
+bool THashSet<TElementType, TAllocator, THasher, TKeyEqual>::Add (TArg&& InElement)
+{
+	const auto [index, bAdded] = SuperType::FindOrPrepareInsert(InElement);
+	if (bAdded)
+	{
+		new(SuperType::GetSlot(index)) TElementType(std::forward<TArg>(InElement));
+	}
+
+	return bAdded;
+}
+
+template <typename TElementType, typename TAllocator, typename THasher, typename TKeyEqual>
+template <typename TLookup>
+const TElementType* THashSet<TElementType, TAllocator, THasher, TKeyEqual>::Find (const TLookup& InKey) const
+{
+	const uint32 index = SuperType::FindIndex(InKey);
+	return index != SuperType::InvalidIndex ? SuperType::GetSlot(index) : nullptr;
+}
+
+
+// Elements live in the allocated block, the set itself only points at it
+template <typename TElementType, typename TAllocator, typename THasher, typename TKeyEqual>
+struct memory::TIsTriviallyRelocatable<THashSet<TElementType, TAllocator, THasher, TKeyEqual>> : std::true_type
+{};
+}
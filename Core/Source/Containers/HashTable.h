@@ -0,0 +1,663 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Containers/Hash.h"
+#include "Math/MathUtility.h"
+#include "Memory/Memory.h"
+#include "Memory/Relocation.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRT_HASH_GROUP_SSE2 1
+#include <emmintrin.h>
+#else
+#define FRT_HASH_GROUP_SSE2 0
+#endif
+
+
+namespace frt
+{
+/**
+* Control bytes of SHashGroup::Width consecutive slots of a hash table, matched against a value all at once. Key points:
+*	- Control byte is Empty, Deleted, or the lower 7 bits of the hash of the element in a full slot
+*	- With SSE2 a match is a compare and a movemask, other targets fall back to a loop
+*	- Matches are bit masks, bit i standing for the i-th slot of the group
+*/
+struct SHashGroup
+{
+	static constexpr uint32 Width = 16u;
+	static constexpr int8 Empty = -128;
+	static constexpr int8 Deleted = -2;
+
+	explicit SHashGroup (const int8* InControl)
+#if FRT_HASH_GROUP_SSE2
+		: Control(_mm_loadu_si128(reinterpret_cast<const __m128i*>(InControl)))
+#else
+		: Control(InControl)
+#endif
+	{}
+
+	uint32 Match (int8 Hash) const
+	{
+#if FRT_HASH_GROUP_SSE2
+		return (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(Hash), Control));
+#else
+		return MatchIf([Hash] (int8 Value) { return Value == Hash; });
+#endif
+	}
+
+	uint32 MatchEmpty () const
+	{
+		return Match(Empty);
+	}
+
+	uint32 MatchEmptyOrDeleted () const
+	{
+#if FRT_HASH_GROUP_SSE2
+		return (uint32)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), Control));
+#else
+		return MatchIf([] (int8 Value) { return Value < -1; });
+#endif
+	}
+
+	static bool IsFull (int8 Value) { return Value >= 0; }
+
+private:
+#if FRT_HASH_GROUP_SSE2
+	__m128i Control;
+#else
+	template <typename TPredicate>
+	uint32 MatchIf (TPredicate Predicate) const
+	{
+		uint32 mask = 0u;
+		for (uint32 i = 0u; i < Width; ++i)
+		{
+			mask |= Predicate(Control[i]) ? 1u << i : 0u;
+		}
+		return mask;
+	}
+
+	const int8* Control;
+#endif
+};
+
+
+/** Key of an element that is the key itself, see THashSet */
+struct SIdentityKeyOf
+{
+	template <typename T>
+	static const T& Get (const T& InElement) { return InElement; }
+};
+
+
+/** Key of a TKeyValuePair, see THashMap */
+struct SPairKeyOf
+{
+	template <typename TPair>
+	static const auto& Get (const TPair& InPair) { return InPair.Key; }
+};
+
+
+/**
+* Open addressing hash table in the SwissTable layout, the implementation behind THashMap and THashSet. Key points:
+*	- Elements are stored in place in a single block, after an array of one control byte per slot
+*	- Lookup probes whole groups of control bytes at once (see SHashGroup) and compares keys only on a 7-bit hash match,
+*	  so a miss rarely touches the elements
+*	- Capacity is a power of two of at least one group; the table rehashes at 7/8 load
+*	- Adding or rehashing invalidates pointers to the elements and iterators, removing only invalidates the removed one
+*	- Lookup with another type than TKeyType (e.g. std::string_view for std::string) needs a transparent THasher,
+*	  otherwise the key is converted to TKeyType first
+*	- Hasher and key comparer are stateless; the hash has to be spread over all bits (see MixHash)
+*	- Allocator instance is held and propagated the same way TArray does it
+*
+* @tparam TElementType
+* @tparam TKeyType
+* @tparam TKeyOf Gets the key of an element, see SIdentityKeyOf and SPairKeyOf
+* @tparam TAllocator
+* @tparam THasher
+* @tparam TKeyEqual
+*/
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+class THashTable : private memory::TAllocatorRef<TAllocator>
+{
+	// Slots follow the control bytes in the same block, so they get the block's alignment and no more
+	static_assert(alignof(TElementType) <= 8u, "Pool blocks are only guaranteed to be 8-byte aligned");
+
+	using AllocatorRefType = memory::TAllocatorRef<TAllocator>;
+
+public:
+	template <typename TIteratedType>
+	class TIterator
+	{
+	public:
+		TIterator (const int8* InControl, TIteratedType* InSlots, uint32 InIndex, uint32 InCapacity)
+			: Control(InControl)
+			, Slots(InSlots)
+			, Index(InIndex)
+			, Capacity(InCapacity)
+		{
+			SkipFree();
+		}
+
+		TIteratedType& operator* () const { return Slots[Index]; }
+		TIteratedType* operator-> () const { return Slots + Index; }
+
+		TIterator& operator++ ()
+		{
+			++Index;
+			SkipFree();
+			return *this;
+		}
+
+		bool operator== (const TIterator& Other) const { return Index == Other.Index; }
+
+	private:
+		void SkipFree ()
+		{
+			while (Index < Capacity && !SHashGroup::IsFull(Control[Index]))
+			{
+				++Index;
+			}
+		}
+
+	private:
+		const int8* Control;
+		TIteratedType* Slots;
+		uint32 Index;
+		uint32 Capacity;
+	};
+
+
+	using Iterator = TIterator<TElementType>;
+	using ConstIterator = TIterator<const TElementType>;
+
+	THashTable ();
+	explicit THashTable (TAllocator* InAllocator);
+	THashTable (const THashTable& Other);
+	THashTable (THashTable&& Other) noexcept;
+	THashTable& operator= (const THashTable& Other);
+	THashTable& operator= (THashTable&& Other) noexcept;
+	~THashTable ();
+
+	// Allocators
+	/** Makes room for InCount elements, so adding up to that many doesn't rehash. */
+	void Reserve (uint32 InCount);
+
+	TAllocator* GetAllocator () const { return AllocatorRefType::GetAllocator(); }
+
+	void Free ();
+
+	void Swap (THashTable& Other) noexcept;
+	// ~Allocators
+
+	// Removers
+	template <typename TLookup>
+	bool Remove (const TLookup& InKey);
+
+	/**
+	* Destruct all elements, set size to 0, but do not free memory.
+	*/
+	void Clear ();
+	// ~Removers
+
+	// Getters
+	template <typename TLookup>
+	bool Contains (const TLookup& InKey) const { return FindIndex(InKey) != InvalidIndex; }
+
+	uint32 GetSize () const { return Size; }
+	uint32 Count () const { return Size; }
+	uint32 GetCapacity () const { return Capacity; }
+
+	bool IsEmpty () const { return Size == 0u; }
+	// ~Getters
+
+	// STL compatibility
+	using value_type = TElementType;
+	using size_type = uint32;
+
+	Iterator begin () { return Iterator(Control, Slots, 0u, Capacity); }
+	ConstIterator begin () const { return ConstIterator(Control, Slots, 0u, Capacity); }
+	Iterator end () { return Iterator(Control, Slots, Capacity, Capacity); }
+	ConstIterator end () const { return ConstIterator(Control, Slots, Capacity, Capacity); }
+
+	size_type size () const { return Size; }
+	bool empty () const { return Size == 0u; }
+	// ~STL
+
+public:
+	static constexpr uint32 MinCapacity = SHashGroup::Width;
+
+protected:
+	static constexpr uint32 InvalidIndex = ~0u;
+
+	template <typename TLookup>
+	uint32 FindIndex (const TLookup& InKey) const;
+
+	/**
+	* Index of the element with InKey and false, or index of a slot claimed for it and true.
+	* In the latter case the caller has to construct the element there before anything else touches the table.
+	*/
+	template <typename TLookup>
+	std::pair<uint32, bool> FindOrPrepareInsert (const TLookup& InKey);
+
+	TElementType* GetSlot (uint32 Index) { return Slots + Index; }
+	const TElementType* GetSlot (uint32 Index) const { return Slots + Index; }
+
+private:
+	static constexpr bool bTransparent = requires { typename THasher::is_transparent; };
+
+	AllocatorRefType& GetAllocatorRef () { return *this; }
+	const AllocatorRefType& GetAllocatorRef () const { return *this; }
+
+	/** InKey itself if the hasher can take it, otherwise InKey converted to TKeyType. */
+	template <typename TLookup>
+	static decltype(auto) ToLookupKey (const TLookup& InKey)
+	{
+		if constexpr (bTransparent || std::is_same_v<TLookup, TKeyType>)
+		{
+			return (InKey);
+		}
+		else
+		{
+			return TKeyType(InKey);
+		}
+	}
+
+	template <typename TLookup>
+	static uint64 HashOf (const TLookup& InKey) { return (uint64)THasher {}(InKey); }
+
+	static int8 GetControlHash (uint64 Hash) { return (int8)(Hash & 0x7fu); }
+
+	uint32 GetGroupMask () const { return Capacity / SHashGroup::Width - 1u; }
+	static uint32 GetGrowthLimit (uint32 InCapacity) { return InCapacity - InCapacity / 8u; }
+	static uint32 GetCapacityFor (uint32 InCount);
+
+	template <typename TLookup>
+	uint32 FindIndex (const TLookup& InKey, uint64 Hash) const;
+	/** First empty or deleted slot on the probe sequence of Hash. */
+	uint32 FindFreeSlot (uint64 Hash) const;
+	/** Claims a free slot for an element with Hash, growing the table if needed. */
+	uint32 PrepareInsert (uint64 Hash);
+
+	void Rehash (uint32 InCapacity);
+	void EraseAt (uint32 Index);
+	void DestroyAll ();
+
+private:
+	int8* Control;
+	TElementType* Slots;
+	uint32 Size;
+	uint32 Capacity;
+	// Free slots left before the table has to rehash; tombstones count as taken
+	uint32 GrowthLeft;
+};
+}
+
+
+namespace frt
+{
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::THashTable ()
+	: Control(nullptr)
+	, Slots(nullptr)
+	, Size(0u)
+	, Capacity(0u)
+	, GrowthLeft(0u)
+{}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::THashTable (TAllocator* InAllocator)
+	: AllocatorRefType(InAllocator)
+	, Control(nullptr)
+	, Slots(nullptr)
+	, Size(0u)
+	, Capacity(0u)
+	, GrowthLeft(0u)
+{}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::THashTable (const THashTable& Other)
+	: AllocatorRefType(Other.GetAllocatorRef())
+	, Control(nullptr)
+	, Slots(nullptr)
+	, Size(0u)
+	, Capacity(0u)
+	, GrowthLeft(0u)
+{
+	*this = Other;
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::THashTable (THashTable&& Other) noexcept
+	: AllocatorRefType(Other.GetAllocatorRef())
+	, Control(Other.Control)
+	, Slots(Other.Slots)
+	, Size(Other.Size)
+	, Capacity(Other.Capacity)
+	, GrowthLeft(Other.GrowthLeft)
+{
+	Other.Control = nullptr;
+	Other.Slots = nullptr;
+	Other.Size = 0u;
+	Other.Capacity = 0u;
+	Other.GrowthLeft = 0u;
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>&
+THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::operator= (const THashTable& Other)
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	Clear();
+	Reserve(Other.Size);
+	for (uint32 i = 0u; i < Other.Capacity; ++i)
+	{
+		if (SHashGroup::IsFull(Other.Control[i]))
+		{
+			const uint32 index = PrepareInsert(HashOf(TKeyOf::Get(Other.Slots[i])));
+			new(Slots + index) TElementType(Other.Slots[i]);
+		}
+	}
+
+	return *this;
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>&
+THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::operator= (THashTable&& Other) noexcept
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	if (GetAllocatorRef().CanAdopt(Other.GetAllocatorRef()))
+	{
+		Free();
+		GetAllocatorRef().Adopt(Other.GetAllocatorRef());
+
+		Control = Other.Control;
+		Slots = Other.Slots;
+		Size = Other.Size;
+		Capacity = Other.Capacity;
+		GrowthLeft = Other.GrowthLeft;
+
+		Other.Control = nullptr;
+		Other.Slots = nullptr;
+		Other.Size = 0u;
+		Other.Capacity = 0u;
+		Other.GrowthLeft = 0u;
+		return *this;
+	}
+
+	Clear();
+	Reserve(Other.Size);
+	for (uint32 i = 0u; i < Other.Capacity; ++i)
+	{
+		if (SHashGroup::IsFull(Other.Control[i]))
+		{
+			const uint32 index = PrepareInsert(HashOf(TKeyOf::Get(Other.Slots[i])));
+			new(Slots + index) TElementType(std::move(Other.Slots[i]));
+		}
+	}
+
+	Other.Free();
+	return *this;
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::~THashTable ()
+{
+	Free();
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+void THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::Reserve (uint32 InCount)
+{
+	const uint32 capacity = GetCapacityFor(math::Max(InCount, Size));
+	if (capacity > Capacity)
+	{
+		Rehash(capacity);
+	}
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+void THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::Free ()
+{
+	DestroyAll();
+	GetAllocatorRef().Free(Control);
+
+	Control = nullptr;
+	Slots = nullptr;
+	Size = 0u;
+	Capacity = 0u;
+	GrowthLeft = 0u;
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+void THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::Swap (THashTable& Other) noexcept
+{
+	GetAllocatorRef().Swap(Other.GetAllocatorRef());
+	std::swap(Control, Other.Control);
+	std::swap(Slots, Other.Slots);
+	std::swap(Size, Other.Size);
+	std::swap(Capacity, Other.Capacity);
+	std::swap(GrowthLeft, Other.GrowthLeft);
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+template <typename TLookup>
+bool THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::Remove (const TLookup& InKey)
+{
+	const uint32 index = FindIndex(InKey);
+	if (index == InvalidIndex)
+	{
+		return false;
+	}
+
+	EraseAt(index);
+	return true;
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+void THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::Clear ()
+{
+	DestroyAll();
+	if (Capacity > 0u)
+	{
+		std::memset(Control, SHashGroup::Empty, Capacity);
+	}
+
+	Size = 0u;
+	GrowthLeft = GetGrowthLimit(Capacity);
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+template <typename TLookup>
+uint32 THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::FindIndex (const TLookup& InKey) const
+{
+	if (Size == 0u)
+	{
+		return InvalidIndex;
+	}
+
+	const auto& key = ToLookupKey(InKey);
+	return FindIndex(key, HashOf(key));
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+template <typename TLookup>
+std::pair<uint32, bool> THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::FindOrPrepareInsert (
+	const TLookup& InKey)
+{
+	const auto& key = ToLookupKey(InKey);
+	const uint64 hash = HashOf(key);
+
+	const uint32 index = Size > 0u ? FindIndex(key, hash) : InvalidIndex;
+	if (index != InvalidIndex)
+	{
+		return { index, false };
+	}
+
+	return { PrepareInsert(hash), true };
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+uint32 THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::GetCapacityFor (uint32 InCount)
+{
+	uint32 capacity = MinCapacity;
+	while (GetGrowthLimit(capacity) < InCount)
+	{
+		capacity *= 2u;
+	}
+	return capacity;
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+template <typename TLookup>
+uint32 THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::FindIndex (
+	const TLookup& InKey,
+	uint64 Hash) const
+{
+	const int8 controlHash = GetControlHash(Hash);
+	const uint32 groupMask = GetGroupMask();
+	uint32 group = (uint32)(Hash >> 7u) & groupMask;
+
+	// Triangular probing over a power-of-two number of groups visits each group once
+	for (uint32 step = 1u; ; ++step)
+	{
+		const uint32 first = group * SHashGroup::Width;
+		const SHashGroup controls(Control + first);
+
+		for (uint32 match = controls.Match(controlHash); match != 0u; match &= match - 1u)
+		{
+			const uint32 index = first + (uint32)std::countr_zero(match);
+			if (TKeyEqual {}(TKeyOf::Get(Slots[index]), InKey))
+			{
+				return index;
+			}
+		}
+
+		if (controls.MatchEmpty() != 0u)
+		{
+			return InvalidIndex;
+		}
+
+		group = (group + step) & groupMask;
+	}
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+uint32 THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::FindFreeSlot (uint64 Hash) const
+{
+	const uint32 groupMask = GetGroupMask();
+	uint32 group = (uint32)(Hash >> 7u) & groupMask;
+
+	for (uint32 step = 1u; ; ++step)
+	{
+		const uint32 first = group * SHashGroup::Width;
+		const uint32 free = SHashGroup(Control + first).MatchEmptyOrDeleted();
+		if (free != 0u)
+		{
+			return first + (uint32)std::countr_zero(free);
+		}
+
+		group = (group + step) & groupMask;
+	}
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+uint32 THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::PrepareInsert (uint64 Hash)
+{
+	if (GrowthLeft == 0u)
+	{
+		// If it's mostly tombstones that filled the table, rehashing in place is enough to get rid of them
+		Rehash(Size < GetGrowthLimit(Capacity) / 2u ? Capacity : math::Max(Capacity * 2u, MinCapacity));
+	}
+
+	const uint32 index = FindFreeSlot(Hash);
+	GrowthLeft -= Control[index] == SHashGroup::Empty ? 1u : 0u;
+	Control[index] = GetControlHash(Hash);
+	++Size;
+
+	return index;
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+void THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::Rehash (uint32 InCapacity)
+{
+	frt_assert(math::IsPowerOfTwo(InCapacity) && InCapacity >= MinCapacity);
+	frt_assert(GetGrowthLimit(InCapacity) > Size);
+
+	int8* oldControl = Control;
+	TElementType* oldSlots = Slots;
+	const uint32 oldCapacity = Capacity;
+
+	Control = (int8*)GetAllocatorRef().ReAllocate(nullptr, (uint64)InCapacity * (1u + sizeof(TElementType)));
+	Slots = reinterpret_cast<TElementType*>(Control + InCapacity);
+	Capacity = InCapacity;
+	GrowthLeft = GetGrowthLimit(InCapacity) - Size;
+	std::memset(Control, SHashGroup::Empty, InCapacity);
+
+	for (uint32 i = 0u; i < oldCapacity; ++i)
+	{
+		if (!SHashGroup::IsFull(oldControl[i]))
+		{
+			continue;
+		}
+
+		TElementType& element = oldSlots[i];
+		const uint64 hash = HashOf(TKeyOf::Get(element));
+		const uint32 index = FindFreeSlot(hash);
+		Control[index] = GetControlHash(hash);
+
+		if constexpr (memory::IsTriviallyRelocatable<TElementType>)
+		{
+			std::memcpy(static_cast<void*>(Slots + index), &element, sizeof(TElementType));
+		}
+		else
+		{
+			new(Slots + index) TElementType(std::move(element));
+			element.~TElementType();
+		}
+	}
+
+	GetAllocatorRef().Free(oldControl);
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+void THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::EraseAt (uint32 Index)
+{
+	Slots[Index].~TElementType();
+	--Size;
+
+	// Probing only goes past groups with no empty slot, so if this group still has one, no probe relies on this slot
+	const bool bReusable = SHashGroup(Control + (Index & ~(SHashGroup::Width - 1u))).MatchEmpty() != 0u;
+	Control[Index] = bReusable ? SHashGroup::Empty : SHashGroup::Deleted;
+	GrowthLeft += bReusable ? 1u : 0u;
+}
+
+template <typename TElementType, typename TKeyType, typename TKeyOf, typename TAllocator, typename THasher, typename TKeyEqual>
+void THashTable<TElementType, TKeyType, TKeyOf, TAllocator, THasher, TKeyEqual>::DestroyAll ()
+{
+	if constexpr (!std::is_trivially_destructible_v<TElementType>)
+	{
+		for (uint32 i = 0u; i < Capacity; ++i)
+		{
+			if (SHashGroup::IsFull(Control[i]))
+			{
+				Slots[i].~TElementType();
+			}
+		}
+	}
+}
+}
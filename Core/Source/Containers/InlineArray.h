@@ -0,0 +1,876 @@
+#pragma once
+
+#include <initializer_list>
+#include <new>
+#include <utility>
+
+#include "Containers/Array.h"
+#include "Math/MathUtility.h"
+#include "Memory/Memory.h"
+
+
+namespace frt
+{
+/**
+* Dynamic array that keeps the first TInlineCount elements inside the object and goes to the allocator only past that. Key points:
+*	- Same interface as TArray, so small known-bounded lists can switch between the two without touching their users
+*	- Elements are always moved, never bit-copied, when they change buffers
+*	- ShrinkToFit and Free bring the elements back inline when they fit
+*	- Allocator instance is held and propagated the same way TArray does it
+*
+* @tparam TElementType
+* @tparam TInlineCount Number of elements stored without an allocation
+* @tparam TAllocator
+*/
+template <typename TElementType, uint32 TInlineCount, typename TAllocator = memory::DefaultPool>
+class TInlineArray : private memory::TAllocatorRef<TAllocator>
+{
+	static_assert(TInlineCount > 0u);
+
+	using AllocatorRefType = memory::TAllocatorRef<TAllocator>;
+
+public:
+	using IndexType = int64;
+
+	using IndexStrategy = math::SIndexStrategy;
+
+	TInlineArray ();
+	explicit TInlineArray (TAllocator* InAllocator);
+	TInlineArray (const TInlineArray& Other);
+	TInlineArray (TInlineArray&& Other) noexcept;
+	TInlineArray& operator= (const TInlineArray& Other);
+	TInlineArray& operator= (TInlineArray&& Other) noexcept;
+	~TInlineArray ();
+
+	TInlineArray (std::initializer_list<TElementType> InList);
+	TInlineArray& operator= (std::initializer_list<TElementType> InList);
+
+	/** Copy from a heap array, e.g. to keep a short list parsed into a TArray. */
+	template <typename TOtherAllocator>
+	TInlineArray& operator= (const TArray<TElementType, TOtherAllocator>& Other);
+
+	// Allocators
+	TInlineArray (uint32 InCapacity);
+	void SetCapacity (uint32 InCapacity);
+
+	TAllocator* GetAllocator () const { return AllocatorRefType::GetAllocator(); }
+
+	template <bool bExtendIfNeeded = true>
+	uint32 SetSize (uint32 InSize);
+
+	template <bool bExtendIfNeeded = true>
+	uint32 SetSize (uint32 InSize, const TElementType& InInitWithValue);
+
+	/** Only grows; new elements are left unconstructed, so it's meant for trivial types. */
+	template <bool bExtendIfNeeded = true>
+	uint32 SetSizeUninitialized (uint32 InSize);
+
+	void ShrinkToFit ();
+
+	void ReAlloc (uint32 InCapacity);
+	void Free ();
+
+	void Swap (TInlineArray& Other) noexcept;
+
+	bool IsInline () const { return HeapData == nullptr; }
+	// ~Allocators
+
+	// Adders
+	TElementType& Add ();
+	TElementType& Add (const TElementType& InElement);
+	TElementType& Add (TElementType&& InElement);
+	TElementType& AddUnique (const TElementType& InElement);
+	TElementType& AddUnique (TElementType&& InElement);
+
+	template <IndexStrategy::EType TIndexType = IndexStrategy::IS_Default>
+	void Insert (const TElementType& InElement, IndexType InIndex);
+
+	template <IndexStrategy::EType TIndexType = IndexStrategy::IS_Default>
+	void Insert (TElementType&& InElement, IndexType InIndex);
+
+	template <typename... Args>
+	void InsertEmplace (IndexType InIndex, Args&&... InArgs);
+
+	template <typename... Args>
+	TElementType& Emplace (Args&&... InArgs);
+
+	void Append (const TInlineArray& InArray);
+	void Append (TInlineArray&& InArray);
+	// ~Adders
+
+	// Removers
+	template <bool bKeepOrder = true>
+	bool Remove (const TElementType& InElement);
+
+	template <bool bKeepOrder = true>
+	uint32 RemoveAll (const TElementType& InElement);
+
+	template <bool bKeepOrder = true, IndexStrategy::EType TIndexType = IndexStrategy::IS_Default>
+	void RemoveAt (IndexType InIndex);
+
+	/**
+	* Destruct all elements, set size to 0, but do not free memory.
+	*/
+	void Clear ();
+
+	void Reset (uint32 WantedCapacity);
+	// ~Removers
+
+	// Getters
+	TElementType* GetData () { return Elements(); }
+	const TElementType* GetData () const { return Elements(); }
+
+	uint32 GetSize () const { return Size; }
+	uint32 Count () const { return Size; }
+	uint32 GetCapacity () const { return Capacity; }
+
+	bool IsEmpty () const { return Size == 0u; }
+	bool Contains (const TElementType& InElement) const { return Find(InElement) < Size; }
+	IndexType GetMaxIndex () const { return (IndexType)Size - 1; }
+
+	template <IndexStrategy::EType TIndexType = IndexStrategy::IS_Default>
+	bool IsIndexValid (IndexType InIndex) const;
+
+	template <IndexStrategy::EType TIndexType = IndexStrategy::IS_Default>
+	TElementType& Get (IndexType InIndex);
+
+	template <IndexStrategy::EType TIndexType = IndexStrategy::IS_Default>
+	const TElementType& Get (IndexType InIndex) const;
+
+	TElementType& operator[] (IndexType InIndex);
+	const TElementType& operator[] (IndexType InIndex) const;
+
+	uint32 Find (const TElementType& InElement) const;
+
+	TElementType& First ();
+	const TElementType& First () const;
+	TElementType& Last ();
+	const TElementType& Last () const;
+	// ~Getters
+
+	// STL compatibility
+	using value_type = TElementType;
+	using size_type = uint32;
+	using difference_type = int64;
+	using reference = TElementType&;
+	using const_reference = const TElementType&;
+
+	TElementType* begin () { return Elements(); }
+	const TElementType* begin () const { return Elements(); }
+	TElementType* end () { return Elements() + Size; }
+	const TElementType* end () const { return Elements() + Size; }
+
+	size_type size () const { return Size; }
+	bool empty () const { return Size == 0; }
+
+	friend void swap (TInlineArray& A, TInlineArray& B) noexcept { A.Swap(B); }
+	// ~STL
+
+public:
+	static constexpr uint32 InlineCount = TInlineCount;
+	static constexpr float GrowthFactor = 1.5f;
+
+private:
+	AllocatorRefType& GetAllocatorRef () { return *this; }
+	const AllocatorRefType& GetAllocatorRef () const { return *this; }
+
+	TElementType* GetInlineData () { return reinterpret_cast<TElementType*>(InlineStorage); }
+	const TElementType* GetInlineData () const { return reinterpret_cast<const TElementType*>(InlineStorage); }
+
+	TElementType* Elements () { return HeapData ? HeapData : GetInlineData(); }
+	const TElementType* Elements () const { return HeapData ? HeapData : GetInlineData(); }
+
+	/** Moves the elements to a buffer of InCapacity, or inline if they fit. */
+	void Relocate (uint32 InCapacity);
+	/** Makes room for one more element. */
+	void Grow ();
+
+	/** Moves all elements of Other to the inline storage of this, both have to be inline. */
+	void MoveInlineFrom (TInlineArray& Other);
+
+private:
+	// Null while the elements are inline; the object never points into itself, so it stays bit-relocatable like TArray
+	TElementType* HeapData;
+	uint32 Size;
+	uint32 Capacity;
+
+	alignas(TElementType) uint8 InlineStorage[sizeof(TElementType) * TInlineCount];
+};
+}
+
+
+namespace frt
+{
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TInlineArray<TElementType, TInlineCount, TAllocator>::TInlineArray ()
+	: HeapData(nullptr)
+	, Size(0u)
+	, Capacity(TInlineCount)
+{}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TInlineArray<TElementType, TInlineCount, TAllocator>::TInlineArray (TAllocator* InAllocator)
+	: AllocatorRefType(InAllocator)
+	, HeapData(nullptr)
+	, Size(0u)
+	, Capacity(TInlineCount)
+{}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TInlineArray<TElementType, TInlineCount, TAllocator>::TInlineArray (const TInlineArray& Other)
+	: AllocatorRefType(Other.GetAllocatorRef())
+	, HeapData(nullptr)
+	, Size(0u)
+	, Capacity(TInlineCount)
+{
+	*this = Other;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TInlineArray<TElementType, TInlineCount, TAllocator>::TInlineArray (TInlineArray&& Other) noexcept
+	: AllocatorRefType(Other.GetAllocatorRef())
+	, HeapData(nullptr)
+	, Size(0u)
+	, Capacity(TInlineCount)
+{
+	if (Other.IsInline())
+	{
+		MoveInlineFrom(Other);
+		return;
+	}
+
+	HeapData = Other.HeapData;
+	Size = Other.Size;
+	Capacity = Other.Capacity;
+
+	Other.HeapData = nullptr;
+	Other.Size = 0u;
+	Other.Capacity = TInlineCount;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TInlineArray<TElementType, TInlineCount, TAllocator>& TInlineArray<TElementType, TInlineCount, TAllocator>::operator= (
+	const TInlineArray& Other)
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	Reset(Other.Size);
+	for (uint32 i = 0u; i < Other.Size; ++i)
+	{
+		new(Elements() + i) TElementType(*(Other.Elements() + i));
+	}
+	Size = Other.Size;
+
+	return *this;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TInlineArray<TElementType, TInlineCount, TAllocator>& TInlineArray<TElementType, TInlineCount, TAllocator>::operator= (
+	TInlineArray&& Other) noexcept
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	if (!Other.IsInline() && GetAllocatorRef().CanAdopt(Other.GetAllocatorRef()))
+	{
+		Free();
+		GetAllocatorRef().Adopt(Other.GetAllocatorRef());
+
+		HeapData = Other.HeapData;
+		Size = Other.Size;
+		Capacity = Other.Capacity;
+
+		Other.HeapData = nullptr;
+		Other.Size = 0u;
+		Other.Capacity = TInlineCount;
+		return *this;
+	}
+
+	Reset(Other.Size);
+	for (uint32 i = 0u; i < Other.Size; ++i)
+	{
+		new(Elements() + i) TElementType(std::move(*(Other.Elements() + i)));
+	}
+	Size = Other.Size;
+
+	Other.Free();
+	return *this;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TInlineArray<TElementType, TInlineCount, TAllocator>::~TInlineArray ()
+{
+	Free();
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TInlineArray<TElementType, TInlineCount, TAllocator>::TInlineArray (std::initializer_list<TElementType> InList)
+	: HeapData(nullptr)
+	, Size(0u)
+	, Capacity(TInlineCount)
+{
+	*this = InList;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TInlineArray<TElementType, TInlineCount, TAllocator>& TInlineArray<TElementType, TInlineCount, TAllocator>::operator= (
+	std::initializer_list<TElementType> InList)
+{
+	Reset((uint32)InList.size());
+	for (const auto& elem : InList)
+	{
+		new(Elements() + Size) TElementType(elem);
+		++Size;
+	}
+
+	return *this;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <typename TOtherAllocator>
+TInlineArray<TElementType, TInlineCount, TAllocator>& TInlineArray<TElementType, TInlineCount, TAllocator>::operator= (
+	const TArray<TElementType, TOtherAllocator>& Other)
+{
+	Reset(Other.Count());
+	for (const auto& elem : Other)
+	{
+		new(Elements() + Size) TElementType(elem);
+		++Size;
+	}
+
+	return *this;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TInlineArray<TElementType, TInlineCount, TAllocator>::TInlineArray (uint32 InCapacity)
+	: HeapData(nullptr)
+	, Size(0u)
+	, Capacity(TInlineCount)
+{
+	SetCapacity(InCapacity);
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::SetCapacity (uint32 InCapacity)
+{
+	if (InCapacity > Capacity)
+	{
+		Relocate(InCapacity);
+	}
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <bool bExtendIfNeeded>
+uint32 TInlineArray<TElementType, TInlineCount, TAllocator>::SetSize (uint32 InSize)
+{
+	return SetSize<bExtendIfNeeded>(InSize, TElementType());
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <bool bExtendIfNeeded>
+uint32 TInlineArray<TElementType, TInlineCount, TAllocator>::SetSize (uint32 InSize, const TElementType& InInitWithValue)
+{
+	if (InSize < Size)
+	{
+		for (uint32 i = InSize; i < Size; ++i)
+		{
+			(Elements() + i)->~TElementType();
+		}
+		return Size = InSize;
+	}
+
+	const uint32 oldSize = Size;
+	SetSizeUninitialized<bExtendIfNeeded>(InSize);
+	for (uint32 i = oldSize; i < Size; ++i)
+	{
+		new(Elements() + i) TElementType(InInitWithValue);
+	}
+
+	return Size;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <bool bExtendIfNeeded>
+uint32 TInlineArray<TElementType, TInlineCount, TAllocator>::SetSizeUninitialized (uint32 InSize)
+{
+	if (InSize <= Size)
+	{
+		return Size;
+	}
+
+	if (InSize > Capacity && bExtendIfNeeded)
+	{
+		Relocate(math::Max(InSize, (uint32)(Capacity * GrowthFactor) + 1u));
+	}
+
+	return Size = math::Min(InSize, Capacity);
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::ShrinkToFit ()
+{
+	if (!IsInline() && Size < Capacity)
+	{
+		Relocate(Size);
+	}
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::ReAlloc (uint32 InCapacity)
+{
+	frt_assert(InCapacity >= Size);
+
+	if (InCapacity != Capacity)
+	{
+		Relocate(InCapacity);
+	}
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::Free ()
+{
+	Clear();
+
+	if (!IsInline())
+	{
+		GetAllocatorRef().Free(HeapData);
+		HeapData = nullptr;
+		Capacity = TInlineCount;
+	}
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::Swap (TInlineArray& Other) noexcept
+{
+	if (this == &Other)
+	{
+		return;
+	}
+
+	GetAllocatorRef().Swap(Other.GetAllocatorRef());
+
+	if (!IsInline() && !Other.IsInline())
+	{
+		std::swap(HeapData, Other.HeapData);
+		std::swap(Size, Other.Size);
+		std::swap(Capacity, Other.Capacity);
+		return;
+	}
+
+	if (IsInline() && Other.IsInline())
+	{
+		TInlineArray& longer = Size >= Other.Size ? *this : Other;
+		TInlineArray& shorter = Size >= Other.Size ? Other : *this;
+
+		for (uint32 i = 0u; i < shorter.Size; ++i)
+		{
+			std::swap(*(longer.Elements() + i), *(shorter.Elements() + i));
+		}
+		for (uint32 i = shorter.Size; i < longer.Size; ++i)
+		{
+			new(shorter.Elements() + i) TElementType(std::move(*(longer.Elements() + i)));
+			(longer.Elements() + i)->~TElementType();
+		}
+		std::swap(Size, Other.Size);
+		return;
+	}
+
+	// One side is on the heap: its buffer changes owner and the inline elements move across
+	TInlineArray& heap = IsInline() ? Other : *this;
+	TInlineArray& local = IsInline() ? *this : Other;
+
+	TElementType* heapData = heap.HeapData;
+	const uint32 heapSize = heap.Size;
+	const uint32 heapCapacity = heap.Capacity;
+
+	heap.HeapData = nullptr;
+	heap.Size = 0u;
+	heap.Capacity = TInlineCount;
+	heap.MoveInlineFrom(local);
+
+	local.HeapData = heapData;
+	local.Size = heapSize;
+	local.Capacity = heapCapacity;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::Add ()
+{
+	return Emplace();
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::Add (const TElementType& InElement)
+{
+	return Emplace(InElement);
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::Add (TElementType&& InElement)
+{
+	return Emplace(std::move(InElement));
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::AddUnique (const TElementType& InElement)
+{
+	const uint32 index = Find(InElement);
+	return index < Size ? *(Elements() + index) : Emplace(InElement);
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::AddUnique (TElementType&& InElement)
+{
+	const uint32 index = Find(InElement);
+	return index < Size ? *(Elements() + index) : Emplace(std::move(InElement));
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <math::SIndexStrategy::EType TIndexType>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::Insert (const TElementType& InElement, IndexType InIndex)
+{
+	InsertEmplace(IndexStrategy::ConvertToDefault<TIndexType>(InIndex, (uint64)Size + 1ull), InElement);
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <math::SIndexStrategy::EType TIndexType>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::Insert (TElementType&& InElement, IndexType InIndex)
+{
+	InsertEmplace(IndexStrategy::ConvertToDefault<TIndexType>(InIndex, (uint64)Size + 1ull), std::move(InElement));
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <typename... Args>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::InsertEmplace (IndexType InIndex, Args&&... InArgs)
+{
+	frt_assert(InIndex >= 0 && InIndex <= (IndexType)Size);
+
+	if (InIndex == (IndexType)Size)
+	{
+		Emplace(std::forward<Args>(InArgs)...);
+		return;
+	}
+
+	// Built up front, the arguments may point into the array
+	TElementType element(std::forward<Args>(InArgs)...);
+
+	if (Size == Capacity)
+	{
+		Grow();
+	}
+
+	new(Elements() + Size) TElementType(std::move(*(Elements() + Size - 1u)));
+	for (uint32 i = Size - 1u; i > (uint32)InIndex; --i)
+	{
+		*(Elements() + i) = std::move(*(Elements() + i - 1u));
+	}
+	*(Elements() + InIndex) = std::move(element);
+	++Size;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <typename... Args>
+TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::Emplace (Args&&... InArgs)
+{
+	if (Size == Capacity)
+	{
+		// Built up front, the arguments may point into the array
+		TElementType element(std::forward<Args>(InArgs)...);
+		Grow();
+		auto* newElem = new(Elements() + Size) TElementType(std::move(element));
+		++Size;
+		return *newElem;
+	}
+
+	auto* newElem = new(Elements() + Size) TElementType(std::forward<Args>(InArgs)...);
+	++Size;
+	return *newElem;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::Append (const TInlineArray& InArray)
+{
+	frt_assert(this != &InArray);
+
+	const uint32 newSize = Size + InArray.Size;
+	if (newSize > Capacity)
+	{
+		Relocate(math::Max(newSize, (uint32)(Capacity * GrowthFactor) + 1u));
+	}
+
+	for (uint32 i = 0u; i < InArray.Size; ++i)
+	{
+		new(Elements() + Size + i) TElementType(*(InArray.Elements() + i));
+	}
+	Size = newSize;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::Append (TInlineArray&& InArray)
+{
+	frt_assert(this != &InArray);
+
+	const uint32 newSize = Size + InArray.Size;
+	if (newSize > Capacity)
+	{
+		Relocate(math::Max(newSize, (uint32)(Capacity * GrowthFactor) + 1u));
+	}
+
+	for (uint32 i = 0u; i < InArray.Size; ++i)
+	{
+		new(Elements() + Size + i) TElementType(std::move(*(InArray.Elements() + i)));
+	}
+	Size = newSize;
+
+	InArray.Free();
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <bool bKeepOrder>
+bool TInlineArray<TElementType, TInlineCount, TAllocator>::Remove (const TElementType& InElement)
+{
+	const uint32 index = Find(InElement);
+	if (index < Size)
+	{
+		RemoveAt<bKeepOrder>(index);
+		return true;
+	}
+
+	return false;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <bool bKeepOrder>
+uint32 TInlineArray<TElementType, TInlineCount, TAllocator>::RemoveAll (const TElementType& InElement)
+{
+	uint32 removedNum = 0u;
+	if constexpr (!bKeepOrder)
+	{
+		for (uint32 i = 0u; i < Size;)
+		{
+			if (*(Elements() + i) == InElement)
+			{
+				RemoveAt<false>(i);
+				++removedNum;
+			}
+			else
+			{
+				++i;
+			}
+		}
+	}
+	else
+	{
+		uint32 kept = 0u;
+		for (uint32 i = 0u; i < Size; ++i)
+		{
+			if (!(*(Elements() + i) == InElement))
+			{
+				if (kept != i)
+				{
+					*(Elements() + kept) = std::move(*(Elements() + i));
+				}
+				++kept;
+			}
+		}
+
+		removedNum = Size - kept;
+		for (uint32 i = kept; i < Size; ++i)
+		{
+			(Elements() + i)->~TElementType();
+		}
+		Size = kept;
+	}
+	return removedNum;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <bool bKeepOrder, math::SIndexStrategy::EType TIndexType>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::RemoveAt (IndexType InIndex)
+{
+	frt_assert(IsIndexValid<TIndexType>(InIndex));
+
+	const uint32 index = (uint32)IndexStrategy::ConvertToDefault<TIndexType>(InIndex, *this);
+	const uint32 last = Size - 1u;
+
+	if constexpr (bKeepOrder)
+	{
+		for (uint32 i = index; i < last; ++i)
+		{
+			*(Elements() + i) = std::move(*(Elements() + i + 1u));
+		}
+	}
+	else
+	{
+		if (index != last)
+		{
+			*(Elements() + index) = std::move(*(Elements() + last));
+		}
+	}
+
+	(Elements() + last)->~TElementType();
+	--Size;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::Clear ()
+{
+	for (uint32 i = 0u; i < Size; ++i)
+	{
+		(Elements() + i)->~TElementType();
+	}
+	Size = 0u;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::Reset (uint32 WantedCapacity)
+{
+	Clear();
+
+	if (WantedCapacity > Capacity)
+	{
+		Relocate(WantedCapacity);
+	}
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <math::SIndexStrategy::EType TIndexType>
+bool TInlineArray<TElementType, TInlineCount, TAllocator>::IsIndexValid (IndexType InIndex) const
+{
+	return Size > 0u && IndexStrategy::IsValid<TIndexType>(InIndex, *this);
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <math::SIndexStrategy::EType TIndexType>
+TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::Get (IndexType InIndex)
+{
+	return const_cast<TElementType&>(static_cast<const TInlineArray&>(*this).Get<TIndexType>(InIndex));
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+template <math::SIndexStrategy::EType TIndexType>
+const TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::Get (IndexType InIndex) const
+{
+	frt_assert(IsIndexValid<TIndexType>(InIndex));
+	return *(Elements() + IndexStrategy::ConvertToDefault<TIndexType>(InIndex, *this));
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::operator[] (IndexType InIndex)
+{
+	return Get<IndexStrategy::IS_Default>(InIndex);
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+const TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::operator[] (IndexType InIndex) const
+{
+	return Get<IndexStrategy::IS_Default>(InIndex);
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+uint32 TInlineArray<TElementType, TInlineCount, TAllocator>::Find (const TElementType& InElement) const
+{
+	for (uint32 i = 0u; i < Size; ++i)
+	{
+		if (*(Elements() + i) == InElement)
+		{
+			return i;
+		}
+	}
+
+	return Size;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::First ()
+{
+	return Get(0);
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+const TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::First () const
+{
+	return Get(0);
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::Last ()
+{
+	return Get<IndexStrategy::IS_Circular>(-1);
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+const TElementType& TInlineArray<TElementType, TInlineCount, TAllocator>::Last () const
+{
+	return Get<IndexStrategy::IS_Circular>(-1);
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::Relocate (uint32 InCapacity)
+{
+	frt_assert(InCapacity >= Size);
+
+	if (InCapacity <= TInlineCount && IsInline())
+	{
+		return;
+	}
+
+	TElementType* newHeapData = nullptr;
+	uint32 newCapacity = TInlineCount;
+	if (InCapacity > TInlineCount)
+	{
+		newHeapData = static_cast<TElementType*>(GetAllocatorRef().ReAllocate(nullptr, sizeof(TElementType) * InCapacity));
+		newCapacity = InCapacity;
+	}
+
+	TElementType* oldData = Elements();
+	TElementType* newData = newHeapData ? newHeapData : GetInlineData();
+	for (uint32 i = 0u; i < Size; ++i)
+	{
+		new(newData + i) TElementType(std::move(*(oldData + i)));
+		(oldData + i)->~TElementType();
+	}
+
+	GetAllocatorRef().Free(HeapData);
+
+	HeapData = newHeapData;
+	Capacity = newCapacity;
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::Grow ()
+{
+	Relocate(math::Max(Size + 1u, (uint32)(Capacity * GrowthFactor)));
+}
+
+template <typename TElementType, uint32 TInlineCount, typename TAllocator>
+void TInlineArray<TElementType, TInlineCount, TAllocator>::MoveInlineFrom (TInlineArray& Other)
+{
+	frt_assert(IsInline() && Size == 0u && Other.IsInline());
+
+	for (uint32 i = 0u; i < Other.Size; ++i)
+	{
+		new(Elements() + i) TElementType(std::move(*(Other.Elements() + i)));
+		(Other.Elements() + i)->~TElementType();
+	}
+	Size = Other.Size;
+	Other.Size = 0u;
+}
+
+
+template <typename T, uint32 TInlineCount, typename TAllocator>
+struct concepts::SIsIndexable<TInlineArray<T, TInlineCount, TAllocator>> : std::true_type
+{};
+
+
+// Inline elements move with the array's bytes, so it's relocatable as long as they are
+template <typename T, uint32 TInlineCount, typename TAllocator>
+struct memory::TIsTriviallyRelocatable<TInlineArray<T, TInlineCount, TAllocator>>
+	: std::bool_constant<memory::IsTriviallyRelocatable<T>>
+{};
+}
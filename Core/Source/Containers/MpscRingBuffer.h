@@ -0,0 +1,180 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+
+
+namespace frt
+{
+/**
+* Bounded lock-free queue for many producer threads and one consumer, e.g. platform input callbacks feeding the
+* game thread. Key points:
+*	- Storage is inline and fixed, nothing is allocated after construction
+*	- Every slot carries a sequence number, so a producer reserves a slot with one CAS and publishes it with one store;
+*	  the consumer never takes a lock and never does a read-modify-write
+*	- Producer and consumer positions sit on their own cache lines, so pushes don't invalidate the consumer's line
+*	- When the queue is full, TryPush drops the element and counts it instead of blocking the producer
+*	- Drain hands elements to a visitor in place, no copy is made; a slot is given back to producers right after
+*	  its visit, so the visitor may push more (they are picked up by the next Drain)
+*
+* @tparam TElementType Copy-assignable, default-constructible
+* @tparam TCapacity Power of two
+*/
+template <typename TElementType, uint32 TCapacity>
+class TMpscRingBuffer
+{
+	static_assert(TCapacity > 1u && (TCapacity & (TCapacity - 1u)) == 0u, "Capacity must be a power of two");
+
+public:
+	static constexpr uint32 Capacity = TCapacity;
+	static constexpr uint64 CacheLineSize = 64u;
+
+	FRT_DELETE_COPY_AND_MOVE_OPS(TMpscRingBuffer);
+
+	TMpscRingBuffer ();
+
+	// Producers
+	/** Returns false and counts the element as dropped if the queue is full. Safe from any thread. */
+	bool TryPush (const TElementType& InElement);
+	bool TryPush (TElementType&& InElement);
+	// ~Producers
+
+	// Consumer
+	/**
+	* Calls InVisitor(const TElementType&) for the elements published so far, oldest first, and frees their slots.
+	* Stops at the first slot that is reserved but not published yet, and after Capacity elements at most,
+	* so producers that keep pushing can't keep it running. Only one thread may drain.
+	*
+	* @return Number of elements visited
+	*/
+	template <typename TVisitor>
+	uint32 Drain (TVisitor&& InVisitor);
+
+	/** Drops everything published so far; consumer side, same as Drain. */
+	uint32 Clear () { return Drain([] (const TElementType&) {}); }
+	// ~Consumer
+
+	// Getters
+	/** Elements rejected because the queue was full, since construction. */
+	uint64 GetDroppedCount () const { return DroppedCount.load(std::memory_order_relaxed); }
+
+	/** Consumer side; approximate while producers are active. */
+	uint32 CountApprox () const;
+	// ~Getters
+
+private:
+	struct SSlot
+	{
+		/** Position the slot can be pushed at; position + 1 once the element is published */
+		std::atomic<uint64> Sequence;
+		TElementType Value;
+	};
+
+	template <typename TValue>
+	bool PushInternal (TValue&& InElement);
+
+private:
+	alignas(CacheLineSize) std::atomic<uint64> Tail;
+	std::atomic<uint64> DroppedCount;
+
+	alignas(CacheLineSize) uint64 Head;
+
+	alignas(CacheLineSize) SSlot Slots[TCapacity];
+};
+}
+
+
+namespace frt
+{
+template <typename TElementType, uint32 TCapacity>
+TMpscRingBuffer<TElementType, TCapacity>::TMpscRingBuffer ()
+	: Tail(0u)
+	, DroppedCount(0u)
+	, Head(0u)
+{
+	for (uint32 i = 0u; i < TCapacity; ++i)
+	{
+		Slots[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+template <typename TElementType, uint32 TCapacity>
+bool TMpscRingBuffer<TElementType, TCapacity>::TryPush (const TElementType& InElement)
+{
+	return PushInternal(InElement);
+}
+
+template <typename TElementType, uint32 TCapacity>
+bool TMpscRingBuffer<TElementType, TCapacity>::TryPush (TElementType&& InElement)
+{
+	return PushInternal(std::move(InElement));
+}
+
+template <typename TElementType, uint32 TCapacity>
+template <typename TValue>
+bool TMpscRingBuffer<TElementType, TCapacity>::PushInternal (TValue&& InElement)
+{
+	uint64 position = Tail.load(std::memory_order_relaxed);
+	SSlot* slot;
+	while (true)
+	{
+		slot = &Slots[position & (TCapacity - 1u)];
+		const uint64 sequence = slot->Sequence.load(std::memory_order_acquire);
+		const int64 distance = (int64)(sequence - position);
+		if (distance == 0)
+		{
+			if (Tail.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (distance < 0)
+		{
+			// Slot still holds an element from one lap ago that the consumer hasn't visited
+			DroppedCount.fetch_add(1u, std::memory_order_relaxed);
+			return false;
+		}
+		else
+		{
+			position = Tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->Value = std::forward<TValue>(InElement);
+	slot->Sequence.store(position + 1u, std::memory_order_release);
+	return true;
+}
+
+template <typename TElementType, uint32 TCapacity>
+template <typename TVisitor>
+uint32 TMpscRingBuffer<TElementType, TCapacity>::Drain (TVisitor&& InVisitor)
+{
+	uint32 visited = 0u;
+	while (visited < TCapacity)
+	{
+		SSlot& slot = Slots[Head & (TCapacity - 1u)];
+		if (slot.Sequence.load(std::memory_order_acquire) != Head + 1u)
+		{
+			break;
+		}
+
+		InVisitor(static_cast<const TElementType&>(slot.Value));
+		slot.Sequence.store(Head + TCapacity, std::memory_order_release);
+		++Head;
+		++visited;
+	}
+
+	return visited;
+}
+
+template <typename TElementType, uint32 TCapacity>
+uint32 TMpscRingBuffer<TElementType, TCapacity>::CountApprox () const
+{
+	const uint64 tail = Tail.load(std::memory_order_relaxed);
+	const uint64 head = Head;
+	return tail > head ? (uint32)(tail - head) : 0u;
+}
+}
@@ -0,0 +1,422 @@
+#pragma once
+
+#include <barrier>
+#include <bit>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "Asserts.h"
+#include "Containers/Array.h"
+
+
+namespace frt
+{
+/**
+* Stable LSD radix sorts for unsigned keys held in TArray, for per-frame batches (draw packets, instances)
+* that are too large for a comparison sort. Key points:
+*	- One 8-bit digit per pass, so a 32-bit key takes up to 4 passes and a 64-bit key up to 8;
+*	  all digit histograms are gathered in a single read of the keys
+*	- Passes whose digit is the same for every key are skipped, so keys that only use their low bits
+*	  (small indices, short packed keys) cost fewer passes
+*	- Elements with equal keys keep their relative order, also in the parallel variants
+*	- The pair variants move a payload (e.g. an index into the packet array) along with each key
+*	- Scratch storage of the same size as the input is taken from the input array's allocator
+*
+* Keys and payloads are moved with memcpy, so both must be trivially copyable.
+*/
+
+/** Sorts InOutKeys in ascending order. */
+template <concepts::Unsigned TKey, typename TAllocator>
+void RadixSort (TArray<TKey, TAllocator>& InOutKeys);
+
+/** Sorts InOutKeys in ascending order and applies the same permutation to InOutValues. */
+template <concepts::Unsigned TKey, typename TValue, typename TKeyAllocator, typename TValueAllocator>
+void RadixSortPairs (TArray<TKey, TKeyAllocator>& InOutKeys, TArray<TValue, TValueAllocator>& InOutValues);
+
+/**
+* Same as RadixSort, split across worker threads when there are enough keys to be worth it; below
+* sort::ParallelThresholdPerThread keys per thread it runs on the calling thread only.
+*
+* @param InMaxThreads Upper bound for the number of threads including the calling one, 0 means hardware concurrency
+*/
+template <concepts::Unsigned TKey, typename TAllocator>
+void ParallelRadixSort (TArray<TKey, TAllocator>& InOutKeys, uint32 InMaxThreads = 0u);
+
+/** Same as RadixSortPairs, split across worker threads the same way as ParallelRadixSort. */
+template <concepts::Unsigned TKey, typename TValue, typename TKeyAllocator, typename TValueAllocator>
+void ParallelRadixSortPairs (
+	TArray<TKey, TKeyAllocator>& InOutKeys, TArray<TValue, TValueAllocator>& InOutValues, uint32 InMaxThreads = 0u);
+
+
+/**
+* Sort key made of bit fields, the first field being the most significant one, e.g.
+* TSortKey<uint64, 16, 16, 32>::Pack(pipeline, material, depth) sorts by pipeline, then material, then depth.
+* Fields must fit in their bits; unused low bits of the key stay zero.
+*
+* @tparam TKey Unsigned key type
+* @tparam TFieldBits Width of each field in bits, most significant first
+*/
+template <concepts::Unsigned TKey, uint32... TFieldBits>
+struct TSortKey
+{
+	static constexpr uint32 FieldCount = sizeof...(TFieldBits);
+	static constexpr uint32 KeyBits = sizeof(TKey) * 8u;
+	static constexpr uint32 UsedBits = (0u + ... + TFieldBits);
+
+	static_assert(FieldCount > 0u, "Sort key needs at least one field");
+	static_assert(((TFieldBits > 0u) && ...), "Sort key fields can't be empty");
+	static_assert(UsedBits <= KeyBits, "Sort key fields don't fit in the key type");
+
+private:
+	static constexpr uint32 Bits[] = { TFieldBits... };
+
+	static constexpr uint32 GetBitsUpTo (uint32 InCount);
+
+	template <typename... TFields, uint32... Indices>
+	static constexpr TKey PackInternal (std::integer_sequence<uint32, Indices...>, TFields... InFields);
+
+public:
+	template <uint32 Index>
+	static constexpr uint32 FieldBits = Bits[Index];
+
+	template <uint32 Index>
+	static constexpr uint32 FieldShift = KeyBits - GetBitsUpTo(Index + 1u);
+
+	template <uint32 Index>
+	static constexpr TKey FieldMask = FieldBits<Index> == KeyBits ? (TKey)~TKey(0u) : (TKey)((TKey(1u) << FieldBits<Index>) - 1u);
+
+	template <typename... TFields>
+	static constexpr TKey Pack (TFields... InFields);
+
+	template <uint32 Index>
+	static constexpr TKey Get (TKey InKey) { return (TKey)((InKey >> FieldShift<Index>) & FieldMask<Index>); }
+};
+
+namespace sort
+{
+/** Fewer keys than this per thread and the parallel variants don't start another thread. */
+constexpr uint32 ParallelThresholdPerThread = 1u << 15;
+
+/**
+* Maps a float to an unsigned key with the same ordering (negative values included, -0 before +0),
+* e.g. view depth for front-to-back sorting; use ~FloatToKey(x) for back-to-front.
+*/
+inline uint32 FloatToKey (float InValue)
+{
+	const uint32 bits = std::bit_cast<uint32>(InValue);
+	return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+/** Top InBits bits of FloatToKey, for a float stored in a narrow sort key field. */
+inline uint32 FloatToKey (float InValue, uint32 InBits)
+{
+	frt_assert(InBits > 0u && InBits <= 32u);
+	return FloatToKey(InValue) >> (32u - InBits);
+}
+
+inline float KeyToFloat (uint32 InKey)
+{
+	return std::bit_cast<float>((InKey & 0x80000000u) ? (InKey & 0x7FFFFFFFu) : ~InKey);
+}
+}
+}
+
+
+namespace frt::sort
+{
+constexpr uint32 DigitBits = 8u;
+constexpr uint32 DigitCount = 1u << DigitBits;
+
+template <typename TKey>
+uint32 GetDigit (TKey InKey, uint32 InPass)
+{
+	return (uint32)(InKey >> (InPass * DigitBits)) & (DigitCount - 1u);
+}
+
+/** Payload type for key-only sorts; never read or written. */
+struct SNoValue {};
+
+template <typename TKey, typename TValue>
+void SortRange (TKey* InOutKeys, TValue* InOutValues, TKey* InScratchKeys, TValue* InScratchValues, uint32 InCount)
+{
+	constexpr bool bWithValues = !std::is_same_v<TValue, SNoValue>;
+	constexpr uint32 PassCount = sizeof(TKey);
+
+	uint32 histograms[PassCount][DigitCount] = {};
+	for (uint32 i = 0u; i < InCount; ++i)
+	{
+		const TKey key = InOutKeys[i];
+		for (uint32 pass = 0u; pass < PassCount; ++pass)
+		{
+			++histograms[pass][GetDigit(key, pass)];
+		}
+	}
+
+	TKey* srcKeys = InOutKeys;
+	TKey* dstKeys = InScratchKeys;
+	TValue* srcValues = InOutValues;
+	TValue* dstValues = InScratchValues;
+
+	for (uint32 pass = 0u; pass < PassCount; ++pass)
+	{
+		uint32* offsets = histograms[pass];
+		if (offsets[GetDigit(srcKeys[0], pass)] == InCount)
+		{
+			continue;
+		}
+
+		uint32 running = 0u;
+		for (uint32 digit = 0u; digit < DigitCount; ++digit)
+		{
+			const uint32 count = offsets[digit];
+			offsets[digit] = running;
+			running += count;
+		}
+
+		for (uint32 i = 0u; i < InCount; ++i)
+		{
+			const uint32 target = offsets[GetDigit(srcKeys[i], pass)]++;
+			dstKeys[target] = srcKeys[i];
+			if constexpr (bWithValues)
+			{
+				dstValues[target] = srcValues[i];
+			}
+		}
+
+		std::swap(srcKeys, dstKeys);
+		if constexpr (bWithValues)
+		{
+			std::swap(srcValues, dstValues);
+		}
+	}
+
+	if (srcKeys != InOutKeys)
+	{
+		std::memcpy(InOutKeys, srcKeys, sizeof(TKey) * InCount);
+		if constexpr (bWithValues)
+		{
+			std::memcpy(InOutValues, srcValues, sizeof(TValue) * InCount);
+		}
+	}
+}
+
+/**
+* Every thread owns a contiguous slice of the source. Per pass each thread counts its slice, then one thread
+* lays out the destination digit by digit and, within a digit, slice by slice, which keeps the sort stable.
+*/
+template <typename TKey, typename TValue>
+void ParallelSortRange (
+	TKey* InOutKeys, TValue* InOutValues, TKey* InScratchKeys, TValue* InScratchValues, uint32 InCount,
+	uint32 InThreadCount)
+{
+	constexpr bool bWithValues = !std::is_same_v<TValue, SNoValue>;
+	constexpr uint32 PassCount = sizeof(TKey);
+
+	TArray<uint32> offsets;
+	offsets.SetSize(InThreadCount * DigitCount);
+	bool bSkipPass = false;
+	uint32 passesDone = 0u;
+	std::barrier sync((ptrdiff_t)InThreadCount);
+
+	auto worker = [&] (uint32 InThreadIndex)
+	{
+		const uint32 begin = (uint32)((uint64)InCount * InThreadIndex / InThreadCount);
+		const uint32 end = (uint32)((uint64)InCount * (InThreadIndex + 1u) / InThreadCount);
+		uint32* threadOffsets = offsets.GetData() + InThreadIndex * DigitCount;
+
+		TKey* srcKeys = InOutKeys;
+		TKey* dstKeys = InScratchKeys;
+		TValue* srcValues = InOutValues;
+		TValue* dstValues = InScratchValues;
+
+		for (uint32 pass = 0u; pass < PassCount; ++pass)
+		{
+			std::memset(threadOffsets, 0, sizeof(uint32) * DigitCount);
+			for (uint32 i = begin; i < end; ++i)
+			{
+				++threadOffsets[GetDigit(srcKeys[i], pass)];
+			}
+			sync.arrive_and_wait();
+
+			if (InThreadIndex == 0u)
+			{
+				bSkipPass = false;
+				uint32 running = 0u;
+				for (uint32 digit = 0u; digit < DigitCount; ++digit)
+				{
+					uint32 digitTotal = 0u;
+					for (uint32 thread = 0u; thread < InThreadCount; ++thread)
+					{
+						uint32& slot = offsets[thread * DigitCount + digit];
+						const uint32 count = slot;
+						slot = running;
+						running += count;
+						digitTotal += count;
+					}
+					bSkipPass |= digitTotal == InCount;
+				}
+				passesDone += bSkipPass ? 0u : 1u;
+			}
+			sync.arrive_and_wait();
+
+			if (bSkipPass)
+			{
+				continue;
+			}
+
+			for (uint32 i = begin; i < end; ++i)
+			{
+				const uint32 target = threadOffsets[GetDigit(srcKeys[i], pass)]++;
+				dstKeys[target] = srcKeys[i];
+				if constexpr (bWithValues)
+				{
+					dstValues[target] = srcValues[i];
+				}
+			}
+			sync.arrive_and_wait();
+
+			std::swap(srcKeys, dstKeys);
+			if constexpr (bWithValues)
+			{
+				std::swap(srcValues, dstValues);
+			}
+		}
+	};
+
+	TArray<std::thread> threads;
+	threads.SetCapacity(InThreadCount - 1u);
+	for (uint32 thread = 1u; thread < InThreadCount; ++thread)
+	{
+		threads.Add(std::thread(worker, thread));
+	}
+	worker(0u);
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	if (passesDone % 2u != 0u)
+	{
+		std::memcpy(InOutKeys, InScratchKeys, sizeof(TKey) * InCount);
+		if constexpr (bWithValues)
+		{
+			std::memcpy(InOutValues, InScratchValues, sizeof(TValue) * InCount);
+		}
+	}
+}
+
+inline uint32 GetThreadCount (uint32 InCount, uint32 InMaxThreads)
+{
+	uint32 maxThreads = InMaxThreads != 0u ? InMaxThreads : std::thread::hardware_concurrency();
+	maxThreads = maxThreads != 0u ? maxThreads : 1u;
+	const uint32 worthIt = InCount / ParallelThresholdPerThread;
+	return worthIt < maxThreads ? (worthIt != 0u ? worthIt : 1u) : maxThreads;
+}
+
+template <typename TKey, typename TKeyAllocator, typename TValue, typename TValueAllocator>
+void Sort (TArray<TKey, TKeyAllocator>& InOutKeys, TArray<TValue, TValueAllocator>* InOutValues, uint32 InThreadCount)
+{
+	static_assert(std::is_trivially_copyable_v<TKey>, "Radix sort keys must be trivially copyable");
+	static_assert(std::is_trivially_copyable_v<TValue>, "Radix sort payloads must be trivially copyable");
+
+	const uint32 count = InOutKeys.Count();
+	if (count < 2u)
+	{
+		return;
+	}
+
+	TArray<TKey, TKeyAllocator> scratchKeys(count, InOutKeys.GetAllocator());
+	scratchKeys.SetSizeUninitialized(count);
+
+	if constexpr (!std::is_same_v<TValue, SNoValue>)
+	{
+		frt_assert(InOutValues->Count() == count);
+
+		TArray<TValue, TValueAllocator> scratchValues(count, InOutValues->GetAllocator());
+		scratchValues.SetSizeUninitialized(count);
+		if (InThreadCount > 1u)
+		{
+			ParallelSortRange(
+				InOutKeys.GetData(), InOutValues->GetData(), scratchKeys.GetData(), scratchValues.GetData(), count,
+				InThreadCount);
+		}
+		else
+		{
+			SortRange(InOutKeys.GetData(), InOutValues->GetData(), scratchKeys.GetData(), scratchValues.GetData(), count);
+		}
+	}
+	else
+	{
+		if (InThreadCount > 1u)
+		{
+			ParallelSortRange<TKey, SNoValue>(
+				InOutKeys.GetData(), nullptr, scratchKeys.GetData(), nullptr, count, InThreadCount);
+		}
+		else
+		{
+			SortRange<TKey, SNoValue>(InOutKeys.GetData(), nullptr, scratchKeys.GetData(), nullptr, count);
+		}
+	}
+}
+}
+
+
+namespace frt
+{
+template <concepts::Unsigned TKey, typename TAllocator>
+void RadixSort (TArray<TKey, TAllocator>& InOutKeys)
+{
+	sort::Sort(InOutKeys, (TArray<sort::SNoValue, TAllocator>*)nullptr, 1u);
+}
+
+template <concepts::Unsigned TKey, typename TValue, typename TKeyAllocator, typename TValueAllocator>
+void RadixSortPairs (TArray<TKey, TKeyAllocator>& InOutKeys, TArray<TValue, TValueAllocator>& InOutValues)
+{
+	sort::Sort(InOutKeys, &InOutValues, 1u);
+}
+
+template <concepts::Unsigned TKey, typename TAllocator>
+void ParallelRadixSort (TArray<TKey, TAllocator>& InOutKeys, uint32 InMaxThreads)
+{
+	sort::Sort(
+		InOutKeys, (TArray<sort::SNoValue, TAllocator>*)nullptr,
+		sort::GetThreadCount(InOutKeys.Count(), InMaxThreads));
+}
+
+template <concepts::Unsigned TKey, typename TValue, typename TKeyAllocator, typename TValueAllocator>
+void ParallelRadixSortPairs (
+	TArray<TKey, TKeyAllocator>& InOutKeys, TArray<TValue, TValueAllocator>& InOutValues, uint32 InMaxThreads)
+{
+	sort::Sort(InOutKeys, &InOutValues, sort::GetThreadCount(InOutKeys.Count(), InMaxThreads));
+}
+
+template <concepts::Unsigned TKey, uint32... TFieldBits>
+constexpr uint32 TSortKey<TKey, TFieldBits...>::GetBitsUpTo (uint32 InCount)
+{
+	uint32 sum = 0u;
+	for (uint32 i = 0u; i < InCount; ++i)
+	{
+		sum += Bits[i];
+	}
+	return sum;
+}
+
+template <concepts::Unsigned TKey, uint32... TFieldBits>
+template <typename... TFields>
+constexpr TKey TSortKey<TKey, TFieldBits...>::Pack (TFields... InFields)
+{
+	static_assert(sizeof...(TFields) == FieldCount, "Pack takes one value per field");
+	return PackInternal(std::make_integer_sequence<uint32, FieldCount>(), InFields...);
+}
+
+template <concepts::Unsigned TKey, uint32... TFieldBits>
+template <typename... TFields, uint32... Indices>
+constexpr TKey TSortKey<TKey, TFieldBits...>::PackInternal (std::integer_sequence<uint32, Indices...>, TFields... InFields)
+{
+	const bool bFieldsFit = (... && (((TKey)InFields & (TKey)~FieldMask<Indices>) == 0u));
+	frt_assert(bFieldsFit);
+	return (TKey)(0u | ... | (TKey)(((TKey)InFields & FieldMask<Indices>) << FieldShift<Indices>));
+}
+}
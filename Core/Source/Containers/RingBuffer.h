@@ -0,0 +1,551 @@
+#pragma once
+
+#include <cstring>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "Asserts.h"
+#include "CoreTypes.h"
+#include "Memory/Memory.h"
+
+
+namespace frt
+{
+/**
+* Double-ended queue over a power-of-two circular buffer, for FIFO work queues and rolling histories. Key points:
+*	- Push and pop at both ends are O(1); an index is masked into the buffer, never divided
+*	- Growing doubles the capacity and moves the elements to the start of the new buffer, so once a queue
+*	  has seen its peak it doesn't allocate anymore; popping never frees
+*	- With SetOverwriteOldest, pushing onto a full buffer drops the element at the other end instead of growing,
+*	  which makes it a fixed-size history (e.g. the last N frame times)
+*	- GetFirstSpan/GetSecondSpan expose the elements as the (at most) two contiguous runs they occupy,
+*	  front to back, for bulk copies and uploads
+*	- TInlineRingBuffer keeps a fixed capacity inside the object and never allocates; pushing onto it when
+*	  it's full and not overwriting is an error
+*	- Holds the allocator instance the same way TArray does (see memory::TAllocatorRef)
+*
+* @tparam TElementType
+* @tparam TAllocator Unused by the inline variant
+* @tparam TInlineCapacity 0 for a growing buffer on the allocator, otherwise the fixed capacity (power of two)
+*/
+template <typename TElementType, typename TAllocator = memory::DefaultPool, uint32 TInlineCapacity = 0u>
+class TRingBuffer : private memory::TAllocatorRef<TAllocator>
+{
+	static_assert((TInlineCapacity & (TInlineCapacity - 1u)) == 0u, "Inline capacity must be a power of two");
+
+	using AllocatorRefType = memory::TAllocatorRef<TAllocator>;
+
+	static constexpr bool bInline = TInlineCapacity != 0u;
+
+public:
+	static constexpr uint32 MinCapacity = 4u;
+
+	template <bool bConst>
+	class TIterator
+	{
+		using TBufferType = std::conditional_t<bConst, const TRingBuffer, TRingBuffer>;
+		using TIteratedType = std::conditional_t<bConst, const TElementType, TElementType>;
+
+	public:
+		TIterator (TBufferType* InBuffer, uint32 InIndex) : Buffer(InBuffer), Index(InIndex) {}
+
+		TIteratedType& operator* () const { return (*Buffer)[Index]; }
+		TIteratedType* operator-> () const { return &(*Buffer)[Index]; }
+
+		TIterator& operator++ ()
+		{
+			++Index;
+			return *this;
+		}
+
+		bool operator== (const TIterator& Other) const { return Index == Other.Index; }
+
+	private:
+		TBufferType* Buffer;
+		uint32 Index;
+	};
+
+	using Iterator = TIterator<false>;
+	using ConstIterator = TIterator<true>;
+
+	TRingBuffer () = default;
+	explicit TRingBuffer (TAllocator* InAllocator) requires (!bInline) : AllocatorRefType(InAllocator) {}
+	TRingBuffer (const TRingBuffer& Other);
+	TRingBuffer (TRingBuffer&& Other) noexcept;
+	TRingBuffer& operator= (const TRingBuffer& Other);
+	TRingBuffer& operator= (TRingBuffer&& Other) noexcept;
+	~TRingBuffer ();
+
+	// Allocators
+	/** Makes room for InCapacity elements, rounded up to a power of two. Inline buffers only check it fits. */
+	void Reserve (uint32 InCapacity);
+
+	/** Destroys the elements and gives the buffer back. */
+	void Free ();
+
+	void Swap (TRingBuffer& Other) noexcept requires (!bInline);
+
+	TAllocator* GetAllocator () const { return AllocatorRefType::GetAllocator(); }
+
+	/** When set, pushing onto a full buffer drops the element at the opposite end instead of growing. */
+	void SetOverwriteOldest (bool bInOverwriteOldest) { bOverwriteOldest = bInOverwriteOldest; }
+	bool IsOverwritingOldest () const { return bOverwriteOldest; }
+	// ~Allocators
+
+	// Adders
+	TElementType& PushBack (const TElementType& InElement) { return EmplaceBack(InElement); }
+	TElementType& PushBack (TElementType&& InElement) { return EmplaceBack(std::move(InElement)); }
+
+	template <typename... Args>
+	TElementType& EmplaceBack (Args&&... InArgs);
+
+	TElementType& PushFront (const TElementType& InElement) { return EmplaceFront(InElement); }
+	TElementType& PushFront (TElementType&& InElement) { return EmplaceFront(std::move(InElement)); }
+
+	template <typename... Args>
+	TElementType& EmplaceFront (Args&&... InArgs);
+	// ~Adders
+
+	// Removers
+	TElementType PopFront ();
+	TElementType PopBack ();
+
+	/** Destroys InCount elements from the front, e.g. the ones just consumed through GetFirstSpan. */
+	void RemoveFront (uint32 InCount = 1u);
+	void RemoveBack (uint32 InCount = 1u);
+
+	/** Destroys all elements, keeps the buffer. */
+	void Clear ();
+	// ~Removers
+
+	// Getters
+	/** Element InIndex places from the front. */
+	TElementType& operator[] (uint32 InIndex);
+	const TElementType& operator[] (uint32 InIndex) const;
+
+	TElementType& First () { return (*this)[0u]; }
+	const TElementType& First () const { return (*this)[0u]; }
+	TElementType& Last () { return (*this)[Size - 1u]; }
+	const TElementType& Last () const { return (*this)[Size - 1u]; }
+
+	/** Elements from the front up to the end of the buffer or the back, whichever comes first. */
+	std::span<TElementType> GetFirstSpan ();
+	std::span<const TElementType> GetFirstSpan () const;
+
+	/** Elements that wrapped around to the start of the buffer, empty if none did. */
+	std::span<TElementType> GetSecondSpan ();
+	std::span<const TElementType> GetSecondSpan () const;
+
+	uint32 Count () const { return Size; }
+	uint32 GetCapacity () const { return Capacity; }
+	bool IsEmpty () const { return Size == 0u; }
+	bool IsFull () const { return Size == Capacity; }
+	// ~Getters
+
+	// STL compatibility
+	using value_type = TElementType;
+	using size_type = uint32;
+
+	Iterator begin () { return Iterator(this, 0u); }
+	ConstIterator begin () const { return ConstIterator(this, 0u); }
+	Iterator end () { return Iterator(this, Size); }
+	ConstIterator end () const { return ConstIterator(this, Size); }
+
+	size_type size () const { return Size; }
+	bool empty () const { return Size == 0u; }
+
+	friend void swap (TRingBuffer& A, TRingBuffer& B) noexcept requires (!bInline) { A.Swap(B); }
+	// ~STL
+
+private:
+	struct SNoInlineStorage
+	{};
+
+	struct alignas(TElementType) SInlineStorage
+	{
+		uint8 Bytes[sizeof(TElementType) * (bInline ? TInlineCapacity : 1u)];
+	};
+
+	TElementType* GetSlots ();
+	const TElementType* GetSlots () const;
+
+	TElementType* GetSlot (uint32 InIndex) { return GetSlots() + ((Head + InIndex) & (Capacity - 1u)); }
+	const TElementType* GetSlot (uint32 InIndex) const { return GetSlots() + ((Head + InIndex) & (Capacity - 1u)); }
+
+	/** Grows, or drops the element at the other end when overwriting. */
+	void MakeRoom (bool bDropFront);
+
+	void ReAlloc (uint32 InCapacity);
+
+	AllocatorRefType& GetAllocatorRef () { return *this; }
+	const AllocatorRefType& GetAllocatorRef () const { return *this; }
+
+private:
+	[[no_unique_address]] std::conditional_t<bInline, SInlineStorage, SNoInlineStorage> InlineStorage;
+	TElementType* Data = nullptr;
+	uint32 Head = 0u;
+	uint32 Size = 0u;
+	uint32 Capacity = TInlineCapacity;
+	bool bOverwriteOldest = false;
+};
+
+
+/** Ring buffer of a fixed capacity kept inside the object; see TRingBuffer. */
+template <typename TElementType, uint32 TCapacity>
+using TInlineRingBuffer = TRingBuffer<TElementType, memory::DefaultPool, TCapacity>;
+}
+
+
+namespace frt
+{
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+TRingBuffer<TElementType, TAllocator, TInlineCapacity>::TRingBuffer (const TRingBuffer& Other)
+	: AllocatorRefType(Other.GetAllocatorRef())
+{
+	*this = Other;
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+TRingBuffer<TElementType, TAllocator, TInlineCapacity>::TRingBuffer (TRingBuffer&& Other) noexcept
+	: AllocatorRefType(Other.GetAllocatorRef())
+{
+	*this = std::move(Other);
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+TRingBuffer<TElementType, TAllocator, TInlineCapacity>& TRingBuffer<TElementType, TAllocator, TInlineCapacity>::operator= (
+	const TRingBuffer& Other)
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	Clear();
+	Reserve(Other.Size);
+	for (const TElementType& element : Other)
+	{
+		EmplaceBack(element);
+	}
+	bOverwriteOldest = Other.bOverwriteOldest;
+
+	return *this;
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+TRingBuffer<TElementType, TAllocator, TInlineCapacity>& TRingBuffer<TElementType, TAllocator, TInlineCapacity>::operator= (
+	TRingBuffer&& Other) noexcept
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	bOverwriteOldest = Other.bOverwriteOldest;
+
+	if constexpr (!bInline)
+	{
+		if (GetAllocatorRef().CanAdopt(Other.GetAllocatorRef()))
+		{
+			Free();
+			GetAllocatorRef().Adopt(Other.GetAllocatorRef());
+
+			Data = Other.Data;
+			Head = Other.Head;
+			Size = Other.Size;
+			Capacity = Other.Capacity;
+
+			Other.Data = nullptr;
+			Other.Head = 0u;
+			Other.Size = 0u;
+			Other.Capacity = 0u;
+			return *this;
+		}
+	}
+
+	// Inline storage, or a buffer that belongs to another allocator instance: elements are moved one by one
+	Clear();
+	Reserve(Other.Size);
+	for (TElementType& element : Other)
+	{
+		EmplaceBack(std::move(element));
+	}
+	Other.Free();
+
+	return *this;
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+TRingBuffer<TElementType, TAllocator, TInlineCapacity>::~TRingBuffer ()
+{
+	Free();
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+void TRingBuffer<TElementType, TAllocator, TInlineCapacity>::Reserve (uint32 InCapacity)
+{
+	if constexpr (bInline)
+	{
+		frt_assert(InCapacity <= TInlineCapacity);
+	}
+	else if (InCapacity > Capacity)
+	{
+		uint32 capacity = Capacity != 0u ? Capacity : MinCapacity;
+		while (capacity < InCapacity)
+		{
+			capacity *= 2u;
+		}
+		ReAlloc(capacity);
+	}
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+void TRingBuffer<TElementType, TAllocator, TInlineCapacity>::Free ()
+{
+	Clear();
+
+	if constexpr (!bInline)
+	{
+		if (Data)
+		{
+			GetAllocatorRef().Free(Data);
+			Data = nullptr;
+		}
+		Capacity = 0u;
+	}
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+void TRingBuffer<TElementType, TAllocator, TInlineCapacity>::Swap (TRingBuffer& Other) noexcept requires (!bInline)
+{
+	GetAllocatorRef().Swap(Other.GetAllocatorRef());
+	std::swap(Data, Other.Data);
+	std::swap(Head, Other.Head);
+	std::swap(Size, Other.Size);
+	std::swap(Capacity, Other.Capacity);
+	std::swap(bOverwriteOldest, Other.bOverwriteOldest);
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+template <typename... Args>
+TElementType& TRingBuffer<TElementType, TAllocator, TInlineCapacity>::EmplaceBack (Args&&... InArgs)
+{
+	if (Size == Capacity)
+	{
+		// Built up front, the arguments may point into the buffer
+		TElementType element(std::forward<Args>(InArgs)...);
+		MakeRoom(true);
+		TElementType* slot = new(GetSlot(Size)) TElementType(std::move(element));
+		++Size;
+		return *slot;
+	}
+
+	TElementType* slot = new(GetSlot(Size)) TElementType(std::forward<Args>(InArgs)...);
+	++Size;
+	return *slot;
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+template <typename... Args>
+TElementType& TRingBuffer<TElementType, TAllocator, TInlineCapacity>::EmplaceFront (Args&&... InArgs)
+{
+	if (Size == Capacity)
+	{
+		// Built up front, the arguments may point into the buffer
+		TElementType element(std::forward<Args>(InArgs)...);
+		MakeRoom(false);
+		Head = (Head - 1u) & (Capacity - 1u);
+		TElementType* slot = new(GetSlots() + Head) TElementType(std::move(element));
+		++Size;
+		return *slot;
+	}
+
+	Head = (Head - 1u) & (Capacity - 1u);
+	TElementType* slot = new(GetSlots() + Head) TElementType(std::forward<Args>(InArgs)...);
+	++Size;
+	return *slot;
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+TElementType TRingBuffer<TElementType, TAllocator, TInlineCapacity>::PopFront ()
+{
+	frt_assert(Size > 0u);
+
+	TElementType element = std::move(*GetSlot(0u));
+	RemoveFront(1u);
+	return element;
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+TElementType TRingBuffer<TElementType, TAllocator, TInlineCapacity>::PopBack ()
+{
+	frt_assert(Size > 0u);
+
+	TElementType element = std::move(*GetSlot(Size - 1u));
+	RemoveBack(1u);
+	return element;
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+void TRingBuffer<TElementType, TAllocator, TInlineCapacity>::RemoveFront (uint32 InCount)
+{
+	frt_assert(InCount <= Size);
+
+	if constexpr (!std::is_trivially_destructible_v<TElementType>)
+	{
+		for (uint32 i = 0u; i < InCount; ++i)
+		{
+			GetSlot(i)->~TElementType();
+		}
+	}
+
+	Head = (Head + InCount) & (Capacity - 1u);
+	Size -= InCount;
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+void TRingBuffer<TElementType, TAllocator, TInlineCapacity>::RemoveBack (uint32 InCount)
+{
+	frt_assert(InCount <= Size);
+
+	if constexpr (!std::is_trivially_destructible_v<TElementType>)
+	{
+		for (uint32 i = Size - InCount; i < Size; ++i)
+		{
+			GetSlot(i)->~TElementType();
+		}
+	}
+
+	Size -= InCount;
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+void TRingBuffer<TElementType, TAllocator, TInlineCapacity>::Clear ()
+{
+	RemoveFront(Size);
+	Head = 0u;
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+TElementType& TRingBuffer<TElementType, TAllocator, TInlineCapacity>::operator[] (uint32 InIndex)
+{
+	frt_assert(InIndex < Size);
+	return *GetSlot(InIndex);
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+const TElementType& TRingBuffer<TElementType, TAllocator, TInlineCapacity>::operator[] (uint32 InIndex) const
+{
+	frt_assert(InIndex < Size);
+	return *GetSlot(InIndex);
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+std::span<TElementType> TRingBuffer<TElementType, TAllocator, TInlineCapacity>::GetFirstSpan ()
+{
+	const uint32 count = Size < Capacity - Head ? Size : Capacity - Head;
+	return { GetSlots() + Head, count };
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+std::span<const TElementType> TRingBuffer<TElementType, TAllocator, TInlineCapacity>::GetFirstSpan () const
+{
+	const uint32 count = Size < Capacity - Head ? Size : Capacity - Head;
+	return { GetSlots() + Head, count };
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+std::span<TElementType> TRingBuffer<TElementType, TAllocator, TInlineCapacity>::GetSecondSpan ()
+{
+	const uint32 firstCount = Size < Capacity - Head ? Size : Capacity - Head;
+	return { GetSlots(), Size - firstCount };
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+std::span<const TElementType> TRingBuffer<TElementType, TAllocator, TInlineCapacity>::GetSecondSpan () const
+{
+	const uint32 firstCount = Size < Capacity - Head ? Size : Capacity - Head;
+	return { GetSlots(), Size - firstCount };
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+TElementType* TRingBuffer<TElementType, TAllocator, TInlineCapacity>::GetSlots ()
+{
+	if constexpr (bInline)
+	{
+		return std::launder(reinterpret_cast<TElementType*>(InlineStorage.Bytes));
+	}
+	else
+	{
+		return Data;
+	}
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+const TElementType* TRingBuffer<TElementType, TAllocator, TInlineCapacity>::GetSlots () const
+{
+	return const_cast<TRingBuffer*>(this)->GetSlots();
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+void TRingBuffer<TElementType, TAllocator, TInlineCapacity>::MakeRoom (bool bDropFront)
+{
+	// Inline buffers can't grow; one that isn't overwriting was overflowed by the caller, kept consistent anyway
+	frt_assert(!bInline || bOverwriteOldest);
+
+	if (bInline || (bOverwriteOldest && Capacity > 0u))
+	{
+		bDropFront ? RemoveFront(1u) : RemoveBack(1u);
+	}
+	else
+	{
+		ReAlloc(Capacity != 0u ? Capacity * 2u : MinCapacity);
+	}
+}
+
+template <typename TElementType, typename TAllocator, uint32 TInlineCapacity>
+void TRingBuffer<TElementType, TAllocator, TInlineCapacity>::ReAlloc (uint32 InCapacity)
+{
+	frt_assert(!bInline && InCapacity >= Size && (InCapacity & (InCapacity - 1u)) == 0u);
+
+	auto* newData = (TElementType*)GetAllocatorRef().ReAllocate(nullptr, sizeof(TElementType) * InCapacity);
+	if constexpr (memory::IsTriviallyRelocatable<TElementType>)
+	{
+		const std::span<TElementType> first = GetFirstSpan();
+		const std::span<TElementType> second = GetSecondSpan();
+		if (!first.empty())
+		{
+			std::memcpy((void*)newData, first.data(), first.size_bytes());
+		}
+		if (!second.empty())
+		{
+			std::memcpy((void*)(newData + first.size()), second.data(), second.size_bytes());
+		}
+	}
+	else
+	{
+		for (uint32 i = 0u; i < Size; ++i)
+		{
+			TElementType* element = GetSlot(i);
+			new(newData + i) TElementType(std::move(*element));
+			element->~TElementType();
+		}
+	}
+
+	if (Data)
+	{
+		GetAllocatorRef().Free(Data);
+	}
+
+	Data = newData;
+	Head = 0u;
+	Capacity = InCapacity;
+}
+
+
+template <typename TElementType, typename TAllocator>
+struct memory::TIsTriviallyRelocatable<TRingBuffer<TElementType, TAllocator, 0u>> : std::true_type
+{};
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "Asserts.h"
+#include "Containers/Array.h"
+
+
+namespace frt
+{
+/**
+* Weak reference into a TSlotMap: slot index in the low bits, generation of the slot in the high ones.
+* Typed by the element only so handles of different maps can't be mixed up; it's a plain 32-bit value otherwise.
+*
+* @tparam TElementType
+*/
+template <typename TElementType>
+struct TSlotHandle
+{
+	static constexpr uint32 IndexBits = 20u;
+	static constexpr uint32 GenerationBits = 32u - IndexBits;
+	static constexpr uint32 IndexMask = (1u << IndexBits) - 1u;
+	static constexpr uint32 MaxGeneration = (1u << GenerationBits) - 1u;
+	static constexpr uint32 InvalidValue = ~0u;
+
+	uint32 Value = InvalidValue;
+
+	TSlotHandle () = default;
+	TSlotHandle (uint32 InIndex, uint32 InGeneration) : Value((InGeneration << IndexBits) | InIndex) {}
+
+	uint32 GetIndex () const { return Value & IndexMask; }
+	uint32 GetGeneration () const { return Value >> IndexBits; }
+
+	/** Only tells whether the handle was ever set, use TSlotMap::Contains to know if it's alive. */
+	bool IsValid () const { return Value != InvalidValue; }
+
+	bool operator== (const TSlotHandle&) const = default;
+};
+
+
+/**
+* Dense array of elements addressed by generational handles, for objects that are referenced from outside
+* and spawned/despawned all the time. Key points:
+*	- Elements are kept packed in one array, so iteration is linear no matter how much churn there was
+*	- Adding and removing are O(1); removal moves the last element into the hole (like TArray::RemoveAt<false>),
+*	  so element order and raw pointers/indices to elements are not stable, handles are
+*	- A handle of a removed element stays stale forever: the slot generation is bumped on removal,
+*	  and a slot whose generation ran out is retired instead of reused
+*	- Free slots are reused in FIFO order, so generations wear out evenly
+*	- At most TSlotHandle::IndexMask slots
+*
+* @tparam TElementType
+* @tparam TAllocator
+*/
+template <typename TElementType, typename TAllocator = memory::DefaultPool>
+class TSlotMap
+{
+public:
+	using HandleType = TSlotHandle<TElementType>;
+
+	TSlotMap () = default;
+	explicit TSlotMap (TAllocator* InAllocator);
+
+	// Allocators
+	void Reserve (uint32 InCapacity);
+	// ~Allocators
+
+	// Adders
+	template <typename... Args>
+	HandleType Emplace (Args&&... InArgs);
+
+	HandleType Add (const TElementType& InElement) { return Emplace(InElement); }
+	HandleType Add (TElementType&& InElement) { return Emplace(std::move(InElement)); }
+	// ~Adders
+
+	// Removers
+	/** Returns false if the handle is stale already. */
+	bool Remove (HandleType InHandle);
+
+	/** Removes all elements and makes all handles stale, keeps the memory. */
+	void Clear ();
+	// ~Removers
+
+	// Getters
+	bool Contains (HandleType InHandle) const { return IndexOf(InHandle) != Count(); }
+
+	TElementType* Find (HandleType InHandle);
+	const TElementType* Find (HandleType InHandle) const;
+
+	/** Same as Find, but the handle must be alive. */
+	TElementType& Get (HandleType InHandle);
+	const TElementType& Get (HandleType InHandle) const;
+
+	/** Position of the element in the dense array, or Count() if the handle is stale. */
+	uint32 IndexOf (HandleType InHandle) const;
+
+	/** Handle of the element at InDenseIndex. */
+	HandleType GetHandle (uint32 InDenseIndex) const;
+
+	TElementType* GetData () { return Elements.GetData(); }
+	const TElementType* GetData () const { return Elements.GetData(); }
+
+	uint32 Count () const { return Elements.Count(); }
+	bool IsEmpty () const { return Elements.IsEmpty(); }
+	// ~Getters
+
+	// STL compatibility
+	TElementType* begin () { return Elements.begin(); }
+	const TElementType* begin () const { return Elements.begin(); }
+	TElementType* end () { return Elements.end(); }
+	const TElementType* end () const { return Elements.end(); }
+	// ~STL
+
+private:
+	static constexpr uint32 InvalidSlot = ~0u;
+
+	struct SSlot
+	{
+		/** Position of the element in Elements while the slot is taken, next free slot otherwise */
+		uint32 DenseIndex;
+		uint32 Generation;
+	};
+
+	void PushFree (uint32 InSlotIndex);
+	uint32 PopFree ();
+
+	TArray<TElementType, TAllocator> Elements;
+	TArray<uint32, TAllocator> DenseToSlot;
+	TArray<SSlot, TAllocator> Slots;
+
+	uint32 FreeHead = InvalidSlot;
+	uint32 FreeTail = InvalidSlot;
+};
+}
+
+
+namespace frt
+{
+template <typename TElementType, typename TAllocator>
+TSlotMap<TElementType, TAllocator>::TSlotMap (TAllocator* InAllocator)
+	: Elements(InAllocator)
+	, DenseToSlot(InAllocator)
+	, Slots(InAllocator)
+{}
+
+template <typename TElementType, typename TAllocator>
+void TSlotMap<TElementType, TAllocator>::Reserve (uint32 InCapacity)
+{
+	if (InCapacity > Elements.GetCapacity())
+	{
+		Elements.SetCapacity(InCapacity);
+		DenseToSlot.SetCapacity(InCapacity);
+	}
+	if (InCapacity > Slots.GetCapacity())
+	{
+		Slots.SetCapacity(InCapacity);
+	}
+}
+
+template <typename TElementType, typename TAllocator>
+template <typename... Args>
+typename TSlotMap<TElementType, TAllocator>::HandleType TSlotMap<TElementType, TAllocator>::Emplace (Args&&... InArgs)
+{
+	uint32 slotIndex = PopFree();
+	if (slotIndex == InvalidSlot)
+	{
+		frt_assert(Slots.Count() < HandleType::IndexMask);
+		slotIndex = Slots.Count();
+		Slots.Add(SSlot { 0u, 0u });
+	}
+
+	SSlot& slot = Slots[slotIndex];
+	slot.DenseIndex = Elements.Count();
+	Elements.Emplace(std::forward<Args>(InArgs)...);
+	DenseToSlot.Add(slotIndex);
+
+	return HandleType(slotIndex, slot.Generation);
+}
+
+template <typename TElementType, typename TAllocator>
+bool TSlotMap<TElementType, TAllocator>::Remove (HandleType InHandle)
+{
+	const uint32 denseIndex = IndexOf(InHandle);
+	if (denseIndex == Count())
+	{
+		return false;
+	}
+
+	const uint32 slotIndex = InHandle.GetIndex();
+	const uint32 lastDenseIndex = Count() - 1u;
+	if (denseIndex != lastDenseIndex)
+	{
+		const uint32 movedSlotIndex = DenseToSlot[lastDenseIndex];
+		Slots[movedSlotIndex].DenseIndex = denseIndex;
+		DenseToSlot[denseIndex] = movedSlotIndex;
+	}
+	Elements.template RemoveAt<false>(denseIndex);
+	DenseToSlot.template RemoveAt<false>(denseIndex);
+
+	PushFree(slotIndex);
+	return true;
+}
+
+template <typename TElementType, typename TAllocator>
+void TSlotMap<TElementType, TAllocator>::Clear ()
+{
+	for (const uint32 slotIndex : DenseToSlot)
+	{
+		PushFree(slotIndex);
+	}
+	Elements.Clear();
+	DenseToSlot.Clear();
+}
+
+template <typename TElementType, typename TAllocator>
+TElementType* TSlotMap<TElementType, TAllocator>::Find (HandleType InHandle)
+{
+	const uint32 denseIndex = IndexOf(InHandle);
+	return denseIndex != Count() ? Elements.GetData() + denseIndex : nullptr;
+}
+
+template <typename TElementType, typename TAllocator>
+const TElementType* TSlotMap<TElementType, TAllocator>::Find (HandleType InHandle) const
+{
+	const uint32 denseIndex = IndexOf(InHandle);
+	return denseIndex != Count() ? Elements.GetData() + denseIndex : nullptr;
+}
+
+template <typename TElementType, typename TAllocator>
+TElementType& TSlotMap<TElementType, TAllocator>::Get (HandleType InHandle)
+{
+	return const_cast<TElementType&>(static_cast<const TSlotMap&>(*this).Get(InHandle));
+}
+
+template <typename TElementType, typename TAllocator>
+const TElementType& TSlotMap<TElementType, TAllocator>::Get (HandleType InHandle) const
+{
+	const uint32 denseIndex = IndexOf(InHandle);
+	frt_assert(denseIndex != Count());
+	return Elements.GetData()[denseIndex];
+}
+
+template <typename TElementType, typename TAllocator>
+uint32 TSlotMap<TElementType, TAllocator>::IndexOf (HandleType InHandle) const
+{
+	const uint32 slotIndex = InHandle.GetIndex();
+	if (slotIndex >= Slots.Count())
+	{
+		return Count();
+	}
+
+	// A free slot always has a generation no handle was given out with yet
+	const SSlot& slot = Slots.GetData()[slotIndex];
+	return slot.Generation == InHandle.GetGeneration() ? slot.DenseIndex : Count();
+}
+
+template <typename TElementType, typename TAllocator>
+typename TSlotMap<TElementType, TAllocator>::HandleType TSlotMap<TElementType, TAllocator>::GetHandle (
+	uint32 InDenseIndex) const
+{
+	frt_assert(InDenseIndex < Count());
+	const uint32 slotIndex = DenseToSlot.GetData()[InDenseIndex];
+	return HandleType(slotIndex, Slots.GetData()[slotIndex].Generation);
+}
+
+template <typename TElementType, typename TAllocator>
+void TSlotMap<TElementType, TAllocator>::PushFree (uint32 InSlotIndex)
+{
+	SSlot& slot = Slots[InSlotIndex];
+	++slot.Generation;
+	slot.DenseIndex = InvalidSlot;
+	if (slot.Generation == HandleType::MaxGeneration)
+	{
+		// Next handle from this slot would be indistinguishable from an old one (or an invalid one), retire it
+		return;
+	}
+
+	if (FreeTail == InvalidSlot)
+	{
+		FreeHead = InSlotIndex;
+	}
+	else
+	{
+		Slots[FreeTail].DenseIndex = InSlotIndex;
+	}
+	FreeTail = InSlotIndex;
+}
+
+template <typename TElementType, typename TAllocator>
+uint32 TSlotMap<TElementType, TAllocator>::PopFree ()
+{
+	const uint32 slotIndex = FreeHead;
+	if (slotIndex != InvalidSlot)
+	{
+		FreeHead = Slots[slotIndex].DenseIndex;
+		if (FreeHead == InvalidSlot)
+		{
+			FreeTail = InvalidSlot;
+		}
+	}
+
+	return slotIndex;
+}
+
+
+// All three arrays are relocatable themselves
+template <typename TElementType, typename TAllocator>
+struct memory::TIsTriviallyRelocatable<TSlotMap<TElementType, TAllocator>> : std::true_type
+{};
+}
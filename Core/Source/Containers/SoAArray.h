@@ -0,0 +1,594 @@
+#pragma once
+
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Asserts.h"
+#include "Math/MathUtility.h"
+#include "Memory/Memory.h"
+
+
+namespace frt
+{
+/**
+* Dynamic array that stores every field in its own column (structure of arrays), for data that is processed
+* one or two fields at a time, e.g. batch transform updates and culling. Key points:
+*	- All columns share one allocation; each column starts on a ColumnAlignment boundary, whatever alignment
+*	  the allocator itself gives, so raw column pointers can go straight into aligned AVX2 loads and stores
+*	- Capacity is a multiple of CapacityGranularity, so a kernel may run whole 8-wide float batches over
+*	  the tail of a column; elements past Count() are not constructed, only trivial types should be touched there
+*	- Add/RemoveAt work on a whole row, RemoveAt<false> moves the last row into the hole like TArray does
+*	- Iteration is zipped: dereferencing gives a tuple of references, so `for (auto [a, b] : Array)` works
+*	- Growing always moves the columns to a new block (offsets depend on capacity), bit-copying the ones
+*	  that are trivially relocatable (see memory::TIsTriviallyRelocatable)
+*	- Holds the allocator instance the same way TArray does (see memory::TAllocatorRef)
+*
+* @tparam TAllocator
+* @tparam TFields Types of the columns, in order; the same type may appear more than once
+*/
+template <typename TAllocator, typename... TFields>
+class TAllocatedSoAArray : private memory::TAllocatorRef<TAllocator>
+{
+	static_assert(sizeof...(TFields) > 0u);
+
+	using AllocatorRefType = memory::TAllocatorRef<TAllocator>;
+	using FieldIndices = std::make_integer_sequence<uint64, sizeof...(TFields)>;
+
+public:
+	static constexpr uint32 FieldCount = sizeof...(TFields);
+	/** Width of an AVX2 register */
+	static constexpr uint64 ColumnAlignment = 32u;
+	/** Floats in an AVX2 register */
+	static constexpr uint32 CapacityGranularity = 8u;
+	static constexpr float GrowthFactor = 1.5f;
+
+	template <uint32 TFieldIndex>
+	using FieldType = std::tuple_element_t<TFieldIndex, std::tuple<TFields...>>;
+
+	using ReferenceType = std::tuple<TFields&...>;
+	using ConstReferenceType = std::tuple<const TFields&...>;
+
+	template <bool bConst>
+	class TIterator;
+	using Iterator = TIterator<false>;
+	using ConstIterator = TIterator<true>;
+
+	TAllocatedSoAArray () = default;
+	explicit TAllocatedSoAArray (TAllocator* InAllocator);
+	TAllocatedSoAArray (const TAllocatedSoAArray& Other);
+	TAllocatedSoAArray (TAllocatedSoAArray&& Other) noexcept;
+	TAllocatedSoAArray& operator= (const TAllocatedSoAArray& Other);
+	TAllocatedSoAArray& operator= (TAllocatedSoAArray&& Other) noexcept;
+	~TAllocatedSoAArray ();
+
+	// Allocators
+	void SetCapacity (uint32 InCapacity);
+
+	TAllocator* GetAllocator () const { return AllocatorRefType::GetAllocator(); }
+
+	/** Default-constructs new rows, destroys the ones past InSize. */
+	void SetSize (uint32 InSize);
+
+	void ShrinkToFit ();
+
+	void ReAlloc (uint32 InCapacity);
+	void Free ();
+
+	void Swap (TAllocatedSoAArray& Other) noexcept;
+	// ~Allocators
+
+	// Adders
+	/** Adds a row of default-constructed fields, returns its index. */
+	uint32 Add ();
+
+	/** Adds a row with one value per field, returns its index. */
+	template <typename... TArgs> requires (sizeof...(TArgs) == sizeof...(TFields))
+	uint32 Add (TArgs&&... InValues);
+	// ~Adders
+
+	// Removers
+	template <bool bKeepOrder = true>
+	void RemoveAt (uint32 InIndex);
+
+	/**
+	* Destruct all rows, set size to 0, but do not free memory.
+	*/
+	void Clear ();
+	// ~Removers
+
+	// Getters
+	/** Start of the column, aligned to ColumnAlignment; null until something is allocated. */
+	template <uint32 TFieldIndex>
+	FieldType<TFieldIndex>* GetColumn () { return std::get<TFieldIndex>(Columns); }
+
+	template <uint32 TFieldIndex>
+	const FieldType<TFieldIndex>* GetColumn () const { return std::get<TFieldIndex>(Columns); }
+
+	template <uint32 TFieldIndex>
+	FieldType<TFieldIndex>& Get (uint32 InIndex);
+
+	template <uint32 TFieldIndex>
+	const FieldType<TFieldIndex>& Get (uint32 InIndex) const;
+
+	ReferenceType operator[] (uint32 InIndex);
+	ConstReferenceType operator[] (uint32 InIndex) const;
+
+	void SwapElements (uint32 InIndexA, uint32 InIndexB);
+
+	uint32 Count () const { return Size; }
+	uint32 GetCapacity () const { return Capacity; }
+	bool IsEmpty () const { return Size == 0u; }
+	bool IsIndexValid (uint32 InIndex) const { return InIndex < Size; }
+	// ~Getters
+
+	// STL compatibility
+	Iterator begin () { return Iterator(Columns, 0u); }
+	ConstIterator begin () const { return ConstIterator(Columns, 0u); }
+	Iterator end () { return Iterator(Columns, Size); }
+	ConstIterator end () const { return ConstIterator(Columns, Size); }
+
+	uint32 size () const { return Size; }
+	bool empty () const { return Size == 0u; }
+
+	friend void swap (TAllocatedSoAArray& A, TAllocatedSoAArray& B) noexcept { A.Swap(B); }
+	// ~STL
+
+public:
+	template <bool bConst>
+	class TIterator
+	{
+	public:
+		using ColumnsType = std::conditional_t<bConst, std::tuple<const TFields*...>, std::tuple<TFields*...>>;
+		using value_type = std::conditional_t<bConst, ConstReferenceType, ReferenceType>;
+		using difference_type = int64;
+
+		TIterator () = default;
+
+		template <typename TColumns>
+		TIterator (const TColumns& InColumns, uint32 InIndex) : Columns(InColumns), Index(InIndex) {}
+
+		value_type operator* () const
+		{
+			return std::apply([this] (auto*... InColumns) { return value_type(InColumns[Index]...); }, Columns);
+		}
+
+		TIterator& operator++ () { ++Index; return *this; }
+		TIterator operator++ (int) { TIterator old = *this; ++Index; return old; }
+
+		bool operator== (const TIterator& Other) const { return Index == Other.Index; }
+
+		uint32 GetIndex () const { return Index; }
+
+	private:
+		ColumnsType Columns {};
+		uint32 Index = 0u;
+	};
+
+private:
+	AllocatorRefType& GetAllocatorRef () { return *this; }
+	const AllocatorRefType& GetAllocatorRef () const { return *this; }
+
+	static constexpr uint64 AlignUp (uint64 Value, uint64 Alignment) { return (Value + Alignment - 1u) & ~(Alignment - 1u); }
+
+	template <typename TField>
+	static constexpr uint64 GetColumnAlignment () { return alignof(TField) > ColumnAlignment ? alignof(TField) : ColumnAlignment; }
+
+	/** Bytes to ask the allocator for, with room to align the first column. */
+	static uint64 GetBlockSize (uint32 InCapacity);
+
+	template <uint64... TFieldIndices>
+	void MoveColumnsTo (std::tuple<TFields*...>& OutColumns, void* InBlock, std::integer_sequence<uint64, TFieldIndices...>);
+
+	template <uint64... TFieldIndices>
+	void DestroyRows (uint32 InBegin, uint32 InEnd, std::integer_sequence<uint64, TFieldIndices...>);
+
+	template <uint64... TFieldIndices>
+	void MoveRow (uint32 InTo, uint32 InFrom, std::integer_sequence<uint64, TFieldIndices...>);
+
+	template <uint64... TFieldIndices>
+	void CopyRowsFrom (const TAllocatedSoAArray& Other, std::integer_sequence<uint64, TFieldIndices...>);
+
+	void Grow ();
+
+private:
+	void* Block = nullptr;
+	std::tuple<TFields*...> Columns {};
+	uint32 Size = 0u;
+	uint32 Capacity = 0u;
+};
+
+
+/** TAllocatedSoAArray in the default pool, which is what almost everything wants */
+template <typename... TFields>
+using TSoAArray = TAllocatedSoAArray<memory::DefaultPool, TFields...>;
+}
+
+
+namespace frt
+{
+template <typename TAllocator, typename... TFields>
+TAllocatedSoAArray<TAllocator, TFields...>::TAllocatedSoAArray (TAllocator* InAllocator)
+	: AllocatorRefType(InAllocator)
+{}
+
+template <typename TAllocator, typename... TFields>
+TAllocatedSoAArray<TAllocator, TFields...>::TAllocatedSoAArray (const TAllocatedSoAArray& Other)
+	: AllocatorRefType(Other.GetAllocatorRef())
+{
+	*this = Other;
+}
+
+template <typename TAllocator, typename... TFields>
+TAllocatedSoAArray<TAllocator, TFields...>::TAllocatedSoAArray (TAllocatedSoAArray&& Other) noexcept
+	: AllocatorRefType(Other.GetAllocatorRef())
+	, Block(Other.Block)
+	, Columns(Other.Columns)
+	, Size(Other.Size)
+	, Capacity(Other.Capacity)
+{
+	Other.Block = nullptr;
+	Other.Columns = {};
+	Other.Size = 0u;
+	Other.Capacity = 0u;
+}
+
+template <typename TAllocator, typename... TFields>
+TAllocatedSoAArray<TAllocator, TFields...>& TAllocatedSoAArray<TAllocator, TFields...>::operator= (
+	const TAllocatedSoAArray& Other)
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	Clear();
+	if (Capacity < Other.Size)
+	{
+		ReAlloc(Other.Size);
+	}
+	CopyRowsFrom(Other, FieldIndices());
+	Size = Other.Size;
+
+	return *this;
+}
+
+template <typename TAllocator, typename... TFields>
+TAllocatedSoAArray<TAllocator, TFields...>& TAllocatedSoAArray<TAllocator, TFields...>::operator= (
+	TAllocatedSoAArray&& Other) noexcept
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	if (!GetAllocatorRef().CanAdopt(Other.GetAllocatorRef()))
+	{
+		// Block belongs to another instance, so rows are moved into ours instead
+		Clear();
+		if (Capacity < Other.Size)
+		{
+			ReAlloc(Other.Size);
+		}
+		for (uint32 i = 0u; i < Other.Size; ++i)
+		{
+			std::apply([&] (TFields*... InTo)
+			{
+				std::apply([&] (TFields*... InFrom) { (new(InTo + i) TFields(std::move(InFrom[i])), ...); }, Other.Columns);
+			}, Columns);
+		}
+		Size = Other.Size;
+
+		Other.Free();
+		return *this;
+	}
+
+	Free();
+	GetAllocatorRef().Adopt(Other.GetAllocatorRef());
+
+	Block = Other.Block;
+	Columns = Other.Columns;
+	Size = Other.Size;
+	Capacity = Other.Capacity;
+
+	Other.Block = nullptr;
+	Other.Columns = {};
+	Other.Size = 0u;
+	Other.Capacity = 0u;
+
+	return *this;
+}
+
+template <typename TAllocator, typename... TFields>
+TAllocatedSoAArray<TAllocator, TFields...>::~TAllocatedSoAArray ()
+{
+	Free();
+}
+
+template <typename TAllocator, typename... TFields>
+void TAllocatedSoAArray<TAllocator, TFields...>::SetCapacity (uint32 InCapacity)
+{
+	ReAlloc(InCapacity);
+}
+
+template <typename TAllocator, typename... TFields>
+void TAllocatedSoAArray<TAllocator, TFields...>::SetSize (uint32 InSize)
+{
+	if (InSize < Size)
+	{
+		DestroyRows(InSize, Size, FieldIndices());
+		Size = InSize;
+		return;
+	}
+
+	if (InSize > Capacity)
+	{
+		ReAlloc(math::Max(InSize, (uint32)(Capacity * GrowthFactor)));
+	}
+	for (uint32 i = Size; i < InSize; ++i)
+	{
+		std::apply([i] (TFields*... InColumns) { (new(InColumns + i) TFields(), ...); }, Columns);
+	}
+	Size = InSize;
+}
+
+template <typename TAllocator, typename... TFields>
+void TAllocatedSoAArray<TAllocator, TFields...>::ShrinkToFit ()
+{
+	if (Size == 0u)
+	{
+		Free();
+		return;
+	}
+
+	if (AlignUp(Size, CapacityGranularity) < Capacity)
+	{
+		ReAlloc(Size);
+	}
+}
+
+template <typename TAllocator, typename... TFields>
+void TAllocatedSoAArray<TAllocator, TFields...>::ReAlloc (uint32 InCapacity)
+{
+	frt_assert(InCapacity >= Size);
+
+	const uint32 newCapacity = (uint32)AlignUp(math::Max(InCapacity, CapacityGranularity), CapacityGranularity);
+	if (newCapacity == Capacity)
+	{
+		return;
+	}
+
+	void* newBlock = GetAllocatorRef().ReAllocate(nullptr, GetBlockSize(newCapacity));
+	Capacity = newCapacity;
+
+	std::tuple<TFields*...> newColumns;
+	MoveColumnsTo(newColumns, newBlock, FieldIndices());
+
+	GetAllocatorRef().Free(Block);
+	Block = newBlock;
+	Columns = newColumns;
+}
+
+template <typename TAllocator, typename... TFields>
+void TAllocatedSoAArray<TAllocator, TFields...>::Free ()
+{
+	Clear();
+
+	GetAllocatorRef().Free(Block);
+	Block = nullptr;
+	Columns = {};
+	Capacity = 0u;
+}
+
+template <typename TAllocator, typename... TFields>
+void TAllocatedSoAArray<TAllocator, TFields...>::Swap (TAllocatedSoAArray& Other) noexcept
+{
+	GetAllocatorRef().Swap(Other.GetAllocatorRef());
+	std::swap(Block, Other.Block);
+	std::swap(Columns, Other.Columns);
+	std::swap(Size, Other.Size);
+	std::swap(Capacity, Other.Capacity);
+}
+
+template <typename TAllocator, typename... TFields>
+uint32 TAllocatedSoAArray<TAllocator, TFields...>::Add ()
+{
+	if (Size == Capacity)
+	{
+		Grow();
+	}
+
+	const uint32 index = Size;
+	std::apply([index] (TFields*... InColumns) { (new(InColumns + index) TFields(), ...); }, Columns);
+	++Size;
+	return index;
+}
+
+template <typename TAllocator, typename... TFields>
+template <typename... TArgs> requires (sizeof...(TArgs) == sizeof...(TFields))
+uint32 TAllocatedSoAArray<TAllocator, TFields...>::Add (TArgs&&... InValues)
+{
+	if (Size == Capacity)
+	{
+		Grow();
+	}
+
+	const uint32 index = Size;
+	std::apply([&] (TFields*... InColumns) { (new(InColumns + index) TFields(std::forward<TArgs>(InValues)), ...); }, Columns);
+	++Size;
+	return index;
+}
+
+template <typename TAllocator, typename... TFields>
+template <bool bKeepOrder>
+void TAllocatedSoAArray<TAllocator, TFields...>::RemoveAt (uint32 InIndex)
+{
+	frt_assert(IsIndexValid(InIndex));
+
+	constexpr auto fieldIndices = FieldIndices();
+	if constexpr (bKeepOrder)
+	{
+		for (uint32 i = InIndex + 1u; i < Size; ++i)
+		{
+			MoveRow(i - 1u, i, fieldIndices);
+		}
+	}
+	else if (InIndex != Size - 1u)
+	{
+		MoveRow(InIndex, Size - 1u, fieldIndices);
+	}
+
+	DestroyRows(Size - 1u, Size, fieldIndices);
+	--Size;
+}
+
+template <typename TAllocator, typename... TFields>
+void TAllocatedSoAArray<TAllocator, TFields...>::Clear ()
+{
+	DestroyRows(0u, Size, FieldIndices());
+	Size = 0u;
+}
+
+template <typename TAllocator, typename... TFields>
+template <uint32 TFieldIndex>
+typename TAllocatedSoAArray<TAllocator, TFields...>::template FieldType<TFieldIndex>&
+TAllocatedSoAArray<TAllocator, TFields...>::Get (uint32 InIndex)
+{
+	frt_assert(IsIndexValid(InIndex));
+	return std::get<TFieldIndex>(Columns)[InIndex];
+}
+
+template <typename TAllocator, typename... TFields>
+template <uint32 TFieldIndex>
+const typename TAllocatedSoAArray<TAllocator, TFields...>::template FieldType<TFieldIndex>&
+TAllocatedSoAArray<TAllocator, TFields...>::Get (uint32 InIndex) const
+{
+	frt_assert(IsIndexValid(InIndex));
+	return std::get<TFieldIndex>(Columns)[InIndex];
+}
+
+template <typename TAllocator, typename... TFields>
+typename TAllocatedSoAArray<TAllocator, TFields...>::ReferenceType TAllocatedSoAArray<TAllocator, TFields...>::operator[] (
+	uint32 InIndex)
+{
+	frt_assert(IsIndexValid(InIndex));
+	return *Iterator(Columns, InIndex);
+}
+
+template <typename TAllocator, typename... TFields>
+typename TAllocatedSoAArray<TAllocator, TFields...>::ConstReferenceType TAllocatedSoAArray<TAllocator, TFields...>::operator[] (
+	uint32 InIndex) const
+{
+	frt_assert(IsIndexValid(InIndex));
+	return *ConstIterator(Columns, InIndex);
+}
+
+template <typename TAllocator, typename... TFields>
+void TAllocatedSoAArray<TAllocator, TFields...>::SwapElements (uint32 InIndexA, uint32 InIndexB)
+{
+	frt_assert(IsIndexValid(InIndexA) && IsIndexValid(InIndexB));
+
+	using std::swap;
+	std::apply([&] (TFields*... InColumns) { (swap(InColumns[InIndexA], InColumns[InIndexB]), ...); }, Columns);
+}
+
+template <typename TAllocator, typename... TFields>
+uint64 TAllocatedSoAArray<TAllocator, TFields...>::GetBlockSize (uint32 InCapacity)
+{
+	uint64 size = 0u;
+	uint64 maxAlignment = 0u;
+	((size = AlignUp(size, GetColumnAlignment<TFields>()) + sizeof(TFields) * InCapacity,
+		maxAlignment = math::Max(maxAlignment, GetColumnAlignment<TFields>())), ...);
+
+	// Allocator may give less alignment than the first column needs
+	return size + maxAlignment - 1u;
+}
+
+template <typename TAllocator, typename... TFields>
+template <uint64... TFieldIndices>
+void TAllocatedSoAArray<TAllocator, TFields...>::MoveColumnsTo (std::tuple<TFields*...>& OutColumns, void* InBlock,
+	std::integer_sequence<uint64, TFieldIndices...>)
+{
+	uint64 address = (uint64)InBlock;
+	((address = AlignUp(address, GetColumnAlignment<TFields>()),
+		std::get<TFieldIndices>(OutColumns) = (TFields*)address,
+		address += sizeof(TFields) * Capacity), ...);
+
+	auto moveColumn = [this] <typename TField> (TField* OutTo, TField* InFrom)
+	{
+		if (!InFrom || Size == 0u)
+		{
+			return;
+		}
+
+		if constexpr (memory::IsTriviallyRelocatable<TField>)
+		{
+			std::memcpy(OutTo, InFrom, sizeof(TField) * Size);
+		}
+		else
+		{
+			for (uint32 i = 0u; i < Size; ++i)
+			{
+				new(OutTo + i) TField(std::move(InFrom[i]));
+				InFrom[i].~TField();
+			}
+		}
+	};
+	(moveColumn(std::get<TFieldIndices>(OutColumns), std::get<TFieldIndices>(Columns)), ...);
+}
+
+template <typename TAllocator, typename... TFields>
+template <uint64... TFieldIndices>
+void TAllocatedSoAArray<TAllocator, TFields...>::DestroyRows (uint32 InBegin, uint32 InEnd,
+	std::integer_sequence<uint64, TFieldIndices...>)
+{
+	auto destroyColumn = [InBegin, InEnd] <typename TField> (TField* InColumn)
+	{
+		if constexpr (!std::is_trivially_destructible_v<TField>)
+		{
+			for (uint32 i = InBegin; i < InEnd; ++i)
+			{
+				InColumn[i].~TField();
+			}
+		}
+	};
+	(destroyColumn(std::get<TFieldIndices>(Columns)), ...);
+}
+
+template <typename TAllocator, typename... TFields>
+template <uint64... TFieldIndices>
+void TAllocatedSoAArray<TAllocator, TFields...>::MoveRow (uint32 InTo, uint32 InFrom,
+	std::integer_sequence<uint64, TFieldIndices...>)
+{
+	((std::get<TFieldIndices>(Columns)[InTo] = std::move(std::get<TFieldIndices>(Columns)[InFrom])), ...);
+}
+
+template <typename TAllocator, typename... TFields>
+template <uint64... TFieldIndices>
+void TAllocatedSoAArray<TAllocator, TFields...>::CopyRowsFrom (const TAllocatedSoAArray& Other,
+	std::integer_sequence<uint64, TFieldIndices...>)
+{
+	auto copyColumn = [&Other] <typename TField> (TField* OutTo, const TField* InFrom)
+	{
+		for (uint32 i = 0u; i < Other.Size; ++i)
+		{
+			new(OutTo + i) TField(InFrom[i]);
+		}
+	};
+	(copyColumn(std::get<TFieldIndices>(Columns), std::get<TFieldIndices>(Other.Columns)), ...);
+}
+
+template <typename TAllocator, typename... TFields>
+void TAllocatedSoAArray<TAllocator, TFields...>::Grow ()
+{
+	ReAlloc(math::Max(Size + 1u, (uint32)(Capacity * GrowthFactor)));
+}
+
+
+// Columns are owned through pointers into one block, nothing points back into the array itself
+template <typename TAllocator, typename... TFields>
+struct memory::TIsTriviallyRelocatable<TAllocatedSoAArray<TAllocator, TFields...>> : std::true_type
+{};
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+
+
+namespace frt
+{
+/**
+* Bounded lock-free Chase-Lev deque: one owner thread pushes and pops at the bottom, any thread steals from the top.
+* Used as a per-thread job queue, the owner works on its newest jobs (hot in cache) while thieves take the oldest ones.
+* Key points:
+*	- Storage is inline and fixed, nothing is allocated after construction; TryPush fails when the deque is full
+*	- The owner only does a read-modify-write when it races a thief for the last element
+*	- Top and bottom sit on their own cache lines, so steals don't invalidate the owner's line
+*	- Elements are kept in atomics, so only small trivially copyable types fit (pointers, indices)
+*
+* @tparam TElementType Trivially copyable
+* @tparam TCapacity Power of two
+*/
+template <typename TElementType, uint32 TCapacity>
+class TWorkStealingDeque
+{
+	static_assert(TCapacity > 1u && (TCapacity & (TCapacity - 1u)) == 0u, "Capacity must be a power of two");
+	static_assert(std::is_trivially_copyable_v<TElementType>);
+
+public:
+	static constexpr uint32 Capacity = TCapacity;
+	static constexpr uint64 CacheLineSize = 64u;
+
+	FRT_DELETE_COPY_AND_MOVE_OPS(TWorkStealingDeque);
+
+	TWorkStealingDeque () = default;
+
+	// Owner
+	/** Returns false if the deque is full. Owner thread only. */
+	bool TryPush (TElementType InElement);
+
+	/** Takes the newest element, OutElement is left as it was on failure. Owner thread only. */
+	bool TryPop (TElementType& OutElement);
+	// ~Owner
+
+	// Thieves
+	/** Takes the oldest element; fails if the deque is empty or another thread took it first. Safe from any thread. */
+	bool TrySteal (TElementType& OutElement);
+	// ~Thieves
+
+	// Getters
+	/** Approximate while other threads are stealing. */
+	uint32 CountApprox () const;
+	// ~Getters
+
+private:
+	static constexpr int64 IndexMask = TCapacity - 1u;
+
+	alignas(CacheLineSize) std::atomic<int64> Top = 0;
+	alignas(CacheLineSize) std::atomic<int64> Bottom = 0;
+	alignas(CacheLineSize) std::atomic<TElementType> Elements[TCapacity] = {};
+};
+}
+
+
+namespace frt
+{
+template <typename TElementType, uint32 TCapacity>
+bool TWorkStealingDeque<TElementType, TCapacity>::TryPush (TElementType InElement)
+{
+	const int64 bottom = Bottom.load(std::memory_order_relaxed);
+	const int64 top = Top.load(std::memory_order_acquire);
+	if (bottom - top >= (int64)TCapacity)
+	{
+		return false;
+	}
+
+	Elements[bottom & IndexMask].store(InElement, std::memory_order_relaxed);
+	// Publishes the element to thieves that read the new bottom
+	Bottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename TElementType, uint32 TCapacity>
+bool TWorkStealingDeque<TElementType, TCapacity>::TryPop (TElementType& OutElement)
+{
+	const int64 bottom = Bottom.load(std::memory_order_relaxed) - 1;
+	Bottom.store(bottom, std::memory_order_relaxed);
+	// Thieves must see the reserved bottom before the owner reads top, or both could take the last element
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64 top = Top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	const TElementType element = Elements[bottom & IndexMask].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		// Last element, race the thieves for it by moving top past it
+		const bool bWon = Top.compare_exchange_strong(top, top + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed);
+		Bottom.store(bottom + 1, std::memory_order_relaxed);
+		if (!bWon)
+		{
+			// A thief has it, handing it out here too would run it twice
+			return false;
+		}
+	}
+
+	OutElement = element;
+	return true;
+}
+
+template <typename TElementType, uint32 TCapacity>
+bool TWorkStealingDeque<TElementType, TCapacity>::TrySteal (TElementType& OutElement)
+{
+	int64 top = Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64 bottom = Bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom)
+	{
+		return false;
+	}
+
+	// Read before the CAS: once top moves on, the owner may overwrite the slot
+	const TElementType element = Elements[top & IndexMask].load(std::memory_order_relaxed);
+	if (!Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	OutElement = element;
+	return true;
+}
+
+template <typename TElementType, uint32 TCapacity>
+uint32 TWorkStealingDeque<TElementType, TCapacity>::CountApprox () const
+{
+	const int64 bottom = Bottom.load(std::memory_order_relaxed);
+	const int64 top = Top.load(std::memory_order_relaxed);
+	return bottom > top ? (uint32)(bottom - top) : 0u;
+}
+}
@@ -0,0 +1,237 @@
+#include "Archetype.h"
+
+#include <cstring>
+
+#include "Asserts.h"
+#include "Math/MathUtility.h"
+#include "Memory/Memory.h"
+
+
+namespace frt::ecs
+{
+namespace
+{
+void RelocateComponent (const SComponentTypeInfo& InInfo, void* InTo, void* InFrom)
+{
+	if (InInfo.Relocate)
+	{
+		InInfo.Relocate(InTo, InFrom);
+	}
+	else
+	{
+		std::memcpy(InTo, InFrom, InInfo.Size);
+	}
+}
+
+void DestroyComponent (const SComponentTypeInfo& InInfo, void* InComponent)
+{
+	if (InInfo.Destroy)
+	{
+		InInfo.Destroy(InComponent);
+	}
+}
+}
+
+
+CArchetype::CArchetype (ComponentMask InMask)
+	: Mask(InMask)
+{
+	uint64 rowSize = sizeof(EntityHandle);
+	for (uint32 componentId = 0; componentId < MaxComponentTypes; ++componentId)
+	{
+		if (HasComponent(Mask, componentId))
+		{
+			const SComponentTypeInfo& info = GetComponentTypeInfo(componentId);
+			frt_assert(info.Alignment <= ColumnAlignment);
+			Columns.Add({ componentId, 0u, &info });
+			rowSize += info.Size;
+		}
+	}
+
+	// Reserve the worst-case padding of every column, the rest is split into rows
+	const uint64 paddingSize = (Columns.Count() + 1u) * ColumnAlignment;
+	frt_assert(ChunkSize > paddingSize + rowSize);
+	RowsPerChunk = (uint32)((ChunkSize - paddingSize) / rowSize);
+
+	uint64 offset = memory::AlignAddress(sizeof(EntityHandle) * RowsPerChunk, ColumnAlignment);
+	for (SColumn& column : Columns)
+	{
+		column.Offset = (uint32)offset;
+		offset = memory::AlignAddress(offset + (uint64)column.Info->Size * RowsPerChunk, ColumnAlignment);
+	}
+	frt_assert(offset <= ChunkSize);
+}
+
+CArchetype::CArchetype (CArchetype&& Other) noexcept
+	: Mask(Other.Mask)
+	, RowCount(Other.RowCount)
+	, RowsPerChunk(Other.RowsPerChunk)
+	, Columns(std::move(Other.Columns))
+	, Chunks(std::move(Other.Chunks))
+{
+	Other.RowCount = 0u;
+}
+
+CArchetype& CArchetype::operator= (CArchetype&& Other) noexcept
+{
+	if (this != &Other)
+	{
+		Clear();
+
+		Mask = Other.Mask;
+		RowCount = Other.RowCount;
+		RowsPerChunk = Other.RowsPerChunk;
+		Columns = std::move(Other.Columns);
+		Chunks = std::move(Other.Chunks);
+
+		Other.RowCount = 0u;
+	}
+	return *this;
+}
+
+CArchetype::~CArchetype ()
+{
+	Clear();
+}
+
+uint32 CArchetype::AddRow (EntityHandle InEntity)
+{
+	const uint32 row = RowCount;
+	if (row == Chunks.Count() * RowsPerChunk)
+	{
+		AddChunk();
+	}
+
+	++RowCount;
+	GetHandles(row / RowsPerChunk)[row % RowsPerChunk] = InEntity;
+	return row;
+}
+
+EntityHandle CArchetype::RemoveRow (uint32 InRow)
+{
+	frt_assert(InRow < RowCount);
+
+	for (const SColumn& column : Columns)
+	{
+		DestroyComponent(*column.Info, GetComponent(InRow, column.ComponentId));
+	}
+
+	return FillHole(InRow);
+}
+
+EntityHandle CArchetype::MoveRow (uint32 InRow, CArchetype& InTarget, uint32& OutTargetRow)
+{
+	frt_assert(InRow < RowCount);
+	frt_assert(&InTarget != this);
+
+	OutTargetRow = InTarget.AddRow(GetHandle(InRow));
+	for (const SColumn& column : Columns)
+	{
+		void* component = GetComponent(InRow, column.ComponentId);
+		if (InTarget.Has(column.ComponentId))
+		{
+			RelocateComponent(*column.Info, InTarget.GetComponent(OutTargetRow, column.ComponentId), component);
+		}
+		else
+		{
+			DestroyComponent(*column.Info, component);
+		}
+	}
+
+	return FillHole(InRow);
+}
+
+void CArchetype::Clear ()
+{
+	for (const SColumn& column : Columns)
+	{
+		if (!column.Info->Destroy)
+		{
+			continue;
+		}
+
+		for (uint32 row = 0; row < RowCount; ++row)
+		{
+			column.Info->Destroy(GetComponent(row, column.ComponentId));
+		}
+	}
+	RowCount = 0u;
+
+	for (const SChunk& chunk : Chunks)
+	{
+		memory::DestroyUnmanaged(chunk.Block);
+	}
+	Chunks.Clear();
+}
+
+uint32 CArchetype::GetChunkRowCount (uint32 InChunkIndex) const
+{
+	const uint32 firstRow = InChunkIndex * RowsPerChunk;
+	frt_assert(firstRow < RowCount);
+	return math::Min(RowCount - firstRow, RowsPerChunk);
+}
+
+EntityHandle* CArchetype::GetHandles (uint32 InChunkIndex) const
+{
+	return reinterpret_cast<EntityHandle*>(Chunks[InChunkIndex].Data);
+}
+
+void* CArchetype::GetColumn (uint32 InChunkIndex, uint32 InComponentId) const
+{
+	frt_assert(Has(InComponentId));
+	return Chunks[InChunkIndex].Data + Columns[GetColumnIndex(Mask, InComponentId)].Offset;
+}
+
+EntityHandle CArchetype::GetHandle (uint32 InRow) const
+{
+	frt_assert(InRow < RowCount);
+	return GetHandles(InRow / RowsPerChunk)[InRow % RowsPerChunk];
+}
+
+void* CArchetype::GetComponent (uint32 InRow, uint32 InComponentId) const
+{
+	frt_assert(InRow < RowCount);
+	const SColumn& column = Columns[GetColumnIndex(Mask, InComponentId)];
+	return Chunks[InRow / RowsPerChunk].Data + column.Offset + (uint64)column.Info->Size * (InRow % RowsPerChunk);
+}
+
+EntityHandle CArchetype::FillHole (uint32 InRow)
+{
+	const uint32 lastRow = RowCount - 1u;
+	EntityHandle movedEntity;
+	if (InRow != lastRow)
+	{
+		for (const SColumn& column : Columns)
+		{
+			RelocateComponent(*column.Info,
+				GetComponent(InRow, column.ComponentId),
+				GetComponent(lastRow, column.ComponentId));
+		}
+
+		movedEntity = GetHandle(lastRow);
+		GetHandles(InRow / RowsPerChunk)[InRow % RowsPerChunk] = movedEntity;
+	}
+
+	--RowCount;
+	TrimChunks();
+	return movedEntity;
+}
+
+void CArchetype::AddChunk ()
+{
+	// The pool only guarantees 8-byte alignment
+	SChunk chunk;
+	chunk.Block = memory::NewUnmanaged(ChunkSize + ColumnAlignment - 1u);
+	chunk.Data = memory::AlignPointer(static_cast<uint8*>(chunk.Block), ColumnAlignment);
+	Chunks.Add(chunk);
+}
+
+void CArchetype::TrimChunks ()
+{
+	while (Chunks.Count() > GetChunkCount() + 1u)
+	{
+		memory::DestroyUnmanaged(Chunks.Last().Block);
+		Chunks.RemoveAt<false>(Chunks.Count() - 1u);
+	}
+}
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Core.h"
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+#include "Containers/Array.h"
+#include "Containers/SlotMap.h"
+#include "Ecs/Component.h"
+
+
+namespace frt
+{
+class CEntity;
+
+/** Entities live in CEntityRegistry and are referred to by handles, raw pointers to their components do not
+* survive structural changes (spawns, despawns, adding or removing components) */
+using EntityHandle = TSlotHandle<CEntity>;
+}
+
+
+namespace frt::ecs
+{
+/**
+* Storage of all entities that have exactly the same set of components. Key points:
+*	- Rows live in fixed-size chunks; a chunk has a column of entity handles followed by a column per component,
+*	  in the order of component ids, so a query reads every column it needs linearly
+*	- Each column starts on a ColumnAlignment boundary, so float columns can go straight into aligned AVX2 loads
+*	- Rows are dense: all chunks but the last one are full, and removal moves the last row into the hole,
+*	  so rows and component addresses are not stable, entity handles are
+*	- Components are type-erased here (see SComponentTypeInfo); new rows are left unconstructed,
+*	  the caller constructs components in place
+*/
+class FRT_CORE_API CArchetype
+{
+public:
+	static constexpr uint64 ChunkSize = 16u * 1024u;
+	/** Width of an AVX2 register */
+	static constexpr uint64 ColumnAlignment = 32u;
+
+	FRT_DELETE_COPY_OPS(CArchetype);
+
+	explicit CArchetype (ComponentMask InMask);
+	CArchetype (CArchetype&& Other) noexcept;
+	CArchetype& operator= (CArchetype&& Other) noexcept;
+	~CArchetype ();
+
+	// Adders
+	/** Appends a row for the entity, its components are left unconstructed. Returns the row. */
+	uint32 AddRow (EntityHandle InEntity);
+	// ~Adders
+
+	// Removers
+	/**
+	* Destroys components of the row and moves the last row into it.
+	* Returns the entity whose row changed, invalid handle if there was none.
+	*/
+	EntityHandle RemoveRow (uint32 InRow);
+
+	/**
+	* Relocates the components InTarget has too into a new row of it, destroys the others and removes the row
+	* the same way RemoveRow does. Components only InTarget has are left unconstructed.
+	*/
+	EntityHandle MoveRow (uint32 InRow, CArchetype& InTarget, uint32& OutTargetRow);
+
+	/** Destroys all rows and frees the chunks. */
+	void Clear ();
+	// ~Removers
+
+	// Getters
+	ComponentMask GetMask () const { return Mask; }
+	bool Has (uint32 InComponentId) const { return HasComponent(Mask, InComponentId); }
+
+	uint32 Count () const { return RowCount; }
+	bool IsEmpty () const { return RowCount == 0u; }
+
+	uint32 GetRowsPerChunk () const { return RowsPerChunk; }
+	/** Chunks that hold at least one row */
+	uint32 GetChunkCount () const { return (RowCount + RowsPerChunk - 1u) / RowsPerChunk; }
+	uint32 GetChunkRowCount (uint32 InChunkIndex) const;
+
+	EntityHandle* GetHandles (uint32 InChunkIndex) const;
+	/** The archetype must have the component. */
+	void* GetColumn (uint32 InChunkIndex, uint32 InComponentId) const;
+
+	template <typename TComponent>
+	TComponent* GetColumn (uint32 InChunkIndex) const
+	{
+		return static_cast<TComponent*>(GetColumn(InChunkIndex, GetComponentId<TComponent>()));
+	}
+
+	EntityHandle GetHandle (uint32 InRow) const;
+	void* GetComponent (uint32 InRow, uint32 InComponentId) const;
+	// ~Getters
+
+private:
+	struct SColumn
+	{
+		uint32 ComponentId;
+		uint32 Offset;
+		const SComponentTypeInfo* Info;
+	};
+
+	struct SChunk
+	{
+		void* Block;
+		uint8* Data;
+	};
+
+	/** Moves the last row into InRow, whose components must be gone already. */
+	EntityHandle FillHole (uint32 InRow);
+
+	void AddChunk ();
+	/** Keeps one empty chunk around, so adding and removing on a chunk border doesn't allocate every time. */
+	void TrimChunks ();
+
+	ComponentMask Mask = 0u;
+	uint32 RowCount = 0u;
+	uint32 RowsPerChunk = 0u;
+
+	TArray<SColumn> Columns;
+	TArray<SChunk> Chunks;
+};
+}
+
+
+namespace frt::memory
+{
+// Owns only the chunk blocks, nothing points back into the archetype
+template <>
+struct TIsTriviallyRelocatable<ecs::CArchetype> : std::true_type
+{};
+}
@@ -0,0 +1,46 @@
+#include "Component.h"
+
+#include <mutex>
+
+#include "Asserts.h"
+
+
+namespace frt::ecs
+{
+namespace
+{
+std::mutex gComponentTypesMutex;
+SComponentTypeInfo gComponentTypes[MaxComponentTypes];
+uint32 gComponentTypeCount = 0u;
+}
+
+
+uint32 RegisterComponentType (const SComponentTypeInfo& InInfo)
+{
+	frt_assert(InInfo.Type);
+
+	std::scoped_lock lock(gComponentTypesMutex);
+
+	// Every module that uses a component registers it on its own. Names alone can't be compared: types in
+	// anonymous namespaces of different files may share one
+	for (uint32 i = 0; i < gComponentTypeCount; ++i)
+	{
+		if (*gComponentTypes[i].Type == *InInfo.Type)
+		{
+			frt_assert(gComponentTypes[i].Size == InInfo.Size);
+			return i;
+		}
+	}
+
+	frt_assert(gComponentTypeCount < MaxComponentTypes);
+	gComponentTypes[gComponentTypeCount] = InInfo;
+	return gComponentTypeCount++;
+}
+
+const SComponentTypeInfo& GetComponentTypeInfo (uint32 InComponentId)
+{
+	// Ids are only given out after the info is written, and it's never changed after
+	frt_assert(InComponentId < MaxComponentTypes);
+	return gComponentTypes[InComponentId];
+}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <bit>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#include "Core.h"
+#include "CoreTypes.h"
+#include "Memory/Relocation.h"
+
+
+namespace frt::ecs
+{
+/** Bit per component id, the set of components of an archetype */
+using ComponentMask = uint64;
+
+static constexpr uint32 MaxComponentTypes = 64u;
+
+
+/**
+* Everything the archetype storage needs to handle a component it only knows by id.
+* Function pointers are null where bytes can be copied or left as they are.
+*/
+struct SComponentTypeInfo
+{
+	const std::type_info* Type = nullptr;
+	const char* Name = nullptr;
+	uint32 Size = 0u;
+	uint32 Alignment = 0u;
+
+	/** Move-constructs at InTo and destroys InFrom */
+	void (*Relocate) (void* InTo, void* InFrom) = nullptr;
+	void (*Destroy) (void* InComponent) = nullptr;
+};
+
+
+/** Returns the id of the type, registering it on first call. Types are told apart by their type_info, so the
+* same type gets the same id in every module, and types with the same name in anonymous namespaces of different
+* files get different ones. */
+FRT_CORE_API uint32 RegisterComponentType (const SComponentTypeInfo& InInfo);
+FRT_CORE_API const SComponentTypeInfo& GetComponentTypeInfo (uint32 InComponentId);
+
+template <typename TComponent>
+SComponentTypeInfo MakeComponentTypeInfo ();
+
+template <typename TComponent>
+uint32 GetComponentId ();
+
+template <typename... TComponents>
+ComponentMask MakeComponentMask ();
+
+inline bool HasComponent (ComponentMask InMask, uint32 InComponentId)
+{
+	return (InMask & (1ull << InComponentId)) != 0u;
+}
+
+/** Components of an archetype are stored in the order of their ids, so the column of one is the number of
+* components with a lower id. */
+inline uint32 GetColumnIndex (ComponentMask InMask, uint32 InComponentId)
+{
+	return (uint32)std::popcount(InMask & ((1ull << InComponentId) - 1ull));
+}
+}
+
+
+namespace frt::ecs
+{
+template <typename TComponent>
+SComponentTypeInfo MakeComponentTypeInfo ()
+{
+	static_assert(std::is_move_constructible_v<TComponent>);
+
+	SComponentTypeInfo info;
+	info.Type = &typeid(TComponent);
+	info.Name = typeid(TComponent).name();
+	info.Size = sizeof(TComponent);
+	info.Alignment = alignof(TComponent);
+
+	if constexpr (!memory::IsTriviallyRelocatable<TComponent>)
+	{
+		info.Relocate = [] (void* InTo, void* InFrom)
+		{
+			TComponent* from = static_cast<TComponent*>(InFrom);
+			new (InTo) TComponent(std::move(*from));
+			from->~TComponent();
+		};
+	}
+
+	if constexpr (!std::is_trivially_destructible_v<TComponent>)
+	{
+		info.Destroy = [] (void* InComponent)
+		{
+			static_cast<TComponent*>(InComponent)->~TComponent();
+		};
+	}
+
+	return info;
+}
+
+template <typename TComponent>
+uint32 GetComponentId ()
+{
+	using ComponentType = std::remove_cvref_t<TComponent>;
+	if constexpr (!std::is_same_v<ComponentType, TComponent>)
+	{
+		return GetComponentId<ComponentType>();
+	}
+	else
+	{
+		static const uint32 id = RegisterComponentType(MakeComponentTypeInfo<ComponentType>());
+		return id;
+	}
+}
+
+template <typename... TComponents>
+ComponentMask MakeComponentMask ()
+{
+	return ((1ull << GetComponentId<TComponents>()) | ... | 0ull);
+}
+}
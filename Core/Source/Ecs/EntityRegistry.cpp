@@ -0,0 +1,130 @@
+#include "EntityRegistry.h"
+
+#include "Asserts.h"
+
+
+namespace frt::ecs
+{
+bool CEntityRegistry::Destroy (EntityHandle InEntity)
+{
+	const SEntityLocation* location = Entities.Find(ToLocationHandle(InEntity));
+	if (!location)
+	{
+		return false;
+	}
+
+	const SEntityLocation removedLocation = *location;
+	const EntityHandle movedEntity = Archetypes[removedLocation.ArchetypeIndex].RemoveRow(removedLocation.Row);
+	if (movedEntity.IsValid())
+	{
+		OnRowMoved(movedEntity, removedLocation.Row);
+	}
+
+	Entities.Remove(ToLocationHandle(InEntity));
+	++StructureVersion;
+	return true;
+}
+
+void CEntityRegistry::Clear ()
+{
+	for (CArchetype& archetype : Archetypes)
+	{
+		archetype.Clear();
+	}
+	Entities.Clear();
+	++StructureVersion;
+}
+
+uint32 CEntityRegistry::FindOrAddArchetype (ComponentMask InMask)
+{
+	if (const uint32* knownIndex = ArchetypeIndices.Find(InMask))
+	{
+		return *knownIndex;
+	}
+
+	const uint32 archetypeIndex = Archetypes.Count();
+	Archetypes.Emplace(InMask);
+	ArchetypeIndices.Add(InMask, archetypeIndex);
+	return archetypeIndex;
+}
+
+EntityHandle CEntityRegistry::AddEntity (uint32 InArchetypeIndex, uint32& OutRow)
+{
+	const LocationHandle location = Entities.Add(SEntityLocation { InArchetypeIndex, 0u });
+	const EntityHandle entity(location.GetIndex(), location.GetGeneration());
+
+	OutRow = Archetypes[InArchetypeIndex].AddRow(entity);
+	Entities.Get(location).Row = OutRow;
+	++StructureVersion;
+	return entity;
+}
+
+CEntityRegistry::SEntityLocation CEntityRegistry::MoveEntity (EntityHandle InEntity, ComponentMask InNewMask)
+{
+	// May add an archetype, so the source one is looked up after
+	const uint32 targetIndex = FindOrAddArchetype(InNewMask);
+
+	SEntityLocation& location = Entities.Get(ToLocationHandle(InEntity));
+	const SEntityLocation oldLocation = location;
+
+	uint32 targetRow = 0u;
+	const EntityHandle movedEntity = Archetypes[oldLocation.ArchetypeIndex].MoveRow(
+		oldLocation.Row, Archetypes[targetIndex], targetRow);
+
+	location = { targetIndex, targetRow };
+	if (movedEntity.IsValid())
+	{
+		OnRowMoved(movedEntity, oldLocation.Row);
+	}
+	++StructureVersion;
+
+	return location;
+}
+
+void* CEntityRegistry::AddComponentUninitialized (EntityHandle InEntity, uint32 InComponentId)
+{
+	const SEntityLocation* location = Entities.Find(ToLocationHandle(InEntity));
+	frt_assert(location);
+
+	const ComponentMask mask = Archetypes[location->ArchetypeIndex].GetMask();
+	frt_assert(!HasComponent(mask, InComponentId));
+
+	const SEntityLocation newLocation = MoveEntity(InEntity, mask | (1ull << InComponentId));
+	return Archetypes[newLocation.ArchetypeIndex].GetComponent(newLocation.Row, InComponentId);
+}
+
+bool CEntityRegistry::RemoveComponent (EntityHandle InEntity, uint32 InComponentId)
+{
+	const SEntityLocation* location = Entities.Find(ToLocationHandle(InEntity));
+	if (!location)
+	{
+		return false;
+	}
+
+	const ComponentMask mask = Archetypes[location->ArchetypeIndex].GetMask();
+	if (!HasComponent(mask, InComponentId))
+	{
+		return false;
+	}
+
+	MoveEntity(InEntity, mask & ~(1ull << InComponentId));
+	return true;
+}
+
+void* CEntityRegistry::FindComponent (EntityHandle InEntity, uint32 InComponentId) const
+{
+	const SEntityLocation* location = Entities.Find(ToLocationHandle(InEntity));
+	if (!location)
+	{
+		return nullptr;
+	}
+
+	const CArchetype& archetype = Archetypes[location->ArchetypeIndex];
+	return archetype.Has(InComponentId) ? archetype.GetComponent(location->Row, InComponentId) : nullptr;
+}
+
+void CEntityRegistry::OnRowMoved (EntityHandle InEntity, uint32 InRow)
+{
+	Entities.Get(ToLocationHandle(InEntity)).Row = InRow;
+}
+}
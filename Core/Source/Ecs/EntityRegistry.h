@@ -0,0 +1,346 @@
+#pragma once
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Core.h"
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+#include "Containers/Array.h"
+#include "Containers/FlatMap.h"
+#include "Containers/SlotMap.h"
+#include "Ecs/Archetype.h"
+#include "Ecs/Component.h"
+#include "Jobs/ParallelFor.h"
+
+
+namespace frt::ecs
+{
+/**
+* Owns all entities of a scene and their components, grouped into archetypes by component set.
+* Key points:
+*	- An entity is only a handle; its components live in the chunks of its archetype (see CArchetype)
+*	- Queries (ForEach, ForEachChunk) visit every archetype that has all the requested components and walk
+*	  its chunks linearly, in archetype, chunk, row order; the order is stable as long as nothing is spawned,
+*	  despawned or changes its component set
+*	- Adding or removing a component moves the entity to another archetype
+*	- No structural changes (Create, Destroy, Add, Remove) while a query runs; component values may change freely
+*	- Parallel queries hand whole chunks to the job system (see jobs::ParallelFor); rows of different chunks
+*	  may be visited concurrently, so the function must only touch the components it was given
+*	- Component pointers are valid until the next structural change, handles until the entity is destroyed
+*/
+class FRT_CORE_API CEntityRegistry
+{
+public:
+	FRT_DELETE_COPY_OPS(CEntityRegistry);
+
+	CEntityRegistry () = default;
+	CEntityRegistry (CEntityRegistry&&) noexcept = default;
+	CEntityRegistry& operator= (CEntityRegistry&&) noexcept = default;
+
+	// Adders
+	/** Creates an entity with default-constructed components. */
+	template <typename... TComponents>
+	EntityHandle Create ();
+
+	template <typename... TComponents>
+	EntityHandle Create (TComponents&&... InComponents);
+
+	/** The entity must be alive and must not have the component yet. Arguments may be components of the registry. */
+	template <typename TComponent, typename... Args>
+	TComponent& Add (EntityHandle InEntity, Args&&... InArgs);
+	// ~Adders
+
+	// Removers
+	/** Returns false if the entity is gone already. */
+	bool Destroy (EntityHandle InEntity);
+
+	/** Returns false if the entity is gone or doesn't have the component. */
+	template <typename TComponent>
+	bool Remove (EntityHandle InEntity) { return RemoveComponent(InEntity, GetComponentId<TComponent>()); }
+
+	/** Destroys all entities, keeps the archetypes. */
+	void Clear ();
+	// ~Removers
+
+	// Getters
+	bool IsAlive (EntityHandle InEntity) const { return Entities.Contains(ToLocationHandle(InEntity)); }
+
+	template <typename TComponent>
+	bool Has (EntityHandle InEntity) const { return FindComponent(InEntity, GetComponentId<TComponent>()) != nullptr; }
+
+	template <typename TComponent>
+	TComponent* Find (EntityHandle InEntity)
+	{
+		return static_cast<TComponent*>(FindComponent(InEntity, GetComponentId<TComponent>()));
+	}
+
+	template <typename TComponent>
+	const TComponent* Find (EntityHandle InEntity) const
+	{
+		return static_cast<const TComponent*>(FindComponent(InEntity, GetComponentId<TComponent>()));
+	}
+
+	/** Same as Find, but the entity must be alive and have the component. */
+	template <typename TComponent>
+	TComponent& Get (EntityHandle InEntity);
+
+	template <typename TComponent>
+	const TComponent& Get (EntityHandle InEntity) const;
+
+	uint32 Count () const { return Entities.Count(); }
+	bool IsEmpty () const { return Entities.IsEmpty(); }
+
+	/** Number of entities that have all of TComponents */
+	template <typename... TComponents>
+	uint32 CountMatching () const;
+
+	/**
+	* Bumped by every structural change. Component pointers and the query order taken at one version stay valid
+	* while it doesn't change, so caches built from them can tell when to rebuild.
+	*/
+	uint64 GetStructureVersion () const { return StructureVersion; }
+
+	uint32 GetArchetypeCount () const { return Archetypes.Count(); }
+	const CArchetype& GetArchetype (uint32 InIndex) const { return Archetypes[InIndex]; }
+	// ~Getters
+
+	// Queries
+	/**
+	* Calls InFunction(TComponents&...) for every entity that has all of TComponents,
+	* or InFunction(EntityHandle, TComponents&...) if it takes the handle first.
+	*/
+	template <typename... TComponents, typename TFunction>
+	void ForEach (TFunction&& InFunction);
+
+	/**
+	* Calls InFunction(uint32 RowCount, const EntityHandle* Handles, TComponents*... Columns) for every chunk
+	* of every archetype that has all of TComponents; for batch kernels that work on whole columns.
+	*/
+	template <typename... TComponents, typename TFunction>
+	void ForEachChunk (TFunction&& InFunction);
+
+	/** Same as ForEach, chunks are spread over the job system. */
+	template <typename... TComponents, typename TFunction>
+	void ParallelForEach (TFunction&& InFunction);
+
+	/**
+	* Same as ForEachChunk, chunks are spread over the job system. InFunction also takes the index of the first row
+	* in query order, InFunction(uint32 FirstIndex, uint32 RowCount, const EntityHandle*, TComponents*...),
+	* to write per-entity output to a flat array without synchronization.
+	*/
+	template <typename... TComponents, typename TFunction>
+	void ParallelForEachChunk (TFunction&& InFunction);
+	// ~Queries
+
+private:
+	struct SEntityLocation
+	{
+		uint32 ArchetypeIndex;
+		uint32 Row;
+	};
+
+	using LocationHandle = TSlotHandle<SEntityLocation>;
+
+	static LocationHandle ToLocationHandle (EntityHandle InEntity)
+	{
+		return LocationHandle(InEntity.GetIndex(), InEntity.GetGeneration());
+	}
+
+	uint32 FindOrAddArchetype (ComponentMask InMask);
+
+	/** Makes a row for a new entity in the archetype, components are left unconstructed. */
+	EntityHandle AddEntity (uint32 InArchetypeIndex, uint32& OutRow);
+
+	/** Moves the entity into the archetype of its components plus/minus one, returns the new location. */
+	SEntityLocation MoveEntity (EntityHandle InEntity, ComponentMask InNewMask);
+
+	void* AddComponentUninitialized (EntityHandle InEntity, uint32 InComponentId);
+	bool RemoveComponent (EntityHandle InEntity, uint32 InComponentId);
+	void* FindComponent (EntityHandle InEntity, uint32 InComponentId) const;
+
+	/** Row InRow of the archetype was taken over by InEntity */
+	void OnRowMoved (EntityHandle InEntity, uint32 InRow);
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+	TSlotMap<SEntityLocation> Entities;
+	TArray<CArchetype> Archetypes;
+	TFlatMap<ComponentMask, uint32> ArchetypeIndices;
+#pragma warning(pop)
+
+	uint64 StructureVersion = 0u;
+};
+}
+
+
+namespace frt::ecs
+{
+template <typename... TComponents>
+EntityHandle CEntityRegistry::Create ()
+{
+	static_assert(sizeof...(TComponents) > 0u);
+	return Create<TComponents...>(TComponents()...);
+}
+
+template <typename... TComponents>
+EntityHandle CEntityRegistry::Create (TComponents&&... InComponents)
+{
+	const ComponentMask mask = MakeComponentMask<std::remove_cvref_t<TComponents>...>();
+	frt_assert((uint32)std::popcount(mask) == sizeof...(TComponents));
+
+	const uint32 archetypeIndex = FindOrAddArchetype(mask);
+	uint32 row = 0u;
+	const EntityHandle entity = AddEntity(archetypeIndex, row);
+
+	const CArchetype& archetype = Archetypes[archetypeIndex];
+	(new (archetype.GetComponent(row, GetComponentId<TComponents>())) std::remove_cvref_t<TComponents>(
+		std::forward<TComponents>(InComponents)), ...);
+
+	return entity;
+}
+
+template <typename TComponent, typename... Args>
+TComponent& CEntityRegistry::Add (EntityHandle InEntity, Args&&... InArgs)
+{
+	// Built up front, the arguments may point into the components the entity's move relocates
+	TComponent component(std::forward<Args>(InArgs)...);
+	void* slot = AddComponentUninitialized(InEntity, GetComponentId<TComponent>());
+	return *new (slot) TComponent(std::move(component));
+}
+
+template <typename TComponent>
+TComponent& CEntityRegistry::Get (EntityHandle InEntity)
+{
+	return const_cast<TComponent&>(static_cast<const CEntityRegistry&>(*this).Get<TComponent>(InEntity));
+}
+
+template <typename TComponent>
+const TComponent& CEntityRegistry::Get (EntityHandle InEntity) const
+{
+	const TComponent* component = Find<TComponent>(InEntity);
+	frt_assert(component);
+	return *component;
+}
+
+template <typename... TComponents>
+uint32 CEntityRegistry::CountMatching () const
+{
+	const ComponentMask mask = MakeComponentMask<TComponents...>();
+
+	uint32 count = 0u;
+	for (const CArchetype& archetype : Archetypes)
+	{
+		if ((archetype.GetMask() & mask) == mask)
+		{
+			count += archetype.Count();
+		}
+	}
+	return count;
+}
+
+template <typename... TComponents, typename TFunction>
+void CEntityRegistry::ForEach (TFunction&& InFunction)
+{
+	ForEachChunk<TComponents...>(
+		[&InFunction] (uint32 InRowCount, const EntityHandle* InHandles, TComponents*... InColumns)
+		{
+			for (uint32 row = 0; row < InRowCount; ++row)
+			{
+				if constexpr (std::is_invocable_v<TFunction&, EntityHandle, TComponents&...>)
+				{
+					InFunction(InHandles[row], InColumns[row]...);
+				}
+				else
+				{
+					InFunction(InColumns[row]...);
+				}
+			}
+		});
+}
+
+template <typename... TComponents, typename TFunction>
+void CEntityRegistry::ForEachChunk (TFunction&& InFunction)
+{
+	const ComponentMask mask = MakeComponentMask<TComponents...>();
+
+	for (CArchetype& archetype : Archetypes)
+	{
+		if ((archetype.GetMask() & mask) != mask)
+		{
+			continue;
+		}
+
+		const uint32 chunkCount = archetype.GetChunkCount();
+		for (uint32 chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+		{
+			InFunction(
+				archetype.GetChunkRowCount(chunkIndex),
+				static_cast<const EntityHandle*>(archetype.GetHandles(chunkIndex)),
+				archetype.template GetColumn<TComponents>(chunkIndex)...);
+		}
+	}
+}
+
+template <typename... TComponents, typename TFunction>
+void CEntityRegistry::ParallelForEach (TFunction&& InFunction)
+{
+	ParallelForEachChunk<TComponents...>(
+		[&InFunction] (uint32, uint32 InRowCount, const EntityHandle* InHandles, TComponents*... InColumns)
+		{
+			for (uint32 row = 0; row < InRowCount; ++row)
+			{
+				if constexpr (std::is_invocable_v<TFunction&, EntityHandle, TComponents&...>)
+				{
+					InFunction(InHandles[row], InColumns[row]...);
+				}
+				else
+				{
+					InFunction(InColumns[row]...);
+				}
+			}
+		});
+}
+
+template <typename... TComponents, typename TFunction>
+void CEntityRegistry::ParallelForEachChunk (TFunction&& InFunction)
+{
+	struct SChunkRef
+	{
+		CArchetype* Archetype;
+		uint32 ChunkIndex;
+		uint32 FirstIndex;
+	};
+
+	const ComponentMask mask = MakeComponentMask<TComponents...>();
+
+	// Same order as ForEachChunk
+	TArray<SChunkRef> chunks;
+	uint32 firstIndex = 0u;
+	for (CArchetype& archetype : Archetypes)
+	{
+		if ((archetype.GetMask() & mask) != mask)
+		{
+			continue;
+		}
+
+		const uint32 chunkCount = archetype.GetChunkCount();
+		for (uint32 chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+		{
+			chunks.Add(SChunkRef { &archetype, chunkIndex, firstIndex });
+			firstIndex += archetype.GetChunkRowCount(chunkIndex);
+		}
+	}
+
+	jobs::ParallelFor(chunks, 1u, [&InFunction] (const SChunkRef& InChunk)
+	{
+		CArchetype& archetype = *InChunk.Archetype;
+		InFunction(
+			InChunk.FirstIndex,
+			archetype.GetChunkRowCount(InChunk.ChunkIndex),
+			static_cast<const EntityHandle*>(archetype.GetHandles(InChunk.ChunkIndex)),
+			archetype.template GetColumn<TComponents>(InChunk.ChunkIndex)...);
+	});
+}
+}
@@ -1,9 +1,17 @@
 ﻿#include "Entity.h"
 
-void frt::CEntity::Tick(float DeltaSeconds)
+void frt::CEntity::SetRotationSpeed (const Vector3f& InSpeed) const
 {
-	if (RotationSpeed.SizeSquared() > 0.0f)
+	if (InSpeed.SizeSquared() == 0.0f)
 	{
-		Transform.RotateBy(RotationSpeed * DeltaSeconds);
+		RemoveComponent<Comp_RotationSpeed>();
+	}
+	else if (Comp_RotationSpeed* rotationSpeed = FindComponent<Comp_RotationSpeed>())
+	{
+		rotationSpeed->Speed = InSpeed;
+	}
+	else
+	{
+		AddComponent<Comp_RotationSpeed>(Comp_RotationSpeed { InSpeed });
 	}
 }
@@ -1,26 +1,52 @@
 ﻿#pragma once
 
+#include "Ecs/EntityRegistry.h"
 #include "Graphics/Model.h"
 #include "Math/Transform.h"
 
 
 namespace frt
 {
+struct Comp_RotationSpeed
+{
+	Vector3f Speed = Vector3f::ZeroVector; // TODO: temp, until there's gameplay code to move things
+};
+
+
+/**
+* View of one entity of a CEntityRegistry, for code that deals with a single entity at a time;
+* systems that touch many entities should query the registry instead.
+* Copies are cheap and all of them refer to the same entity; every accessor looks the components up again,
+* so a CEntity stays safe to hold across spawns and despawns of others.
+*/
 class CEntity
 {
 public:
-	// temp implementation
-	void Tick (float DeltaSeconds);
+	CEntity (ecs::CEntityRegistry& InRegistry, EntityHandle InHandle) : Registry(&InRegistry), Handle(InHandle) {}
+
+	EntityHandle GetHandle () const { return Handle; }
+	bool IsAlive () const { return Registry->IsAlive(Handle); }
 
-	const math::STransform& GetTransform () const { return Transform; }
-	math::STransform Transform;
-	Vector3f RotationSpeed = Vector3f::ZeroVector; // TODO: also temp
+	math::STransform& GetTransform () const { return Registry->Get<math::STransform>(Handle); }
+	graphics::Comp_RenderModel& GetRenderModel () const { return Registry->Get<graphics::Comp_RenderModel>(Handle); }
 
-	// TODO: These are here temporary
-	const memory::TRefShared<graphics::Comp_RenderModel>& GetRenderModel () const { return RenderModel; }
-	memory::TRefShared<graphics::Comp_RenderModel> RenderModel;
-	bool bRayTraced = true; // TODO: should be per-material
+	/** Zero speed removes the component, so entities that don't rotate are not visited by the update. */
+	void SetRotationSpeed (const Vector3f& InSpeed) const;
 
+	template <typename TComponent>
+	TComponent* FindComponent () const { return Registry->Find<TComponent>(Handle); }
+
+	template <typename TComponent, typename... Args>
+	TComponent& AddComponent (Args&&... InArgs) const
+	{
+		return Registry->Add<TComponent>(Handle, std::forward<Args>(InArgs)...);
+	}
+
+	template <typename TComponent>
+	bool RemoveComponent () const { return Registry->Remove<TComponent>(Handle); }
+
+private:
+	ecs::CEntityRegistry* Registry = nullptr;
+	EntityHandle Handle;
 };
 }
-
@@ -1,4 +1,4 @@
-#include "GameInstance.h"
+﻿#include "GameInstance.h"
 
 #include <filesystem>
 #include <iostream>
@@ -90,8 +90,14 @@ GameInstance::GameInstance ()
 	: FrameCount(0)
 	, World(*this)
 {
-	MemoryPool = memory::CMemoryPool(2_Gb);
+	FrameTimeHistory.SetOverwriteOldest(true);
+
+	MemoryPool = memory::CMemoryPool(2_Gb, memory::EMemoryPoolFlags::ThreadSafe);
 	MemoryPool.MakeThisPrimaryInstance();
+	FrameArena = memory::CFrameArena(&MemoryPool, 4_Mb);
+	FrameArena.MakeThisPrimaryInstance();
+	JobSystem = MemoryPool.NewUnique<jobs::CJobSystem>();
+	JobSystem->MakeThisPrimaryInstance();
 
 	Timer = new CTimer;
 
@@ -114,11 +120,17 @@ GameInstance::GameInstance ()
 	InputSystem.SetDefaultWindow(
 		static_cast<input::WindowId>(reinterpret_cast<uintptr_t>(Window->GetHandle())));
 
-	Renderer = MemoryPool.NewUnique<CRenderer>(Window);
-	Renderer->Resize(UserSettings.DisplaySettings.FullscreenMode == EFullscreenMode::Fullscreen);
-	DisplayOptions = graphics::GetDisplayOptions(Renderer->GetAdapter());
+	{
+		FRT_MEMORY_TAG_SCOPE(Renderer);
+		Renderer = MemoryPool.NewUnique<CRenderer>(Window);
+		Renderer->Resize(UserSettings.DisplaySettings.FullscreenMode == EFullscreenMode::Fullscreen);
+		DisplayOptions = graphics::GetDisplayOptions(Renderer->GetAdapter());
+	}
 
-	World.Initialize();
+	{
+		FRT_MEMORY_TAG_SCOPE(World);
+		World.Initialize();
+	}
 	MeshRenderer = World.MeshRenderer.GetWeak();
 
 	Camera = memory::NewShared<CCamera>();
@@ -128,7 +140,10 @@ GameInstance::GameInstance ()
 	World = MemoryPool.NewUnique<Sys_MeshRenderer>();
 #endif
 
-	ActiveActionMap = InputActionLibrary.LoadOrCreateActionMap(GetDefaultInputMapPath());
+	{
+		FRT_MEMORY_TAG_SCOPE(Input);
+		ActiveActionMap = InputActionLibrary.LoadOrCreateActionMap(GetDefaultInputMapPath());
+	}
 
 #if !defined(FRT_HEADLESS)
 	IMGUI_CHECKVERSION();
@@ -181,6 +196,8 @@ GameInstance::~GameInstance ()
 
 	delete Window;
 	Window = nullptr;
+#else
+	MemoryPool.PrintReport();
 #endif
 
 	delete Timer;
@@ -221,70 +238,72 @@ input::CInputActionMap* GameInstance::GetActiveInputActionMap ()
 
 void GameInstance::Load ()
 {
+	FRT_MEMORY_TAG_SCOPE(Assets);
+
 	std::cout << std::filesystem::current_path() << std::endl;
 
 	std::filesystem::path floorMaterialPath =
 		std::filesystem::path("../Core/Content/Models/Floor") / ("floor_mat" + std::to_string(0) + ".frtmat");
-	auto floor = World.SpawnEntity();
-	floor->RenderModel->Model = memory::NewShared<SRenderModel>(
+	const CEntity floor = World.GetEntity(World.SpawnEntity());
+	floor.GetRenderModel().Model = memory::NewShared<SRenderModel>(
 		SRenderModel::FromMesh(
 			mesh::GenerateGrid(10.f, 10.f, 16u, 16u),
 			Renderer->GetMaterialLibrary().LoadOrCreateMaterial(floorMaterialPath, {})));
-	floor->bRayTraced = true;
-	floor->Transform.SetTranslation(0.f, -1.f, 0.f);
+	floor.GetRenderModel().bRayTraced = true;
+	floor.GetTransform().SetTranslation(0.f, -1.f, 0.f);
 
 	std::filesystem::path pillarMaterialPath =
 		std::filesystem::path("../Core/Content/Models/Pillar") / ("pillar_mat" + std::to_string(0) + ".frtmat");
-	auto pillar = World.SpawnEntity();
-	pillar->RenderModel->Model = memory::NewShared<SRenderModel>(
+	const CEntity pillar = World.GetEntity(World.SpawnEntity());
+	pillar.GetRenderModel().Model = memory::NewShared<SRenderModel>(
 		SRenderModel::FromMesh(
 			mesh::GenerateCube(Vector3f(.65f, 1.8f, .65f), 1),
 			// mesh::GenerateCylinder(0.65f, 0.65f, 1.8f, 20u, 2u),
 			Renderer->GetMaterialLibrary().LoadOrCreateMaterial(pillarMaterialPath, {})));
-	pillar->bRayTraced = true;
-	pillar->Transform.SetTranslation(-2.5f, -0.2f, 0.f);
+	pillar.GetRenderModel().bRayTraced = true;
+	pillar.GetTransform().SetTranslation(-2.5f, -0.2f, 0.f);
 
 	std::filesystem::path cubeMaterialPath =
 		std::filesystem::path("../Core/Content/Models/Cube") / ("cube_mat" + std::to_string(0) + ".frtmat");
-	auto cube = World.SpawnEntity();
-	cube->RenderModel->Model = memory::NewShared<SRenderModel>(
+	const CEntity cube = World.GetEntity(World.SpawnEntity());
+	cube.GetRenderModel().Model = memory::NewShared<SRenderModel>(
 		SRenderModel::FromMesh(
 			mesh::GenerateCube(Vector3f(1.f), 1),
 			Renderer->GetMaterialLibrary().LoadOrCreateMaterial(cubeMaterialPath, {})));
-	cube->Transform.SetTranslation(1.5f, 0.f, -1.5f);
+	cube.GetTransform().SetTranslation(1.5f, 0.f, -1.5f);
 
 	// Cylinder = World->SpawnEntity();
 	// Cylinder->RenderModel.Model = memory::NewShared<graphics::SRenderModel>(
 	// 	graphics::SRenderModel::FromMesh(mesh::GenerateCylinder(1.f, 0.5, 1.f, 10u, 10u)));
 
 	Sphere = World.SpawnEntity();
-	Sphere->RenderModel->Model = memory::NewShared<graphics::SRenderModel>(
+	World.GetEntity(Sphere).GetRenderModel().Model = memory::NewShared<graphics::SRenderModel>(
 		graphics::SRenderModel::FromMesh(mesh::GenerateSphere(.3f, 30u, 30u)));
 
-	auto skullEnt = World.SpawnEntity();
-	skullEnt->RenderModel->Model = memory::NewShared<graphics::SRenderModel>(
+	const CEntity skullEnt = World.GetEntity(World.SpawnEntity());
+	skullEnt.GetRenderModel().Model = memory::NewShared<graphics::SRenderModel>(
 		graphics::SRenderModel::LoadFromFile(
 			R"(..\Core\Content\Models\Skull\scene.gltf)",
 			R"(..\Core\Content\Models\Skull\textures\defaultMat_baseColor.jpeg)"));
-	skullEnt->Transform.SetTranslation(-2.5f, 1.5f, 0.f);
-	skullEnt->Transform.SetScale(Vector3f(.45f));
-	skullEnt->RotationSpeed = Vector3f::UpVector * (math::PI_OVER_FOUR * 0.25f);
+	skullEnt.GetTransform().SetTranslation(-2.5f, 1.5f, 0.f);
+	skullEnt.GetTransform().SetScale(Vector3f(.45f));
+	skullEnt.SetRotationSpeed(Vector3f::UpVector * (math::PI_OVER_FOUR * 0.25f));
 
-	auto duckEnt = World.SpawnEntity();
-	duckEnt->RenderModel->Model = memory::NewShared<graphics::SRenderModel>(
+	const CEntity duckEnt = World.GetEntity(World.SpawnEntity());
+	duckEnt.GetRenderModel().Model = memory::NewShared<graphics::SRenderModel>(
 		graphics::SRenderModel::LoadFromFile(
 			R"(..\Core\Content\Models\Duck\Duck.gltf)",
 			R"(..\Core\Content\Models\Duck\DuckCM.png)"));
-	duckEnt->Transform.SetTranslation(0.f, 0.f, 0.f);
+	duckEnt.GetTransform().SetTranslation(0.f, 0.f, 0.f);
 
-	auto head = World.SpawnEntity();
-	head->RenderModel->Model = memory::NewShared<graphics::SRenderModel>(
+	const CEntity head = World.GetEntity(World.SpawnEntity());
+	head.GetRenderModel().Model = memory::NewShared<graphics::SRenderModel>(
 		graphics::SRenderModel::LoadFromFile(
 			R"(..\Core\Content\Models\Head\1\african_head.obj)",
 			R"(..\Core\Content\Models\Head\1\african_head_diffuse.jpg)"));
-	head->Transform.SetTranslation(2.5f, 1.5f, 0.f);
-	head->Transform.SetScale(Vector3f(.45f));
-	head->RotationSpeed = Vector3f::UpVector * (math::PI_OVER_FOUR * 0.25f);
+	head.GetTransform().SetTranslation(2.5f, 1.5f, 0.f);
+	head.GetTransform().SetScale(Vector3f(.45f));
+	head.SetRotationSpeed(Vector3f::UpVector * (math::PI_OVER_FOUR * 0.25f));
 
 	// TODO: When Sponza is added, the renderer crashes. Probably multiple sections aren't handled properly
 	// auto sponzaEnt = World->SpawnEntity();
@@ -298,20 +317,20 @@ void GameInstance::Load ()
 	std::filesystem::path lightMaterialPath =
 		std::filesystem::path("../Core/Content/Light") / ("light_mat" + std::to_string(0) + ".frtmat");
 
-	auto lightSource1 = World.SpawnEntity();
-	lightSource1->RenderModel->Model = memory::NewShared<graphics::SRenderModel>(
+	const CEntity lightSource1 = World.GetEntity(World.SpawnEntity());
+	lightSource1.GetRenderModel().Model = memory::NewShared<graphics::SRenderModel>(
 		SRenderModel::FromMesh(mesh::GenerateSphere(.3f, 30u, 30u),
 			Renderer->GetMaterialLibrary().LoadOrCreateMaterial(lightMaterialPath, {})));
-	lightSource1->Transform.SetTranslation(0.f, 2.f, -3.f);
+	lightSource1.GetTransform().SetTranslation(0.f, 2.f, -3.f);
 
 	std::filesystem::path lightMaterialPath2 =
 		std::filesystem::path("../Core/Content/Light") / ("light_mat" + std::to_string(2) + ".frtmat");
 
-	auto lightSource2 = World.SpawnEntity();
-	lightSource2->RenderModel->Model = memory::NewShared<graphics::SRenderModel>(
+	const CEntity lightSource2 = World.GetEntity(World.SpawnEntity());
+	lightSource2.GetRenderModel().Model = memory::NewShared<graphics::SRenderModel>(
 		SRenderModel::FromMesh(mesh::GenerateQuad(1.f, 1.f),
 			Renderer->GetMaterialLibrary().LoadOrCreateMaterial(lightMaterialPath2, {})));
-	lightSource2->Transform.SetTranslation(-2.5f, 2.5f, 0.f);
+	lightSource2.GetTransform().SetTranslation(-2.5f, 2.5f, 0.f);
 	// lightSource2->Transform.SetRotation(math::PI, 0.f, 0.f);
 
 	/*memory::TRefShared<CEntity> walls[3];
@@ -350,7 +369,12 @@ void GameInstance::Input (float DeltaSeconds)
 	}
 
 #ifndef FRT_HEADLESS
-	input::SInputActionState* EnableMoveState = ActiveActionMap->ActionMap.FindActionState("IA_EnableMove");
+	static const SName EnableMoveAction("IA_EnableMove");
+	static const SName MoveForwardAction("IA_MoveForward");
+	static const SName MoveLeftAction("IA_MoveLeft");
+	static const SName MoveUpAction("IA_MoveUp");
+
+	input::SInputActionState* EnableMoveState = ActiveActionMap->ActionMap.FindActionState(EnableMoveAction);
 	if (EnableMoveState && EnableMoveState->bDown)
 	{
 		// Look
@@ -362,11 +386,11 @@ void GameInstance::Input (float DeltaSeconds)
 
 		// Speed
 		Vector3f CameraMoveVector = Vector3f::ZeroVector;
-		input::SInputActionState* MoveForwardState = ActiveActionMap->ActionMap.FindActionState("IA_MoveForward");
+		input::SInputActionState* MoveForwardState = ActiveActionMap->ActionMap.FindActionState(MoveForwardAction);
 		CameraMoveVector += Vector3f::ForwardVector * MoveForwardState->Value;
-		input::SInputActionState* MoveLeftState = ActiveActionMap->ActionMap.FindActionState("IA_MoveLeft");
+		input::SInputActionState* MoveLeftState = ActiveActionMap->ActionMap.FindActionState(MoveLeftAction);
 		CameraMoveVector += Vector3f::LeftVector * MoveLeftState->Value;
-		input::SInputActionState* MoveUpState = ActiveActionMap->ActionMap.FindActionState("IA_MoveUp");
+		input::SInputActionState* MoveUpState = ActiveActionMap->ActionMap.FindActionState(MoveUpAction);
 		CameraMoveVector += Vector3f::UpVector * MoveUpState->Value;
 
 		// Move
@@ -407,6 +431,7 @@ void GameInstance::Input (float DeltaSeconds)
 void GameInstance::Tick (float DeltaSeconds)
 {
 	++FrameCount;
+	FrameArena.BeginFrame();
 
 #if !defined(FRT_HEADLESS)
 	ImGui_ImplDX12_NewFrame();
@@ -452,28 +477,39 @@ uint64 GameInstance::GetFrameCount () const
 	return FrameCount;
 }
 
-void GameInstance::CalculateFrameStats () const
+void GameInstance::CalculateFrameStats ()
 {
-	static int frameCount = 0;
-	static float timeElapsed = 0.f;
-
-	++frameCount;
-
-	static float fps = 0.f, msPerFrame = 0.f;
+	FrameTimeHistory.PushBack(Timer->GetDeltaSeconds());
 
-	if (Timer->GetTotalSeconds() - timeElapsed >= 1.f)
+	float totalSeconds = 0.f;
+	for (const float frameSeconds : FrameTimeHistory)
 	{
-		fps = static_cast<float>(frameCount);
-		msPerFrame = 1000.f / fps;
-
-		frameCount = 0;
-		timeElapsed += 1.f;
+		totalSeconds += frameSeconds;
 	}
 
+	const float msPerFrame = 1000.f * totalSeconds / static_cast<float>(FrameTimeHistory.Count());
+	const float fps = msPerFrame > 0.f ? 1000.f / msPerFrame : 0.f;
+
 #if !defined(FRT_HEADLESS)
 	ImGui::Begin("Stats", nullptr, ImGuiWindowFlags_NoResize);
 	ImGui::Text("FPS: %.2f", fps);
 	ImGui::Text("MS/frame: %.2f", msPerFrame);
+	ImGui::PlotLines(
+		"Frame times",
+		[] (void* History, int Index)
+		{
+			return 1000.f * (*static_cast<const decltype(FrameTimeHistory)*>(History))[static_cast<uint32>(Index)];
+		},
+		&FrameTimeHistory,
+		static_cast<int>(FrameTimeHistory.Count()));
+
+	const CSystemScheduler& systems = World.Systems;
+	for (uint32 i = 0u; i < systems.GetSystemCount(); ++i)
+	{
+		const CSystemScheduler::SSystemStats& stats = systems.GetStats(i);
+		ImGui::Text("%s: %.3f ms (avg %.3f)", systems.GetSystem(i).GetName(), stats.LastMilliseconds,
+			stats.AverageMilliseconds);
+	}
 	ImGui::End();
 #else
 	std::printf("FPS: %.2f; MS/frame: %.2f\n", fps, msPerFrame);
@@ -651,31 +687,31 @@ void GameInstance::UpdateEntities (float DeltaSeconds)
 	float Radius = 1.0f;
 	float Height = std::sin(VerticalTime * 2.0f) * 0.5f; // Oscillates between -0.5 and 0.5
 
-	if (Cube)
+	if (const std::optional<CEntity> cube = World.FindEntity(Cube))
 	{
 		Vector3f CubePos;
 		CubePos.x = (Radius + 0.6f) * std::sin(Angle) + 1.f;
 		CubePos.y = Height;
 		CubePos.z = (Radius + 0.6f) * std::cos(Angle);
-		Cube->Transform.SetTranslation(CubePos);
+		cube->GetTransform().SetTranslation(CubePos);
 	}
 
-	if (Sphere)
+	if (const std::optional<CEntity> sphere = World.FindEntity(Sphere))
 	{
 		Vector3f SpherePos;
 		SpherePos.x = (Radius + 1.0f) * std::sin(-Angle) + 1.f;
 		SpherePos.y = -Height;
 		SpherePos.z = (Radius + 1.0f) * std::cos(-Angle);
-		Sphere->Transform.SetTranslation(SpherePos);
+		sphere->GetTransform().SetTranslation(SpherePos);
 	}
 
-	if (Cylinder)
+	if (const std::optional<CEntity> cylinder = World.FindEntity(Cylinder))
 	{
 		Vector3f CylinderPos;
 		CylinderPos.x = (Radius - .5f) * std::sin(-Angle) + 1.f;
 		CylinderPos.y = -Height + 0.1f;
 		CylinderPos.z = (Radius - .5f) * std::cos(-Angle);
-		Cylinder->Transform.SetTranslation(CylinderPos);
+		cylinder->GetTransform().SetTranslation(CylinderPos);
 	}
 }
 
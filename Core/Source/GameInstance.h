@@ -5,9 +5,12 @@
 #include "Window.h"
 #include "Sys_MeshRenderer.h"
 #include "WorldScene.h"
+#include "Containers/RingBuffer.h"
 #include "Graphics/Render/RenderCommonTypes.h"
 #include "Input/InputActionLibrary.h"
 #include "Input/InputSystem.h"
+#include "Jobs/JobSystem.h"
+#include "Memory/FrameArena.h"
 #include "Memory/MemoryPool.h"
 #include "Memory/Ref.h"
 #include "User/UserSettings.h"
@@ -75,7 +78,7 @@ public:
 	const CWorldScene& GetWorldScene () const { return World; }
 
 protected:
-	void CalculateFrameStats () const;
+	void CalculateFrameStats ();
 
 #ifndef FRT_HEADLESS
 	virtual void OnWindowResize ();
@@ -89,6 +92,8 @@ protected:
 
 protected:
 	memory::CMemoryPool MemoryPool;
+	memory::CFrameArena FrameArena;
+	memory::TRefUnique<jobs::CJobSystem> JobSystem;
 	CTimer* Timer;
 #ifndef FRT_HEADLESS
 	CWindow* Window;
@@ -103,9 +108,9 @@ protected:
 	input::SInputActionMapAsset* ActiveActionMap = nullptr;
 
 	// temp
-	memory::TRefShared<CEntity> Cube;
-	memory::TRefShared<CEntity> Cylinder;
-	memory::TRefShared<CEntity> Sphere;
+	EntityHandle Cube;
+	EntityHandle Cylinder;
+	EntityHandle Sphere;
 	void UpdateEntities (float DeltaSeconds);
 	// ~temp
 
@@ -114,6 +119,9 @@ protected:
 
 	uint64 FrameCount;
 
+	/** Durations of the last frames in seconds, oldest first; the frame stats are averaged over it. */
+	TInlineRingBuffer<float, 128> FrameTimeHistory;
+
 	bool bCameraMovementEnabled = false;
 };
 
@@ -627,17 +627,17 @@ CRayTracingPipelineGenerator::SRootSignatureAssociation::SRootSignatureAssociati
 
 void CShaderBindingTableGenerator::AddRayGenerationProgram (
 	const std::wstring& EntryPoint,
-	const TArray<void*>& InputData)
+	const InputDataArray& InputData)
 {
 	RayGen.Emplace(EntryPoint, InputData);
 }
 
-void CShaderBindingTableGenerator::AddMissProgram (const std::wstring& EntryPoint, const TArray<void*>& InputData)
+void CShaderBindingTableGenerator::AddMissProgram (const std::wstring& EntryPoint, const InputDataArray& InputData)
 {
 	Miss.Emplace(EntryPoint, InputData);
 }
 
-void CShaderBindingTableGenerator::AddHitGroup (const std::wstring& EntryPoint, const TArray<void*>& InputData)
+void CShaderBindingTableGenerator::AddHitGroup (const std::wstring& EntryPoint, const InputDataArray& InputData)
 {
 	HitGroup.Emplace(EntryPoint, InputData);
 }
@@ -776,7 +776,7 @@ uint32 CShaderBindingTableGenerator::GetEntrySize (const TArray<SSBTEntry>& Entr
 	return entrySize;
 }
 
-CShaderBindingTableGenerator::SSBTEntry::SSBTEntry (const std::wstring& InEntryPoint, const TArray<void*>& InInputData)
+CShaderBindingTableGenerator::SSBTEntry::SSBTEntry (const std::wstring& InEntryPoint, const InputDataArray& InInputData)
 	: EntryPoint(InEntryPoint)
 	, InputData(std::move(InInputData))
 {}
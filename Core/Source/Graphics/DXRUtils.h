@@ -29,6 +29,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string>
 
 #include "Containers/Array.h"
+#include "Containers/InlineArray.h"
 #include "Graphics/Render/RenderResourceAllocators.h"
 
 
@@ -380,20 +381,23 @@ private:
 class CShaderBindingTableGenerator
 {
 public:
+	/** Root arguments of one entry; the renderer binds up to 6 per hit group */
+	using InputDataArray = TInlineArray<void*, 6u>;
+
 	/**
 	 * Add a ray generation program by name, with its list of data pointers or values according to the layout of its root signature
 	 */
-	void AddRayGenerationProgram (const std::wstring& EntryPoint, const TArray<void*>& InputData);
+	void AddRayGenerationProgram (const std::wstring& EntryPoint, const InputDataArray& InputData);
 
 	/**
 	 * Add a miss program by name, with its list of data pointers or values according to the layout of its root signature
 	 */
-	void AddMissProgram (const std::wstring& EntryPoint, const TArray<void*>& InputData);
+	void AddMissProgram (const std::wstring& EntryPoint, const InputDataArray& InputData);
 
 	/**
 	 * Add a hit group by name, with its list of data pointers or values according to the layout of its root signature
 	 */
-	void AddHitGroup (const std::wstring& EntryPoint, const TArray<void*>& InputData);
+	void AddHitGroup (const std::wstring& EntryPoint, const InputDataArray& InputData);
 
 	uint32 ComputeSBTSize ();
 
@@ -413,9 +417,9 @@ public:
 private:
 	struct SSBTEntry
 	{
-		SSBTEntry (const std::wstring& InEntryPoint, const TArray<void*>& InInputData);
+		SSBTEntry (const std::wstring& InEntryPoint, const InputDataArray& InInputData);
 		std::wstring EntryPoint;
-		TArray<void*> InputData;
+		InputDataArray InputData;
 	};
 
 
@@ -71,8 +71,8 @@ SRenderModel SRenderModel::LoadFromFile (const std::string& Filename, const std:
 		defaultMaterial.Name = materialName.empty()
 									? materialBaseName + "_mat" + std::to_string(materialIndex)
 									: materialName;
-		defaultMaterial.VertexShaderName = "VertexShader";
-		defaultMaterial.PixelShaderName = "PixelShader";
+		defaultMaterial.VertexShaderName = SName("VertexShader");
+		defaultMaterial.PixelShaderName = SName("PixelShader");
 
 		std::filesystem::path materialPath =
 			materialDir / (materialBaseName + "_mat" + std::to_string(materialIndex) + ".frtmat");
@@ -109,7 +109,7 @@ SRenderModel SRenderModel::LoadFromFile (const std::string& Filename, const std:
 
 	// Sections
 	const int32 meshesNum = (int32)scene->mNumMeshes;
-	result.Sections = TArray<SRenderSection>(meshesNum);
+	result.Sections.Reset((uint32)meshesNum);
 
 	int32 indexNum = 0;
 	int32 vertexNum = 0;
@@ -244,8 +244,8 @@ SRenderModel SRenderModel::FromMesh (SMesh&& Mesh, memory::TRefShared<SMaterial>
 	else
 	{
 		memory::TRefShared<SMaterial> material = memory::NewShared<SMaterial>();
-		material->VertexShaderName = "VertexShader";
-		material->PixelShaderName = "PixelShader";
+		material->VertexShaderName = SName("VertexShader");
+		material->PixelShaderName = SName("PixelShader");
 		result.Materials.Add(material);
 	}
 
@@ -5,7 +5,9 @@
 #include "Core.h"
 #include "Mesh.h"
 #include "Containers/Array.h"
+#include "Containers/InlineArray.h"
 #include "Memory/Ref.h"
+#include "Memory/SlabAllocator.h"
 #include "Render/ConstantBuffer.h"
 #include "Render/GraphicsCoreTypes.h"
 #include "Render/Material.h"
@@ -33,7 +35,7 @@ struct FRT_CORE_API SRenderSection
 
 struct FRT_CORE_API SRenderModel
 {
-	TArray<SRenderSection> Sections;
+	TInlineArray<SRenderSection, 1u> Sections;
 	TArray<memory::TRefShared<SMaterial>> Materials;
 
 	TArray<SVertex> Vertices;
@@ -45,10 +47,12 @@ struct FRT_CORE_API SRenderModel
 	static SRenderModel LoadFromFile (const std::string& Filename, const std::string& TexturePath);
 	static SRenderModel FromMesh (SMesh&& Mesh, memory::TRefShared<SMaterial> Material = nullptr);
 };
+FRT_DECLARE_THREAD_SAFE_REFS(SRenderModel)
 
 struct FRT_CORE_API Comp_RenderModel
 {
 	memory::TRefShared<SRenderModel> Model;
+	bool bRayTraced = true; // TODO: should be per-material
 
 	// TODO: material overrides, bone pose, per-instance params.
 };
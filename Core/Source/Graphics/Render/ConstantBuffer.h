@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "CoreTypes.h"
+#include "Memory/FrameArena.h"
 #include "Memory/Memory.h"
 #include "RenderResourceAllocators.h"
 
@@ -18,7 +19,15 @@ struct SConstantBuffer
 	ID3D12Resource* GpuResource = nullptr;
 	std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> DescriptorHeapHandleGpu;
 
-	uint64 UploadOffset = 0;
+	/** Staged in the upload arena, waiting for Upload */
+	struct SPendingCopy
+	{
+		uint64 UploadOffset = 0;
+		uint32 FirstObject = 0;
+		uint32 ObjectCount = 0;
+	};
+
+	std::vector<SPendingCopy> PendingCopies;
 	uint32 ObjectCount = 0;
 
 	SConstantBuffer () = default;
@@ -29,6 +38,9 @@ struct SConstantBuffer
 		uint32 InObjectCount = 1);
 
 	void CopyBunch (TData* Data, uint32 Count, DX12_UploadArena& UploadArena);
+	/** Stages Count objects to overwrite the ones from FirstObject on; the rest of the buffer keeps its data. */
+	void CopyRange (const TData* Data, uint32 FirstObject, uint32 Count, DX12_UploadArena& UploadArena);
+	/** Records the copies staged since the last call, does nothing if there are none. */
 	void Upload (DX12_UploadArena& UploadArena, ID3D12GraphicsCommandList* CommandList);
 	void RebuildDescriptors (ID3D12Device* Device, DX12_DescriptorHeap& DescriptorHeap);
 };
@@ -85,16 +97,47 @@ void SConstantBuffer<TData>::CopyBunch (TData* Data, uint32 Count, DX12_UploadAr
 	const uint32 copyCount = Count < ObjectCount ? Count : ObjectCount;
 	const uint64 totalSize = DataSize * ObjectCount;
 
-	auto staging = static_cast<uint8*>(memory::NewUnmanaged(totalSize));
+	// Staging dies with the frame, so there's nothing to free
+	auto staging = static_cast<uint8*>(memory::CFrameArena::GetPrimaryInstance()->Allocate(totalSize));
 	memset(staging, 0, totalSize);
 	for (uint32 i = 0; i < copyCount; ++i)
 	{
 		memcpy(staging + DataSize * i, Data + i, sizeof(TData));
 	}
 
-	uint8* dest = UploadArena.Allocate(totalSize, &UploadOffset);
+	SPendingCopy& copy = PendingCopies.emplace_back();
+	copy.FirstObject = 0u;
+	copy.ObjectCount = ObjectCount;
+	uint8* dest = UploadArena.Allocate(totalSize, &copy.UploadOffset);
 	memcpy(dest, staging, totalSize);
-	memory::DestroyUnmanaged(staging);
+}
+
+template <typename TData>
+void SConstantBuffer<TData>::CopyRange (
+	const TData* Data,
+	uint32 FirstObject,
+	uint32 Count,
+	DX12_UploadArena& UploadArena)
+{
+	if (!Data || FirstObject >= ObjectCount)
+	{
+		return;
+	}
+
+	const uint32 copyCount = Count < ObjectCount - FirstObject ? Count : ObjectCount - FirstObject;
+	if (copyCount == 0u)
+	{
+		return;
+	}
+
+	SPendingCopy& copy = PendingCopies.emplace_back();
+	copy.FirstObject = FirstObject;
+	copy.ObjectCount = copyCount;
+	uint8* dest = UploadArena.Allocate(DataSize * copyCount, &copy.UploadOffset);
+	for (uint32 i = 0; i < copyCount; ++i)
+	{
+		memcpy(dest + DataSize * i, Data + i, sizeof(TData));
+	}
 }
 
 template <typename TData>
@@ -102,6 +145,11 @@ void SConstantBuffer<TData>::Upload (
 	DX12_UploadArena& UploadArena,
 	ID3D12GraphicsCommandList* CommandList)
 {
+	if (PendingCopies.empty())
+	{
+		return;
+	}
+
 	{
 		D3D12_RESOURCE_BARRIER resourceBarrier = {};
 		resourceBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -112,13 +160,16 @@ void SConstantBuffer<TData>::Upload (
 		CommandList->ResourceBarrier(1, &resourceBarrier);
 	}
 
-	CommandList->CopyBufferRegion(
-		GpuResource,
-		0,
-		UploadArena.GetGPUBuffer(),
-		UploadOffset,
-		DataSize * ObjectCount);
-	UploadOffset = 0;
+	for (const SPendingCopy& copy : PendingCopies)
+	{
+		CommandList->CopyBufferRegion(
+			GpuResource,
+			DataSize * copy.FirstObject,
+			UploadArena.GetGPUBuffer(),
+			copy.UploadOffset,
+			DataSize * copy.ObjectCount);
+	}
+	PendingCopies.clear();
 
 	{
 		D3D12_RESOURCE_BARRIER resourceBarrier = {};
@@ -51,6 +51,7 @@ void SFrameResources::EnsureObjectCapacity (
 	}
 
 	ObjectCB = SConstantBuffer<SObjectConstants>(Device, BufferArena, DescriptorHeap, ObjectCount);
+	ObjectCBLayoutVersion = ~0ull;
 }
 
 void SFrameResources::EnsureMaterialCapacity (
@@ -82,6 +82,13 @@ struct SFrameResources
 	SConstantBuffer<SMaterialConstants> MaterialCB;
 	DX12_UploadArena UploadArena;
 
+	/**
+	* What ObjectCB holds: the registry structure version it was filled at (objects keep their index while it holds)
+	* and the transform hierarchy frame it is up to date with, so only matrices changed since then are copied.
+	*/
+	uint64 ObjectCBLayoutVersion = ~0ull;
+	uint64 ObjectCBFrame = 0;
+
 	uint64 FenceValue = 0;
 
 	SFrameResources () = default;
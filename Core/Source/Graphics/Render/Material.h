@@ -6,8 +6,11 @@
 #include "Core.h"
 #include "CoreTypes.h"
 #include "Enum.h"
+#include "Name.h"
 #include "Texture.h"
 #include "Graphics/SColor.h"
+#include "Memory/Ref.h"
+#include "Memory/SlabAllocator.h"
 
 
 namespace frt::graphics
@@ -24,8 +27,8 @@ struct FRT_CORE_API SMaterial
 	static constexpr uint32 InvalidTextureIndex = 0xFFFFFFFFu;
 
 	std::string Name;
-	std::string VertexShaderName;
-	std::string PixelShaderName;
+	SName VertexShaderName;
+	SName PixelShaderName;
 	std::string BaseColorTexturePath;
 	std::filesystem::path SourcePath;
 	std::filesystem::file_time_type LastWriteTime;
@@ -49,4 +52,6 @@ struct FRT_CORE_API SMaterial
 	bool bHasBaseColorTexture = false;
 	std::filesystem::path LoadedBaseColorTexturePath;
 };
+FRT_DECLARE_SLAB_POOL(SMaterial)
+FRT_DECLARE_THREAD_SAFE_REFS(SMaterial)
 }
@@ -129,16 +129,15 @@ memory::TRefShared<SMaterial> CMaterialLibrary::LoadOrCreateMaterial (
 	const std::filesystem::path& MaterialPath,
 	const SMaterial& DefaultMaterial)
 {
-	const std::string key = MakeKey(MaterialPath);
-	auto it = Materials.find(key);
-	if (it != Materials.end())
+	const SName key = MakeKey(MaterialPath);
+	if (const SMaterialRecord* existing = Materials.Find(key))
 	{
-		return it->second.Material;
+		return existing->Material;
 	}
 
 	SMaterialRecord record;
 	record.Material = LoadMaterialFromFile(MaterialPath, DefaultMaterial, true);
-	Materials.emplace(key, record);
+	Materials.Add(key, record);
 	return record.Material;
 }
 
@@ -147,12 +146,12 @@ bool CMaterialLibrary::ReloadModifiedMaterials ()
 	bool anyReloaded = false;
 	for (auto& entry : Materials)
 	{
-		if (!entry.second.Material)
+		if (!entry.Value.Material)
 		{
 			continue;
 		}
 
-		SMaterial& material = *entry.second.Material;
+		SMaterial& material = *entry.Value.Material;
 		if (material.SourcePath.empty())
 		{
 			continue;
@@ -251,11 +250,11 @@ bool CMaterialLibrary::ParseMaterialFile (const std::filesystem::path& MaterialP
 		}
 		else if (key == "vertex_shader")
 		{
-			Material.VertexShaderName = value;
+			Material.VertexShaderName = SName(value);
 		}
 		else if (key == "pixel_shader")
 		{
-			Material.PixelShaderName = value;
+			Material.PixelShaderName = SName(value);
 		}
 		else if (key == "color")
 		{
@@ -320,8 +319,8 @@ bool CMaterialLibrary::SaveMaterialFile (const std::filesystem::path& MaterialPa
 	stream << "version: " << MaterialFileVersion << "\n";
 	stream << "# FRT material\n";
 	stream << "name: " << Material.Name << "\n";
-	stream << "vertex_shader: " << Material.VertexShaderName << "\n";
-	stream << "pixel_shader: " << Material.PixelShaderName << "\n";
+	stream << "vertex_shader: " << Material.VertexShaderName.ToString() << "\n";
+	stream << "pixel_shader: " << Material.PixelShaderName.ToString() << "\n";
 	stream << "color: " << Material.DiffuseAlbedo.ToString() << "\n";
 	stream << "metallic: " << Material.Metallic << "\n";
 	stream << "roughness: " << Material.Roughness << "\n";
@@ -404,7 +403,7 @@ void CMaterialLibrary::EnsureBaseColorTexture (SMaterial& Material) const
 		srvDesc.Texture2D.PlaneSlice = 0;
 
 		D3D12_CPU_DESCRIPTOR_HANDLE cpuDescriptor = {};
-		Renderer->CreateShaderResourceView(newTexture.GpuTexture, srvDesc, &cpuDescriptor, &newTexture.GpuDescriptor);
+		newTexture.GpuDescriptor = Renderer->CreateShaderResourceView(newTexture.GpuTexture, srvDesc, &cpuDescriptor);
 	}
 #endif
 
@@ -413,8 +412,8 @@ void CMaterialLibrary::EnsureBaseColorTexture (SMaterial& Material) const
 	Material.LoadedBaseColorTexturePath = texturePath;
 }
 
-std::string CMaterialLibrary::MakeKey (const std::filesystem::path& MaterialPath)
+SName CMaterialLibrary::MakeKey (const std::filesystem::path& MaterialPath)
 {
-	return MaterialPath.lexically_normal().string();
+	return SName(MaterialPath.lexically_normal().string());
 }
 }
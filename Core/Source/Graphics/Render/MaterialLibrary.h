@@ -2,9 +2,10 @@
 
 #include <filesystem>
 #include <string>
-#include <unordered_map>
 
 #include "Core.h"
+#include "Name.h"
+#include "Containers/HashMap.h"
 #include "Memory/Ref.h"
 
 
@@ -41,9 +42,9 @@ private:
 	bool SaveMaterialFile (const std::filesystem::path& MaterialPath, const SMaterial& Material) const;
 	void EnsureBaseColorTexture (SMaterial& Material) const;
 
-	static std::string MakeKey (const std::filesystem::path& MaterialPath);
+	static SName MakeKey (const std::filesystem::path& MaterialPath);
 
-	std::unordered_map<std::string, SMaterialRecord> Materials;
+	THashMap<SName, SMaterialRecord> Materials;
 	CRenderer* Renderer = nullptr;
 };
 }
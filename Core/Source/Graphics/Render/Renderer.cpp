@@ -716,38 +716,34 @@ void CRenderer::ProcessPendingResourceUploads ()
 
 	frt_assert(bCommandListRecording);
 
-	for (uint32 i = 0; i < PendingBufferUploads.Count(); ++i)
+	while (!PendingBufferUploads.IsEmpty())
 	{
-		SPendingBufferUpload& upload = PendingBufferUploads[i];
-		if (!upload.Resource)
+		const SPendingBufferUpload& upload = PendingBufferUploads.First();
+		if (upload.Resource)
 		{
-			continue;
+			RecordBufferUpload(
+				upload.Resource,
+				static_cast<uint64>(upload.Data.Count()),
+				upload.Data.GetData(),
+				upload.FinalState);
 		}
-
-		RecordBufferUpload(
-			upload.Resource,
-			static_cast<uint64>(upload.Data.Count()),
-			upload.Data.GetData(),
-			upload.FinalState);
+		PendingBufferUploads.RemoveFront();
 	}
-	PendingBufferUploads.Clear();
 
-	for (uint32 i = 0; i < PendingTextureUploads.Count(); ++i)
+	while (!PendingTextureUploads.IsEmpty())
 	{
-		SPendingTextureUpload& upload = PendingTextureUploads[i];
-		if (!upload.Resource || upload.PackedTexels.IsEmpty())
+		const SPendingTextureUpload& upload = PendingTextureUploads.First();
+		if (upload.Resource && !upload.PackedTexels.IsEmpty())
 		{
-			continue;
+			RecordTextureUpload(
+				upload.Resource,
+				upload.Desc,
+				upload.RowPitch,
+				upload.PackedTexels.GetData(),
+				upload.FinalState);
 		}
-
-		RecordTextureUpload(
-			upload.Resource,
-			upload.Desc,
-			upload.RowPitch,
-			upload.PackedTexels.GetData(),
-			upload.FinalState);
+		PendingTextureUploads.RemoveFront();
 	}
-	PendingTextureUploads.Clear();
 }
 
 ID3D12Resource* CRenderer::CreateBufferAsset (const D3D12_RESOURCE_DESC& Desc)
@@ -766,7 +762,7 @@ void CRenderer::EnqueueBufferUpload (
 	frt_assert(Resource);
 	frt_assert(SizeInBytes <= UINT32_MAX);
 
-	SPendingBufferUpload& pendingUpload = PendingBufferUploads.Add();
+	SPendingBufferUpload& pendingUpload = PendingBufferUploads.EmplaceBack();
 	pendingUpload.Resource = Resource;
 	pendingUpload.FinalState = FinalState;
 	pendingUpload.Data.SetSizeUninitialized<true>(static_cast<uint32>(SizeInBytes));
@@ -798,7 +794,7 @@ void CRenderer::EnqueueTextureUpload (
 	TArray<uint8> packedTexels;
 	const uint32 rowPitch = BuildPackedTextureData(Desc, Texels, packedTexels);
 
-	SPendingTextureUpload& pendingUpload = PendingTextureUploads.Add();
+	SPendingTextureUpload& pendingUpload = PendingTextureUploads.EmplaceBack();
 	pendingUpload.Resource = Resource;
 	pendingUpload.Desc = Desc;
 	pendingUpload.FinalState = FinalState;
@@ -880,24 +876,7 @@ void CRenderer::CreateRootSignature ()
 	}
 }
 
-static std::string MakePipelineStateKey (
-	const std::string& VertexShaderName,
-	const std::string& PixelShaderName,
-	D3D12_CULL_MODE CullMode,
-	D3D12_COMPARISON_FUNC DepthFunc,
-	bool bDepthEnable,
-	bool bDepthWrite,
-	bool bAlphaBlend)
-{
-	return VertexShaderName + "|" + PixelShaderName
-			+ "|" + std::to_string(static_cast<uint32>(CullMode))
-			+ "|" + std::to_string(static_cast<uint32>(DepthFunc))
-			+ "|" + (bDepthEnable ? "1" : "0")
-			+ "|" + (bDepthWrite ? "1" : "0")
-			+ "|" + (bAlphaBlend ? "1" : "0");
-}
-
-static uint64 HashDefines (const TArray<SShaderDefine>& Defines)
+static uint64 HashDefines (const ShaderDefineArray& Defines)
 {
 	constexpr uint64 offsetBasis = 1469598103934665603ull;
 	constexpr uint64 prime = 1099511628211ull;
@@ -925,7 +904,7 @@ static uint64 HashDefines (const TArray<SShaderDefine>& Defines)
 	return hash;
 }
 
-static std::string MakeShaderPermutationName (const std::string& BaseName, const TArray<SShaderDefine>& Defines)
+static std::string MakeShaderPermutationName (const std::string& BaseName, const ShaderDefineArray& Defines)
 {
 	if (Defines.IsEmpty())
 	{
@@ -942,14 +921,27 @@ static std::string MakeShaderPermutationName (const std::string& BaseName, const
 	return BaseName + "_perm_" + buffer;
 }
 
-static void BuildShaderDefines (
-	const SMaterial& Material,
-	EShaderStage Stage,
-	TArray<SShaderDefine>& OutDefines)
+// Material state that selects a shader permutation, one bit per define
+enum EShaderPermutationBits : uint32
 {
-	OutDefines.Clear();
+	ShaderPermutation_BaseColorTexture = 1u << 0u
+};
 
+static uint32 GetShaderPermutationBits (const SMaterial& Material, EShaderStage Stage)
+{
+	uint32 bits = 0u;
 	if (Stage == EShaderStage::Pixel && (Material.Flags && EMaterialFlags::UseBaseColorTexture))
+	{
+		bits |= ShaderPermutation_BaseColorTexture;
+	}
+	return bits;
+}
+
+static void BuildShaderDefines (uint32 PermutationBits, ShaderDefineArray& OutDefines)
+{
+	OutDefines.Clear();
+
+	if (PermutationBits & ShaderPermutation_BaseColorTexture)
 	{
 		SShaderDefine& define = OutDefines.Add();
 		define.Name = "FRT_HAS_BASE_COLOR_TEXTURE";
@@ -957,65 +949,94 @@ static void BuildShaderDefines (
 	}
 }
 
-CRenderer::SShaderPermutation CRenderer::BuildShaderPermutation (
-	const std::string& BaseName,
-	const SMaterial& Material,
-	EShaderStage Stage) const
+uint64 CRenderer::SPipelineStateKeyHash::operator() (const SPipelineStateKey& Key) const noexcept
+{
+	const uint64 state = (uint64)Key.CullMode
+						| (uint64)Key.DepthFunc << 8u
+						| (uint64)Key.bDepthEnable << 16u
+						| (uint64)Key.bDepthWrite << 17u
+						| (uint64)Key.bAlphaBlend << 18u;
+
+	uint64 hash = MixHash((uint64)Key.VertexShader.GetId() << 32u | Key.PixelShader.GetId());
+	hash = MixHash(hash ^ ((uint64)Key.VertexPermutation << 32u | Key.PixelPermutation));
+	return MixHash(hash ^ state);
+}
+
+CRenderer::SPipelineStateKey CRenderer::MakePipelineStateKey (const SMaterial& Material)
+{
+	static const SName defaultVertexShader("VertexShader");
+	static const SName defaultPixelShader("PixelShader");
+
+	SPipelineStateKey key;
+	key.VertexShader = Material.VertexShaderName.IsNone() ? defaultVertexShader : Material.VertexShaderName;
+	key.PixelShader = Material.PixelShaderName.IsNone() ? defaultPixelShader : Material.PixelShaderName;
+	key.VertexPermutation = GetShaderPermutationBits(Material, EShaderStage::Vertex);
+	key.PixelPermutation = GetShaderPermutationBits(Material, EShaderStage::Pixel);
+	key.CullMode = Material.CullMode;
+	key.DepthFunc = Material.DepthFunc;
+	key.bDepthEnable = Material.bDepthEnable;
+	key.bDepthWrite = Material.bDepthWrite;
+	key.bAlphaBlend = Material.bAlphaBlend;
+	return key;
+}
+
+CRenderer::SShaderPermutation CRenderer::BuildShaderPermutation (SName BaseName, uint32 PermutationBits) const
 {
 	SShaderPermutation permutation;
-	BuildShaderDefines(Material, Stage, permutation.Defines);
-	permutation.Name = MakeShaderPermutationName(BaseName, permutation.Defines);
+	BuildShaderDefines(PermutationBits, permutation.Defines);
+
+	const std::string baseName(BaseName.ToString());
+	const std::string name = MakeShaderPermutationName(baseName, permutation.Defines);
+	permutation.Name = SName(name);
 
 	const std::filesystem::path shaderSourceDir = R"(..\Core\Content\Shaders)";
 	const std::filesystem::path shaderBinDir = shaderSourceDir / "Bin";
-	permutation.CompiledPath = shaderBinDir / (permutation.Name + ".shader");
-	permutation.SourcePath = shaderSourceDir / (BaseName + ".hlsl");
+	permutation.CompiledPath = shaderBinDir / (name + ".shader");
+	permutation.SourcePath = shaderSourceDir / (baseName + ".hlsl");
 	return permutation;
 }
 
-ComPtr<ID3D12PipelineState> CRenderer::BuildPipelineState (
-	const SShaderPermutation& VertexShader,
-	const SShaderPermutation& PixelShader,
-	D3D12_CULL_MODE CullMode,
-	D3D12_COMPARISON_FUNC DepthFunc,
-	bool bDepthEnable,
-	bool bDepthWrite,
-	bool bAlphaBlend)
+ComPtr<ID3D12PipelineState> CRenderer::BuildPipelineState (const SPipelineStateKey& Key)
 {
+	const SShaderPermutation vertexPermutation = BuildShaderPermutation(Key.VertexShader, Key.VertexPermutation);
+	const SShaderPermutation pixelPermutation = BuildShaderPermutation(Key.PixelShader, Key.PixelPermutation);
+
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
 	psoDesc.pRootSignature = RootSignature.Get();
 
 	const std::filesystem::path shaderSourceDir = R"(..\Core\Content\Shaders)";
 
 	const SShaderAsset* vertexShader = ShaderLibrary.LoadShader(
-		VertexShader.Name,
-		VertexShader.CompiledPath,
-		VertexShader.SourcePath,
+		vertexPermutation.Name,
+		vertexPermutation.CompiledPath,
+		vertexPermutation.SourcePath,
 		shaderSourceDir,
 		"main",
 		"vs_6_0",
 		EShaderStage::Vertex,
-		VertexShader.Defines);
+		vertexPermutation.Defines);
+	// Loading the pixel shader can move the vertex one, the bytecode buffer itself stays put
+	psoDesc.VS = vertexShader->GetBytecode();
+
 	const SShaderAsset* pixelShader = ShaderLibrary.LoadShader(
-		PixelShader.Name,
-		PixelShader.CompiledPath,
-		PixelShader.SourcePath,
+		pixelPermutation.Name,
+		pixelPermutation.CompiledPath,
+		pixelPermutation.SourcePath,
 		shaderSourceDir,
 		"main",
 		"ps_6_0",
 		EShaderStage::Pixel,
-		PixelShader.Defines);
+		pixelPermutation.Defines);
 
-	psoDesc.VS = vertexShader->GetBytecode();
 	psoDesc.PS = pixelShader->GetBytecode();
 
-	psoDesc.BlendState.RenderTarget[0].BlendEnable = bAlphaBlend;
+	psoDesc.BlendState.RenderTarget[0].BlendEnable = Key.bAlphaBlend;
 	psoDesc.BlendState.RenderTarget[0].LogicOpEnable = false;
-	psoDesc.BlendState.RenderTarget[0].SrcBlend = bAlphaBlend ? D3D12_BLEND_SRC_ALPHA : D3D12_BLEND_ONE;
-	psoDesc.BlendState.RenderTarget[0].DestBlend = bAlphaBlend ? D3D12_BLEND_INV_SRC_ALPHA : D3D12_BLEND_ZERO;
+	psoDesc.BlendState.RenderTarget[0].SrcBlend = Key.bAlphaBlend ? D3D12_BLEND_SRC_ALPHA : D3D12_BLEND_ONE;
+	psoDesc.BlendState.RenderTarget[0].DestBlend = Key.bAlphaBlend ? D3D12_BLEND_INV_SRC_ALPHA : D3D12_BLEND_ZERO;
 	psoDesc.BlendState.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
 	psoDesc.BlendState.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
-	psoDesc.BlendState.RenderTarget[0].DestBlendAlpha = bAlphaBlend ? D3D12_BLEND_INV_SRC_ALPHA : D3D12_BLEND_ZERO;
+	psoDesc.BlendState.RenderTarget[0].DestBlendAlpha = Key.bAlphaBlend ? D3D12_BLEND_INV_SRC_ALPHA : D3D12_BLEND_ZERO;
 	psoDesc.BlendState.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
 	psoDesc.BlendState.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
 	psoDesc.SampleMask = UINT_MAX;
@@ -1023,15 +1044,15 @@ ComPtr<ID3D12PipelineState> CRenderer::BuildPipelineState (
 	psoDesc.SampleDesc.Quality = 0;
 
 	psoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
-	psoDesc.RasterizerState.CullMode = CullMode;
+	psoDesc.RasterizerState.CullMode = Key.CullMode;
 	psoDesc.RasterizerState.FrontCounterClockwise = false;
 	psoDesc.RasterizerState.DepthClipEnable = true;
 
-	psoDesc.DepthStencilState.DepthEnable = bDepthEnable;
+	psoDesc.DepthStencilState.DepthEnable = Key.bDepthEnable;
 	psoDesc.DepthStencilState.StencilEnable = false;
 	psoDesc.DepthStencilState.DepthWriteMask =
-		bDepthWrite ? D3D12_DEPTH_WRITE_MASK_ALL : D3D12_DEPTH_WRITE_MASK_ZERO;
-	psoDesc.DepthStencilState.DepthFunc = DepthFunc;
+		Key.bDepthWrite ? D3D12_DEPTH_WRITE_MASK_ALL : D3D12_DEPTH_WRITE_MASK_ZERO;
+	psoDesc.DepthStencilState.DepthFunc = Key.DepthFunc;
 
 	D3D12_INPUT_ELEMENT_DESC inputElementDescs[6] = {};
 	inputElementDescs[0].SemanticName = "POSITION";
@@ -1091,29 +1112,10 @@ ComPtr<ID3D12PipelineState> CRenderer::BuildPipelineState (
 
 void CRenderer::CreatePipelineState ()
 {
-	PipelineStateCache.clear();
-	const SMaterial defaultMaterial = {};
-	const SShaderPermutation vertexShader = BuildShaderPermutation(
-		"VertexShader", defaultMaterial, EShaderStage::Vertex);
-	const SShaderPermutation pixelShader = BuildShaderPermutation("PixelShader", defaultMaterial, EShaderStage::Pixel);
-	PipelineState = BuildPipelineState(
-		vertexShader,
-		pixelShader,
-		defaultMaterial.CullMode,
-		defaultMaterial.DepthFunc,
-		defaultMaterial.bDepthEnable,
-		defaultMaterial.bDepthWrite,
-		defaultMaterial.bAlphaBlend);
-	PipelineStateCache.emplace(
-		MakePipelineStateKey(
-			vertexShader.Name,
-			pixelShader.Name,
-			defaultMaterial.CullMode,
-			defaultMaterial.DepthFunc,
-			defaultMaterial.bDepthEnable,
-			defaultMaterial.bDepthWrite,
-			defaultMaterial.bAlphaBlend),
-		PipelineState);
+	PipelineStateCache.Clear();
+	const SPipelineStateKey key = MakePipelineStateKey(SMaterial {});
+	PipelineState = BuildPipelineState(key);
+	PipelineStateCache.Add(key, PipelineState);
 }
 
 void CRenderer::TransitionCurrentBackBufferToRenderTarget ()
@@ -1172,46 +1174,21 @@ CMaterialLibrary& CRenderer::GetMaterialLibrary ()
 
 ID3D12PipelineState* CRenderer::GetPipelineStateForMaterial (const SMaterial& Material)
 {
-	const std::string vertexShaderBase = Material.VertexShaderName.empty()
-											? "VertexShader"
-											: Material.VertexShaderName;
-	const std::string pixelShaderBase = Material.PixelShaderName.empty()
-											? "PixelShader"
-											: Material.PixelShaderName;
-
-	const SShaderPermutation vertexShader = BuildShaderPermutation(vertexShaderBase, Material, EShaderStage::Vertex);
-	const SShaderPermutation pixelShader = BuildShaderPermutation(pixelShaderBase, Material, EShaderStage::Pixel);
-
-	const std::string key = MakePipelineStateKey(
-		vertexShader.Name,
-		pixelShader.Name,
-		Material.CullMode,
-		Material.DepthFunc,
-		Material.bDepthEnable,
-		Material.bDepthWrite,
-		Material.bAlphaBlend);
-	auto it = PipelineStateCache.find(key);
-	if (it != PipelineStateCache.end())
-	{
-		return it->second.Get();
+	const SPipelineStateKey key = MakePipelineStateKey(Material);
+	if (const ComPtr<ID3D12PipelineState>* cached = PipelineStateCache.Find(key))
+	{
+		return cached->Get();
 	}
 
-	ComPtr<ID3D12PipelineState> pipelineState = BuildPipelineState(
-		vertexShader,
-		pixelShader,
-		Material.CullMode,
-		Material.DepthFunc,
-		Material.bDepthEnable,
-		Material.bDepthWrite,
-		Material.bAlphaBlend);
+	ComPtr<ID3D12PipelineState> pipelineState = BuildPipelineState(key);
 	ID3D12PipelineState* pipelineRaw = pipelineState.Get();
-	PipelineStateCache.emplace(key, std::move(pipelineState));
+	PipelineStateCache.Add(key, std::move(pipelineState));
 	return pipelineRaw;
 }
 
 D3D12_GPU_DESCRIPTOR_HANDLE CRenderer::GetDefaultWhiteTextureGpu () const
 {
-	return DefaultWhiteTexture.GpuDescriptor;
+	return DefaultWhiteTexture.GpuDescriptor ? *DefaultWhiteTexture.GpuDescriptor : D3D12_GPU_DESCRIPTOR_HANDLE {};
 }
 
 void CRenderer::EnsureObjectConstantCapacity (uint32 ObjectCount)
@@ -1310,45 +1287,34 @@ void CRenderer::RebuildShaderDescriptors ()
 		FramesResources[i].MaterialCB.RebuildDescriptors(Device.Get(), ShaderDescriptorHeap);
 	}
 
-	for (uint32 i = 0; i < TrackedSrvs.Count(); ++i)
+	for (SShaderResourceViewRecord& record : TrackedSrvs)
 	{
-		SShaderResourceViewRecord& record = TrackedSrvs[i];
 		if (!record.Resource)
 		{
 			continue;
 		}
 
 		D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = {};
-		D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = {};
-		ShaderDescriptorHeap.Allocate(&cpuHandle, &gpuHandle);
-
-		if (record.GpuHandle)
-		{
-			*record.GpuHandle = gpuHandle;
-		}
-
+		ShaderDescriptorHeap.Allocate(&cpuHandle, &record.GpuHandle);
 		Device->CreateShaderResourceView(record.Resource, &record.Desc, cpuHandle);
 	}
 }
 
-void CRenderer::CreateShaderResourceView (
+const D3D12_GPU_DESCRIPTOR_HANDLE* CRenderer::CreateShaderResourceView (
 	ID3D12Resource* Texture,
 	const D3D12_SHADER_RESOURCE_VIEW_DESC& Desc,
-	D3D12_CPU_DESCRIPTOR_HANDLE* OutCpuHandle,
-	D3D12_GPU_DESCRIPTOR_HANDLE* OutGpuHandle)
+	D3D12_CPU_DESCRIPTOR_HANDLE* OutCpuHandle)
 {
 	EnsureShaderDescriptorCapacity(static_cast<uint32>(ShaderDescriptorHeap.GetCount() + 1u));
 
-	ShaderDescriptorHeap.Allocate(OutCpuHandle, OutGpuHandle);
+	SShaderResourceViewRecord& record = TrackedSrvs[TrackedSrvs.Emplace()];
+	record.Resource = Texture;
+	record.Desc = Desc;
+
+	ShaderDescriptorHeap.Allocate(OutCpuHandle, &record.GpuHandle);
 	Device->CreateShaderResourceView(Texture, &Desc, *OutCpuHandle);
 
-	if (OutGpuHandle)
-	{
-		SShaderResourceViewRecord& record = TrackedSrvs.Add();
-		record.Resource = Texture;
-		record.Desc = Desc;
-		record.GpuHandle = OutGpuHandle;
-	}
+	return &record.GpuHandle;
 }
 
 void CRenderer::CreateDefaultWhiteTexture ()
@@ -1383,8 +1349,7 @@ void CRenderer::CreateDefaultWhiteTexture ()
 	srvDesc.Texture2D.PlaneSlice = 0;
 
 	D3D12_CPU_DESCRIPTOR_HANDLE cpuDescriptor = {};
-	CreateShaderResourceView(
-		DefaultWhiteTexture.GpuTexture, srvDesc, &cpuDescriptor, &DefaultWhiteTexture.GpuDescriptor);
+	DefaultWhiteTexture.GpuDescriptor = CreateShaderResourceView(DefaultWhiteTexture.GpuTexture, srvDesc, &cpuDescriptor);
 
 	// Upload is queued; it will be processed during initialization or the first frame.
 }
@@ -1408,7 +1373,8 @@ void CRenderer::InitializeRaytracingResources ()
 	CreateShaderBindingTable();
 }
 
-void CRenderer::SetRaytracingMaterialTextureSets (const TArray<SRaytracingMaterialTextureSet>& MaterialTextureSets)
+void CRenderer::SetRaytracingMaterialTextureSets (
+	const TArray<SRaytracingMaterialTextureSet, memory::CFrameArena>& MaterialTextureSets)
 {
 	bool bChanged = RaytracingMaterialTextureSets.Count() != MaterialTextureSets.Count();
 	if (!bChanged)
@@ -1440,7 +1406,7 @@ void CRenderer::SetRaytracingMaterialTextureSets (const TArray<SRaytracingMateri
 }
 
 void CRenderer::SetRaytracingHitGroupEntries (
-	const TArray<SRaytracingHitGroupEntry>& HitGroupEntries)
+	const TArray<SRaytracingHitGroupEntry, memory::CFrameArena>& HitGroupEntries)
 {
 	bool bChanged = RaytracingHitGroupEntries.Count() != HitGroupEntries.Count();
 	if (!bChanged)
@@ -5,7 +5,6 @@
 #include <dxgi1_4.h>
 #include <filesystem>
 #include <string>
-#include <unordered_map>
 #include <wrl/client.h>
 
 #include "Event.h"
@@ -15,7 +14,11 @@
 #include "ShaderAsset.h"
 #include "Texture.h"
 #include "Containers/Array.h"
+#include "Containers/ChunkedArray.h"
+#include "Containers/HashMap.h"
+#include "Containers/RingBuffer.h"
 #include "Graphics/DXRUtils.h"
+#include "Memory/FrameArena.h"
 
 
 namespace frt
@@ -154,8 +157,8 @@ private:
 	DX12_Arena BufferArena;
 	DX12_Arena TextureArena;
 
-	TArray<SPendingBufferUpload> PendingBufferUploads;
-	TArray<SPendingTextureUpload> PendingTextureUploads;
+	TRingBuffer<SPendingBufferUpload> PendingBufferUploads;
+	TRingBuffer<SPendingTextureUpload> PendingTextureUploads;
 
 	// Rasterization
 public:
@@ -164,11 +167,11 @@ public:
 	CMaterialLibrary& GetMaterialLibrary ();
 	ID3D12PipelineState* GetPipelineStateForMaterial (const SMaterial& Material);
 	D3D12_GPU_DESCRIPTOR_HANDLE GetDefaultWhiteTextureGpu () const;
-	void CreateShaderResourceView (
+	/** Returned handle is owned by the renderer and is updated in place whenever the descriptor heap is rebuilt. */
+	const D3D12_GPU_DESCRIPTOR_HANDLE* CreateShaderResourceView (
 		ID3D12Resource* Texture,
 		const D3D12_SHADER_RESOURCE_VIEW_DESC& Desc,
-		D3D12_CPU_DESCRIPTOR_HANDLE* OutCpuHandle,
-		D3D12_GPU_DESCRIPTOR_HANDLE* OutGpuHandle);
+		D3D12_CPU_DESCRIPTOR_HANDLE* OutCpuHandle);
 	DX12_DescriptorHeap& GetDescriptorHeap ();
 
 	frt::CEvent<> OnShaderDescriptorHeapRebuild;
@@ -180,27 +183,41 @@ public:
 private:
 	struct SShaderPermutation
 	{
-		std::string Name;
+		SName Name;
 		std::filesystem::path CompiledPath;
 		std::filesystem::path SourcePath;
-		TArray<SShaderDefine> Defines;
+		ShaderDefineArray Defines;
 	};
 
 
 	void CreateRootSignature ();
+	/** Everything a pipeline state is built from; made from a material without touching any strings */
+	struct SPipelineStateKey
+	{
+		SName VertexShader;
+		SName PixelShader;
+		uint32 VertexPermutation = 0u;
+		uint32 PixelPermutation = 0u;
+		D3D12_CULL_MODE CullMode = D3D12_CULL_MODE_NONE;
+		D3D12_COMPARISON_FUNC DepthFunc = D3D12_COMPARISON_FUNC_LESS;
+		bool bDepthEnable = true;
+		bool bDepthWrite = true;
+		bool bAlphaBlend = false;
+
+		bool operator== (const SPipelineStateKey&) const = default;
+	};
+
+
+	struct SPipelineStateKeyHash
+	{
+		uint64 operator() (const SPipelineStateKey& Key) const noexcept;
+	};
+
+
 	void CreatePipelineState ();
-	[[nodiscard]] SShaderPermutation BuildShaderPermutation (
-		const std::string& BaseName,
-		const SMaterial& Material,
-		EShaderStage Stage) const;
-	ComPtr<ID3D12PipelineState> BuildPipelineState (
-		const SShaderPermutation& VertexShader,
-		const SShaderPermutation& PixelShader,
-		D3D12_CULL_MODE CullMode,
-		D3D12_COMPARISON_FUNC DepthFunc,
-		bool bDepthEnable,
-		bool bDepthWrite,
-		bool bAlphaBlend);
+	[[nodiscard]] static SPipelineStateKey MakePipelineStateKey (const SMaterial& Material);
+	[[nodiscard]] SShaderPermutation BuildShaderPermutation (SName BaseName, uint32 PermutationBits) const;
+	ComPtr<ID3D12PipelineState> BuildPipelineState (const SPipelineStateKey& Key);
 	void CreateDefaultWhiteTexture ();
 	void EnsureShaderDescriptorCapacity (uint32 RequiredCount);
 	void RebuildShaderDescriptorHeap (uint32 NewCapacity);
@@ -215,7 +232,8 @@ private:
 	ComPtr<ID3D12PipelineState> PipelineState;
 	CShaderLibrary ShaderLibrary;
 	CMaterialLibrary MaterialLibrary;
-	std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> PipelineStateCache;
+	THashMap<SPipelineStateKey, ComPtr<ID3D12PipelineState>, memory::DefaultPool, SPipelineStateKeyHash>
+		PipelineStateCache;
 	STexture DefaultWhiteTexture = {};
 	bool bPendingPipelineStateRebuild = false;
 
@@ -227,7 +245,7 @@ private:
 	{
 		ID3D12Resource* Resource = nullptr;
 		D3D12_SHADER_RESOURCE_VIEW_DESC Desc = {};
-		D3D12_GPU_DESCRIPTOR_HANDLE* GpuHandle = nullptr;
+		D3D12_GPU_DESCRIPTOR_HANDLE GpuHandle = {};
 	};
 
 
@@ -238,7 +256,8 @@ private:
 	ComPtr<ID3D12Resource> DepthStencilBuffer;
 	D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilDescriptor;
 
-	TArray<SShaderResourceViewRecord> TrackedSrvs;
+	// Chunked so the handles given out by CreateShaderResourceView never move
+	TChunkedArray<SShaderResourceViewRecord> TrackedSrvs;
 
 	D3D12_DESCRIPTOR_HEAP_TYPE ShaderDescriptorHeapType = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
 	D3D12_DESCRIPTOR_HEAP_FLAGS ShaderDescriptorHeapFlags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
@@ -258,8 +277,9 @@ public:
 	};
 
 	void InitializeRaytracingResources ();
-	void SetRaytracingMaterialTextureSets (const TArray<SRaytracingMaterialTextureSet>& MaterialTextureSets);
-	void SetRaytracingHitGroupEntries (const TArray<SRaytracingHitGroupEntry>& HitGroupEntries);
+	void SetRaytracingMaterialTextureSets (
+		const TArray<SRaytracingMaterialTextureSet, memory::CFrameArena>& MaterialTextureSets);
+	void SetRaytracingHitGroupEntries (const TArray<SRaytracingHitGroupEntry, memory::CFrameArena>& HitGroupEntries);
 	raytracing::SAccelerationStructureBuffers TopLevelASBuffers;
 
 private:
@@ -127,46 +127,17 @@ static bool RunProcess (const std::wstring& ApplicationPath, const std::wstring&
 }
 #endif
 
-size_t CShaderLibrary::SStringHash::operator() (std::string_view Value) const noexcept
-{
-	return std::hash<std::string_view>{}(Value);
-}
-
-size_t CShaderLibrary::SStringHash::operator() (const std::string& Value) const noexcept
-{
-	return std::hash<std::string_view>{}(Value);
-}
-
-bool CShaderLibrary::SStringEqual::operator() (std::string_view Lhs, std::string_view Rhs) const noexcept
-{
-	return Lhs == Rhs;
-}
-
-bool CShaderLibrary::SStringEqual::operator() (const std::string& Lhs, const std::string& Rhs) const noexcept
-{
-	return Lhs == Rhs;
-}
-
-bool CShaderLibrary::SStringEqual::operator() (const std::string& Lhs, std::string_view Rhs) const noexcept
-{
-	return std::string_view(Lhs) == Rhs;
-}
-
-bool CShaderLibrary::SStringEqual::operator() (std::string_view Lhs, const std::string& Rhs) const noexcept
-{
-	return Lhs == std::string_view(Rhs);
-}
-
-static std::string BuildShaderKey (std::string_view Name, const TArray<SShaderDefine>& Defines)
+static SName BuildShaderKey (SName Name, const ShaderDefineArray& Defines)
 {
 	if (Defines.IsEmpty())
 	{
-		return std::string(Name);
+		return Name;
 	}
 
+	const std::string_view name = Name.ToString();
 	std::string key;
-	key.reserve(Name.size() + Defines.Count() * 16u);
-	key.append(Name);
+	key.reserve(name.size() + Defines.Count() * 16u);
+	key.append(name);
 	key.push_back('|');
 	for (uint32 i = 0; i < Defines.Count(); ++i)
 	{
@@ -185,7 +156,7 @@ static std::string BuildShaderKey (std::string_view Name, const TArray<SShaderDe
 		key.push_back(';');
 	}
 
-	return key;
+	return SName(key);
 }
 
 static std::filesystem::file_time_type GetLastWriteTime (const std::filesystem::path& Path)
@@ -384,39 +355,38 @@ bool SShaderAsset::ReloadIfChanged ()
 
 
 const SShaderAsset* CShaderLibrary::LoadShader (
-	std::string_view Name,
+	SName Name,
 	const std::filesystem::path& CompiledPath,
 	const std::filesystem::path& SourcePath,
 	const std::filesystem::path& IncludeDir,
 	std::string_view EntryPoint,
 	std::string_view TargetProfile,
 	EShaderStage Stage,
-	const TArray<SShaderDefine>& Defines)
+	const ShaderDefineArray& Defines)
 {
-	frt_assert(!Name.empty());
+	frt_assert(!Name.IsNone());
 	frt_assert(!CompiledPath.empty());
 
 	const std::filesystem::path compiledPath = GetAbsolutePath(CompiledPath);
 	const std::filesystem::path sourcePath = GetAbsolutePath(SourcePath);
 	const std::filesystem::path includeDir = GetAbsolutePath(IncludeDir);
 
-	const std::string key = BuildShaderKey(Name, Defines);
-	auto it = Shaders.find(key);
-	if (it != Shaders.end())
+	const SName key = BuildShaderKey(Name, Defines);
+	if (const SShaderAsset* existing = Shaders.Find(key))
 	{
-		frt_assert(it->second.Path == compiledPath);
-		frt_assert(it->second.SourcePath == sourcePath);
-		frt_assert(it->second.IncludeDir == includeDir);
+		frt_assert(existing->Path == compiledPath);
+		frt_assert(existing->SourcePath == sourcePath);
+		frt_assert(existing->IncludeDir == includeDir);
 		if (!EntryPoint.empty())
 		{
-			frt_assert(it->second.EntryPoint == EntryPoint);
+			frt_assert(existing->EntryPoint == EntryPoint);
 		}
 		if (!TargetProfile.empty())
 		{
-			frt_assert(it->second.TargetProfile == TargetProfile);
+			frt_assert(existing->TargetProfile == TargetProfile);
 		}
-		frt_assert(it->second.Stage == Stage);
-		return &it->second;
+		frt_assert(existing->Stage == Stage);
+		return existing;
 	}
 
 	SShaderAsset asset;
@@ -448,22 +418,14 @@ const SShaderAsset* CShaderLibrary::LoadShader (
 	asset.LastWriteTime = GetLastWriteTime(watchPath);
 	frt_assert(!asset.Bytecode.IsEmpty());
 
-	auto [insertedIt, inserted] = Shaders.emplace(asset.Name, std::move(asset));
-	frt_assert(inserted);
-	return &insertedIt->second;
+	return &Shaders.Add(key, std::move(asset));
 }
 
-const SShaderAsset* CShaderLibrary::GetShader (std::string_view Name) const
+const SShaderAsset* CShaderLibrary::GetShader (SName Name) const
 {
-	frt_assert(!Name.empty());
-
-	auto it = Shaders.find(Name);
-	if (it == Shaders.end())
-	{
-		return nullptr;
-	}
+	frt_assert(!Name.IsNone());
 
-	return &it->second;
+	return Shaders.Find(Name);
 }
 
 bool CShaderLibrary::ReloadModifiedShaders ()
@@ -471,7 +433,7 @@ bool CShaderLibrary::ReloadModifiedShaders ()
 	bool bAnyReloaded = false;
 	for (auto& entry : Shaders)
 	{
-		if (entry.second.ReloadIfChanged())
+		if (entry.Value.ReloadIfChanged())
 		{
 			bAnyReloaded = true;
 		}
@@ -6,10 +6,12 @@
 #include <filesystem>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 
 #include "CoreTypes.h"
+#include "Name.h"
 #include "Containers/Array.h"
+#include "Containers/HashMap.h"
+#include "Containers/InlineArray.h"
 
 
 namespace frt::graphics
@@ -30,17 +32,21 @@ struct SShaderDefine
 	std::string Value;
 };
 
+// Permutations carry a handful of defines at most
+using ShaderDefineArray = TInlineArray<SShaderDefine, 4u>;
+
 
 struct SShaderAsset
 {
-	std::string Name;
+	/** Shader name, with the defines appended if there are any */
+	SName Name;
 	std::filesystem::path Path;
 	std::filesystem::path SourcePath;
 	std::filesystem::path IncludeDir;
 	std::string EntryPoint;
 	std::string TargetProfile;
 	EShaderStage Stage = EShaderStage::Vertex;
-	TArray<SShaderDefine> Defines;
+	ShaderDefineArray Defines;
 	TArray<uint8> Bytecode;
 	std::filesystem::file_time_type LastWriteTime;
 
@@ -52,37 +58,20 @@ struct SShaderAsset
 class CShaderLibrary
 {
 public:
+	/** Returned asset stays where it is only until the next shader is loaded. */
 	const SShaderAsset* LoadShader (
-		std::string_view Name,
+		SName Name,
 		const std::filesystem::path& CompiledPath,
 		const std::filesystem::path& SourcePath,
 		const std::filesystem::path& IncludeDir,
 		std::string_view EntryPoint,
 		std::string_view TargetProfile,
 		EShaderStage Stage,
-		const TArray<SShaderDefine>& Defines);
-	const SShaderAsset* GetShader (std::string_view Name) const;
+		const ShaderDefineArray& Defines);
+	const SShaderAsset* GetShader (SName Name) const;
 	bool ReloadModifiedShaders ();
 
 private:
-	struct SStringHash
-	{
-		using is_transparent = void;
-
-		size_t operator() (std::string_view Value) const noexcept;
-		size_t operator() (const std::string& Value) const noexcept;
-	};
-
-	struct SStringEqual
-	{
-		using is_transparent = void;
-
-		bool operator() (std::string_view Lhs, std::string_view Rhs) const noexcept;
-		bool operator() (const std::string& Lhs, const std::string& Rhs) const noexcept;
-		bool operator() (const std::string& Lhs, std::string_view Rhs) const noexcept;
-		bool operator() (std::string_view Lhs, const std::string& Rhs) const noexcept;
-	};
-
-	std::unordered_map<std::string, SShaderAsset, SStringHash, SStringEqual> Shaders;
+	THashMap<SName, SShaderAsset> Shaders;
 };
 }
@@ -17,6 +17,7 @@ struct FRT_CORE_API STexture
 	uint32* Texels;
 
 	ID3D12Resource* GpuTexture;
-	D3D12_GPU_DESCRIPTOR_HANDLE GpuDescriptor;
+	/** Owned by the renderer, stays valid across copies of the texture and descriptor heap rebuilds */
+	const D3D12_GPU_DESCRIPTOR_HANDLE* GpuDescriptor;
 };
 }
@@ -444,7 +444,7 @@ bool CInputActionMap::LoadFromFile (const std::filesystem::path& Path)
 		if (key == "action")
 		{
 			SInputAction& action = Actions.Add();
-			action.Name = value;
+			action.Name = SName(value);
 			action.Kind = EInputActionKind::Button;
 			currentAction = &action;
 			continue;
@@ -501,7 +501,7 @@ bool CInputActionMap::SaveToStream (std::ostream& Stream) const
 
 	for (const SInputAction& action : Actions)
 	{
-		Stream << "action: " << action.Name << "\n";
+		Stream << "action: " << action.Name.ToString() << "\n";
 		Stream << "type: " << ActionKindToString(action.Kind) << "\n";
 		for (const SInputBinding& binding : action.Bindings)
 		{
@@ -596,7 +596,7 @@ void CInputActionMap::Clear ()
 {
 	Actions.Clear();
 	States.Clear();
-	ActionIndex.clear();
+	ActionIndex.Clear();
 }
 
 void CInputActionMap::Evaluate (const CInputSystem& Input, WindowId Window)
@@ -692,39 +692,39 @@ void CInputActionMap::Evaluate (const CInputSystem& Input, WindowId Window)
 	}
 }
 
-const SInputAction* CInputActionMap::FindAction (const std::string& Name) const
+const SInputAction* CInputActionMap::FindAction (SName Name) const
 {
-	auto it = ActionIndex.find(Name);
-	if (it == ActionIndex.end())
+	const uint32* index = ActionIndex.Find(Name);
+	if (!index)
 	{
 		return nullptr;
 	}
 
-	return &Actions[it->second];
+	return &Actions[*index];
 }
 
-SInputAction* CInputActionMap::FindAction (const std::string& Name)
+SInputAction* CInputActionMap::FindAction (SName Name)
 {
 	return const_cast<SInputAction*>(static_cast<const CInputActionMap&>(*this).FindAction(Name));
 }
 
-const SInputActionState* CInputActionMap::FindActionState (const std::string& Name) const
+const SInputActionState* CInputActionMap::FindActionState (SName Name) const
 {
-	auto it = ActionIndex.find(Name);
-	if (it == ActionIndex.end())
+	const uint32* index = ActionIndex.Find(Name);
+	if (!index)
 	{
 		return nullptr;
 	}
 
-	return &States[it->second];
+	return &States[*index];
 }
 
-SInputActionState* CInputActionMap::FindActionState (const std::string& Name)
+SInputActionState* CInputActionMap::FindActionState (SName Name)
 {
 	return const_cast<SInputActionState*>(static_cast<const CInputActionMap&>(*this).FindActionState(Name));
 }
 
-void CInputActionMap::ApplyActionKind (const std::string& Name, EInputActionKind Kind)
+void CInputActionMap::ApplyActionKind (SName Name, EInputActionKind Kind)
 {
 	SInputAction* action = FindAction(Name);
 	if (!action)
@@ -737,11 +737,11 @@ void CInputActionMap::ApplyActionKind (const std::string& Name, EInputActionKind
 
 void CInputActionMap::RebuildIndex ()
 {
-	ActionIndex.clear();
-	ActionIndex.reserve(Actions.Count());
+	ActionIndex.Clear();
+	ActionIndex.Reserve(Actions.Count());
 	for (uint32 index = 0; index < Actions.Count(); ++index)
 	{
-		ActionIndex.emplace(Actions[index].Name, index);
+		ActionIndex.Emplace(Actions[index].Name, index);
 	}
 }
 
@@ -4,10 +4,12 @@
 #include <iosfwd>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 
 #include "Core.h"
+#include "Name.h"
 #include "Containers/Array.h"
+#include "Containers/HashMap.h"
+#include "Containers/InlineArray.h"
 #include "Input/InputTypes.h"
 
 
@@ -54,14 +56,14 @@ struct SInputBinding
 
 struct SInputAction
 {
-	std::string Name;
+	SName Name;
 	EInputActionKind Kind = EInputActionKind::Button;
-	TArray<SInputBinding> Bindings;
+	TInlineArray<SInputBinding, 4u> Bindings;
 };
 
 struct SInputActionEventData
 {
-	std::string_view Name;
+	SName Name;
 	EInputActionKind Kind = EInputActionKind::Button;
 	EInputActionEventType Type = EInputActionEventType::Pressed;
 	float Value = 0.0f;
@@ -109,13 +111,13 @@ public:
 	const TArray<SInputAction>& GetActions () const { return Actions; }
 	const TArray<SInputActionState>& GetActionStates () const { return States; }
 
-	const SInputAction* FindAction (const std::string& Name) const;
-	SInputAction* FindAction (const std::string& Name);
+	const SInputAction* FindAction (SName Name) const;
+	SInputAction* FindAction (SName Name);
 
-	const SInputActionState* FindActionState (const std::string& Name) const;
-	SInputActionState* FindActionState (const std::string& Name);
+	const SInputActionState* FindActionState (SName Name) const;
+	SInputActionState* FindActionState (SName Name);
 
-	void ApplyActionKind (const std::string& Name, EInputActionKind Kind);
+	void ApplyActionKind (SName Name, EInputActionKind Kind);
 
 	InputEventAction OnActionEvent;
 
@@ -127,6 +129,6 @@ private:
 private:
 	TArray<SInputAction> Actions;
 	TArray<SInputActionState> States;
-	std::unordered_map<std::string, uint32> ActionIndex;
+	THashMap<SName, uint32> ActionIndex;
 };
 }
@@ -1,7 +1,6 @@
 ﻿#include "Input/InputSystem.h"
 
 #include <algorithm>
-#include <vector>
 
 #include "Input/PlatformInput.h"
 
@@ -12,22 +11,19 @@ void CInputSystem::Update (float FrameTimeSeconds)
 {
 	BeginFrame(FrameTimeSeconds);
 
-	std::vector<SInputEvent> events;
-	CPlatformInputQueue::Drain(events);
-
-	for (const SInputEvent& event : events)
+	CPlatformInputQueue::Drain([this] (const SInputEvent& InEvent)
 	{
 		std::visit(
 			[this] (const auto& data)
 			{
 				HandleEvent(data);
-			}, event.Data);
-	}
+			}, InEvent.Data);
+	});
 }
 
 void CInputSystem::Clear ()
 {
-	WindowStates.clear();
+	WindowStates.Clear();
 	DefaultWindow = InvalidWindowId;
 }
 
@@ -324,19 +320,12 @@ float CInputSystem::GetGamepadAxis (uint8 GamepadIndex, EGamepadAxis Axis, Windo
 
 CInputSystem::SWindowInputState& CInputSystem::GetOrCreateState (WindowId Window)
 {
-	auto [it, inserted] = WindowStates.emplace(Window, SWindowInputState{});
-	return it->second;
+	return WindowStates.FindOrAdd(Window);
 }
 
 const CInputSystem::SWindowInputState* CInputSystem::FindState (WindowId Window) const
 {
-	auto it = WindowStates.find(Window);
-	if (it == WindowStates.end())
-	{
-		return nullptr;
-	}
-
-	return &it->second;
+	return WindowStates.Find(Window);
 }
 
 WindowId CInputSystem::ResolveWindow (WindowId Window) const
@@ -353,7 +342,7 @@ void CInputSystem::BeginFrame (float FrameTimeSeconds)
 {
 	CurrentTimeSeconds = FrameTimeSeconds;
 
-	for (auto& [windowId, state] : WindowStates)
+	for (auto [windowId, state] : WindowStates)
 	{
 		state.Previous = state.Current;
 		state.Current.Mouse.Delta = Vector2f(0.0f, 0.0f);
@@ -1,8 +1,7 @@
 ﻿#pragma once
 
-#include <unordered_map>
-
 #include "Core.h"
+#include "Containers/FlatMap.h"
 #include "Input/InputTypes.h"
 
 
@@ -70,7 +69,8 @@ private:
 	void HandleEvent (const SDeviceConnectionEventData& Data);
 
 private:
-	std::unordered_map<WindowId, SWindowInputState> WindowStates;
+	/** Usually a single window, so a sorted array beats hashing. */
+	TFlatMap<WindowId, SWindowInputState> WindowStates;
 	WindowId DefaultWindow = InvalidWindowId;
 	float CurrentTimeSeconds = 0.0f;
 };
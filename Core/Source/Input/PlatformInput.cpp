@@ -1,6 +1,5 @@
 ﻿#include "Input/PlatformInput.h"
 
-#include <mutex>
 #include <utility>
 
 
@@ -8,67 +7,64 @@ namespace frt::input
 {
 namespace
 {
-	std::vector<SInputEvent> gEventQueue;
-	std::mutex gQueueMutex;
-
-	void EnqueueInternal (EInputEventType Type, FInputEventData Data)
+	void EnqueueInternal (CPlatformInputQueue::RingType& Ring, EInputEventType Type, FInputEventData Data)
 	{
-		std::scoped_lock lock(gQueueMutex);
-		gEventQueue.push_back(SInputEvent{ Type, std::move(Data) });
+		// A full queue means the game thread is stalled, dropping the newest events is what we want then
+		(void)Ring.TryPush(SInputEvent{ Type, std::move(Data) });
 	}
 }
 
 
+CPlatformInputQueue::RingType& CPlatformInputQueue::GetRing ()
+{
+	// Function static, platform callbacks may fire before anything else is initialized
+	static RingType ring;
+	return ring;
+}
+
+
 void CPlatformInputQueue::Enqueue (const SKeyboardEventData& Data)
 {
-	EnqueueInternal(EInputEventType::Keyboard, Data);
+	EnqueueInternal(GetRing(), EInputEventType::Keyboard, Data);
 }
 
 void CPlatformInputQueue::Enqueue (const SMouseButtonEventData& Data)
 {
-	EnqueueInternal(EInputEventType::MouseButton, Data);
+	EnqueueInternal(GetRing(), EInputEventType::MouseButton, Data);
 }
 
 void CPlatformInputQueue::Enqueue (const SMouseMoveEventData& Data)
 {
-	EnqueueInternal(EInputEventType::MouseMove, Data);
+	EnqueueInternal(GetRing(), EInputEventType::MouseMove, Data);
 }
 
 void CPlatformInputQueue::Enqueue (const SMouseWheelEventData& Data)
 {
-	EnqueueInternal(EInputEventType::MouseWheel, Data);
+	EnqueueInternal(GetRing(), EInputEventType::MouseWheel, Data);
 }
 
 void CPlatformInputQueue::Enqueue (const SGamepadButtonEventData& Data)
 {
-	EnqueueInternal(EInputEventType::GamepadButton, Data);
+	EnqueueInternal(GetRing(), EInputEventType::GamepadButton, Data);
 }
 
 void CPlatformInputQueue::Enqueue (const SGamepadAxisEventData& Data)
 {
-	EnqueueInternal(EInputEventType::GamepadAxis, Data);
+	EnqueueInternal(GetRing(), EInputEventType::GamepadAxis, Data);
 }
 
 void CPlatformInputQueue::Enqueue (const SDeviceConnectionEventData& Data)
 {
-	EnqueueInternal(EInputEventType::DeviceConnection, Data);
+	EnqueueInternal(GetRing(), EInputEventType::DeviceConnection, Data);
 }
 
-void CPlatformInputQueue::Drain (std::vector<SInputEvent>& OutEvents)
+void CPlatformInputQueue::Clear ()
 {
-	std::scoped_lock lock(gQueueMutex);
-	if (gEventQueue.empty())
-	{
-		return;
-	}
-
-	OutEvents.insert(OutEvents.end(), gEventQueue.begin(), gEventQueue.end());
-	gEventQueue.clear();
+	GetRing().Clear();
 }
 
-void CPlatformInputQueue::Clear ()
+uint64 CPlatformInputQueue::GetDroppedCount ()
 {
-	std::scoped_lock lock(gQueueMutex);
-	gEventQueue.clear();
+	return GetRing().GetDroppedCount();
 }
 }
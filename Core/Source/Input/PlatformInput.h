@@ -1,9 +1,10 @@
 ﻿#pragma once
 
+#include <utility>
 #include <variant>
-#include <vector>
 
 #include "Core.h"
+#include "Containers/MpscRingBuffer.h"
 #include "Input/InputTypes.h"
 
 
@@ -36,9 +37,18 @@ struct SInputEvent
 };
 
 
+/**
+* Events from platform callbacks on their way to CInputSystem. Enqueue is lock-free and may be called from any thread;
+* Drain and Clear belong to the thread that runs CInputSystem::Update. If the game thread stalls long enough to fill
+* the queue, new events are dropped and counted rather than blocking the platform thread.
+*/
 class FRT_CORE_API CPlatformInputQueue
 {
 public:
+	/** Several seconds of a 1000 Hz mouse plus gamepads at frame rate */
+	static constexpr uint32 Capacity = 4096u;
+	using RingType = TMpscRingBuffer<SInputEvent, Capacity>;
+
 	static void Enqueue (const SKeyboardEventData& Data);
 	static void Enqueue (const SMouseButtonEventData& Data);
 	static void Enqueue (const SMouseMoveEventData& Data);
@@ -47,7 +57,16 @@ public:
 	static void Enqueue (const SGamepadAxisEventData& Data);
 	static void Enqueue (const SDeviceConnectionEventData& Data);
 
-	static void Drain (std::vector<SInputEvent>& OutEvents);
+	/** Calls InVisitor(const SInputEvent&) for every queued event, in place and oldest first; returns the count. */
+	template <typename TVisitor>
+	static uint32 Drain (TVisitor&& InVisitor) { return GetRing().Drain(std::forward<TVisitor>(InVisitor)); }
+
 	static void Clear ();
+
+	/** Events lost to a full queue since startup. */
+	static uint64 GetDroppedCount ();
+
+private:
+	static RingType& GetRing ();
 };
 }
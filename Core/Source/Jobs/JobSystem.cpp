@@ -0,0 +1,205 @@
+#include "JobSystem.h"
+
+#include "Asserts.h"
+#include "Math/MathUtility.h"
+
+
+namespace frt::jobs
+{
+namespace
+{
+thread_local const CJobSystem* tCurrentSystem = nullptr;
+thread_local uint32 tCurrentThreadIndex = CJobSystem::InvalidThreadIndex;
+
+/** Rounds of looking for jobs before an idle worker goes to sleep */
+constexpr uint32 IdleSpinCount = 64u;
+}
+
+
+CJobSystem::CJobSystem (uint32 InWorkerCount)
+{
+	if (InWorkerCount == DefaultWorkerCount)
+	{
+		const uint32 hardwareThreads = std::thread::hardware_concurrency();
+		InWorkerCount = hardwareThreads > 1u ? hardwareThreads - 1u : 0u;
+	}
+	WorkerCount = math::Min(InWorkerCount, MaxThreadCount - 1u);
+
+	Queues = new SThreadQueue[GetThreadCount()];
+
+	tCurrentSystem = this;
+	tCurrentThreadIndex = 0u;
+
+	Workers.SetCapacity(WorkerCount);
+	for (uint32 i = 1u; i <= WorkerCount; ++i)
+	{
+		Workers.Add(std::thread(&CJobSystem::WorkerMain, this, i));
+	}
+}
+
+CJobSystem::~CJobSystem ()
+{
+	bStopping.store(true, std::memory_order_seq_cst);
+	WorkSignal.fetch_add(1u, std::memory_order_seq_cst);
+	WorkSignal.notify_all();
+
+	for (std::thread& worker : Workers)
+	{
+		worker.join();
+	}
+	Workers.Clear();
+
+	if (tCurrentSystem == this)
+	{
+		tCurrentSystem = nullptr;
+		tCurrentThreadIndex = InvalidThreadIndex;
+	}
+
+	if (PrimaryInstance == this)
+	{
+		PrimaryInstance = nullptr;
+	}
+
+	delete[] Queues;
+}
+
+void CJobSystem::MakeThisPrimaryInstance ()
+{
+	PrimaryInstance = this;
+}
+
+CJobSystem* CJobSystem::GetPrimaryInstance ()
+{
+	return PrimaryInstance;
+}
+
+void CJobSystem::Run (SJob* InJobs, uint32 InCount, CJobCounter& InCounter)
+{
+	InCounter.Pending.fetch_add(InCount, std::memory_order_relaxed);
+
+	const uint32 threadIndex = GetCurrentThreadIndex();
+	if (WorkerCount == 0u || threadIndex == InvalidThreadIndex)
+	{
+		for (uint32 i = 0u; i < InCount; ++i)
+		{
+			InJobs[i].Counter = &InCounter;
+			Execute(InJobs[i]);
+		}
+		return;
+	}
+
+	bool bPushed = false;
+	for (uint32 i = 0u; i < InCount; ++i)
+	{
+		SJob& job = InJobs[i];
+		job.Counter = &InCounter;
+		if (Queues[threadIndex].Jobs.TryPush(&job))
+		{
+			bPushed = true;
+		}
+		else
+		{
+			Execute(job);
+		}
+	}
+
+	if (bPushed)
+	{
+		WakeWorkers();
+	}
+}
+
+void CJobSystem::Wait (const CJobCounter& InCounter)
+{
+	const uint32 threadIndex = GetCurrentThreadIndex();
+	while (!InCounter.IsDone())
+	{
+		if (threadIndex == InvalidThreadIndex || !TryRunJob(threadIndex))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+uint32 CJobSystem::GetCurrentThreadIndex () const
+{
+	return tCurrentSystem == this ? tCurrentThreadIndex : InvalidThreadIndex;
+}
+
+void CJobSystem::WorkerMain (uint32 InThreadIndex)
+{
+	tCurrentSystem = this;
+	tCurrentThreadIndex = InThreadIndex;
+
+	while (true)
+	{
+		// Read before looking, so jobs pushed after it are not missed by the sleep below
+		const uint32 signal = WorkSignal.load(std::memory_order_seq_cst);
+		if (bStopping.load(std::memory_order_relaxed))
+		{
+			break;
+		}
+
+		bool bRanJob = false;
+		for (uint32 spin = 0u; spin < IdleSpinCount && !bRanJob; ++spin)
+		{
+			bRanJob = TryRunJob(InThreadIndex);
+			if (!bRanJob)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		if (!bRanJob)
+		{
+			SleepingCount.fetch_add(1u, std::memory_order_seq_cst);
+			WorkSignal.wait(signal, std::memory_order_seq_cst);
+			SleepingCount.fetch_sub(1u, std::memory_order_relaxed);
+		}
+	}
+
+	tCurrentSystem = nullptr;
+	tCurrentThreadIndex = InvalidThreadIndex;
+}
+
+bool CJobSystem::TryRunJob (uint32 InThreadIndex)
+{
+	SJob* job = nullptr;
+	bool bFound = Queues[InThreadIndex].Jobs.TryPop(job);
+	if (!bFound)
+	{
+		const uint32 threadCount = GetThreadCount();
+		for (uint32 i = 1u; i < threadCount && !bFound; ++i)
+		{
+			bFound = Queues[(InThreadIndex + i) % threadCount].Jobs.TrySteal(job);
+		}
+	}
+
+	if (!bFound)
+	{
+		return false;
+	}
+
+	Execute(*job);
+	return true;
+}
+
+void CJobSystem::Execute (SJob& InJob)
+{
+	frt_assert(InJob.Function && InJob.Counter);
+
+	// The job may be gone as soon as the counter drops, take what's needed first
+	CJobCounter* counter = InJob.Counter;
+	InJob.Function(InJob.Data);
+	counter->Pending.fetch_sub(1u, std::memory_order_acq_rel);
+}
+
+void CJobSystem::WakeWorkers ()
+{
+	WorkSignal.fetch_add(1u, std::memory_order_seq_cst);
+	if (SleepingCount.load(std::memory_order_seq_cst) > 0u)
+	{
+		WorkSignal.notify_all();
+	}
+}
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include "Core.h"
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+#include "Containers/Array.h"
+#include "Containers/WorkStealingDeque.h"
+
+
+namespace frt::jobs
+{
+/** Number of jobs of a batch that haven't finished yet; waiting for it is the fence before the dependent work */
+class CJobCounter
+{
+public:
+	FRT_DELETE_COPY_AND_MOVE_OPS(CJobCounter);
+
+	CJobCounter () = default;
+
+	bool IsDone () const { return Pending.load(std::memory_order_acquire) == 0u; }
+
+private:
+	friend class CJobSystem;
+
+	std::atomic<uint32> Pending = 0u;
+};
+
+
+struct SJob
+{
+	using FunctionType = void (*) (void* InData);
+
+	FunctionType Function = nullptr;
+	void* Data = nullptr;
+	/** Set by CJobSystem::Run */
+	CJobCounter* Counter = nullptr;
+};
+
+
+/**
+* Fixed pool of worker threads that run jobs, for splitting frame work across cores. Key points:
+*	- Every thread of the system (the workers and the owner, the thread that created it) has its own
+*	  work-stealing deque; jobs are pushed to the deque of the thread that runs them, idle threads steal
+*	  from the others
+*	- Dependencies are expressed with counters: Wait returns once all jobs run with the counter have finished,
+*	  and runs other jobs in the meantime instead of blocking, so jobs may run and wait for jobs of their own
+*	- Idle workers spin a little, then sleep until new jobs are pushed
+*	- Threads outside of the system, a system without workers and jobs that don't fit into a full deque
+*	  run inline, so single-core runs take the same code path
+*	- Jobs and counters are owned by the caller and must stay alive until the counter is done
+*/
+class FRT_CORE_API CJobSystem
+{
+public:
+	static constexpr uint32 MaxThreadCount = 64u;
+	static constexpr uint32 QueueCapacity = 1024u;
+	static constexpr uint32 InvalidThreadIndex = ~0u;
+	/** One worker per hardware thread, except the one of the owner */
+	static constexpr uint32 DefaultWorkerCount = ~0u;
+
+	FRT_DELETE_COPY_AND_MOVE_OPS(CJobSystem);
+
+	explicit CJobSystem (uint32 InWorkerCount = DefaultWorkerCount);
+	~CJobSystem ();
+
+	void MakeThisPrimaryInstance ();
+	static CJobSystem* GetPrimaryInstance ();
+
+	// Jobs
+	/** Queues the jobs on the calling thread and counts them in InCounter. */
+	void Run (SJob* InJobs, uint32 InCount, CJobCounter& InCounter);
+	void Run (SJob& InJob, CJobCounter& InCounter) { Run(&InJob, 1u, InCounter); }
+
+	/** Runs queued jobs until the counter is done. */
+	void Wait (const CJobCounter& InCounter);
+	// ~Jobs
+
+	// Getters
+	uint32 GetWorkerCount () const { return WorkerCount; }
+	/** Workers and the owner */
+	uint32 GetThreadCount () const { return WorkerCount + 1u; }
+
+	/** 0 for the owner, 1 and up for workers, InvalidThreadIndex for threads outside of the system */
+	uint32 GetCurrentThreadIndex () const;
+	// ~Getters
+
+private:
+	struct alignas(64) SThreadQueue
+	{
+		TWorkStealingDeque<SJob*, QueueCapacity> Jobs;
+	};
+
+	void WorkerMain (uint32 InThreadIndex);
+
+	/** Runs one job from the own deque, or stolen from another one. Returns false if there was none. */
+	bool TryRunJob (uint32 InThreadIndex);
+	static void Execute (SJob& InJob);
+
+	void WakeWorkers ();
+
+private:
+	uint32 WorkerCount = 0u;
+	SThreadQueue* Queues = nullptr;
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+	TArray<std::thread> Workers;
+
+	/** Bumped whenever jobs are pushed, sleeping workers wait for it to change */
+	std::atomic<uint32> WorkSignal = 0u;
+	std::atomic<uint32> SleepingCount = 0u;
+	std::atomic<bool> bStopping = false;
+#pragma warning(pop)
+
+	static inline CJobSystem* PrimaryInstance = nullptr;
+};
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Jobs/JobSystem.h"
+#include "Math/MathUtility.h"
+
+
+namespace frt::jobs
+{
+/**
+* Splits [0, InCount) into batches of InGrainSize and calls InFunction(uint32 Begin, uint32 End) for each,
+* on the workers of the primary job system and the calling thread; returns when all batches are done.
+* Key points:
+*	- Batches are handed out from a shared counter, so threads that got cheap ones simply take more
+*	- Runs inline, in order, if there is nothing to split, no workers or the caller isn't a thread of the system
+*	- InFunction runs concurrently with itself: batches must not write to shared state without synchronization
+*/
+template <typename TFunction>
+void ParallelFor (uint32 InCount, uint32 InGrainSize, TFunction&& InFunction);
+
+/** Calls InFunction(T&) for every element, InGrainSize elements per batch. */
+template <typename T, typename TFunction>
+void ParallelFor (std::span<T> InRange, uint32 InGrainSize, TFunction&& InFunction);
+
+template <typename T, typename TAllocator, typename TFunction>
+void ParallelFor (TArray<T, TAllocator>& InArray, uint32 InGrainSize, TFunction&& InFunction);
+
+
+namespace _private
+{
+	template <typename TFunction>
+	struct TParallelForContext
+	{
+		TFunction* Function = nullptr;
+		uint32 Count = 0u;
+		uint32 GrainSize = 1u;
+		uint32 BatchCount = 0u;
+		std::atomic<uint32> NextBatch = 0u;
+
+		void RunBatches ()
+		{
+			for (uint32 batch = NextBatch.fetch_add(1u, std::memory_order_relaxed);
+				batch < BatchCount;
+				batch = NextBatch.fetch_add(1u, std::memory_order_relaxed))
+			{
+				const uint32 begin = batch * GrainSize;
+				(*Function)(begin, math::Min(begin + GrainSize, Count));
+			}
+		}
+
+		static void RunBatchesJob (void* InContext)
+		{
+			static_cast<TParallelForContext*>(InContext)->RunBatches();
+		}
+	};
+}
+}
+
+
+namespace frt::jobs
+{
+template <typename TFunction>
+void ParallelFor (uint32 InCount, uint32 InGrainSize, TFunction&& InFunction)
+{
+	if (InCount == 0u)
+	{
+		return;
+	}
+
+	const uint32 grainSize = math::Max(InGrainSize, 1u);
+	const uint32 batchCount = (InCount - 1u) / grainSize + 1u;
+
+	CJobSystem* jobSystem = CJobSystem::GetPrimaryInstance();
+	if (batchCount == 1u
+		|| !jobSystem
+		|| jobSystem->GetWorkerCount() == 0u
+		|| jobSystem->GetCurrentThreadIndex() == CJobSystem::InvalidThreadIndex)
+	{
+		InFunction(0u, InCount);
+		return;
+	}
+
+	using ContextType = _private::TParallelForContext<std::remove_reference_t<TFunction>>;
+	ContextType context;
+	context.Function = &InFunction;
+	context.Count = InCount;
+	context.GrainSize = grainSize;
+	context.BatchCount = batchCount;
+
+	// The caller takes batches too, so one helper less than batches is enough
+	const uint32 helperCount = math::Min(batchCount - 1u, jobSystem->GetWorkerCount());
+	SJob helpers[CJobSystem::MaxThreadCount];
+	for (uint32 i = 0u; i < helperCount; ++i)
+	{
+		helpers[i].Function = &ContextType::RunBatchesJob;
+		helpers[i].Data = &context;
+	}
+
+	CJobCounter counter;
+	jobSystem->Run(helpers, helperCount, counter);
+	context.RunBatches();
+	jobSystem->Wait(counter);
+}
+
+template <typename T, typename TFunction>
+void ParallelFor (std::span<T> InRange, uint32 InGrainSize, TFunction&& InFunction)
+{
+	T* data = InRange.data();
+	ParallelFor((uint32)InRange.size(), InGrainSize,
+		[data, &InFunction] (uint32 InBegin, uint32 InEnd)
+		{
+			for (uint32 i = InBegin; i < InEnd; ++i)
+			{
+				InFunction(data[i]);
+			}
+		});
+}
+
+template <typename T, typename TAllocator, typename TFunction>
+void ParallelFor (TArray<T, TAllocator>& InArray, uint32 InGrainSize, TFunction&& InFunction)
+{
+	ParallelFor(std::span<T>(InArray.GetData(), InArray.Count()), InGrainSize, std::forward<TFunction>(InFunction));
+}
+}
@@ -88,11 +88,11 @@ namespace math
 #if defined(__GNUC__) || defined(__GNUG__) || defined(__clang__)
 		if constexpr (sizeof(T) == 8u)
 		{
-			highestBitIdx = sizeof(T) * 8 - __builtin_ctzll(Value) - 1;
+			highestBitIdx = 63 - __builtin_clzll(Value);
 		}
 		else
 		{
-			highestBitIdx = sizeof(T) * 8 - __builtin_ctz(Value) - 1;
+			highestBitIdx = 31 - __builtin_clz((uint32)Value);
 		}
 #elif defined(_MSC_VER)
 		if constexpr (sizeof(T) == 8u)
@@ -4,30 +4,35 @@
 
 #include "Core.h"
 #include "Math.h"
+#include "TransformBatch.h"
 
 
 namespace frt::math
 {
+/**
+* Translation, rotation and scale, relative to the parent if there is one (see Comp_Parent).
+* Doesn't cache its matrix: world matrices are kept by Sys_TransformHierarchy, which recomposes only the ones
+* whose transform is dirty. Every setter marks it dirty.
+*/
 struct FRT_CORE_API STransform
 {
 	using RawType = DirectX::XMFLOAT4X4;
 
 private:
-#pragma warning(push)
-#pragma warning(disable: 4251)
-	mutable DirectX::XMFLOAT4X4 Matrix4x4;
-	mutable DirectX::XMMATRIX MatrixIntr;
-#pragma warning(pop)
-
 	Vector3f Translation;
 	Vector3f Rotation;
 	Vector3f Scale;
+	bool bDirty = true;
 
 public:
 	STransform ();
 
-	const DirectX::XMFLOAT4X4& GetMatrix () const;
-	DirectX::XMFLOAT3X4 GetRaytracingTransform () const;
+	/** Composed from translation, rotation and scale on every call, see ComposeMatrices for many at once. */
+	DirectX::XMFLOAT4X4 ComputeMatrix () const;
+
+	bool IsDirty () const { return bDirty; }
+	void MarkDirty () { bDirty = true; }
+	void ClearDirty () { bDirty = false; }
 
 	const Vector3f& GetTranslation () const { return Translation; }
 	const Vector3f& GetRotation () const { return Rotation; }
@@ -52,30 +57,21 @@ inline STransform::STransform ()
 	: Translation(Vector3f::ZeroVector)
 	, Rotation(Vector3f::ZeroVector)
 	, Scale(Vector3f::OneVector)
-{
-	MatrixIntr = DirectX::XMMatrixIdentity();
-	DirectX::XMStoreFloat4x4(&Matrix4x4, MatrixIntr);
-}
+{}
 
-inline const DirectX::XMFLOAT4X4& STransform::GetMatrix () const
+inline DirectX::XMFLOAT4X4 STransform::ComputeMatrix () const
 {
-	using namespace DirectX;
-
-	const XMMATRIX rotation = XMMatrixRotationRollPitchYaw(Rotation.x, Rotation.y, Rotation.z);
-	const XMMATRIX scale = XMMatrixScaling(Scale.x, Scale.y, Scale.z);
-	const XMMATRIX translation = XMMatrixTranslation(Translation.x, Translation.y, Translation.z);
-	const XMMATRIX engineMatrix = XMMatrixMultiply(XMMatrixMultiply(rotation, scale), translation);
-	const XMMATRIX lufToDx = XMMatrixScaling(-1.f, 1.f, 1.f);
-	MatrixIntr = XMMatrixMultiply(lufToDx, engineMatrix);
-
-	XMStoreFloat4x4(&Matrix4x4, MatrixIntr);
-
-	return Matrix4x4;
+	// Same path as the scalar tail of ComposeMatrices, so single and batched results match bit for bit
+	return ComposeMatrix(
+		Translation.x, Translation.y, Translation.z,
+		Rotation.x, Rotation.y, Rotation.z,
+		Scale.x, Scale.y, Scale.z);
 }
 
-inline DirectX::XMFLOAT3X4 STransform::GetRaytracingTransform () const
+/** Row-major 3x4 of the matrix, the layout raytracing instance descs take. */
+inline DirectX::XMFLOAT3X4 ToRaytracingTransform (const DirectX::XMFLOAT4X4& InMatrix)
 {
-	const DirectX::XMFLOAT4X4& m = GetMatrix();
+	const DirectX::XMFLOAT4X4& m = InMatrix;
 
 	return DirectX::XMFLOAT3X4(
 		m._11, m._21, m._31, m._41,
@@ -86,45 +82,54 @@ inline DirectX::XMFLOAT3X4 STransform::GetRaytracingTransform () const
 inline void STransform::SetTranslation (float X, float Y, float Z)
 {
 	Translation = Vector3f(X, Y, Z);
+	bDirty = true;
 }
 
 inline void STransform::SetTranslation (const Vector3f& InTranslation)
 {
 	Translation = InTranslation;
+	bDirty = true;
 }
 
 inline void STransform::SetRotation (float X, float Y, float Z)
 {
 	Rotation = Vector3f(X, Y, Z);
+	bDirty = true;
 }
 
 inline void STransform::SetRotation (const Vector3f& InRotation)
 {
 	Rotation = InRotation;
+	bDirty = true;
 }
 
 inline void STransform::SetScale (float InScale)
 {
 	Scale = Vector3f(InScale);
+	bDirty = true;
 }
 
 inline void STransform::SetScale (const Vector3f& InScale)
 {
 	Scale = InScale;
+	bDirty = true;
 }
 
 inline void STransform::MoveBy (const Vector3f& Delta)
 {
 	Translation += Delta;
+	bDirty = true;
 }
 
 inline void STransform::RotateBy (const Vector3f& Delta)
 {
 	Rotation += Delta;
+	bDirty = true;
 }
 
 inline void STransform::ScaleBy (float Delta)
 {
 	Scale *= Delta;
+	bDirty = true;
 }
 }
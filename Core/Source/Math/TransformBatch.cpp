@@ -0,0 +1,255 @@
+#include "TransformBatch.h"
+
+#if FRT_TRANSFORM_BATCH_LANES > 4
+#include <immintrin.h>
+#elif FRT_TRANSFORM_BATCH_LANES == 4
+#include <emmintrin.h>
+#endif
+
+
+namespace frt::math
+{
+namespace
+{
+#if FRT_TRANSFORM_BATCH_LANES > 1
+/** Writes 4 matrices given as 16 vectors of entries (one lane per matrix) in row-major order. */
+void StoreTransposed (__m128 (&InEntries)[16], DirectX::XMFLOAT4X4* OutMatrices)
+{
+	for (uint32 row = 0; row < 4u; ++row)
+	{
+		__m128 a = InEntries[row * 4u];
+		__m128 b = InEntries[row * 4u + 1u];
+		__m128 c = InEntries[row * 4u + 2u];
+		__m128 d = InEntries[row * 4u + 3u];
+		_MM_TRANSPOSE4_PS(a, b, c, d);
+		_mm_storeu_ps(&OutMatrices[0].m[row][0], a);
+		_mm_storeu_ps(&OutMatrices[1].m[row][0], b);
+		_mm_storeu_ps(&OutMatrices[2].m[row][0], c);
+		_mm_storeu_ps(&OutMatrices[3].m[row][0], d);
+	}
+}
+#endif
+
+#if FRT_TRANSFORM_BATCH_LANES == 16
+struct SLanes
+{
+	using Type = __m512;
+	using Mask = __mmask16;
+
+	static Type Load (const float* InData) { return _mm512_loadu_ps(InData); }
+	static Type Set (float InValue) { return _mm512_set1_ps(InValue); }
+	static Type Add (Type A, Type B) { return _mm512_add_ps(A, B); }
+	static Type Sub (Type A, Type B) { return _mm512_sub_ps(A, B); }
+	static Type Mul (Type A, Type B) { return _mm512_mul_ps(A, B); }
+	static Type Negate (Type A)
+	{
+		return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(A), _mm512_set1_epi32(0x80000000)));
+	}
+	static Type Round (Type A) { return _mm512_cvtepi32_ps(_mm512_cvtps_epi32(A)); }
+
+	static Mask Greater (Type A, Type B) { return _mm512_cmp_ps_mask(A, B, _CMP_GT_OQ); }
+	static Mask Less (Type A, Type B) { return _mm512_cmp_ps_mask(A, B, _CMP_LT_OQ); }
+	static Mask Or (Mask A, Mask B) { return static_cast<Mask>(A | B); }
+	static Type Select (Mask InMask, Type InTrue, Type InFalse) { return _mm512_mask_blend_ps(InMask, InFalse, InTrue); }
+
+	static void Store (Type (&InEntries)[16], DirectX::XMFLOAT4X4* OutMatrices)
+	{
+		StoreQuarter<0>(InEntries, OutMatrices);
+		StoreQuarter<1>(InEntries, OutMatrices + 4);
+		StoreQuarter<2>(InEntries, OutMatrices + 8);
+		StoreQuarter<3>(InEntries, OutMatrices + 12);
+	}
+
+	template <int TQuarter>
+	static void StoreQuarter (Type (&InEntries)[16], DirectX::XMFLOAT4X4* OutMatrices)
+	{
+		__m128 entries[16];
+		for (uint32 i = 0; i < 16u; ++i)
+		{
+			entries[i] = _mm512_extractf32x4_ps(InEntries[i], TQuarter);
+		}
+		StoreTransposed(entries, OutMatrices);
+	}
+};
+#elif FRT_TRANSFORM_BATCH_LANES == 8
+struct SLanes
+{
+	using Type = __m256;
+	using Mask = __m256;
+
+	static Type Load (const float* InData) { return _mm256_loadu_ps(InData); }
+	static Type Set (float InValue) { return _mm256_set1_ps(InValue); }
+	static Type Add (Type A, Type B) { return _mm256_add_ps(A, B); }
+	static Type Sub (Type A, Type B) { return _mm256_sub_ps(A, B); }
+	static Type Mul (Type A, Type B) { return _mm256_mul_ps(A, B); }
+	static Type Negate (Type A) { return _mm256_xor_ps(A, _mm256_set1_ps(-0.f)); }
+	static Type Round (Type A) { return _mm256_cvtepi32_ps(_mm256_cvtps_epi32(A)); }
+
+	static Mask Greater (Type A, Type B) { return _mm256_cmp_ps(A, B, _CMP_GT_OQ); }
+	static Mask Less (Type A, Type B) { return _mm256_cmp_ps(A, B, _CMP_LT_OQ); }
+	static Mask Or (Mask A, Mask B) { return _mm256_or_ps(A, B); }
+	static Type Select (Mask InMask, Type InTrue, Type InFalse) { return _mm256_blendv_ps(InFalse, InTrue, InMask); }
+
+	static void Store (Type (&InEntries)[16], DirectX::XMFLOAT4X4* OutMatrices)
+	{
+		__m128 low[16];
+		__m128 high[16];
+		for (uint32 i = 0; i < 16u; ++i)
+		{
+			low[i] = _mm256_castps256_ps128(InEntries[i]);
+			high[i] = _mm256_extractf128_ps(InEntries[i], 1);
+		}
+		StoreTransposed(low, OutMatrices);
+		StoreTransposed(high, OutMatrices + 4);
+	}
+};
+#elif FRT_TRANSFORM_BATCH_LANES == 4
+struct SLanes
+{
+	using Type = __m128;
+	using Mask = __m128;
+
+	static Type Load (const float* InData) { return _mm_loadu_ps(InData); }
+	static Type Set (float InValue) { return _mm_set1_ps(InValue); }
+	static Type Add (Type A, Type B) { return _mm_add_ps(A, B); }
+	static Type Sub (Type A, Type B) { return _mm_sub_ps(A, B); }
+	static Type Mul (Type A, Type B) { return _mm_mul_ps(A, B); }
+	static Type Negate (Type A) { return _mm_xor_ps(A, _mm_set1_ps(-0.f)); }
+	static Type Round (Type A) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(A)); }
+
+	static Mask Greater (Type A, Type B) { return _mm_cmpgt_ps(A, B); }
+	static Mask Less (Type A, Type B) { return _mm_cmplt_ps(A, B); }
+	static Mask Or (Mask A, Mask B) { return _mm_or_ps(A, B); }
+	static Type Select (Mask InMask, Type InTrue, Type InFalse)
+	{
+		return _mm_or_ps(_mm_and_ps(InMask, InTrue), _mm_andnot_ps(InMask, InFalse));
+	}
+
+	static void Store (Type (&InEntries)[16], DirectX::XMFLOAT4X4* OutMatrices)
+	{
+		StoreTransposed(InEntries, OutMatrices);
+	}
+};
+#endif
+
+#if FRT_TRANSFORM_BATCH_LANES > 1
+/** Lane-wise _private::SinCos, operation for operation */
+template <typename TLanes>
+void SinCosLanes (typename TLanes::Type InAngle, typename TLanes::Type& OutSin, typename TLanes::Type& OutCos)
+{
+	using L = TLanes;
+	using V = typename TLanes::Type;
+
+	const V quotient = L::Round(L::Mul(InAngle, L::Set(_private::InvTwoPi)));
+	V y = L::Sub(InAngle, L::Mul(L::Set(_private::TwoPi), quotient));
+
+	const typename L::Mask above = L::Greater(y, L::Set(_private::HalfPi));
+	const typename L::Mask below = L::Less(y, L::Set(-_private::HalfPi));
+	y = L::Select(above, L::Sub(L::Set(_private::Pi), y), L::Select(below, L::Sub(L::Set(-_private::Pi), y), y));
+	const V sign = L::Select(L::Or(above, below), L::Set(-1.f), L::Set(1.f));
+
+	const V y2 = L::Mul(y, y);
+
+	V sine = L::Add(L::Mul(L::Set(-2.3889859e-08f), y2), L::Set(2.7525562e-06f));
+	sine = L::Sub(L::Mul(sine, y2), L::Set(0.00019840874f));
+	sine = L::Add(L::Mul(sine, y2), L::Set(0.0083333310f));
+	sine = L::Sub(L::Mul(sine, y2), L::Set(0.16666667f));
+	sine = L::Add(L::Mul(sine, y2), L::Set(1.f));
+	OutSin = L::Mul(sine, y);
+
+	V cosine = L::Add(L::Mul(L::Set(-2.6051615e-07f), y2), L::Set(2.4760495e-05f));
+	cosine = L::Sub(L::Mul(cosine, y2), L::Set(0.0013888378f));
+	cosine = L::Add(L::Mul(cosine, y2), L::Set(0.041666638f));
+	cosine = L::Sub(L::Mul(cosine, y2), L::Set(0.5f));
+	cosine = L::Add(L::Mul(cosine, y2), L::Set(1.f));
+	OutCos = L::Mul(sign, cosine);
+}
+
+/** Lane-wise ComposeMatrix of the transforms from InIndex on */
+template <typename TLanes>
+void ComposeLanes (const STransformArrays& InTransforms, uint32 InIndex, DirectX::XMFLOAT4X4* OutMatrices)
+{
+	using L = TLanes;
+	using V = typename TLanes::Type;
+
+	V sp, cp, sy, cy, sr, cr;
+	SinCosLanes<L>(L::Load(InTransforms.RotationX + InIndex), sp, cp);
+	SinCosLanes<L>(L::Load(InTransforms.RotationY + InIndex), sy, cy);
+	SinCosLanes<L>(L::Load(InTransforms.RotationZ + InIndex), sr, cr);
+
+	const V srsp = L::Mul(sr, sp);
+	const V crsp = L::Mul(cr, sp);
+
+	const V r00 = L::Add(L::Mul(cr, cy), L::Mul(srsp, sy));
+	const V r01 = L::Mul(sr, cp);
+	const V r02 = L::Sub(L::Mul(srsp, cy), L::Mul(cr, sy));
+	const V r10 = L::Sub(L::Mul(crsp, sy), L::Mul(sr, cy));
+	const V r11 = L::Mul(cr, cp);
+	const V r12 = L::Add(L::Mul(sr, sy), L::Mul(crsp, cy));
+	const V r20 = L::Mul(cp, sy);
+	const V r21 = L::Negate(sp);
+	const V r22 = L::Mul(cp, cy);
+
+	const V scaleX = L::Load(InTransforms.ScaleX + InIndex);
+	const V scaleY = L::Load(InTransforms.ScaleY + InIndex);
+	const V scaleZ = L::Load(InTransforms.ScaleZ + InIndex);
+	const V zero = L::Set(0.f);
+
+	V entries[16] = {
+		L::Negate(L::Mul(r00, scaleX)), L::Negate(L::Mul(r01, scaleY)), L::Negate(L::Mul(r02, scaleZ)), zero,
+		L::Mul(r10, scaleX), L::Mul(r11, scaleY), L::Mul(r12, scaleZ), zero,
+		L::Mul(r20, scaleX), L::Mul(r21, scaleY), L::Mul(r22, scaleZ), zero,
+		L::Load(InTransforms.TranslationX + InIndex),
+		L::Load(InTransforms.TranslationY + InIndex),
+		L::Load(InTransforms.TranslationZ + InIndex),
+		L::Set(1.f) };
+
+	L::Store(entries, OutMatrices);
+}
+#endif
+
+void ComposeScalarRange (const STransformArrays& InTransforms, uint32 InFirst, DirectX::XMFLOAT4X4* OutMatrices)
+{
+	for (uint32 i = InFirst; i < InTransforms.Count; ++i)
+	{
+		OutMatrices[i] = ComposeMatrix(
+			InTransforms.TranslationX[i], InTransforms.TranslationY[i], InTransforms.TranslationZ[i],
+			InTransforms.RotationX[i], InTransforms.RotationY[i], InTransforms.RotationZ[i],
+			InTransforms.ScaleX[i], InTransforms.ScaleY[i], InTransforms.ScaleZ[i]);
+	}
+}
+}
+
+
+void ComposeMatrices (const STransformArrays& InTransforms, DirectX::XMFLOAT4X4* OutMatrices)
+{
+	uint32 i = 0u;
+
+#if FRT_TRANSFORM_BATCH_LANES > 1
+	for (; i + FRT_TRANSFORM_BATCH_LANES <= InTransforms.Count; i += FRT_TRANSFORM_BATCH_LANES)
+	{
+		ComposeLanes<SLanes>(InTransforms, i, OutMatrices + i);
+	}
+#endif
+
+	ComposeScalarRange(InTransforms, i, OutMatrices);
+}
+
+void ComposeMatricesScalar (const STransformArrays& InTransforms, DirectX::XMFLOAT4X4* OutMatrices)
+{
+	ComposeScalarRange(InTransforms, 0u, OutMatrices);
+}
+
+const char* GetTransformBatchInstructionSet ()
+{
+#if FRT_TRANSFORM_BATCH_LANES == 16
+	return "AVX-512";
+#elif FRT_TRANSFORM_BATCH_LANES == 8
+	return "AVX2";
+#elif FRT_TRANSFORM_BATCH_LANES == 4
+	return "SSE2";
+#else
+	return "Scalar";
+#endif
+}
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cmath>
+
+#include <DirectXMath.h>
+
+#include "Asserts.h"
+#include "Core.h"
+#include "CoreTypes.h"
+#include "Math.h"
+
+#if defined(__AVX512F__)
+#define FRT_TRANSFORM_BATCH_LANES 16
+#elif defined(__AVX2__)
+#define FRT_TRANSFORM_BATCH_LANES 8
+#elif defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRT_TRANSFORM_BATCH_LANES 4
+#else
+#define FRT_TRANSFORM_BATCH_LANES 1
+#endif
+
+
+namespace frt::math
+{
+/**
+* Translations, rotations (pitch, yaw, roll in radians, as in STransform) and scales of Count transforms,
+* one array per component.
+*/
+struct STransformArrays
+{
+	const float* TranslationX = nullptr;
+	const float* TranslationY = nullptr;
+	const float* TranslationZ = nullptr;
+	const float* RotationX = nullptr;
+	const float* RotationY = nullptr;
+	const float* RotationZ = nullptr;
+	const float* ScaleX = nullptr;
+	const float* ScaleY = nullptr;
+	const float* ScaleZ = nullptr;
+	uint32 Count = 0u;
+};
+
+/**
+* Composes the matrices of all transforms, the same way STransform::ComputeMatrix does. Key points:
+*	- Transforms are processed 16, 8 or 4 at a time with AVX-512, AVX2 or SSE2, whichever the build targets
+*	  (see FRT_TRANSFORM_BATCH_LANES); the rest and builds without SSE2 go through the scalar path
+*	- Every lane does the same operations in the same order as the scalar path, with its own sine and cosine,
+*	  so results are bitwise equal to ComputeMatrix whatever the width (given floating-point contraction is off,
+*	  the MSVC default)
+*	- Input arrays need no alignment, outputs are written linearly
+*/
+FRT_CORE_API void ComposeMatrices (const STransformArrays& InTransforms, DirectX::XMFLOAT4X4* OutMatrices);
+
+/** Scalar path of ComposeMatrices, for tests and benchmarks. */
+FRT_CORE_API void ComposeMatricesScalar (const STransformArrays& InTransforms, DirectX::XMFLOAT4X4* OutMatrices);
+
+/** Instruction set ComposeMatrices was built with: "AVX-512", "AVX2", "SSE2" or "Scalar" */
+FRT_CORE_API const char* GetTransformBatchInstructionSet ();
+
+
+/** Staging for transforms gathered from structures (STransform, components) to feed ComposeMatrices. */
+template <uint32 TCapacity>
+struct TTransformBlock
+{
+	static constexpr uint32 Capacity = TCapacity;
+
+	alignas(64) float TranslationX[TCapacity];
+	alignas(64) float TranslationY[TCapacity];
+	alignas(64) float TranslationZ[TCapacity];
+	alignas(64) float RotationX[TCapacity];
+	alignas(64) float RotationY[TCapacity];
+	alignas(64) float RotationZ[TCapacity];
+	alignas(64) float ScaleX[TCapacity];
+	alignas(64) float ScaleY[TCapacity];
+	alignas(64) float ScaleZ[TCapacity];
+	uint32 Count = 0u;
+
+	bool IsFull () const { return Count == TCapacity; }
+	bool IsEmpty () const { return Count == 0u; }
+	void Clear () { Count = 0u; }
+
+	/** Returns the index of the transform in the block. */
+	uint32 Add (const Vector3f& InTranslation, const Vector3f& InRotation, const Vector3f& InScale);
+
+	STransformArrays GetArrays () const;
+};
+
+
+namespace _private
+{
+inline constexpr float Pi = 3.141592654f;
+inline constexpr float HalfPi = 1.570796327f;
+inline constexpr float TwoPi = 6.283185307f;
+inline constexpr float InvTwoPi = 0.159154943f;
+
+/** 11- and 10-degree minimax polynomials on [-Pi/2, Pi/2], the same the SIMD paths evaluate */
+inline void SinCos (float InAngle, float& OutSin, float& OutCos)
+{
+	// Ties to even, as the SIMD conversions round
+	const float quotient = std::nearbyint(InAngle * InvTwoPi);
+	float y = InAngle - TwoPi * quotient;
+
+	float sign = 1.f;
+	if (y > HalfPi)
+	{
+		y = Pi - y;
+		sign = -1.f;
+	}
+	else if (y < -HalfPi)
+	{
+		y = -Pi - y;
+		sign = -1.f;
+	}
+
+	const float y2 = y * y;
+	OutSin = (((((-2.3889859e-08f * y2 + 2.7525562e-06f) * y2 - 0.00019840874f) * y2 + 0.0083333310f) * y2
+		- 0.16666667f) * y2 + 1.f) * y;
+	const float cosine = ((((-2.6051615e-07f * y2 + 2.4760495e-05f) * y2 - 0.0013888378f) * y2 + 0.041666638f) * y2
+		- 0.5f) * y2 + 1.f;
+	OutCos = sign * cosine;
+}
+}
+
+/**
+* Rotation * scale * translation in row-vector convention, rotation as XMMatrixRotationRollPitchYaw builds it,
+* followed by the LUF to DirectX flip of the X axis.
+*/
+inline DirectX::XMFLOAT4X4 ComposeMatrix (
+	float InTranslationX, float InTranslationY, float InTranslationZ,
+	float InRotationX, float InRotationY, float InRotationZ,
+	float InScaleX, float InScaleY, float InScaleZ)
+{
+	float sp, cp, sy, cy, sr, cr;
+	_private::SinCos(InRotationX, sp, cp);
+	_private::SinCos(InRotationY, sy, cy);
+	_private::SinCos(InRotationZ, sr, cr);
+
+	const float srsp = sr * sp;
+	const float crsp = cr * sp;
+
+	const float r00 = cr * cy + srsp * sy;
+	const float r01 = sr * cp;
+	const float r02 = srsp * cy - cr * sy;
+	const float r10 = crsp * sy - sr * cy;
+	const float r11 = cr * cp;
+	const float r12 = sr * sy + crsp * cy;
+	const float r20 = cp * sy;
+	const float r21 = -sp;
+	const float r22 = cp * cy;
+
+	return DirectX::XMFLOAT4X4(
+		-(r00 * InScaleX), -(r01 * InScaleY), -(r02 * InScaleZ), 0.f,
+		r10 * InScaleX, r11 * InScaleY, r12 * InScaleZ, 0.f,
+		r20 * InScaleX, r21 * InScaleY, r22 * InScaleZ, 0.f,
+		InTranslationX, InTranslationY, InTranslationZ, 1.f);
+}
+}
+
+
+namespace frt::math
+{
+template <uint32 TCapacity>
+uint32 TTransformBlock<TCapacity>::Add (const Vector3f& InTranslation, const Vector3f& InRotation, const Vector3f& InScale)
+{
+	frt_assert(Count < TCapacity);
+
+	const uint32 index = Count++;
+	TranslationX[index] = InTranslation.x;
+	TranslationY[index] = InTranslation.y;
+	TranslationZ[index] = InTranslation.z;
+	RotationX[index] = InRotation.x;
+	RotationY[index] = InRotation.y;
+	RotationZ[index] = InRotation.z;
+	ScaleX[index] = InScale.x;
+	ScaleY[index] = InScale.y;
+	ScaleZ[index] = InScale.z;
+	return index;
+}
+
+template <uint32 TCapacity>
+STransformArrays TTransformBlock<TCapacity>::GetArrays () const
+{
+	STransformArrays arrays;
+	arrays.TranslationX = TranslationX;
+	arrays.TranslationY = TranslationY;
+	arrays.TranslationZ = TranslationZ;
+	arrays.RotationX = RotationX;
+	arrays.RotationY = RotationY;
+	arrays.RotationZ = RotationZ;
+	arrays.ScaleX = ScaleX;
+	arrays.ScaleY = ScaleY;
+	arrays.ScaleZ = ScaleZ;
+	arrays.Count = Count;
+	return arrays;
+}
+}
@@ -0,0 +1,192 @@
+#include "AllocationTrace.h"
+
+#include <atomic>
+
+#include "Asserts.h"
+
+
+namespace frt::memory
+{
+namespace
+{
+std::atomic<uint16> gThreadCount = 0u;
+}
+
+
+CAllocationTraceRecorder::~CAllocationTraceRecorder ()
+{
+	Stop();
+}
+
+bool CAllocationTraceRecorder::Start (const std::filesystem::path& InPath)
+{
+	std::scoped_lock lock(Mutex);
+
+	frt_assert(!bRecording);
+
+	Stream.open(InPath, std::ios::binary | std::ios::trunc);
+	if (!Stream.is_open())
+	{
+		return false;
+	}
+
+	// Event count is patched in on Stop
+	const STraceFileHeader header;
+	Stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	NextAddressId = 0u;
+	EventCount = 0ull;
+	LiveBlocks.clear();
+	Pending.clear();
+	Pending.reserve(EventsPerWrite);
+	StartTime = std::chrono::steady_clock::now();
+	bRecording = true;
+	return true;
+}
+
+void CAllocationTraceRecorder::Stop ()
+{
+	std::scoped_lock lock(Mutex);
+
+	if (!bRecording)
+	{
+		return;
+	}
+
+	WritePending();
+
+	STraceFileHeader header;
+	header.EventCount = EventCount;
+	Stream.seekp(0);
+	Stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	Stream.close();
+
+	LiveBlocks.clear();
+	bRecording = false;
+}
+
+void CAllocationTraceRecorder::OnAllocate (const void* Memory, uint64 Size)
+{
+	if (!Memory)
+	{
+		return;
+	}
+
+	std::scoped_lock lock(Mutex);
+
+	if (bRecording)
+	{
+		const uint32 id = NextAddressId++;
+		LiveBlocks[Memory] = { id, Size };
+		Push(ETraceOp::Allocate, id, Size);
+	}
+}
+
+void CAllocationTraceRecorder::OnReAllocate (const void* OldMemory, const void* NewMemory, uint64 Size)
+{
+	if (!NewMemory)
+	{
+		return;
+	}
+
+	std::scoped_lock lock(Mutex);
+
+	if (!bRecording)
+	{
+		return;
+	}
+
+	const auto it = OldMemory ? LiveBlocks.find(OldMemory) : LiveBlocks.end();
+	if (it == LiveBlocks.end())
+	{
+		// Nothing to reallocate on replay, the block is new as far as the trace is concerned
+		const uint32 id = NextAddressId++;
+		LiveBlocks[NewMemory] = { id, Size };
+		Push(ETraceOp::Allocate, id, Size);
+		return;
+	}
+
+	const uint32 id = it->second.AddressId;
+	LiveBlocks.erase(it);
+	LiveBlocks[NewMemory] = { id, Size };
+	Push(ETraceOp::ReAllocate, id, Size);
+}
+
+void CAllocationTraceRecorder::OnFree (const void* Memory)
+{
+	if (!Memory)
+	{
+		return;
+	}
+
+	std::scoped_lock lock(Mutex);
+
+	if (!bRecording)
+	{
+		return;
+	}
+
+	const auto it = LiveBlocks.find(Memory);
+	if (it != LiveBlocks.end())
+	{
+		Push(ETraceOp::Free, it->second.AddressId, it->second.Size);
+		LiveBlocks.erase(it);
+	}
+}
+
+bool CAllocationTraceRecorder::Load (const std::filesystem::path& InPath, std::vector<STraceEvent>& OutEvents)
+{
+	std::ifstream stream(InPath, std::ios::binary);
+	if (!stream.is_open())
+	{
+		return false;
+	}
+
+	STraceFileHeader header;
+	stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!stream || header.Magic != STraceFileHeader::ExpectedMagic || header.Version != STraceFileHeader::CurrentVersion)
+	{
+		return false;
+	}
+
+	OutEvents.resize(header.EventCount);
+	stream.read(reinterpret_cast<char*>(OutEvents.data()), (std::streamsize)(header.EventCount * sizeof(STraceEvent)));
+	if (!stream)
+	{
+		OutEvents.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void CAllocationTraceRecorder::Push (ETraceOp Op, uint32 AddressId, uint64 Size)
+{
+	STraceEvent& event = Pending.emplace_back();
+	event.Timestamp = (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - StartTime).count();
+	event.Size = Size;
+	event.AddressId = AddressId;
+	event.ThreadId = GetThreadId();
+	event.Op = Op;
+
+	++EventCount;
+
+	if (Pending.size() >= EventsPerWrite)
+	{
+		WritePending();
+	}
+}
+
+void CAllocationTraceRecorder::WritePending ()
+{
+	Stream.write(reinterpret_cast<const char*>(Pending.data()), (std::streamsize)(Pending.size() * sizeof(STraceEvent)));
+	Pending.clear();
+}
+
+uint16 CAllocationTraceRecorder::GetThreadId ()
+{
+	thread_local const uint16 threadId = gThreadCount++;
+	return threadId;
+}
+}
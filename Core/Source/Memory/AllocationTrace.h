@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Core.h"
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+
+
+namespace frt::memory
+{
+enum class ETraceOp : uint8
+{
+	Allocate = 0u,
+	ReAllocate,
+	Free,
+};
+
+
+struct STraceEvent
+{
+	uint64 Timestamp = 0ull; // Nanoseconds since the recording started
+	uint64 Size = 0ull;      // Requested size; for Free, the size the block was allocated with
+	uint32 AddressId = 0u;   // Stays the same through reallocations, never reused
+	uint16 ThreadId = 0u;    // Order in which threads made their first traced call
+	ETraceOp Op = ETraceOp::Allocate;
+	FRT_STRUCT_PADDING(1);
+};
+
+
+static_assert(sizeof(STraceEvent) == 24u);
+
+
+struct STraceFileHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x41545246u; // "FRTA"
+	static constexpr uint32 CurrentVersion = 1u;
+
+	uint32 Magic = ExpectedMagic;
+	uint32 Version = CurrentVersion;
+	uint64 EventCount = 0ull;
+};
+
+
+/**
+* Writes allocations of a CMemoryPool to a binary trace, see CMemoryPool::SetTraceRecorder. Key points:
+*	- The file is STraceFileHeader followed by STraceEvent records, in the order calls were made
+*	- Addresses are replaced with ids, so a trace can be replayed against any allocator, see ReplayTrace
+*	- Frees and reallocations of blocks allocated before the recording started are dropped
+*	- Bookkeeping lives on the system heap, so the traced pool doesn't see the recorder's own allocations
+*/
+class FRT_CORE_API CAllocationTraceRecorder
+{
+public:
+	static constexpr uint32 EventsPerWrite = 16u * 1024u;
+
+	FRT_DELETE_COPY_AND_MOVE_OPS(CAllocationTraceRecorder);
+
+	CAllocationTraceRecorder () = default;
+	~CAllocationTraceRecorder ();
+
+	bool Start (const std::filesystem::path& InPath);
+	/** Writes what's left and finalizes the file. */
+	void Stop ();
+	bool IsRecording () const { return bRecording; }
+
+	void OnAllocate (const void* Memory, uint64 Size);
+	void OnReAllocate (const void* OldMemory, const void* NewMemory, uint64 Size);
+	void OnFree (const void* Memory);
+
+	uint64 GetEventCount () const { return EventCount; }
+
+	static bool Load (const std::filesystem::path& InPath, std::vector<STraceEvent>& OutEvents);
+
+private:
+	struct SLiveBlock
+	{
+		uint32 AddressId = 0u;
+		uint64 Size = 0ull;
+	};
+
+
+	void Push (ETraceOp Op, uint32 AddressId, uint64 Size);
+	void WritePending ();
+	static uint16 GetThreadId ();
+
+private:
+	bool bRecording = false;
+	uint32 NextAddressId = 0u;
+	uint64 EventCount = 0ull;
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+	std::mutex Mutex;
+	std::ofstream Stream;
+	std::chrono::steady_clock::time_point StartTime;
+	std::unordered_map<const void*, SLiveBlock> LiveBlocks;
+	std::vector<STraceEvent> Pending;
+#pragma warning(pop)
+};
+}
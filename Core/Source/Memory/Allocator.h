@@ -1,4 +1,8 @@
 ﻿#pragma once
+#include <type_traits>
+#include <utility>
+
+#include "Asserts.h"
 #include "Core.h"
 #include "CoreTypes.h"
 
@@ -15,4 +19,107 @@ public:
 
 	virtual void DeleteManaged (void* Memory) = 0;
 };
+
+
+/**
+* Allocator instance a container holds on to, so the container can live in a pool other than the primary one. Key points:
+*	- For allocator classes (CMemoryPool, CFrameArena) it's a pointer to the instance
+*	- Unless given explicitly, the instance is the primary one at the moment of the first allocation,
+*	  so containers can be constructed before a primary instance is set
+*	- Stateless allocators (empty types with ReAllocate and Free) are kept as an empty base and add nothing to the container
+*/
+template <typename TAllocator, bool bStateless = std::is_empty_v<TAllocator>>
+class TAllocatorRef
+{
+public:
+	TAllocatorRef () = default;
+	explicit TAllocatorRef (TAllocator* InAllocator) : Allocator(InAllocator) {}
+
+	/** Instance the memory comes from, the primary one if nothing was allocated yet. */
+	TAllocator* GetAllocator () const { return Allocator ? Allocator : TAllocator::GetPrimaryInstance(); }
+
+	void* ReAllocate (void* Memory, uint64 Size) { return Bind()->ReAllocate(Memory, Size); }
+
+	/** False if the allocator can't resize without moving, or has no way to try. */
+	bool ResizeInPlace (void* Memory, uint64 Size)
+	{
+		if constexpr (requires (TAllocator& InAllocator, void* InMemory, uint64 InSize) { InAllocator.ResizeInPlace(InMemory, InSize); })
+		{
+			return Bind()->ResizeInPlace(Memory, Size);
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	void Free (void* Memory)
+	{
+		if (Memory)
+		{
+			frt_assert(Allocator);
+			Allocator->Free(Memory);
+		}
+	}
+
+	/** Whether memory of Other can be freed through this, so a buffer can change hands without copying. */
+	bool CanAdopt (const TAllocatorRef& Other) const
+	{
+		return !Allocator || !Other.Allocator || Allocator == Other.Allocator;
+	}
+
+	void Adopt (const TAllocatorRef& Other)
+	{
+		if (Other.Allocator)
+		{
+			Allocator = Other.Allocator;
+		}
+	}
+
+	void Swap (TAllocatorRef& Other) noexcept { std::swap(Allocator, Other.Allocator); }
+
+private:
+	TAllocator* Bind ()
+	{
+		if (!Allocator)
+		{
+			Allocator = TAllocator::GetPrimaryInstance();
+			frt_assert(Allocator);
+		}
+		return Allocator;
+	}
+
+private:
+	TAllocator* Allocator = nullptr;
+};
+
+
+template <typename TAllocator>
+class TAllocatorRef<TAllocator, true> : private TAllocator
+{
+public:
+	TAllocatorRef () = default;
+	explicit TAllocatorRef (TAllocator*) {}
+
+	TAllocator* GetAllocator () const { return const_cast<TAllocator*>(static_cast<const TAllocator*>(this)); }
+
+	void* ReAllocate (void* Memory, uint64 Size) { return TAllocator::ReAllocate(Memory, Size); }
+	void Free (void* Memory) { TAllocator::Free(Memory); }
+
+	bool ResizeInPlace (void* Memory, uint64 Size)
+	{
+		if constexpr (requires (TAllocator& InAllocator, void* InMemory, uint64 InSize) { InAllocator.ResizeInPlace(InMemory, InSize); })
+		{
+			return TAllocator::ResizeInPlace(Memory, Size);
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	bool CanAdopt (const TAllocatorRef&) const { return true; }
+	void Adopt (const TAllocatorRef&) {}
+	void Swap (TAllocatorRef&) noexcept {}
+};
 }
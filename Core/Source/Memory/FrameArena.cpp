@@ -0,0 +1,270 @@
+#include "FrameArena.h"
+
+#include <cstring>
+#include <utility>
+
+#include "Asserts.h"
+#include "MemoryPool.h"
+#include "Math/MathUtility.h"
+
+
+namespace frt::memory
+{
+namespace
+{
+uint64 AlignSize (uint64 Size)
+{
+	return (Size + CFrameArena::Alignment - 1ull) & ~(CFrameArena::Alignment - 1ull);
+}
+
+// Backing pool only guarantees 8 bytes, so every block taken from it is over-allocated and aligned manually
+uint8* AlignPointer (void* Memory)
+{
+	return reinterpret_cast<uint8*>(AlignSize(reinterpret_cast<uint64>(Memory)));
+}
+}
+
+
+CFrameArena::CFrameArena (CFrameArena&& Other) noexcept
+{
+	*this = std::move(Other);
+}
+
+CFrameArena& CFrameArena::operator= (CFrameArena&& Other) noexcept
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	ReleaseAll();
+
+	BackingPool = Other.BackingPool;
+	for (uint32 i = 0u; i < MaxFrameCount; ++i)
+	{
+		Frames[i] = Other.Frames[i];
+		Other.Frames[i] = SFrame();
+	}
+	FrameCount = Other.FrameCount;
+	FrameIndex = Other.FrameIndex;
+	Cursor = Other.Cursor;
+	End = Other.End;
+	LastAllocation = Other.LastAllocation;
+
+	Other.BackingPool = nullptr;
+	Other.FrameCount = 0u;
+	Other.FrameIndex = 0u;
+	Other.Cursor = nullptr;
+	Other.End = nullptr;
+	Other.LastAllocation = nullptr;
+
+	return *this;
+}
+
+CFrameArena::CFrameArena ()
+{}
+
+CFrameArena::CFrameArena (CMemoryPool* InBackingPool, uint64 InFrameSize, uint32 InFrameCount)
+	: BackingPool(InBackingPool)
+	, FrameCount(InFrameCount)
+{
+	frt_assert(BackingPool);
+	frt_assert(FrameCount > 0u && FrameCount <= MaxFrameCount);
+
+	FRT_MEMORY_TAG_SCOPE(FrameArena);
+	const uint64 bufferSize = AlignSize(InFrameSize);
+	for (uint32 i = 0u; i < FrameCount; ++i)
+	{
+		Frames[i].Allocation = BackingPool->Allocate(bufferSize + Alignment);
+		Frames[i].Buffer = AlignPointer(Frames[i].Allocation);
+		Frames[i].BufferSize = bufferSize;
+	}
+
+	Cursor = Frames[0].Buffer;
+	End = Cursor + bufferSize;
+}
+
+CFrameArena::~CFrameArena ()
+{
+	ReleaseAll();
+
+	if (PrimaryInstance == this)
+	{
+		PrimaryInstance = nullptr;
+	}
+}
+
+void CFrameArena::MakeThisPrimaryInstance ()
+{
+	PrimaryInstance = this;
+}
+
+CFrameArena* CFrameArena::GetPrimaryInstance ()
+{
+	return PrimaryInstance;
+}
+
+void CFrameArena::BeginFrame ()
+{
+	frt_assert(FrameCount > 0u);
+
+	FrameIndex = (FrameIndex + 1u) % FrameCount;
+	ResetFrame(Frames[FrameIndex]);
+}
+
+void* CFrameArena::Allocate (uint64 Size)
+{
+	frt_assert(FrameCount > 0u);
+
+	const uint64 fullSize = sizeof(SHeader) + AlignSize(Size);
+	if ((uint64)(End - Cursor) < fullSize)
+	{
+		return AllocateOverflow(Size);
+	}
+
+	auto* header = reinterpret_cast<SHeader*>(Cursor);
+	header->Size = Size;
+	Cursor += fullSize;
+	Frames[FrameIndex].Used += fullSize;
+
+	LastAllocation = reinterpret_cast<uint8*>(header + 1);
+	return LastAllocation;
+}
+
+void* CFrameArena::ReAllocate (void* Memory, uint64 Size)
+{
+	if (!Memory)
+	{
+		return Allocate(Size);
+	}
+
+	const uint64 oldSize = (static_cast<SHeader*>(Memory) - 1)->Size;
+	if (ResizeInPlace(Memory, Size))
+	{
+		return Memory;
+	}
+
+	void* newMemory = Allocate(Size);
+	std::memcpy(newMemory, Memory, math::Min(oldSize, Size));
+	return newMemory;
+}
+
+bool CFrameArena::ResizeInPlace (void* Memory, uint64 Size)
+{
+	SHeader* header = static_cast<SHeader*>(Memory) - 1;
+	const uint64 oldSize = header->Size;
+
+	// The latest allocation can grow or shrink in place as long as the bump range has room for it
+	if (Memory == LastAllocation)
+	{
+		const uint64 oldFullSize = AlignSize(oldSize);
+		const uint64 newFullSize = AlignSize(Size);
+		if ((uint8*)Memory + newFullSize > End)
+		{
+			return false;
+		}
+
+		header->Size = Size;
+		Cursor = (uint8*)Memory + newFullSize;
+		Frames[FrameIndex].Used = Frames[FrameIndex].Used - oldFullSize + newFullSize;
+		return true;
+	}
+
+	return Size <= oldSize;
+}
+
+void CFrameArena::Free (void* Memory)
+{
+	if (Memory && Memory == LastAllocation)
+	{
+		SHeader* header = static_cast<SHeader*>(Memory) - 1;
+		Cursor = reinterpret_cast<uint8*>(header);
+		Frames[FrameIndex].Used -= sizeof(SHeader) + AlignSize(header->Size);
+		LastAllocation = nullptr;
+	}
+}
+
+void CFrameArena::DeleteManaged (void* Memory)
+{
+	Free(Memory);
+}
+
+uint64 CFrameArena::GetUsedSize () const
+{
+	return FrameCount > 0u ? Frames[FrameIndex].Used : 0ull;
+}
+
+uint64 CFrameArena::GetFrameBufferSize () const
+{
+	return FrameCount > 0u ? Frames[FrameIndex].BufferSize : 0ull;
+}
+
+void CFrameArena::ResetFrame (SFrame& Frame)
+{
+	if (Frame.Overflow)
+	{
+		while (Frame.Overflow)
+		{
+			SChunk* next = Frame.Overflow->Next;
+			BackingPool->Free(Frame.Overflow);
+			Frame.Overflow = next;
+		}
+
+		// Grow once to what the frame actually needed instead of overflowing every time
+		FRT_MEMORY_TAG_SCOPE(FrameArena);
+		const uint64 newSize = AlignSize(Frame.Used + Frame.Used / 4ull);
+		BackingPool->Free(Frame.Allocation);
+		Frame.Allocation = BackingPool->Allocate(newSize + Alignment);
+		Frame.Buffer = AlignPointer(Frame.Allocation);
+		Frame.BufferSize = newSize;
+	}
+
+	Frame.Used = 0ull;
+	Cursor = Frame.Buffer;
+	End = Frame.Buffer + Frame.BufferSize;
+	LastAllocation = nullptr;
+}
+
+void* CFrameArena::AllocateOverflow (uint64 Size)
+{
+	SFrame& frame = Frames[FrameIndex];
+
+	const uint64 fullSize = sizeof(SHeader) + AlignSize(Size);
+	const uint64 chunkSize = sizeof(SChunk) + Alignment + math::Max<uint64>(fullSize, frame.BufferSize / 2ull);
+
+	FRT_MEMORY_TAG_SCOPE(FrameArena);
+	auto* chunk = static_cast<SChunk*>(BackingPool->Allocate(chunkSize));
+	frt_assert(chunk);
+	chunk->Size = chunkSize;
+	chunk->Next = frame.Overflow;
+	frame.Overflow = chunk;
+
+	// Whatever is left in the previous range is abandoned, the frame continues in the new chunk
+	Cursor = AlignPointer(chunk + 1);
+	End = reinterpret_cast<uint8*>(chunk) + chunkSize;
+
+	return Allocate(Size);
+}
+
+void CFrameArena::ReleaseAll ()
+{
+	for (uint32 i = 0u; i < FrameCount; ++i)
+	{
+		SFrame& frame = Frames[i];
+		while (frame.Overflow)
+		{
+			SChunk* next = frame.Overflow->Next;
+			BackingPool->Free(frame.Overflow);
+			frame.Overflow = next;
+		}
+		BackingPool->Free(frame.Allocation);
+		frame = SFrame();
+	}
+
+	FrameCount = 0u;
+	FrameIndex = 0u;
+	Cursor = nullptr;
+	End = nullptr;
+	LastAllocation = nullptr;
+}
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Allocator.h"
+#include "Core.h"
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+
+
+namespace frt::memory
+{
+class CMemoryPool;
+
+
+/**
+* Linear allocator for data that dies within a frame or two. Key points:
+*	- Allocation is a pointer bump; Free does nothing unless it's the latest allocation, which gets rolled back
+*	- Memory is split between FrameCount buffers. BeginFrame switches to the next one and resets it,
+*	  so whatever was allocated during a frame stays valid for FrameCount - 1 more frames
+*	- If a frame doesn't fit its buffer, overflow chunks are taken from the backing pool.
+*	  They are returned on the buffer's next reset, and the buffer grows to fit the peak usage
+*	- Not thread-safe, meant for the game thread
+*
+* Can be used as TArray allocator, or with STL containers through TFrameArenaStlAllocator.
+*/
+class FRT_CORE_API CFrameArena : public IAllocator
+{
+public:
+	static constexpr uint32 MaxFrameCount = 3u;
+	static constexpr uint64 Alignment = 16ull;
+
+	FRT_DELETE_COPY_OPS(CFrameArena);
+	CFrameArena (CFrameArena&& Other) noexcept;
+	CFrameArena& operator= (CFrameArena&& Other) noexcept;
+
+	CFrameArena ();
+	CFrameArena (CMemoryPool* InBackingPool, uint64 InFrameSize, uint32 InFrameCount = 2u);
+
+	virtual ~CFrameArena () override;
+
+	void MakeThisPrimaryInstance ();
+	static CFrameArena* GetPrimaryInstance ();
+
+	/** Switches to the next frame buffer, invalidating everything allocated FrameCount frames ago. */
+	void BeginFrame ();
+
+	virtual void* Allocate (uint64 Size) override;
+	void* ReAllocate (void* Memory, uint64 Size);
+	/** Only the latest allocation can grow, any allocation can shrink. */
+	bool ResizeInPlace (void* Memory, uint64 Size);
+	virtual void Free (void* Memory) override;
+	virtual void DeleteManaged (void* Memory) override;
+
+	uint32 GetFrameIndex () const { return FrameIndex; }
+	uint32 GetFrameCount () const { return FrameCount; }
+	/** Bytes taken in the current frame, including allocation headers. */
+	uint64 GetUsedSize () const;
+	uint64 GetFrameBufferSize () const;
+
+private:
+	struct SHeader
+	{
+		uint64 Size = 0ull;
+		uint64 Padding = 0ull;
+	};
+
+
+	struct SChunk
+	{
+		SChunk* Next = nullptr;
+		uint64 Size = 0ull;
+	};
+
+
+	struct SFrame
+	{
+		void* Allocation = nullptr;
+		uint8* Buffer = nullptr;
+		uint64 BufferSize = 0ull;
+		SChunk* Overflow = nullptr;
+		uint64 Used = 0ull;
+	};
+
+
+	void ResetFrame (SFrame& Frame);
+	void* AllocateOverflow (uint64 Size);
+	void ReleaseAll ();
+
+private:
+	CMemoryPool* BackingPool = nullptr;
+
+	SFrame Frames[MaxFrameCount];
+	uint32 FrameCount = 0u;
+	uint32 FrameIndex = 0u;
+
+	// Bump range of the current frame, either its buffer or the latest overflow chunk
+	uint8* Cursor = nullptr;
+	uint8* End = nullptr;
+	uint8* LastAllocation = nullptr;
+
+	static inline CFrameArena* PrimaryInstance = nullptr;
+};
+
+
+/** Allocator for STL containers that takes memory from a frame arena, the primary one at construction by default */
+template <typename T>
+struct TFrameArenaStlAllocator
+{
+	static_assert(alignof(T) <= CFrameArena::Alignment);
+
+	using value_type = T;
+
+	TFrameArenaStlAllocator () noexcept
+		: Arena(CFrameArena::GetPrimaryInstance())
+	{}
+
+	explicit TFrameArenaStlAllocator (CFrameArena* InArena) noexcept
+		: Arena(InArena)
+	{}
+
+	template <typename U>
+	TFrameArenaStlAllocator (const TFrameArenaStlAllocator<U>& Other) noexcept
+		: Arena(Other.Arena)
+	{}
+
+	T* allocate (std::size_t Count)
+	{
+		return static_cast<T*>(Arena->Allocate(Count * sizeof(T)));
+	}
+
+	void deallocate (T* Memory, std::size_t)
+	{
+		Arena->Free(Memory);
+	}
+
+	template <typename U>
+	bool operator== (const TFrameArenaStlAllocator<U>& Other) const noexcept { return Arena == Other.Arena; }
+
+	CFrameArena* Arena = nullptr;
+};
+}
@@ -32,7 +32,6 @@ namespace literals
 
 namespace frt::memory
 {
-class PoolAllocator;
 using DefaultPool = CMemoryPool;
 
 template <typename T, typename... Args>
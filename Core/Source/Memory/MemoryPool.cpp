@@ -1,14 +1,12 @@
 ﻿#include "MemoryPool.h"
 
+#include <cstdio>
 #include <new>
 
-#if _WINDOWS
-// #include <intrin.h>
-#include <windows.h>
-#include <memoryapi.h>
-#elif _UNIX
-#include <sys/mman.h>
-#endif
+#include "AllocationTrace.h"
+#include "Math/MathUtility.h"
+#include "ThreadCache.h"
+#include "VirtualRegions.h"
 
 
 namespace frt::memory
@@ -23,35 +21,71 @@ CMemoryPool& CMemoryPool::operator= (CMemoryPool&& Other) noexcept
 	MemorySize = Other.MemorySize;
 	Memory = Other.Memory;
 	Tlsf = Other.Tlsf;
+	Regions = Other.Regions;
+	ThreadCache = Other.ThreadCache;
+	Slabs = Other.Slabs;
+	Tracker = Other.Tracker;
+	TraceRecorder = Other.TraceRecorder;
+	if (Slabs)
+	{
+		Slabs->SetBackingPool(this);
+	}
 	Other.MemorySize = 0;
 	Other.Memory = nullptr;
 	Other.Tlsf = nullptr;
+	Other.Regions = nullptr;
+	Other.ThreadCache = nullptr;
+	Other.Slabs = nullptr;
+	Other.Tracker = nullptr;
+	Other.TraceRecorder = nullptr;
 	return *this;
 }
 
 CMemoryPool::CMemoryPool ()
 {}
 
-CMemoryPool::CMemoryPool (uint64 InSize)
-	: MemorySize(InSize)
+CMemoryPool::CMemoryPool (uint64 InSize, SFlags<EMemoryPoolFlags> InFlags)
 {
-#if _WINDOWS
-	// Memory = new uint8[MemorySize];
-	Memory = (uint8*)VirtualAlloc(nullptr, MemorySize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-#elif _UNIX
-		Memory = mmap(nullptr, MemorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-		// munmap(pool, PoolSize);
-#endif
-	Tlsf = new(Memory) TLSF(MemorySize);
+	const bool bHugePages = InFlags && EMemoryPoolFlags::HugePages;
+
+	// Only the first step is committed up front, it has to fit TLSF control block and the regions bookkeeping
+	constexpr uint64 initialCommit = CVirtualRegions::CommitStep;
+	static_assert(TLSF::GetSize() + sizeof(CVirtualRegions) + TLSF::GetPoolOverhead() < initialCommit);
+
+	MemorySize = math::Max(TLSF::AlignUp(InSize, CVirtualRegions::CommitStep), initialCommit);
+	Memory = static_cast<uint8*>(CVirtualRegions::Reserve(MemorySize, bHugePages));
+	frt_assert(Memory);
+	CVirtualRegions::Commit(Memory, initialCommit, bHugePages);
+
+	Tlsf = new(Memory) TLSF(initialCommit);
+
+	CVirtualRegions::SRegion region;
+	region.Base = Memory;
+	region.Pool = Memory + TLSF::GetSize();
+	region.ReservedSize = MemorySize;
+	region.CommittedSize = initialCommit;
+
+	void* regionsMemory = Tlsf->Memalign(alignof(CVirtualRegions), sizeof(CVirtualRegions));
+	frt_assert(regionsMemory);
+	Regions = new(regionsMemory) CVirtualRegions(region, MemorySize, bHugePages);
+	Tlsf->SetPoolProvider(Regions);
+
+	InitializeThreadCache(InFlags);
+	InitializeTracker();
+	InitializeSlabs();
 }
 
-CMemoryPool::CMemoryPool (void* InMemory, uint64 InSize)
+CMemoryPool::CMemoryPool (void* InMemory, uint64 InSize, SFlags<EMemoryPoolFlags> InFlags)
 	: MemorySize(InSize)
 {
 	frt_assert((uint64)InMemory % TLSF::AlignSize == 0);
+	frt_assert(InSize > TLSF::GetSize() + TLSF::GetPoolOverhead() + sizeof(TLSF::SBlockHeader));
 
 	Memory = static_cast<uint8*>(InMemory);
 	Tlsf = new(Memory) TLSF(MemorySize);
+	InitializeThreadCache(InFlags);
+	InitializeTracker();
+	InitializeSlabs();
 }
 
 CMemoryPool::~CMemoryPool ()
@@ -59,16 +93,30 @@ CMemoryPool::~CMemoryPool ()
 	if (Memory)
 	{
 		frt_assert(Tlsf);
+		if (Slabs)
+		{
+			Slabs->~CSlabPools();
+		}
+		if (ThreadCache)
+		{
+			ThreadCache->~CThreadCachedHeap();
+		}
 		Tlsf->~TLSF();
-#if _WINDOWS
-		VirtualFree(Memory, 0, MEM_RELEASE);
-#elif _UNIX
 
-#endif
+		// External memory is not ours to release
+		if (Regions)
+		{
+			Regions->ReleaseRegions();
+		}
 	}
 
 	Memory = nullptr;
 	Tlsf = nullptr;
+	Regions = nullptr;
+	ThreadCache = nullptr;
+	Slabs = nullptr;
+	Tracker = nullptr;
+	TraceRecorder = nullptr;
 }
 
 void CMemoryPool::MakeThisPrimaryInstance ()
@@ -81,27 +129,263 @@ CMemoryPool* CMemoryPool::GetPrimaryInstance ()
 	return PrimaryInstance;
 }
 
+uint64 CMemoryPool::GetReservedSize () const
+{
+	return Regions ? Regions->GetReservedSize() : MemorySize;
+}
+
+uint64 CMemoryPool::GetCommittedSize () const
+{
+	return Regions ? Regions->GetCommittedSize() : MemorySize;
+}
+
+SMemoryTagStats CMemoryPool::GetTagStats (EMemoryTag Tag) const
+{
+	return Tracker ? Tracker->GetStats(Tag) : SMemoryTagStats();
+}
+
+SHeapReport CMemoryPool::GetHeapReport () const
+{
+	frt_assert(Tlsf);
+
+	std::unique_lock<std::mutex> lock;
+	if (ThreadCache)
+	{
+		lock = ThreadCache->LockTlsf();
+	}
+
+	SHeapReport report;
+	if (Regions)
+	{
+		for (uint32 i = 0u; i < Regions->GetRegionCount(); ++i)
+		{
+			TLSF::ReportPool(Regions->GetRegion(i).Pool, report);
+		}
+	}
+	else
+	{
+		TLSF::ReportPool(Memory + TLSF::GetSize(), report);
+	}
+	return report;
+}
+
+void CMemoryPool::PrintReport () const
+{
+	constexpr double mb = 1024.0 * 1024.0;
+
+	std::printf("Memory pool: reserved %.2f Mb, committed %.2f Mb\n",
+		(double)GetReservedSize() / mb, (double)GetCommittedSize() / mb);
+
+	if (Tracker)
+	{
+		std::printf("  %-12s %12s %12s %10s %12s\n", "Tag", "Live, Kb", "Peak, Kb", "Live", "Allocations");
+		for (uint32 i = 0u; i < (uint32)EMemoryTag::Count; ++i)
+		{
+			const EMemoryTag tag = (EMemoryTag)i;
+			const SMemoryTagStats stats = Tracker->GetStats(tag);
+			if (stats.AllocationCount == 0ull)
+			{
+				continue;
+			}
+
+			const std::string_view name = enum_::ToString(tag);
+			std::printf("  %-12.*s %12.1f %12.1f %10llu %12llu\n", (int)name.size(), name.data(),
+				(double)stats.LiveBytes / 1024.0, (double)stats.PeakBytes / 1024.0,
+				(unsigned long long)stats.LiveCount, (unsigned long long)stats.AllocationCount);
+		}
+	}
+
+	const SHeapReport report = GetHeapReport();
+	std::printf("  Heap: %u pools, %.2f Mb used in %llu blocks, %.2f Mb free in %llu blocks\n",
+		report.PoolCount,
+		(double)report.UsedBytes / mb, (unsigned long long)report.UsedBlockCount,
+		(double)report.FreeBytes / mb, (unsigned long long)report.FreeBlockCount);
+	std::printf("  Largest free block: %.2f Mb, fragmentation: %.3f\n",
+		(double)report.LargestFreeBlock / mb, report.GetFragmentation());
+
+	std::printf("  Free blocks per bin (first/second level, min size: count):\n");
+	for (uint32 fl = 0u; fl < TLSF::FirstLevelIndexCount; ++fl)
+	{
+		for (uint32 sl = 0u; sl < TLSF::SecondLevelIndexCount; ++sl)
+		{
+			if (const uint32 count = report.FreeBlockHistogram[fl][sl])
+			{
+				std::printf("    %2u/%2u %14llu: %u\n", fl, sl, (unsigned long long)TLSF::GetBinMinSize(fl, sl), count);
+			}
+		}
+	}
+}
+
+void CMemoryPool::SetTraceRecorder (CAllocationTraceRecorder* InRecorder)
+{
+#if FRT_MEMORY_TRACKING
+	TraceRecorder = InRecorder;
+#endif
+}
+
 void* CMemoryPool::Allocate (uint64 Size)
 {
 	frt_assert(Tlsf);
 
-	return Tlsf->Malloc(Size);
+#if FRT_MEMORY_TRACKING
+	void* memory = AllocateUntracked(Size + sizeof(CMemoryTracker::SHeader));
+	memory = Tracker->OnAllocate(memory, Size, GetCurrentMemoryTag());
+	if (TraceRecorder)
+	{
+		TraceRecorder->OnAllocate(memory, Size);
+	}
+	return memory;
+#else
+	return AllocateUntracked(Size);
+#endif
 }
 
 void* CMemoryPool::ReAllocate (void* InMemory, uint64 Size)
 {
 	frt_assert(Tlsf);
 
-	return Tlsf->Realloc(InMemory, Size);
+#if FRT_MEMORY_TRACKING
+	if (!InMemory)
+	{
+		return Allocate(Size);
+	}
+
+	// Stays under the tag it was allocated with, whatever the current scope is
+	const CMemoryTracker::SHeader header = CMemoryTracker::GetHeader(InMemory);
+	void* oldMemory = Tracker->OnFree(InMemory);
+	void* newMemory = ReAllocateUntracked(oldMemory, Size + sizeof(CMemoryTracker::SHeader));
+	if (!newMemory)
+	{
+		// The old block is still there, so it's counted back
+		Tracker->OnAllocate(oldMemory, header.Size, header.Tag);
+		return nullptr;
+	}
+
+	newMemory = Tracker->OnAllocate(newMemory, Size, header.Tag);
+	if (TraceRecorder)
+	{
+		TraceRecorder->OnReAllocate(InMemory, newMemory, Size);
+	}
+	return newMemory;
+#else
+	return ReAllocateUntracked(InMemory, Size);
+#endif
+}
+
+bool CMemoryPool::ResizeInPlace (void* InMemory, uint64 Size)
+{
+	frt_assert(Tlsf && InMemory);
+
+#if FRT_MEMORY_TRACKING
+	const CMemoryTracker::SHeader header = CMemoryTracker::GetHeader(InMemory);
+	void* rawMemory = static_cast<CMemoryTracker::SHeader*>(InMemory) - 1;
+	if (!ResizeInPlaceUntracked(rawMemory, Size + sizeof(CMemoryTracker::SHeader)))
+	{
+		return false;
+	}
+
+	Tracker->OnFree(InMemory);
+	Tracker->OnAllocate(rawMemory, Size, header.Tag);
+	if (TraceRecorder)
+	{
+		TraceRecorder->OnReAllocate(InMemory, InMemory, Size);
+	}
+	return true;
+#else
+	return ResizeInPlaceUntracked(InMemory, Size);
+#endif
 }
 
 void CMemoryPool::Free (void* MemoryToFree)
 {
 	frt_assert(Tlsf);
 
-	if (MemoryToFree)
+	if (!MemoryToFree)
+	{
+		return;
+	}
+
+#if FRT_MEMORY_TRACKING
+	// Before the block can be handed out again, so the recorder never sees its address twice
+	if (TraceRecorder)
+	{
+		TraceRecorder->OnFree(MemoryToFree);
+	}
+	FreeUntracked(Tracker->OnFree(MemoryToFree));
+#else
+	FreeUntracked(MemoryToFree);
+#endif
+}
+
+void* CMemoryPool::AllocateUntracked (uint64 Size)
+{
+	if (ThreadCache)
+	{
+		return ThreadCache->Allocate(Size);
+	}
+
+	return Tlsf->Malloc(Size);
+}
+
+void* CMemoryPool::ReAllocateUntracked (void* InMemory, uint64 Size)
+{
+	if (ThreadCache)
+	{
+		return ThreadCache->ReAllocate(InMemory, Size);
+	}
+
+	return Tlsf->Realloc(InMemory, Size);
+}
+
+bool CMemoryPool::ResizeInPlaceUntracked (void* InMemory, uint64 Size)
+{
+	if (ThreadCache)
+	{
+		return ThreadCache->ResizeInPlace(InMemory, Size);
+	}
+
+	return Tlsf->ResizeInPlace(InMemory, Size);
+}
+
+void CMemoryPool::FreeUntracked (void* MemoryToFree)
+{
+	if (ThreadCache)
+	{
+		ThreadCache->Free(MemoryToFree);
+	}
+	else
 	{
 		Tlsf->Free(MemoryToFree);
 	}
 }
+
+void CMemoryPool::InitializeThreadCache (SFlags<EMemoryPoolFlags> InFlags)
+{
+	if (!(InFlags && EMemoryPoolFlags::ThreadSafe))
+	{
+		return;
+	}
+
+	// The front-end lives inside the pool it serves, same as TLSF control block
+	void* memory = Tlsf->Memalign(alignof(CThreadCachedHeap), sizeof(CThreadCachedHeap));
+	frt_assert(memory);
+	ThreadCache = new(memory) CThreadCachedHeap(Tlsf);
+}
+
+void CMemoryPool::InitializeTracker ()
+{
+#if FRT_MEMORY_TRACKING
+	// Has to exist before anything goes through Allocate, all of which it expects to have a header
+	void* memory = Tlsf->Memalign(alignof(CMemoryTracker), sizeof(CMemoryTracker));
+	frt_assert(memory);
+	Tracker = new(memory) CMemoryTracker();
+#endif
+}
+
+void CMemoryPool::InitializeSlabs ()
+{
+	void* memory = Allocate(sizeof(CSlabPools));
+	frt_assert(memory);
+	Slabs = new(memory) CSlabPools(this, IsThreadSafe());
+}
 }
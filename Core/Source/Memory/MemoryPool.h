@@ -8,14 +8,38 @@
 #include "Core.h"
 #include "CoreTypes.h"
 #include "CoreUtils.h"
+#include "Enum.h"
+#include "MemoryTracking.h"
 #include "Ref.h"
+#include "SlabAllocator.h"
 #include "TLSF.h"
 
 
 namespace frt::memory
 {
+class CAllocationTraceRecorder;
+class CThreadCachedHeap;
+class CVirtualRegions;
+
+
+enum class EMemoryPoolFlags : uint8
+{
+	None       = 0u,
+	ThreadSafe = 1u << 0u, // Per-thread caches in front of TLSF, see CThreadCachedHeap
+	HugePages  = 1u << 1u, // Transparent huge pages for the reserved regions, Linux only
+};
+
+
+FRT_DECLARE_FLAG_ENUM(EMemoryPoolFlags);
+
+
 /**
-* 
+* General purpose pool on top of TLSF.
+* When the pool owns its memory, InSize is only reserved: pages are committed as TLSF needs them,
+* and once the reservation is used up another one is chained in, see CVirtualRegions.
+* A pool over external memory is fixed-size.
+*
+* With FRT_MEMORY_TRACKING, allocations are counted per EMemoryTag, see FRT_MEMORY_TAG_SCOPE.
 */
 class FRT_CORE_API CMemoryPool : public IAllocator
 {
@@ -25,16 +49,43 @@ public:
 	CMemoryPool& operator= (CMemoryPool&& Other) noexcept;
 
 	CMemoryPool ();
-	CMemoryPool (uint64 InSize);
-	CMemoryPool (void* InMemory, uint64 InSize);
+	CMemoryPool (uint64 InSize, SFlags<EMemoryPoolFlags> InFlags = EMemoryPoolFlags::None);
+	CMemoryPool (void* InMemory, uint64 InSize, SFlags<EMemoryPoolFlags> InFlags = EMemoryPoolFlags::None);
 
 	virtual ~CMemoryPool () override;
 
 	void MakeThisPrimaryInstance ();
 	static CMemoryPool* GetPrimaryInstance ();
 
+	bool IsThreadSafe () const { return ThreadCache != nullptr; }
+	bool IsGrowable () const { return Regions != nullptr; }
+
+	/** Slabs serving managed allocations, see NewManaged. */
+	const CSlabPools& GetSlabPools () const { return *Slabs; }
+
+	uint64 GetReservedSize () const;
+	uint64 GetCommittedSize () const;
+
+	bool IsTrackingEnabled () const { return Tracker != nullptr; }
+	/** Zeros when tracking is compiled out. */
+	SMemoryTagStats GetTagStats (EMemoryTag Tag) const;
+
+	/**
+	* Walks the whole heap, so it's slow and blocks other threads of a thread-safe pool.
+	* Blocks held by thread caches and slabs count as used.
+	*/
+	SHeapReport GetHeapReport () const;
+
+	/** Prints tag stats and the heap report to stdout. */
+	void PrintReport () const;
+
+	/** Every Allocate, ReAllocate and Free is reported to the recorder. Does nothing when tracking is compiled out. */
+	void SetTraceRecorder (CAllocationTraceRecorder* InRecorder);
+
 	virtual void* Allocate (uint64 Size) override;
 	virtual void* ReAllocate (void* Memory, uint64 Size);
+	/** Resizes without moving the memory, returns false if that's not possible and leaves the block as it was. */
+	bool ResizeInPlace (void* Memory, uint64 Size);
 	virtual void Free (void* MemoryToFree) override;
 
 	template <typename T, typename... Args>
@@ -52,11 +103,29 @@ public:
 	void DeleteUnmanaged (void* MemoryToDelete);
 	virtual void DeleteManaged (void* MemoryToDelete) override;
 
+private:
+	void InitializeThreadCache (SFlags<EMemoryPoolFlags> InFlags);
+	void InitializeTracker ();
+	void InitializeSlabs ();
+
+	void* AllocateUntracked (uint64 Size);
+	void* ReAllocateUntracked (void* Memory, uint64 Size);
+	bool ResizeInPlaceUntracked (void* Memory, uint64 Size);
+	void FreeUntracked (void* MemoryToFree);
+
+	template <typename T>
+	IAllocator* GetManagedAllocator ();
+
 private:
 	uint64 MemorySize = 0ull;
 	uint8* Memory = nullptr;
 
 	TLSF* Tlsf = nullptr;
+	CVirtualRegions* Regions = nullptr;
+	CThreadCachedHeap* ThreadCache = nullptr;
+	CSlabPools* Slabs = nullptr;
+	CMemoryTracker* Tracker = nullptr;
+	CAllocationTraceRecorder* TraceRecorder = nullptr;
 
 	// Just for convenience, so we don't have to access GameInstance each time
 	static inline CMemoryPool* PrimaryInstance = nullptr;
@@ -75,14 +144,33 @@ T* CMemoryPool::NewUnmanaged (Args&&... InArgs)
 	return object;
 }
 
+template <typename T>
+IAllocator* CMemoryPool::GetManagedAllocator ()
+{
+	constexpr uint64 size = TRefControlBlock<T>::GetFullSize();
+
+	CSlabAllocator* slab = nullptr;
+	if constexpr (IsDedicatedSlabType<T>)
+	{
+		slab = Slabs->GetDedicatedSlab(CSlabPools::GetDedicatedTypeIndex<T>(), size);
+	}
+	else if constexpr (size <= CSlabPools::MaxSizeClassSize)
+	{
+		slab = Slabs->GetSizeClassSlab(size);
+	}
+
+	return slab ? static_cast<IAllocator*>(slab) : this;
+}
+
 template <typename T, typename... Args>
 TRefControlBlock<T>* CMemoryPool::NewManaged (Args&&... InArgs)
 {
 	constexpr uint64 size = TRefControlBlock<T>::GetFullSize();
-	void* memory = Allocate(size);
+	IAllocator* allocator = GetManagedAllocator<T>();
+	void* memory = allocator->Allocate(size);
 
 	auto* control = new(memory) TRefControlBlock<T>(std::forward<Args>(InArgs)...);
-	control->Allocator = PrimaryInstance;
+	control->Allocator = allocator;
 	return control;
 }
 
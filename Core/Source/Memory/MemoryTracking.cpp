@@ -0,0 +1,78 @@
+#include "MemoryTracking.h"
+
+#include "Asserts.h"
+
+
+namespace frt::memory
+{
+namespace
+{
+thread_local EMemoryTag gCurrentTag = EMemoryTag::Untagged;
+}
+
+
+EMemoryTag GetCurrentMemoryTag ()
+{
+	return gCurrentTag;
+}
+
+
+CMemoryTagScope::CMemoryTagScope (EMemoryTag InTag)
+	: PreviousTag(gCurrentTag)
+{
+	gCurrentTag = InTag;
+}
+
+CMemoryTagScope::~CMemoryTagScope ()
+{
+	gCurrentTag = PreviousTag;
+}
+
+
+void* CMemoryTracker::OnAllocate (void* RawMemory, uint64 Size, EMemoryTag Tag)
+{
+	if (!RawMemory)
+	{
+		return nullptr;
+	}
+
+	auto* header = static_cast<SHeader*>(RawMemory);
+	header->Size = Size;
+	header->Tag = Tag;
+
+	SCounters& counters = Counters[(uint32)header->Tag];
+	const uint64 live = counters.LiveBytes.fetch_add(Size, std::memory_order_relaxed) + Size;
+	counters.LiveCount.fetch_add(1ull, std::memory_order_relaxed);
+	counters.AllocationCount.fetch_add(1ull, std::memory_order_relaxed);
+
+	uint64 peak = counters.PeakBytes.load(std::memory_order_relaxed);
+	while (live > peak && !counters.PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+	{}
+
+	return header + 1;
+}
+
+void* CMemoryTracker::OnFree (void* Memory)
+{
+	auto* header = static_cast<SHeader*>(Memory) - 1;
+	frt_assert((uint32)header->Tag < (uint32)EMemoryTag::Count);
+
+	SCounters& counters = Counters[(uint32)header->Tag];
+	counters.LiveBytes.fetch_sub(header->Size, std::memory_order_relaxed);
+	counters.LiveCount.fetch_sub(1ull, std::memory_order_relaxed);
+
+	return header;
+}
+
+SMemoryTagStats CMemoryTracker::GetStats (EMemoryTag Tag) const
+{
+	const SCounters& counters = Counters[(uint32)Tag];
+
+	SMemoryTagStats stats;
+	stats.LiveBytes = counters.LiveBytes.load(std::memory_order_relaxed);
+	stats.PeakBytes = counters.PeakBytes.load(std::memory_order_relaxed);
+	stats.LiveCount = counters.LiveCount.load(std::memory_order_relaxed);
+	stats.AllocationCount = counters.AllocationCount.load(std::memory_order_relaxed);
+	return stats;
+}
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+
+#include "Core.h"
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+#include "Enum.h"
+
+
+// Per-tag accounting of CMemoryPool allocations, on in debug builds unless set explicitly
+#ifndef FRT_MEMORY_TRACKING
+#if defined(DEBUG) || defined(_DEBUG)
+#define FRT_MEMORY_TRACKING 1
+#else
+#define FRT_MEMORY_TRACKING 0
+#endif
+#endif
+
+
+namespace frt::memory
+{
+enum class EMemoryTag : uint8
+{
+	Untagged = 0u,
+	Core,
+	Renderer,
+	Assets,
+	World,
+	Input,
+	FrameArena,
+	Count,
+};
+
+
+struct SMemoryTagStats
+{
+	uint64 LiveBytes = 0ull;
+	uint64 PeakBytes = 0ull;
+	uint64 LiveCount = 0ull;
+	uint64 AllocationCount = 0ull; // Reallocations included
+};
+
+
+/** Tag new allocations made by this thread get, see FRT_MEMORY_TAG_SCOPE. */
+FRT_CORE_API EMemoryTag GetCurrentMemoryTag ();
+
+
+/** Sets the thread's current tag for its lifetime, nested scopes form a stack */
+class FRT_CORE_API CMemoryTagScope
+{
+public:
+	FRT_DELETE_COPY_AND_MOVE_OPS(CMemoryTagScope);
+
+	explicit CMemoryTagScope (EMemoryTag InTag);
+	~CMemoryTagScope ();
+
+private:
+	EMemoryTag PreviousTag = EMemoryTag::Untagged;
+};
+
+
+/**
+* Live, peak and total counters per tag. Key points:
+*	- Each tracked allocation is prefixed with SHeader, so Free knows the size and the tag it was counted under
+*	- Counters are atomics, so the tracker can sit behind a thread-safe pool
+*	- Peak is per tag; the sum of peaks is not the peak of the pool
+*/
+class FRT_CORE_API CMemoryTracker
+{
+public:
+	struct SHeader
+	{
+		uint64 Size = 0ull;
+		EMemoryTag Tag = EMemoryTag::Untagged;
+		FRT_STRUCT_PADDING(7);
+	};
+
+
+	// Keeps TLSF alignment of the memory handed out
+	static_assert(sizeof(SHeader) == 16u);
+
+	FRT_DELETE_COPY_AND_MOVE_OPS(CMemoryTracker);
+
+	CMemoryTracker () = default;
+
+	/** Fills the header at the start of RawMemory and returns the memory after it. */
+	void* OnAllocate (void* RawMemory, uint64 Size, EMemoryTag Tag);
+	/** Returns the start of the allocation, including the header. */
+	void* OnFree (void* Memory);
+
+	static const SHeader& GetHeader (const void* Memory) { return *(static_cast<const SHeader*>(Memory) - 1); }
+
+	SMemoryTagStats GetStats (EMemoryTag Tag) const;
+
+private:
+	struct SCounters
+	{
+		std::atomic<uint64> LiveBytes = 0ull;
+		std::atomic<uint64> PeakBytes = 0ull;
+		std::atomic<uint64> LiveCount = 0ull;
+		std::atomic<uint64> AllocationCount = 0ull;
+	};
+
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+	SCounters Counters[(uint32)EMemoryTag::Count];
+#pragma warning(pop)
+};
+}
+
+
+FRT_DECLARE_ENUM_REFLECTION(
+	frt::memory::EMemoryTag,
+	FRT_ENUM_ENTRY(frt::memory::EMemoryTag, Untagged),
+	FRT_ENUM_ENTRY(frt::memory::EMemoryTag, Core),
+	FRT_ENUM_ENTRY(frt::memory::EMemoryTag, Renderer),
+	FRT_ENUM_ENTRY(frt::memory::EMemoryTag, Assets),
+	FRT_ENUM_ENTRY(frt::memory::EMemoryTag, World),
+	FRT_ENUM_ENTRY(frt::memory::EMemoryTag, Input),
+	FRT_ENUM_ENTRY(frt::memory::EMemoryTag, FrameArena));
+
+
+#define FRT_MEMORY_TAG_CONCAT_IMPL(A, B) A##B
+#define FRT_MEMORY_TAG_CONCAT(A, B) FRT_MEMORY_TAG_CONCAT_IMPL(A, B)
+
+#if FRT_MEMORY_TRACKING
+#define FRT_MEMORY_TAG_SCOPE(Tag)\
+	const ::frt::memory::CMemoryTagScope FRT_MEMORY_TAG_CONCAT(memoryTagScope, __LINE__)(::frt::memory::EMemoryTag::Tag)
+#else
+#define FRT_MEMORY_TAG_SCOPE(Tag)
+#endif
@@ -1,10 +1,14 @@
 ﻿#pragma once
 
+#include <atomic>
 #include <new>
+#include <type_traits>
+#include <utility>
 
 #include "Allocator.h"
 #include "Asserts.h"
 #include "CoreTypes.h"
+#include "Relocation.h"
 
 
 namespace frt::memory
@@ -39,7 +43,8 @@ using namespace refs;
  * @param TRefUnique   : owning, similar to std::unique_ptr, but has extra cost as it also has control block and allows getting weak ptrs.
  *	This makes RefUnique's usage more clear as one don't have to use raw ptr or to move ownership just to use an object in some function.
  *
- * @todo multithreading support
+ * Ref counts are not synchronized unless the type is declared with FRT_DECLARE_THREAD_SAFE_REFS, see TRefCountPolicy.
+ * Non-owning refs are never synchronized.
  */
 namespace refs
 {
@@ -67,11 +72,106 @@ namespace refs
 	struct TRefUnique;
 
 
+	template <typename T>
+	struct RefCountPolicyTag
+	{};
+
+
+	/** Types marked with FRT_DECLARE_THREAD_SAFE_REFS can have their refs copied and released from any thread */
+	template <typename T>
+	struct TIsThreadSafeRefType
+	{
+		static constexpr bool value = requires (RefCountPolicyTag<std::remove_cv_t<T>> Tag)
+		{
+			frt_thread_safe_refs_marker(Tag);
+		};
+	};
+
+
+	/** Counting for objects confined to one thread: plain loads and stores, no locked instructions or fences */
+	struct SRefCountSingleThread
+	{
+		static uint32 Load (const std::atomic<uint32>& Count) { return Count.load(std::memory_order_relaxed); }
+
+		static void Increment (std::atomic<uint32>& Count)
+		{
+			Count.store(Count.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+		}
+
+		/** Returns the new count. */
+		static uint32 Decrement (std::atomic<uint32>& Count)
+		{
+			const uint32 count = Count.load(std::memory_order_relaxed) - 1u;
+			Count.store(count, std::memory_order_relaxed);
+			return count;
+		}
+
+		static bool IncrementIfNotZero (std::atomic<uint32>& Count)
+		{
+			const uint32 count = Count.load(std::memory_order_relaxed);
+			if (count == 0u)
+			{
+				return false;
+			}
+			Count.store(count + 1u, std::memory_order_relaxed);
+			return true;
+		}
+	};
+
+
+	/**
+	* Counting for objects shared between threads. Key points:
+	*	- A new ref is always made from an existing one, so increments don't need ordering
+	*	- Decrements release, and the one that hits zero acquires, so destruction sees every write done through other refs
+	*	- Weak to strong upgrade never resurrects an object whose strong count has already hit zero
+	*/
+	struct SRefCountThreadSafe
+	{
+		static uint32 Load (const std::atomic<uint32>& Count) { return Count.load(std::memory_order_acquire); }
+
+		static void Increment (std::atomic<uint32>& Count)
+		{
+			Count.fetch_add(1u, std::memory_order_relaxed);
+		}
+
+		static uint32 Decrement (std::atomic<uint32>& Count)
+		{
+			const uint32 count = Count.fetch_sub(1u, std::memory_order_release) - 1u;
+			if (count == 0u)
+			{
+				std::atomic_thread_fence(std::memory_order_acquire);
+			}
+			return count;
+		}
+
+		static bool IncrementIfNotZero (std::atomic<uint32>& Count)
+		{
+			uint32 count = Count.load(std::memory_order_relaxed);
+			while (count != 0u)
+			{
+				if (Count.compare_exchange_weak(count, count + 1u, std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+	};
+
+
+	template <typename T>
+	using TRefCountPolicy = std::conditional_t<TIsThreadSafeRefType<T>::value, SRefCountThreadSafe, SRefCountSingleThread>;
+
+
+	/**
+	* Counts are atomics for both policies, so the layout doesn't depend on the policy.
+	* The policy is only looked up in member functions, where T is complete and its marker is visible.
+	*/
 	template <typename T>
 	struct TRefControlBlock
 	{
-		uint32 StrongRefCount = 1u;
-		uint32 WeakRefCount = 1u;
+		std::atomic<uint32> StrongRefCount = 1u;
+		std::atomic<uint32> WeakRefCount = 1u; // +1 held by all strong refs together
 
 		IAllocator* Allocator = nullptr; // TODO: 
 
@@ -93,24 +193,33 @@ namespace refs
 		template <typename... Args>
 		explicit TRefControlBlock (Args&&... InArgs) { new(Ptr()) T(std::forward<Args>(InArgs)...); }
 
+		uint32 GetStrongRefCount () const { return TRefCountPolicy<T>::Load(StrongRefCount); }
+		uint32 GetWeakRefCount () const { return TRefCountPolicy<T>::Load(WeakRefCount); }
+
 		TRefControlBlock* CopyStrong ()
 		{
-			frt_assert(StrongRefCount > 0u);
-			++StrongRefCount;
+			frt_assert(GetStrongRefCount() > 0u);
+			TRefCountPolicy<T>::Increment(StrongRefCount);
 			return this;
 		}
 
+		/** Strong ref out of a weak one, nullptr if the object is already gone. */
+		TRefControlBlock* TryCopyStrong ()
+		{
+			return TRefCountPolicy<T>::IncrementIfNotZero(StrongRefCount) ? this : nullptr;
+		}
+
 		TRefControlBlock* CopyWeak ()
 		{
-			frt_assert(StrongRefCount > 0u);
-			++WeakRefCount;
+			frt_assert(GetWeakRefCount() > 0u);
+			TRefCountPolicy<T>::Increment(WeakRefCount);
 			return this;
 		}
 
 		void DecrementStrong ()
 		{
-			frt_assert(StrongRefCount > 0u);
-			if (--StrongRefCount == 0u)
+			frt_assert(GetStrongRefCount() > 0u);
+			if (TRefCountPolicy<T>::Decrement(StrongRefCount) == 0u)
 			{
 				Ptr()->~T();
 				DecrementWeak();
@@ -119,8 +228,8 @@ namespace refs
 
 		void DecrementWeak ()
 		{
-			frt_assert(WeakRefCount > 0u);
-			if (--WeakRefCount == 0u)
+			frt_assert(GetWeakRefCount() > 0u);
+			if (TRefCountPolicy<T>::Decrement(WeakRefCount) == 0u)
 			{
 				Allocator->DeleteManaged(this);
 			}
@@ -318,7 +427,7 @@ namespace refs
 	{
 		TRefShared () = default;
 
-		TRefShared (const TRefShared& Other) { Control = Other.Control->CopyStrong(); }
+		TRefShared (const TRefShared& Other) : Control{ Other.Control ? Other.Control->CopyStrong() : nullptr } {}
 
 		TRefShared& operator= (const TRefShared& Other)
 		{
@@ -330,7 +439,7 @@ namespace refs
 			{
 				Control->DecrementStrong();
 			}
-			Control = Other.Control->CopyStrong();
+			Control = Other.Control ? Other.Control->CopyStrong() : nullptr;
 			return *this;
 		}
 
@@ -369,7 +478,7 @@ namespace refs
 		const T* operator-> () const { return Ptr(); }
 		const T& operator* () const { return *Ptr(); }
 
-		explicit constexpr operator bool () const { return Control && Control->StrongRefCount > 0u; }
+		explicit operator bool () const { return Control && Control->GetStrongRefCount() > 0u; }
 		explicit operator const T* () const { return Ptr(); }
 
 		void Release ()
@@ -381,13 +490,13 @@ namespace refs
 			Control = nullptr;
 		}
 
-		void Reset (const TRefControlBlock<T>* NewPtr = nullptr)
+		void Reset (TRefControlBlock<T>* NewControl = nullptr)
 		{
 			if (Control)
 			{
 				Control->DecrementStrong();
 			}
-			Control = NewPtr;
+			Control = NewControl;
 		}
 
 	protected:
@@ -402,7 +511,7 @@ namespace refs
 	{
 		TRefWeak () = default;
 
-		TRefWeak (const TRefWeak& Other) : Control{ Other.Control->CopyWeak() } {}
+		TRefWeak (const TRefWeak& Other) : Control{ Other.Control ? Other.Control->CopyWeak() : nullptr } {}
 
 		TRefWeak& operator= (const TRefWeak& Other)
 		{
@@ -414,7 +523,7 @@ namespace refs
 			{
 				Control->DecrementWeak();
 			}
-			Control = Other.Control->CopyWeak();
+			Control = Other.Control ? Other.Control->CopyWeak() : nullptr;
 			return *this;
 		}
 
@@ -472,10 +581,12 @@ namespace refs
 		const T* operator-> () const { return Control->Ptr(); }
 		const T& operator* () const { return *Ptr(); }
 
-		explicit constexpr operator bool () const { return Ptr() != nullptr; }
+		/** Only a hint when other threads hold strong refs, Lock and check the result instead. */
+		explicit operator bool () const { return Control && Control->GetStrongRefCount() > 0u; }
 		explicit operator const T* () const { return Ptr(); }
 
-		TRefShared<T> Lock () { return TRefShared<T>(Control->CopyStrong()); }
+		/** Empty if the object is already gone. */
+		TRefShared<T> Lock () const { return TRefShared<T>(Control ? Control->TryCopyStrong() : nullptr); }
 
 		void Reset (TRefControlBlock<T>* NewControl = nullptr)
 		{
@@ -532,7 +643,7 @@ namespace refs
 		const T* operator-> () const { return Ptr(); }
 		const T& operator* () const { return *Ptr(); }
 
-		explicit constexpr operator bool () const { return Control && Control->StrongRefCount > 0u; }
+		explicit operator bool () const { return Control && Control->GetStrongRefCount() > 0u; }
 		explicit operator const T* () const { return Ptr(); }
 
 		void Release ()
@@ -544,19 +655,37 @@ namespace refs
 			Control = nullptr;
 		}
 
-		void Reset (const TRefControlBlock<T>* NewPtr = nullptr)
+		void Reset (TRefControlBlock<T>* NewControl = nullptr)
 		{
 			if (Control)
 			{
 				Control->DecrementStrong();
 			}
-			Control = NewPtr;
+			Control = NewControl;
 		}
 
 	protected:
 		T* Ptr () { return Control->Ptr(); }
 		const T* Ptr () const { return Control->Ptr(); }
-		TRefControlBlock<T>* Control;
+		TRefControlBlock<T>* Control = nullptr;
 	};
 }
+
+
+// Owning refs are just a pointer to the control block, their bytes can move without touching the counts
+template <typename T>
+struct TIsTriviallyRelocatable<refs::TRefShared<T>> : std::true_type
+{};
+
+template <typename T>
+struct TIsTriviallyRelocatable<refs::TRefWeak<T>> : std::true_type
+{};
+
+template <typename T>
+struct TIsTriviallyRelocatable<refs::TRefUnique<T>> : std::true_type
+{};
 }
+
+
+#define FRT_DECLARE_THREAD_SAFE_REFS(Type)\
+	constexpr void frt_thread_safe_refs_marker(::frt::memory::refs::RefCountPolicyTag<Type>) {}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <type_traits>
+
+
+namespace frt::memory
+{
+template <typename T>
+struct RelocationTag
+{};
+
+
+/**
+* Whether an object of T can be moved to another address by copying its bytes, skipping the move constructor and
+* the destructor of the source. Containers use it to grow with realloc/memcpy instead of moving element by element.
+* Key points:
+*	- Trivially copyable types are relocatable
+*	- Other types opt in with FRT_DECLARE_TRIVIALLY_RELOCATABLE, class templates with a specialization of this trait
+*	- Types that point into themselves, or are registered somewhere by address, must not opt in
+*/
+template <typename T>
+struct TIsTriviallyRelocatable
+{
+	static constexpr bool value = std::is_trivially_copyable_v<T> || requires (RelocationTag<std::remove_cv_t<T>> Tag)
+	{
+		frt_trivially_relocatable_marker(Tag);
+	};
+};
+
+
+template <typename T>
+inline constexpr bool IsTriviallyRelocatable = TIsTriviallyRelocatable<T>::value;
+}
+
+
+#define FRT_DECLARE_TRIVIALLY_RELOCATABLE(Type)\
+	constexpr void frt_trivially_relocatable_marker(::frt::memory::RelocationTag<Type>) {}
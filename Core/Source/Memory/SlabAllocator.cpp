@@ -0,0 +1,236 @@
+#include "SlabAllocator.h"
+
+#include <new>
+
+#include "Asserts.h"
+#include "MemoryPool.h"
+#include "Math/MathUtility.h"
+
+
+namespace frt::memory
+{
+namespace
+{
+std::atomic<uint32> gDedicatedTypeCount = 0u;
+
+uint64 AlignUp (uint64 Value, uint64 Align)
+{
+	return (Value + Align - 1ull) & ~(Align - 1ull);
+}
+}
+
+
+CSlabAllocator::CSlabAllocator (CMemoryPool* InBackingPool, uint32 InBlockSize, bool bInThreadSafe)
+	: BackingPool(InBackingPool)
+	, BlockSize((uint32)AlignUp(math::Max<uint64>(InBlockSize, sizeof(SFreeBlock)), BlockAlignment))
+	, bThreadSafe(bInThreadSafe)
+{
+	frt_assert(BackingPool);
+
+	BlocksPerChunk = math::Max<uint32>(MinBlocksPerChunk, (uint32)(ChunkSize / BlockSize));
+	Stats.BlockSize = BlockSize;
+}
+
+CSlabAllocator::~CSlabAllocator ()
+{
+	while (Chunks)
+	{
+		SChunk* next = Chunks->Next;
+		BackingPool->Free(Chunks);
+		Chunks = next;
+	}
+	FreeList = nullptr;
+}
+
+void* CSlabAllocator::Allocate (uint64 Size)
+{
+	frt_assert(Size <= BlockSize);
+
+	std::unique_lock lock(Mutex, std::defer_lock);
+	if (bThreadSafe)
+	{
+		lock.lock();
+	}
+
+	if (!FreeList)
+	{
+		AddChunk();
+	}
+
+	SFreeBlock* block = FreeList;
+	FreeList = block->Next;
+
+	++Stats.LiveCount;
+	++Stats.AllocationCount;
+	Stats.PeakLiveCount = math::Max(Stats.PeakLiveCount, Stats.LiveCount);
+
+	return block;
+}
+
+void CSlabAllocator::Free (void* Memory)
+{
+	if (!Memory)
+	{
+		return;
+	}
+
+	std::unique_lock lock(Mutex, std::defer_lock);
+	if (bThreadSafe)
+	{
+		lock.lock();
+	}
+
+	frt_assert(Stats.LiveCount > 0u);
+
+	auto* block = static_cast<SFreeBlock*>(Memory);
+	block->Next = FreeList;
+	FreeList = block;
+	--Stats.LiveCount;
+}
+
+void CSlabAllocator::DeleteManaged (void* Memory)
+{
+	Free(Memory);
+}
+
+SSlabStats CSlabAllocator::GetStats () const
+{
+	std::unique_lock lock(Mutex, std::defer_lock);
+	if (bThreadSafe)
+	{
+		lock.lock();
+	}
+
+	return Stats;
+}
+
+void CSlabAllocator::AddChunk ()
+{
+	// Chunk header is padded, so the first block starts aligned as well
+	const uint64 headerSize = AlignUp(sizeof(SChunk), BlockAlignment);
+	const uint64 size = headerSize + (uint64)BlockSize * BlocksPerChunk + BlockAlignment;
+
+	auto* chunk = static_cast<SChunk*>(BackingPool->Allocate(size));
+	frt_assert(chunk);
+	chunk->Next = Chunks;
+	Chunks = chunk;
+
+	auto* blocks = reinterpret_cast<uint8*>(AlignUp((uint64)chunk + headerSize, BlockAlignment));
+
+	// Pushed backwards, so blocks are handed out in address order
+	for (uint32 i = BlocksPerChunk; i > 0u; --i)
+	{
+		auto* block = reinterpret_cast<SFreeBlock*>(blocks + (uint64)(i - 1u) * BlockSize);
+		block->Next = FreeList;
+		FreeList = block;
+	}
+
+	++Stats.ChunkCount;
+	Stats.Capacity += BlocksPerChunk;
+}
+
+
+CSlabPools::CSlabPools (CMemoryPool* InBackingPool, bool bInThreadSafe)
+	: BackingPool(InBackingPool)
+	, bThreadSafe(bInThreadSafe)
+{}
+
+CSlabPools::~CSlabPools ()
+{
+	auto destroy = [this] (std::atomic<CSlabAllocator*>& Slot)
+	{
+		if (CSlabAllocator* slab = Slot.load())
+		{
+			slab->~CSlabAllocator();
+			BackingPool->Free(slab);
+			Slot = nullptr;
+		}
+	};
+
+	for (auto& slot : SizeClassSlabs)
+	{
+		destroy(slot);
+	}
+	for (auto& slot : DedicatedSlabs)
+	{
+		destroy(slot);
+	}
+}
+
+CSlabAllocator* CSlabPools::GetSizeClassSlab (uint64 Size)
+{
+	if (Size == 0ull || Size > MaxSizeClassSize)
+	{
+		return nullptr;
+	}
+
+	const uint32 sizeClass = (uint32)((Size - 1ull) / SizeClassStep);
+	std::atomic<CSlabAllocator*>& slot = SizeClassSlabs[sizeClass];
+
+	CSlabAllocator* slab = slot.load(std::memory_order_acquire);
+	return slab ? slab : CreateSlab(slot, (uint64)(sizeClass + 1u) * SizeClassStep);
+}
+
+CSlabAllocator* CSlabPools::GetDedicatedSlab (uint32 TypeIndex, uint64 Size)
+{
+	if (TypeIndex >= MaxDedicatedSlabs)
+	{
+		return nullptr;
+	}
+
+	std::atomic<CSlabAllocator*>& slot = DedicatedSlabs[TypeIndex];
+
+	CSlabAllocator* slab = slot.load(std::memory_order_acquire);
+	return slab ? slab : CreateSlab(slot, Size);
+}
+
+void CSlabPools::SetBackingPool (CMemoryPool* InBackingPool)
+{
+	std::unique_lock lock(CreationMutex, std::defer_lock);
+	if (bThreadSafe)
+	{
+		lock.lock();
+	}
+
+	BackingPool = InBackingPool;
+	for (auto& slot : SizeClassSlabs)
+	{
+		if (CSlabAllocator* slab = slot.load())
+		{
+			slab->SetBackingPool(InBackingPool);
+		}
+	}
+	for (auto& slot : DedicatedSlabs)
+	{
+		if (CSlabAllocator* slab = slot.load())
+		{
+			slab->SetBackingPool(InBackingPool);
+		}
+	}
+}
+
+uint32 CSlabPools::RegisterDedicatedType ()
+{
+	return gDedicatedTypeCount++;
+}
+
+CSlabAllocator* CSlabPools::CreateSlab (std::atomic<CSlabAllocator*>& Slot, uint64 BlockSize)
+{
+	std::unique_lock lock(CreationMutex, std::defer_lock);
+	if (bThreadSafe)
+	{
+		lock.lock();
+	}
+
+	if (CSlabAllocator* slab = Slot.load(std::memory_order_acquire))
+	{
+		return slab;
+	}
+
+	void* memory = BackingPool->Allocate(sizeof(CSlabAllocator));
+	frt_assert(memory);
+	auto* slab = new(memory) CSlabAllocator(BackingPool, (uint32)BlockSize, bThreadSafe);
+	Slot.store(slab, std::memory_order_release);
+	return slab;
+}
+}
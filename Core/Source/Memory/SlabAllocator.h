@@ -0,0 +1,192 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+#include "Allocator.h"
+#include "Core.h"
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+
+
+namespace frt::memory
+{
+class CMemoryPool;
+
+
+template <typename T>
+struct SlabPoolTag
+{};
+
+
+/** Types marked with FRT_DECLARE_SLAB_POOL get a slab of their own instead of sharing one by size */
+template <typename T>
+struct TIsDedicatedSlabType
+{
+	static constexpr bool value = requires (SlabPoolTag<T> Tag)
+	{
+		frt_slab_pool_marker(Tag);
+	};
+};
+
+
+template <typename T>
+inline constexpr bool IsDedicatedSlabType = TIsDedicatedSlabType<T>::value;
+
+
+struct SSlabStats
+{
+	uint32 BlockSize = 0u;
+	uint32 ChunkCount = 0u;
+	uint32 Capacity = 0u;
+	uint32 LiveCount = 0u;
+	uint32 PeakLiveCount = 0u;
+	uint64 AllocationCount = 0ull;
+
+	float GetOccupancy () const { return Capacity ? (float)LiveCount / (float)Capacity : 0.f; }
+};
+
+
+/**
+* Pool of fixed-size blocks. Key points:
+*	- Blocks are carved out of contiguous chunks taken from the backing pool, so neighbours stay close in memory
+*	- Freed blocks go to an intrusive free list and are reused first, both Allocate and Free are O(1)
+*	- Chunks are only returned to the backing pool when the slab is destroyed
+*/
+class FRT_CORE_API CSlabAllocator : public IAllocator
+{
+public:
+	static constexpr uint64 ChunkSize = 64ull * 1024ull;
+	static constexpr uint32 MinBlocksPerChunk = 16u;
+	static constexpr uint32 BlockAlignment = 16u;
+
+	FRT_DELETE_COPY_AND_MOVE_OPS(CSlabAllocator);
+
+	CSlabAllocator (CMemoryPool* InBackingPool, uint32 InBlockSize, bool bInThreadSafe);
+	virtual ~CSlabAllocator () override;
+
+	virtual void* Allocate (uint64 Size) override;
+	virtual void Free (void* Memory) override;
+	virtual void DeleteManaged (void* Memory) override;
+
+	uint32 GetBlockSize () const { return BlockSize; }
+	SSlabStats GetStats () const;
+
+	void SetBackingPool (CMemoryPool* InBackingPool) { BackingPool = InBackingPool; }
+
+private:
+	struct SFreeBlock
+	{
+		SFreeBlock* Next = nullptr;
+	};
+
+
+	struct SChunk
+	{
+		SChunk* Next = nullptr;
+	};
+
+
+	void AddChunk ();
+
+private:
+	CMemoryPool* BackingPool = nullptr;
+	uint32 BlockSize = 0u;
+	uint32 BlocksPerChunk = 0u;
+	bool bThreadSafe = false;
+
+	SChunk* Chunks = nullptr;
+	SFreeBlock* FreeList = nullptr;
+	SSlabStats Stats;
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+	mutable std::mutex Mutex;
+#pragma warning(pop)
+};
+
+
+/**
+* Slabs owned by CMemoryPool for managed allocations. Key points:
+*	- Control blocks up to MaxSizeClassSize share slabs by size class
+*	- Types declared with FRT_DECLARE_SLAB_POOL get their own slab of any size, so they are packed together
+*	- Slabs are created on first use
+*/
+class FRT_CORE_API CSlabPools
+{
+public:
+	static constexpr uint32 SizeClassStep = 32u;
+	static constexpr uint32 MaxSizeClassSize = 512u;
+	static constexpr uint32 SizeClassCount = MaxSizeClassSize / SizeClassStep;
+	static constexpr uint32 MaxDedicatedSlabs = 64u;
+
+	FRT_DELETE_COPY_AND_MOVE_OPS(CSlabPools);
+
+	CSlabPools (CMemoryPool* InBackingPool, bool bInThreadSafe);
+	~CSlabPools ();
+
+	/** Slab shared by all managed types of a similar size, or nullptr if the size is too big for one. */
+	CSlabAllocator* GetSizeClassSlab (uint64 Size);
+	/** Slab of a single type, nullptr if the limit of dedicated slabs is reached. */
+	CSlabAllocator* GetDedicatedSlab (uint32 TypeIndex, uint64 Size);
+
+	template <typename TFunc>
+	void ForEachSlab (TFunc&& Func) const;
+
+	/** CMemoryPool is movable, slabs have to follow it. */
+	void SetBackingPool (CMemoryPool* InBackingPool);
+
+	static uint32 RegisterDedicatedType ();
+
+	template <typename T>
+	static uint32 GetDedicatedTypeIndex ();
+
+private:
+	CSlabAllocator* CreateSlab (std::atomic<CSlabAllocator*>& Slot, uint64 BlockSize);
+
+private:
+	CMemoryPool* BackingPool = nullptr;
+	bool bThreadSafe = false;
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+	std::mutex CreationMutex;
+	std::atomic<CSlabAllocator*> SizeClassSlabs[SizeClassCount] = {};
+	std::atomic<CSlabAllocator*> DedicatedSlabs[MaxDedicatedSlabs] = {};
+#pragma warning(pop)
+};
+}
+
+
+#define FRT_DECLARE_SLAB_POOL(Type)\
+	constexpr void frt_slab_pool_marker(::frt::memory::SlabPoolTag<Type>) {}
+
+
+namespace frt::memory
+{
+template <typename TFunc>
+void CSlabPools::ForEachSlab (TFunc&& Func) const
+{
+	for (const auto& slot : SizeClassSlabs)
+	{
+		if (const CSlabAllocator* slab = slot.load(std::memory_order_acquire))
+		{
+			Func(*slab);
+		}
+	}
+	for (const auto& slot : DedicatedSlabs)
+	{
+		if (const CSlabAllocator* slab = slot.load(std::memory_order_acquire))
+		{
+			Func(*slab);
+		}
+	}
+}
+
+template <typename T>
+uint32 CSlabPools::GetDedicatedTypeIndex ()
+{
+	static const uint32 index = RegisterDedicatedType();
+	return index;
+}
+}
@@ -124,6 +124,8 @@ TLSF::SControl::SControl ()
 			FreeBlocks[i][j] = &BlockNull;
 		}
 	}
+
+	PoolProvider = nullptr;
 }
 
 TLSF::SBlockHeader* TLSF::SControl::SearchSuitableBlock (uint32& InOutFli, uint32& InOutSli)
@@ -322,6 +324,13 @@ TLSF::SBlockHeader* TLSF::SControl::LocateBlockFree (uint64 Size)
 		if (fl < FirstLevelIndexCount)
 		{
 			block = SearchSuitableBlock(fl, sl);
+
+			// Out of memory, give the provider a chance to add more and search once again
+			if (!block && PoolProvider && PoolProvider->Grow(*(TLSF*)this, Size))
+			{
+				MappingSearch(Size, fl, sl);
+				block = SearchSuitableBlock(fl, sl);
+			}
 		}
 	}
 
@@ -400,6 +409,17 @@ void TLSF::MappingInsert (uint64 Size, uint32& OutFli, uint32& OutSli)
 	OutSli = sl;
 }
 
+uint64 TLSF::GetBinMinSize (uint32 Fli, uint32 Sli)
+{
+	if (Fli == 0u)
+	{
+		return (uint64)Sli * (SmallBlockSize / SecondLevelIndexCount);
+	}
+
+	const uint32 bit = Fli + FirstLevelIndexShift - 1u;
+	return (1ull << bit) + ((uint64)Sli << (bit - SecondLevelIndexCountLog2));
+}
+
 void TLSF::MappingSearch (uint64 Size, uint32& OutFli, uint32& OutSli)
 {
 	if (Size >= SmallBlockSize)
@@ -462,7 +482,63 @@ void TLSF::RemovePool (void* InMemory)
 	uint32 fl, sl;
 
 	MappingInsert(block->GetSize(), fl, sl);
-	((SControl*)InMemory)->RemoveFreeBlock(block, fl, sl);
+	((SControl*)this)->RemoveFreeBlock(block, fl, sl);
+}
+
+void TLSF::ExtendPool (void* InMemory, uint64 InSize, uint64 InNewSize)
+{
+	constexpr uint64 poolOverhead = GetPoolOverhead();
+	const uint64 poolBytes = AlignDown(InSize - poolOverhead, AlignSize);
+	const uint64 newPoolBytes = AlignDown(InNewSize - poolOverhead, AlignSize);
+
+	if (newPoolBytes <= poolBytes || newPoolBytes - poolBytes < sizeof(SBlockHeader) || newPoolBytes > BlockMaxSize)
+	{
+		return;
+	}
+
+	// The zero-sized sentinel that terminates the pool becomes a free block spanning the new memory
+	SBlockHeader* block = SBlockHeader::OffsetToBlock(InMemory, (int64)poolBytes);
+	frt_assert(block->GetSize() == 0ull && !block->IsFree());
+
+	block->SetSize(newPoolBytes - poolBytes - Overhead);
+	block->SetFree();
+
+	SBlockHeader* next = block->LinkNext();
+	next->SetSize(0ull);
+	next->SetUsed();
+	next->SetPrevFree();
+
+	auto control = (SControl*)this;
+	block = control->MergeBlockPrev(block);
+	control->InsertBlockIntoFreeList(block);
+}
+
+void TLSF::ReportPool (const void* InMemory, SHeapReport& InOutReport)
+{
+	++InOutReport.PoolCount;
+
+	WalkPool(InMemory, [&InOutReport] (void*, uint64 BlockSize, bool bFree)
+	{
+		if (!bFree)
+		{
+			InOutReport.UsedBytes += BlockSize;
+			++InOutReport.UsedBlockCount;
+			return;
+		}
+
+		uint32 fl, sl;
+		MappingInsert(BlockSize, fl, sl);
+		++InOutReport.FreeBlockHistogram[fl][sl];
+
+		InOutReport.FreeBytes += BlockSize;
+		++InOutReport.FreeBlockCount;
+		InOutReport.LargestFreeBlock = math::Max(InOutReport.LargestFreeBlock, BlockSize);
+	});
+}
+
+void TLSF::SetPoolProvider (IPoolProvider* InProvider)
+{
+	((SControl*)this)->PoolProvider = InProvider;
 }
 
 void* TLSF::Malloc (uint64 Size)
@@ -476,7 +552,6 @@ void* TLSF::Malloc (uint64 Size)
 
 void* TLSF::Realloc (void* Memory, uint64 Size)
 {
-	auto control = (SControl*)this;
 	void* newMemory = nullptr;
 
 	// Zero size request is treated as free
@@ -489,44 +564,55 @@ void* TLSF::Realloc (void* Memory, uint64 Size)
 	{
 		newMemory = Malloc(Size);
 	}
+	else if (ResizeInPlace(Memory, Size))
+	{
+		newMemory = Memory;
+	}
 	else
 	{
-		SBlockHeader* block = SBlockHeader::Cast(Memory);
-		SBlockHeader* next = block->NextBlock();
-
-		frt_assert(!block->IsFree());
+		const uint64 currentSize = SBlockHeader::Cast(Memory)->GetSize();
 
-		const uint64 currentSize = block->GetSize();
-		const uint64 combinedSize = currentSize + next->GetSize() + Overhead;
-		const uint64 adjust = AdjustRequestedSize(Size, AlignSize);
-
-		if (adjust > currentSize && (!next->IsFree() || adjust > combinedSize))
-		{
-			newMemory = Malloc(Size);
-			if (newMemory)
-			{
-				const uint64 minSize = math::Min(currentSize, Size);
-				std::memcpy(newMemory, Memory, minSize);
-				std::memset((uint8*)newMemory + minSize, 0, Size - minSize);
-				Free(Memory);
-			}
-		}
-		else
+		newMemory = Malloc(Size);
+		if (newMemory)
 		{
-			if (adjust > currentSize)
-			{
-				control->MergeBlockNext(block);
-				block->MarkAsUsed();
-			}
-
-			control->TrimBlockUsed(block, adjust);
-			newMemory = Memory;
+			const uint64 minSize = math::Min(currentSize, Size);
+			std::memcpy(newMemory, Memory, minSize);
+			std::memset((uint8*)newMemory + minSize, 0, Size - minSize);
+			Free(Memory);
 		}
 	}
 
 	return newMemory;
 }
 
+bool TLSF::ResizeInPlace (void* Memory, uint64 Size)
+{
+	auto control = (SControl*)this;
+
+	SBlockHeader* block = SBlockHeader::Cast(Memory);
+	SBlockHeader* next = block->NextBlock();
+
+	frt_assert(!block->IsFree());
+
+	const uint64 currentSize = block->GetSize();
+	const uint64 combinedSize = currentSize + next->GetSize() + Overhead;
+	const uint64 adjust = AdjustRequestedSize(Size, AlignSize);
+
+	if (adjust == 0ull || (adjust > currentSize && (!next->IsFree() || adjust > combinedSize)))
+	{
+		return false;
+	}
+
+	if (adjust > currentSize)
+	{
+		control->MergeBlockNext(block);
+		block->MarkAsUsed();
+	}
+
+	control->TrimBlockUsed(block, adjust);
+	return true;
+}
+
 void* TLSF::Memalign (uint64 Align, uint64 Size)
 {
 	const uint64 adjust = AdjustRequestedSize(Size, AlignSize);
@@ -545,7 +631,7 @@ void* TLSF::Memalign (uint64 Align, uint64 Size)
 	{
 		void* ptr = SBlockHeader::Cast(block);
 		void* aligned = AlignPtr(ptr, Align);
-		uint64 gap = (uint8*)aligned - ptr;
+		uint64 gap = (uint8*)aligned - (uint8*)ptr;
 
 		if (gap && gap < gapMin)
 		{
@@ -554,7 +640,7 @@ void* TLSF::Memalign (uint64 Align, uint64 Size)
 			const void* nextAligned = (uint8*)aligned + offset;
 
 			aligned = AlignPtr(nextAligned, Align);
-			gap = (uint8*)aligned - ptr;
+			gap = (uint8*)aligned - (uint8*)ptr;
 		}
 
 		if (gap)
@@ -582,5 +668,13 @@ void TLSF::Free (void* Memory)
 	}
 }
 
+uint64 TLSF::GetAllocationSize (const void* Memory)
+{
+	frt_assert(Memory);
+	const SBlockHeader* block = SBlockHeader::Cast(const_cast<void*>(Memory));
+	frt_assert(!block->IsFree());
+	return block->GetSize();
+}
+
 #pragma endregion TLSF Core
 }
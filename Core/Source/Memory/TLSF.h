@@ -6,6 +6,21 @@
 
 namespace frt::memory
 {
+struct TLSF;
+struct SHeapReport;
+
+
+/** Gives a TLSF instance more memory once none of its free blocks fits a request */
+class IPoolProvider
+{
+public:
+	virtual ~IPoolProvider () = default;
+
+	/** Must add a new pool or extend an existing one so that a block of at least Size bytes becomes free */
+	virtual bool Grow (TLSF& Tlsf, uint64 Size) = 0;
+};
+
+
 struct TLSF
 {
 	static constexpr uint32 SecondLevelIndexCountLog2 = 5u; // public
@@ -73,6 +88,8 @@ struct TLSF
 
 		SBlockHeader* FreeBlocks[FirstLevelIndexCount][SecondLevelIndexCount];
 
+		IPoolProvider* PoolProvider = nullptr;
+
 		SControl ();
 
 		SBlockHeader* SearchSuitableBlock (uint32& InOutFli, uint32& InOutSli);
@@ -101,6 +118,8 @@ struct TLSF
 	static uint64 AdjustRequestedSize (uint64 Size, uint64 Align);
 	static void MappingInsert (uint64 Size, uint32& OutFli, uint32& OutSli);
 	static void MappingSearch (uint64 Size, uint32& OutFli, uint32& OutSli);
+	/** Smallest block size MappingInsert puts into the given bin */
+	static uint64 GetBinMinSize (uint32 Fli, uint32 Sli);
 
 	static constexpr uint64 GetSize () { return sizeof(SControl); }
 	static constexpr uint64 GetPoolOverhead () { return 2u * Overhead; }
@@ -111,10 +130,70 @@ struct TLSF
 
 	void* AddPool (void* InMemory, uint64 InSize);
 	void RemovePool (void* InMemory);
+	/**
+	* Grows the last pool added at InMemory from InSize to InNewSize bytes.
+	* Memory in between must directly follow the pool and be accessible already.
+	*/
+	void ExtendPool (void* InMemory, uint64 InSize, uint64 InNewSize);
+
+	void SetPoolProvider (IPoolProvider* InProvider);
 
 	void* Malloc (uint64 Size);
 	void* Realloc (void* Memory, uint64 Size);
+	/** Grows the block into a free neighbour or trims it, returns false if it would have to move. */
+	bool ResizeInPlace (void* Memory, uint64 Size);
 	void* Memalign (uint64 Align, uint64 Size);
 	void Free (void* Memory);
+
+	/** Usable size of the block backing an allocation, may be bigger than requested */
+	static uint64 GetAllocationSize (const void* Memory);
+
+	/**
+	* Visits every physical block of the pool added at InMemory, in address order.
+	* Func is called as Func(void* BlockMemory, uint64 BlockSize, bool bFree). Not thread-safe.
+	*/
+	template <typename TFunc>
+	static void WalkPool (const void* InMemory, TFunc&& Func);
+
+	/** Adds blocks of the pool added at InMemory to the report. */
+	static void ReportPool (const void* InMemory, SHeapReport& InOutReport);
+};
+
+
+/** Snapshot of a TLSF heap, see TLSF::ReportPool */
+struct SHeapReport
+{
+	uint64 UsedBytes = 0ull;
+	uint64 FreeBytes = 0ull;
+	uint64 UsedBlockCount = 0ull;
+	uint64 FreeBlockCount = 0ull;
+	uint64 LargestFreeBlock = 0ull;
+	uint32 PoolCount = 0u;
+
+	// Number of free blocks per first-/second-level bin, same mapping TLSF uses for its free lists
+	uint32 FreeBlockHistogram[TLSF::FirstLevelIndexCount][TLSF::SecondLevelIndexCount] = {};
+
+	/** 0 when all free memory is a single block, close to 1 when it's scattered in small pieces. */
+	float GetFragmentation () const
+	{
+		return FreeBytes ? 1.f - (float)((double)LargestFreeBlock / (double)FreeBytes) : 0.f;
+	}
 };
 }
+
+
+namespace frt::memory
+{
+template <typename TFunc>
+void TLSF::WalkPool (const void* InMemory, TFunc&& Func)
+{
+	SBlockHeader* block = SBlockHeader::OffsetToBlock(InMemory, -(int64)Overhead);
+
+	// The pool ends with a zero-sized sentinel
+	while (!block->IsLast())
+	{
+		Func(SBlockHeader::Cast(block), block->GetSize(), block->IsFree());
+		block = block->NextBlock();
+	}
+}
+}
@@ -0,0 +1,460 @@
+#include "ThreadCache.h"
+
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "Asserts.h"
+#include "TLSF.h"
+#include "Math/MathUtility.h"
+
+
+namespace frt::memory
+{
+namespace
+{
+	constexpr uint32 MaxHeapsPerThread = 8u;
+
+
+	struct SLocalCacheSlot
+	{
+		CThreadCachedHeap* Heap = nullptr;
+		uint64 HeapSerial = 0ull;
+		CThreadCachedHeap::SThreadCache* Cache = nullptr;
+	};
+
+
+	// Serials of heaps that are still alive. Only touched when a heap is created/destroyed and on thread exit,
+	// so that a thread outliving a heap doesn't hand its cache back to freed memory.
+	std::mutex gLiveHeapsMutex;
+	std::vector<uint64> gLiveHeaps;
+	std::atomic<uint64> gNextHeapSerial = 1ull;
+
+	bool IsHeapAlive (uint64 Serial)
+	{
+		for (const uint64 serial : gLiveHeaps)
+		{
+			if (serial == Serial)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	struct SLocalCaches
+	{
+		SLocalCacheSlot Slots[MaxHeapsPerThread];
+
+		~SLocalCaches ()
+		{
+			std::scoped_lock lock(gLiveHeapsMutex);
+			for (SLocalCacheSlot& slot : Slots)
+			{
+				if (slot.Cache && IsHeapAlive(slot.HeapSerial))
+				{
+					slot.Heap->ReleaseCache(slot.Cache);
+				}
+				slot = {};
+			}
+		}
+	};
+
+
+	thread_local SLocalCaches gLocalCaches;
+}
+
+
+CThreadCachedHeap::CThreadCachedHeap (TLSF* InTlsf)
+	: Tlsf(InTlsf)
+	, Serial(gNextHeapSerial.fetch_add(1ull, std::memory_order_relaxed))
+{
+	frt_assert(Tlsf);
+
+	std::scoped_lock lock(gLiveHeapsMutex);
+	gLiveHeaps.push_back(Serial);
+}
+
+CThreadCachedHeap::~CThreadCachedHeap ()
+{
+	std::scoped_lock lock(gLiveHeapsMutex);
+	for (uint64& serial : gLiveHeaps)
+	{
+		if (serial == Serial)
+		{
+			serial = gLiveHeaps.back();
+			gLiveHeaps.pop_back();
+			break;
+		}
+	}
+
+	// Caches live inside the TLSF pool, so there is nothing to free here
+}
+
+void* CThreadCachedHeap::Allocate (uint64 Size)
+{
+	if (Size > MaxCachedSize)
+	{
+		return AllocateDirect(Size);
+	}
+
+	SThreadCache* cache = GetLocalCache(true);
+	if (!cache)
+	{
+		return AllocateDirect(Size);
+	}
+
+	const uint32 sizeClass = GetSizeClass(Size);
+	SFreeNode* node = cache->Bins[sizeClass];
+
+	if (!node && cache->RemoteFrees.load(std::memory_order_relaxed))
+	{
+		DrainRemoteFrees(cache);
+		node = cache->Bins[sizeClass];
+	}
+
+	if (!node)
+	{
+		return Refill(cache, sizeClass);
+	}
+
+	cache->Bins[sizeClass] = node->Next;
+	--cache->BinCounts[sizeClass];
+	return node;
+}
+
+void* CThreadCachedHeap::ReAllocate (void* Memory, uint64 Size)
+{
+	if (!Memory)
+	{
+		return Allocate(Size);
+	}
+
+	if (Size == 0ull)
+	{
+		Free(Memory);
+		return nullptr;
+	}
+
+	SBlockTag* tag = GetTag(Memory);
+	if (tag->CacheIndex == DirectCacheIndex)
+	{
+		// The tag is the first thing in the block, so TLSF carries it over on its own
+		std::scoped_lock lock(TlsfMutex);
+		auto* newTag = static_cast<SBlockTag*>(Tlsf->Realloc(tag, Size + sizeof(SBlockTag)));
+		return newTag ? newTag + 1 : nullptr;
+	}
+
+	const uint64 currentSize = GetSizeClassSize(tag->SizeClass);
+	if (Size <= currentSize)
+	{
+		return Memory;
+	}
+
+	void* newMemory = Allocate(Size);
+	if (newMemory)
+	{
+		std::memcpy(newMemory, Memory, currentSize);
+		Free(Memory);
+	}
+	return newMemory;
+}
+
+bool CThreadCachedHeap::ResizeInPlace (void* Memory, uint64 Size)
+{
+	SBlockTag* tag = GetTag(Memory);
+	if (tag->CacheIndex == DirectCacheIndex)
+	{
+		std::scoped_lock lock(TlsfMutex);
+		return Tlsf->ResizeInPlace(tag, Size + sizeof(SBlockTag));
+	}
+
+	return Size <= GetSizeClassSize(tag->SizeClass);
+}
+
+void CThreadCachedHeap::Free (void* Memory)
+{
+	if (!Memory)
+	{
+		return;
+	}
+
+	SBlockTag* tag = GetTag(Memory);
+	if (tag->CacheIndex == DirectCacheIndex)
+	{
+		std::scoped_lock lock(TlsfMutex);
+		Tlsf->Free(tag);
+		return;
+	}
+
+	frt_assert(tag->CacheIndex < CacheCount.load(std::memory_order_acquire));
+
+	auto* node = static_cast<SFreeNode*>(Memory);
+	SThreadCache* cache = GetLocalCache(false);
+	if (cache && cache->Index == tag->CacheIndex)
+	{
+		PushLocal(cache, node, tag->SizeClass);
+	}
+	else
+	{
+		PushRemote(Caches[tag->CacheIndex], node);
+	}
+}
+
+void CThreadCachedHeap::FlushThisThread ()
+{
+	if (SThreadCache* cache = GetLocalCache(false))
+	{
+		DrainRemoteFrees(cache);
+		for (uint32 sizeClass = 0u; sizeClass < SizeClassCount; ++sizeClass)
+		{
+			Flush(cache, sizeClass, 0u);
+		}
+	}
+}
+
+uint64 CThreadCachedHeap::GetAllocationSize (const void* Memory)
+{
+	const SBlockTag* tag = GetTag(Memory);
+	if (tag->CacheIndex == DirectCacheIndex)
+	{
+		return TLSF::GetAllocationSize(tag) - sizeof(SBlockTag);
+	}
+	return GetSizeClassSize(tag->SizeClass);
+}
+
+uint32 CThreadCachedHeap::GetSizeClass (uint64 Size)
+{
+	frt_assert(Size <= MaxCachedSize);
+
+	// 16-byte steps up to 128, then four classes per power of two: 160, 192, 224, 256, 320, ...
+	if (Size <= 128ull)
+	{
+		return Size ? (uint32)((Size + 15ull) >> 4u) - 1u : 0u;
+	}
+
+	const uint32 log2 = math::GetIndexOfFirstOneBit(Size - 1ull);
+	const uint32 step = (uint32)((Size - 1ull) >> (log2 - 2u)) - 4u;
+	return 8u + (log2 - 7u) * 4u + step;
+}
+
+uint64 CThreadCachedHeap::GetSizeClassSize (uint32 SizeClass)
+{
+	frt_assert(SizeClass < SizeClassCount);
+
+	if (SizeClass < 8u)
+	{
+		return (SizeClass + 1ull) << 4u;
+	}
+
+	const uint32 group = SizeClass - 8u;
+	const uint32 log2 = 7u + group / 4u;
+	return (5ull + group % 4u) << (log2 - 2u);
+}
+
+void CThreadCachedHeap::ReleaseCache (SThreadCache* Cache)
+{
+	DrainRemoteFrees(Cache);
+	for (uint32 sizeClass = 0u; sizeClass < SizeClassCount; ++sizeClass)
+	{
+		Flush(Cache, sizeClass, 0u);
+	}
+	Cache->bOwned.store(false, std::memory_order_release);
+}
+
+CThreadCachedHeap::SThreadCache* CThreadCachedHeap::GetLocalCache (bool bCreate)
+{
+	SLocalCacheSlot* freeSlot = nullptr;
+	for (SLocalCacheSlot& slot : gLocalCaches.Slots)
+	{
+		if (slot.Heap == this && slot.HeapSerial == Serial)
+		{
+			return slot.Cache;
+		}
+		if (!freeSlot && !slot.Cache)
+		{
+			freeSlot = &slot;
+		}
+	}
+
+	if (!bCreate)
+	{
+		return nullptr;
+	}
+
+	if (!freeSlot)
+	{
+		// Reclaim slots of heaps that are gone
+		std::scoped_lock lock(gLiveHeapsMutex);
+		for (SLocalCacheSlot& slot : gLocalCaches.Slots)
+		{
+			if (!IsHeapAlive(slot.HeapSerial))
+			{
+				slot = {};
+				freeSlot = freeSlot ? freeSlot : &slot;
+			}
+		}
+
+		if (!freeSlot)
+		{
+			return nullptr;
+		}
+	}
+
+	SThreadCache* cache = AcquireCache();
+	if (cache)
+	{
+		*freeSlot = SLocalCacheSlot{ this, Serial, cache };
+	}
+	return cache;
+}
+
+CThreadCachedHeap::SThreadCache* CThreadCachedHeap::AcquireCache ()
+{
+	// Adopt a cache left behind by an exited thread first
+	const uint32 count = CacheCount.load(std::memory_order_acquire);
+	for (uint32 i = 0u; i < count; ++i)
+	{
+		bool bExpected = false;
+		if (Caches[i]->bOwned.compare_exchange_strong(bExpected, true, std::memory_order_acquire))
+		{
+			return Caches[i];
+		}
+	}
+
+	std::scoped_lock lock(TlsfMutex);
+
+	const uint32 index = CacheCount.load(std::memory_order_relaxed);
+	if (index >= MaxThreadCaches)
+	{
+		return nullptr;
+	}
+
+	void* memory = Tlsf->Memalign(alignof(SThreadCache), sizeof(SThreadCache));
+	if (!memory)
+	{
+		return nullptr;
+	}
+
+	auto* cache = new(memory) SThreadCache;
+	cache->Index = index;
+	Caches[index] = cache;
+	CacheCount.store(index + 1u, std::memory_order_release);
+	return cache;
+}
+
+void* CThreadCachedHeap::AllocateDirect (uint64 Size)
+{
+	SBlockTag* tag = nullptr;
+	{
+		std::scoped_lock lock(TlsfMutex);
+		tag = static_cast<SBlockTag*>(Tlsf->Malloc(Size + sizeof(SBlockTag)));
+	}
+
+	if (!tag)
+	{
+		return nullptr;
+	}
+
+	*tag = SBlockTag{};
+	return tag + 1;
+}
+
+void* CThreadCachedHeap::Refill (SThreadCache* Cache, uint32 SizeClass)
+{
+	const uint64 blockSize = GetSizeClassSize(SizeClass) + sizeof(SBlockTag);
+	const uint32 batchCount = GetBatchCount(SizeClass);
+
+	SFreeNode* head = nullptr;
+	uint32 count = 0u;
+	{
+		std::scoped_lock lock(TlsfMutex);
+		for (; count < batchCount; ++count)
+		{
+			auto* tag = static_cast<SBlockTag*>(Tlsf->Malloc(blockSize));
+			if (!tag)
+			{
+				break;
+			}
+
+			tag->CacheIndex = Cache->Index;
+			tag->SizeClass = SizeClass;
+
+			auto* node = reinterpret_cast<SFreeNode*>(tag + 1);
+			node->Next = head;
+			head = node;
+		}
+	}
+
+	if (!head)
+	{
+		return nullptr;
+	}
+
+	// Hand out the first block, keep the rest
+	Cache->Bins[SizeClass] = head->Next;
+	Cache->BinCounts[SizeClass] = count - 1u;
+	return head;
+}
+
+void CThreadCachedHeap::Flush (SThreadCache* Cache, uint32 SizeClass, uint32 CountToKeep)
+{
+	if (Cache->BinCounts[SizeClass] <= CountToKeep)
+	{
+		return;
+	}
+
+	std::scoped_lock lock(TlsfMutex);
+	while (Cache->BinCounts[SizeClass] > CountToKeep)
+	{
+		SFreeNode* node = Cache->Bins[SizeClass];
+		Cache->Bins[SizeClass] = node->Next;
+		--Cache->BinCounts[SizeClass];
+		Tlsf->Free(GetTag(node));
+	}
+}
+
+void CThreadCachedHeap::DrainRemoteFrees (SThreadCache* Cache)
+{
+	SFreeNode* node = Cache->RemoteFrees.exchange(nullptr, std::memory_order_acquire);
+	while (node)
+	{
+		SFreeNode* next = node->Next;
+		PushLocal(Cache, node, GetTag(node)->SizeClass);
+		node = next;
+	}
+}
+
+void CThreadCachedHeap::PushLocal (SThreadCache* Cache, SFreeNode* Node, uint32 SizeClass)
+{
+	Node->Next = Cache->Bins[SizeClass];
+	Cache->Bins[SizeClass] = Node;
+
+	const uint32 batchCount = GetBatchCount(SizeClass);
+	if (++Cache->BinCounts[SizeClass] > 2u * batchCount)
+	{
+		Flush(Cache, SizeClass, batchCount);
+	}
+}
+
+void CThreadCachedHeap::PushRemote (SThreadCache* Owner, SFreeNode* Node)
+{
+	Node->Next = Owner->RemoteFrees.load(std::memory_order_relaxed);
+	while (!Owner->RemoteFrees.compare_exchange_weak(
+		Node->Next, Node, std::memory_order_release, std::memory_order_relaxed))
+	{}
+}
+
+uint32 CThreadCachedHeap::GetBatchCount (uint32 SizeClass)
+{
+	// Roughly 8 Kb per refill, but never fewer than 4 blocks or more than 64
+	constexpr uint64 batchBytes = 8ull * 1024ull;
+	return (uint32)math::Clamp<uint64>(batchBytes / GetSizeClassSize(SizeClass), 4ull, 64ull);
+}
+
+CThreadCachedHeap::SBlockTag* CThreadCachedHeap::GetTag (const void* Memory)
+{
+	return const_cast<SBlockTag*>(static_cast<const SBlockTag*>(Memory) - 1);
+}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+#include "Core.h"
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+
+
+namespace frt::memory
+{
+struct TLSF;
+
+
+/**
+* Thread-caching front-end for a single TLSF instance. Key points:
+*	- Requests up to MaxCachedSize are rounded up to a size class and served from a per-thread bin without locking
+*	- Bins are refilled from, and flushed back to, the backing TLSF in batches, so the lock is taken once per batch
+*	- A block freed by a thread that didn't allocate it is pushed onto the owner's lock-free remote-free list;
+*	  the owner reclaims the whole list the next time the corresponding bin runs dry
+*	- Bigger requests go straight to TLSF under the lock
+*
+* Every allocation is prefixed with an 8-byte tag (owning cache and size class), so TLSF alignment is preserved.
+* Caches of exited threads are kept and adopted by new threads, together with whatever was freed to them remotely.
+*/
+class FRT_CORE_API CThreadCachedHeap
+{
+public:
+	static constexpr uint32 SizeClassCount = 20u;
+	static constexpr uint64 MaxCachedSize = 1024ull;
+	static constexpr uint32 MaxThreadCaches = 128u;
+	static constexpr uint32 DirectCacheIndex = ~0u;
+
+	struct SBlockTag
+	{
+		uint32 CacheIndex = DirectCacheIndex;
+		uint32 SizeClass = 0u;
+	};
+
+
+	struct SFreeNode
+	{
+		SFreeNode* Next = nullptr;
+	};
+
+
+	struct alignas(64) SThreadCache
+	{
+		SFreeNode* Bins[SizeClassCount] = {};
+		uint32 BinCounts[SizeClassCount] = {};
+		uint32 Index = 0u;
+		std::atomic<bool> bOwned = true;
+
+		// Multi-producer push, single consumer takes the whole list at once, so there is no ABA to worry about
+		alignas(64) std::atomic<SFreeNode*> RemoteFrees = nullptr;
+	};
+
+
+	FRT_DELETE_COPY_AND_MOVE_OPS(CThreadCachedHeap);
+
+	explicit CThreadCachedHeap (TLSF* InTlsf);
+	~CThreadCachedHeap ();
+
+	void* Allocate (uint64 Size);
+	void* ReAllocate (void* Memory, uint64 Size);
+	/** Cached blocks fit anything up to their size class, direct ones go to TLSF. */
+	bool ResizeInPlace (void* Memory, uint64 Size);
+	void Free (void* Memory);
+
+	/** Returns all blocks cached by the calling thread to TLSF. */
+	void FlushThisThread ();
+
+	/** Keeps other threads away from TLSF while the lock is held, e.g. to walk the heap. */
+	std::unique_lock<std::mutex> LockTlsf () { return std::unique_lock(TlsfMutex); }
+
+	/** Usable size of an allocation made by this heap. */
+	static uint64 GetAllocationSize (const void* Memory);
+
+	static uint32 GetSizeClass (uint64 Size);
+	static uint64 GetSizeClassSize (uint32 SizeClass);
+
+	// Thread-exit hook, not meant to be called directly
+	void ReleaseCache (SThreadCache* Cache);
+
+private:
+	SThreadCache* GetLocalCache (bool bCreate);
+	SThreadCache* AcquireCache ();
+
+	void* AllocateDirect (uint64 Size);
+	void* Refill (SThreadCache* Cache, uint32 SizeClass);
+	void Flush (SThreadCache* Cache, uint32 SizeClass, uint32 CountToKeep);
+	void DrainRemoteFrees (SThreadCache* Cache);
+	void PushLocal (SThreadCache* Cache, SFreeNode* Node, uint32 SizeClass);
+	void PushRemote (SThreadCache* Owner, SFreeNode* Node);
+
+	static uint32 GetBatchCount (uint32 SizeClass);
+	static SBlockTag* GetTag (const void* Memory);
+
+private:
+	TLSF* Tlsf = nullptr;
+	uint64 Serial = 0ull;
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+	std::mutex TlsfMutex;
+	SThreadCache* Caches[MaxThreadCaches] = {};
+	std::atomic<uint32> CacheCount = 0u;
+#pragma warning(pop)
+};
+}
@@ -0,0 +1,246 @@
+#include "TraceReplay.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "Asserts.h"
+#include "MemoryPool.h"
+#include "VirtualRegions.h"
+#include "Math/MathUtility.h"
+
+
+namespace frt::memory
+{
+SReplayResult ReplayTrace (const std::vector<STraceEvent>& Events, IReplayTarget& Target)
+{
+	using clock = std::chrono::steady_clock;
+
+	SReplayResult result;
+	result.OperationCount = Events.size();
+
+	// Ids are dense, so blocks are looked up by index instead of hashing on every event
+	uint32 addressCount = 0u;
+	for (const STraceEvent& event : Events)
+	{
+		addressCount = math::Max(addressCount, event.AddressId + 1u);
+	}
+
+	std::vector<void*> blocks(addressCount, nullptr);
+	std::vector<uint64> sizes(addressCount, 0ull);
+
+	// Peak is found up front, so fragmentation can be sampled at the right moment
+	uint64 liveBytes = 0ull;
+	uint64 peakIndex = 0ull;
+	for (uint64 i = 0ull; i < Events.size(); ++i)
+	{
+		const STraceEvent& event = Events[i];
+		switch (event.Op)
+		{
+		case ETraceOp::Allocate:
+			liveBytes += event.Size;
+			break;
+		case ETraceOp::ReAllocate:
+			liveBytes = liveBytes - sizes[event.AddressId] + event.Size;
+			break;
+		case ETraceOp::Free:
+			liveBytes -= sizes[event.AddressId];
+			break;
+		}
+		sizes[event.AddressId] = event.Op == ETraceOp::Free ? 0ull : event.Size;
+
+		if (liveBytes > result.PeakLiveBytes)
+		{
+			result.PeakLiveBytes = liveBytes;
+			peakIndex = i;
+		}
+	}
+	sizes.assign(addressCount, 0ull);
+
+	clock::duration elapsed {};
+	clock::time_point start = clock::now();
+
+	for (uint64 i = 0ull; i < Events.size(); ++i)
+	{
+		const STraceEvent& event = Events[i];
+		void*& block = blocks[event.AddressId];
+		uint64& size = sizes[event.AddressId];
+
+		switch (event.Op)
+		{
+		case ETraceOp::Allocate:
+			block = Target.Allocate(event.Size);
+			size = event.Size;
+			result.FailedCount += block ? 0ull : 1ull;
+			break;
+
+		case ETraceOp::ReAllocate:
+			if (void* memory = Target.ReAllocate(block, size, event.Size))
+			{
+				block = memory;
+				size = event.Size;
+			}
+			else
+			{
+				++result.FailedCount;
+			}
+			break;
+
+		case ETraceOp::Free:
+			Target.Free(block, size);
+			block = nullptr;
+			size = 0ull;
+			break;
+		}
+
+		if (i == peakIndex)
+		{
+			elapsed += clock::now() - start;
+			result.FragmentationAtPeak = Target.GetFragmentation();
+			start = clock::now();
+		}
+	}
+
+	elapsed += clock::now() - start;
+	result.NanosecondsPerOperation = Events.empty()
+		? 0.0
+		: (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / (double)Events.size();
+
+	// Memory is only ever added to the targets, so the footprint at the end is the peak one
+	result.PeakFootprint = Target.GetFootprint();
+
+	for (uint32 id = 0u; id < addressCount; ++id)
+	{
+		if (blocks[id])
+		{
+			Target.Free(blocks[id], sizes[id]);
+		}
+	}
+
+	return result;
+}
+
+
+CTlsfReplayTarget::CTlsfReplayTarget (uint64 InCapacity)
+{
+	ReservedSize = TLSF::AlignUp(math::Max<uint64>(InCapacity, CVirtualRegions::CommitStep), CVirtualRegions::CommitStep);
+	Memory = static_cast<uint8*>(CVirtualRegions::Reserve(ReservedSize, false));
+	frt_assert(Memory);
+
+	CommittedSize = TLSF::AlignUp(TLSF::GetSize() + TLSF::GetPoolOverhead() + TLSF::BlockMinSize, CommitStep);
+	CVirtualRegions::Commit(Memory, CommittedSize, false);
+
+	Tlsf = new(Memory) TLSF(CommittedSize);
+	Tlsf->SetPoolProvider(this);
+	Pool = Memory + TLSF::GetSize();
+}
+
+CTlsfReplayTarget::~CTlsfReplayTarget ()
+{
+	Tlsf->~TLSF();
+	CVirtualRegions::Release(Memory, ReservedSize);
+}
+
+void* CTlsfReplayTarget::Allocate (uint64 Size)
+{
+	return Tlsf->Malloc(Size);
+}
+
+void* CTlsfReplayTarget::ReAllocate (void* InMemory, uint64 OldSize, uint64 NewSize)
+{
+	return Tlsf->Realloc(InMemory, NewSize);
+}
+
+void CTlsfReplayTarget::Free (void* InMemory, uint64 Size)
+{
+	Tlsf->Free(InMemory);
+}
+
+float CTlsfReplayTarget::GetFragmentation () const
+{
+	SHeapReport report;
+	TLSF::ReportPool(Pool, report);
+	return report.GetFragmentation();
+}
+
+bool CTlsfReplayTarget::Grow (TLSF& InTlsf, uint64 Size)
+{
+	// Same headroom as CVirtualRegions::Grow
+	const uint64 needed = Size + Size / 16ull + TLSF::GetPoolOverhead() + sizeof(TLSF::SBlockHeader);
+	const uint64 commitSize = TLSF::AlignUp(needed, CommitStep);
+	if (ReservedSize - CommittedSize < commitSize || !CVirtualRegions::Commit(Memory + CommittedSize, commitSize, false))
+	{
+		return false;
+	}
+
+	const uint64 poolOffset = Pool - Memory;
+	InTlsf.ExtendPool(Pool, CommittedSize - poolOffset, CommittedSize + commitSize - poolOffset);
+	CommittedSize += commitSize;
+	return true;
+}
+
+
+void* CMallocReplayTarget::Allocate (uint64 Size)
+{
+	return std::malloc(Size);
+}
+
+void* CMallocReplayTarget::ReAllocate (void* Memory, uint64 OldSize, uint64 NewSize)
+{
+	return std::realloc(Memory, NewSize);
+}
+
+void CMallocReplayTarget::Free (void* Memory, uint64 Size)
+{
+	std::free(Memory);
+}
+
+
+CAllocatorReplayTarget::CAllocatorReplayTarget (IAllocator& InAllocator, const char* InName)
+	: Allocator(InAllocator)
+	, Name(InName)
+{}
+
+void* CAllocatorReplayTarget::Allocate (uint64 Size)
+{
+	return Allocator.Allocate(Size);
+}
+
+void* CAllocatorReplayTarget::ReAllocate (void* Memory, uint64 OldSize, uint64 NewSize)
+{
+	void* newMemory = Allocator.Allocate(NewSize);
+	if (newMemory && Memory)
+	{
+		std::memcpy(newMemory, Memory, math::Min(OldSize, NewSize));
+		Allocator.Free(Memory);
+	}
+	return newMemory;
+}
+
+void CAllocatorReplayTarget::Free (void* Memory, uint64 Size)
+{
+	Allocator.Free(Memory);
+}
+
+
+CMemoryPoolReplayTarget::CMemoryPoolReplayTarget (CMemoryPool& InPool, const char* InName)
+	: CAllocatorReplayTarget(InPool, InName)
+	, Pool(InPool)
+{}
+
+void* CMemoryPoolReplayTarget::ReAllocate (void* Memory, uint64 OldSize, uint64 NewSize)
+{
+	return Pool.ReAllocate(Memory, NewSize);
+}
+
+uint64 CMemoryPoolReplayTarget::GetFootprint () const
+{
+	return Pool.GetCommittedSize();
+}
+
+float CMemoryPoolReplayTarget::GetFragmentation () const
+{
+	return Pool.GetHeapReport().GetFragmentation();
+}
+}
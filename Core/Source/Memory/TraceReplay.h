@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+
+#include "AllocationTrace.h"
+#include "Allocator.h"
+#include "Core.h"
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+#include "TLSF.h"
+
+
+namespace frt::memory
+{
+class CMemoryPool;
+
+
+/** Allocator a trace is replayed against, see ReplayTrace */
+class FRT_CORE_API IReplayTarget
+{
+public:
+	virtual ~IReplayTarget () = default;
+
+	virtual const char* GetName () const = 0;
+
+	virtual void* Allocate (uint64 Size) = 0;
+	virtual void* ReAllocate (void* Memory, uint64 OldSize, uint64 NewSize) = 0;
+	virtual void Free (void* Memory, uint64 Size) = 0;
+
+	/** Bytes taken from the system, 0 if the target can't tell. */
+	virtual uint64 GetFootprint () const { return 0ull; }
+	/** See SHeapReport::GetFragmentation, negative if the target can't tell. */
+	virtual float GetFragmentation () const { return -1.f; }
+};
+
+
+struct SReplayResult
+{
+	uint64 OperationCount = 0ull;
+	uint64 FailedCount = 0ull;
+	double NanosecondsPerOperation = 0.0;
+	uint64 PeakLiveBytes = 0ull; // Sum of requested sizes, same for every target
+	uint64 PeakFootprint = 0ull;
+	float FragmentationAtPeak = -1.f;
+};
+
+
+/**
+* Runs the trace against Target as fast as possible, on the calling thread and in recorded order.
+* Fragmentation is sampled right after the event with the highest live bytes, the sampling is not timed.
+* Whatever the trace left allocated is freed at the end.
+*/
+FRT_CORE_API SReplayResult ReplayTrace (const std::vector<STraceEvent>& Events, IReplayTarget& Target);
+
+
+/**
+* Bare TLSF over a reserved range that is committed in CommitStep pieces as TLSF runs out,
+* so the footprint is measured with a finer step than CMemoryPool's.
+*/
+class FRT_CORE_API CTlsfReplayTarget : public IReplayTarget, private IPoolProvider
+{
+public:
+	static constexpr uint64 CommitStep = 64ull * 1024ull;
+
+	FRT_DELETE_COPY_AND_MOVE_OPS(CTlsfReplayTarget);
+
+	explicit CTlsfReplayTarget (uint64 InCapacity);
+	virtual ~CTlsfReplayTarget () override;
+
+	virtual const char* GetName () const override { return "TLSF"; }
+
+	virtual void* Allocate (uint64 Size) override;
+	virtual void* ReAllocate (void* Memory, uint64 OldSize, uint64 NewSize) override;
+	virtual void Free (void* Memory, uint64 Size) override;
+
+	virtual uint64 GetFootprint () const override { return CommittedSize; }
+	virtual float GetFragmentation () const override;
+
+private:
+	virtual bool Grow (TLSF& InTlsf, uint64 Size) override;
+
+private:
+	uint8* Memory = nullptr;
+	uint8* Pool = nullptr;
+	uint64 ReservedSize = 0ull;
+	uint64 CommittedSize = 0ull;
+	TLSF* Tlsf = nullptr;
+};
+
+
+/** std::malloc, footprint and fragmentation are unknown */
+class FRT_CORE_API CMallocReplayTarget : public IReplayTarget
+{
+public:
+	virtual const char* GetName () const override { return "malloc"; }
+
+	virtual void* Allocate (uint64 Size) override;
+	virtual void* ReAllocate (void* Memory, uint64 OldSize, uint64 NewSize) override;
+	virtual void Free (void* Memory, uint64 Size) override;
+};
+
+
+/** Any IAllocator, reallocation is done as allocate, copy and free */
+class FRT_CORE_API CAllocatorReplayTarget : public IReplayTarget
+{
+public:
+	CAllocatorReplayTarget (IAllocator& InAllocator, const char* InName);
+
+	virtual const char* GetName () const override { return Name; }
+
+	virtual void* Allocate (uint64 Size) override;
+	virtual void* ReAllocate (void* Memory, uint64 OldSize, uint64 NewSize) override;
+	virtual void Free (void* Memory, uint64 Size) override;
+
+protected:
+	IAllocator& Allocator;
+	const char* Name = nullptr;
+};
+
+
+/** CMemoryPool with its own reallocation, footprint and heap report */
+class FRT_CORE_API CMemoryPoolReplayTarget : public CAllocatorReplayTarget
+{
+public:
+	CMemoryPoolReplayTarget (CMemoryPool& InPool, const char* InName);
+
+	virtual void* ReAllocate (void* Memory, uint64 OldSize, uint64 NewSize) override;
+
+	virtual uint64 GetFootprint () const override;
+	virtual float GetFragmentation () const override;
+
+private:
+	CMemoryPool& Pool;
+};
+}
@@ -0,0 +1,163 @@
+#include "VirtualRegions.h"
+
+#include "Asserts.h"
+#include "Math/MathUtility.h"
+
+#if _WINDOWS
+#include <windows.h>
+#include <memoryapi.h>
+#elif _UNIX
+#include <sys/mman.h>
+#endif
+
+
+namespace frt::memory
+{
+CVirtualRegions::CVirtualRegions (const SRegion& InFirstRegion, uint64 InReserveSize, bool bInHugePages)
+	: RegionCount(1u)
+	, ReserveSize(InReserveSize)
+	, bHugePages(bInHugePages)
+{
+	Regions[0] = InFirstRegion;
+}
+
+bool CVirtualRegions::Grow (TLSF& Tlsf, uint64 Size)
+{
+	// Leave room for the size class round-up done by TLSF search and for the pool's own headers
+	const uint64 needed = Size + Size / 16ull + TLSF::GetPoolOverhead() + sizeof(TLSF::SBlockHeader);
+	const uint64 commitSize = TLSF::AlignUp(needed, CommitStep);
+
+	SRegion& last = Regions[RegionCount - 1u];
+	if (last.ReservedSize - last.CommittedSize >= commitSize)
+	{
+		if (!Commit(last.Base + last.CommittedSize, commitSize, bHugePages))
+		{
+			return false;
+		}
+
+		const uint64 poolOffset = last.Pool - last.Base;
+		Tlsf.ExtendPool(last.Pool, last.CommittedSize - poolOffset, last.CommittedSize + commitSize - poolOffset);
+		last.CommittedSize += commitSize;
+		return true;
+	}
+
+	if (RegionCount == MaxRegions)
+	{
+		return false;
+	}
+
+	const uint64 reserveSize = math::Max(ReserveSize, commitSize);
+	auto* base = static_cast<uint8*>(Reserve(reserveSize, bHugePages));
+	if (!base)
+	{
+		return false;
+	}
+
+	if (!Commit(base, commitSize, bHugePages) || !Tlsf.AddPool(base, commitSize))
+	{
+		Release(base, reserveSize);
+		return false;
+	}
+
+	SRegion& region = Regions[RegionCount++];
+	region.Base = base;
+	region.Pool = base;
+	region.ReservedSize = reserveSize;
+	region.CommittedSize = commitSize;
+	return true;
+}
+
+void CVirtualRegions::ReleaseRegions ()
+{
+	for (uint32 i = RegionCount - 1u; i > 0u; --i)
+	{
+		Release(Regions[i].Base, Regions[i].ReservedSize);
+	}
+
+	// The first region holds this object, so nothing is touched after it's gone
+	const SRegion first = Regions[0];
+	this->~CVirtualRegions();
+	Release(first.Base, first.ReservedSize);
+}
+
+uint64 CVirtualRegions::GetReservedSize () const
+{
+	uint64 size = 0ull;
+	for (uint32 i = 0u; i < RegionCount; ++i)
+	{
+		size += Regions[i].ReservedSize;
+	}
+	return size;
+}
+
+uint64 CVirtualRegions::GetCommittedSize () const
+{
+	uint64 size = 0ull;
+	for (uint32 i = 0u; i < RegionCount; ++i)
+	{
+		size += Regions[i].CommittedSize;
+	}
+	return size;
+}
+
+void* CVirtualRegions::Reserve (uint64 Size, bool bHugePages)
+{
+	frt_assert(Size % CommitStep == 0ull);
+
+#if _WINDOWS
+	// Large pages can't be committed on demand on Windows, so the flag is ignored here
+	return VirtualAlloc(nullptr, Size, MEM_RESERVE, PAGE_NOACCESS);
+#elif _UNIX
+	constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+	if (!bHugePages)
+	{
+		void* memory = mmap(nullptr, Size, PROT_NONE, flags, -1, 0);
+		return memory != MAP_FAILED ? memory : nullptr;
+	}
+
+	// Transparent huge pages need 2Mb aligned ranges, so reserve a bit more and trim both ends
+	void* memory = mmap(nullptr, Size + CommitStep, PROT_NONE, flags, -1, 0);
+	if (memory == MAP_FAILED)
+	{
+		return nullptr;
+	}
+
+	auto* start = static_cast<uint8*>(memory);
+	auto* aligned = static_cast<uint8*>(TLSF::AlignPtr(start, CommitStep));
+	const uint64 head = aligned - start;
+	if (head)
+	{
+		munmap(start, head);
+	}
+	munmap(aligned + Size, CommitStep - head);
+	return aligned;
+#endif
+}
+
+bool CVirtualRegions::Commit (void* Memory, uint64 Size, bool bHugePages)
+{
+#if _WINDOWS
+	return VirtualAlloc(Memory, Size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#elif _UNIX
+	// Pages still come from the kernel lazily on first touch, so committing doesn't grow RSS by itself
+	if (mprotect(Memory, Size, PROT_READ | PROT_WRITE) != 0)
+	{
+		return false;
+	}
+	if (bHugePages)
+	{
+		madvise(Memory, Size, MADV_HUGEPAGE);
+	}
+	return true;
+#endif
+}
+
+void CVirtualRegions::Release (void* Memory, uint64 Size)
+{
+#if _WINDOWS
+	VirtualFree(Memory, 0, MEM_RELEASE);
+#elif _UNIX
+	munmap(Memory, Size);
+#endif
+}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Core.h"
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+#include "TLSF.h"
+
+
+namespace frt::memory
+{
+/**
+* Reserve-then-commit backing of a growable CMemoryPool. Key points:
+*	- Each region reserves address space up front, but commits it in CommitStep chunks only once TLSF runs out
+*	- Chunks committed later are appended to the region's TLSF pool, so big blocks can still span several of them
+*	- When a reservation is used up, a new region is reserved and chained in as another TLSF pool
+*	- With huge pages, regions are aligned to CommitStep and advised for transparent huge pages (Linux only)
+*
+* The object itself is allocated from the first region, hence ReleaseRegions instead of a destructor doing the job.
+*/
+class FRT_CORE_API CVirtualRegions : public IPoolProvider
+{
+public:
+	static constexpr uint32 MaxRegions = 32u;
+	static constexpr uint64 CommitStep = 2ull * 1024ull * 1024ull; // Same as x64 huge page
+
+	struct SRegion
+	{
+		uint8* Base = nullptr;
+		uint8* Pool = nullptr; // Where TLSF pool of this region starts
+		uint64 ReservedSize = 0ull;
+		uint64 CommittedSize = 0ull;
+	};
+
+
+	FRT_DELETE_COPY_AND_MOVE_OPS(CVirtualRegions);
+
+	CVirtualRegions (const SRegion& InFirstRegion, uint64 InReserveSize, bool bInHugePages);
+	virtual ~CVirtualRegions () override = default;
+
+	virtual bool Grow (TLSF& Tlsf, uint64 Size) override;
+
+	/** Gives all regions back to the OS, including the one this object lives in. */
+	void ReleaseRegions ();
+
+	uint32 GetRegionCount () const { return RegionCount; }
+	const SRegion& GetRegion (uint32 Index) const { return Regions[Index]; }
+	uint64 GetReservedSize () const;
+	uint64 GetCommittedSize () const;
+
+	static void* Reserve (uint64 Size, bool bHugePages);
+	static bool Commit (void* Memory, uint64 Size, bool bHugePages);
+	static void Release (void* Memory, uint64 Size);
+
+private:
+	SRegion Regions[MaxRegions];
+	uint32 RegionCount = 0u;
+	uint64 ReserveSize = 0ull;
+	bool bHugePages = false;
+};
+}
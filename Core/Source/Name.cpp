@@ -0,0 +1,216 @@
+#include "Name.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+
+#include "Asserts.h"
+#include "Containers/HashMap.h"
+#include "Math/MathUtility.h"
+
+
+namespace frt
+{
+namespace
+{
+	// Names are made during static initialization and outlive every memory pool, so the table takes the system heap
+	struct SNameTableAllocator
+	{
+		void* ReAllocate (void* Memory, uint64 Size) { return std::realloc(Memory, Size); }
+		void Free (void* Memory) { std::free(Memory); }
+	};
+
+
+	struct SNameEntry
+	{
+		const char* Text = "";
+		uint32 Length = 0u;
+		uint32 LowercaseId = 0u;
+	};
+
+
+	constexpr char ToLowerAscii (char Char)
+	{
+		return (Char >= 'A' && Char <= 'Z') ? (char)(Char - 'A' + 'a') : Char;
+	}
+
+
+	/**
+	* Entries live in fixed-size chunks that never move, so an entry can be read by id without the lock.
+	* Text is copied into big blocks that are never freed either.
+	*/
+	class CNameTable
+	{
+	public:
+		static constexpr uint32 EntriesPerChunkLog2 = 12u;
+		static constexpr uint32 EntriesPerChunk = 1u << EntriesPerChunkLog2;
+		static constexpr uint32 MaxChunks = 1024u;
+		static constexpr uint64 TextBlockSize = 64ull * 1024ull;
+
+		// Never destroyed, names in other statics may be read during shutdown
+		static CNameTable& Get ()
+		{
+			static CNameTable* table = new(std::malloc(sizeof(CNameTable))) CNameTable();
+			return *table;
+		}
+
+		CNameTable ()
+		{
+			// Id 0 is None, the empty string
+			AddLocked(std::string_view(), 0u);
+		}
+
+		uint32 Find (std::string_view Text) const
+		{
+			if (Text.empty())
+			{
+				return 0u;
+			}
+
+			std::shared_lock lock(Mutex);
+			const uint32* id = Ids.Find(Text);
+			return id ? *id : 0u;
+		}
+
+		uint32 FindOrAdd (std::string_view Text)
+		{
+			if (Text.empty())
+			{
+				return 0u;
+			}
+
+			{
+				std::shared_lock lock(Mutex);
+				if (const uint32* id = Ids.Find(Text))
+				{
+					return *id;
+				}
+			}
+
+			// Lowercase spelling is interned first, so it can be linked to without a second pass
+			char stackBuffer[256];
+			char* lowercase = Text.size() <= sizeof(stackBuffer) ? stackBuffer : (char*)std::malloc(Text.size());
+			bool bHasUppercase = false;
+			for (uint64 i = 0u; i < Text.size(); ++i)
+			{
+				lowercase[i] = ToLowerAscii(Text[i]);
+				bHasUppercase |= lowercase[i] != Text[i];
+			}
+
+			std::unique_lock lock(Mutex);
+			uint32 lowercaseId = 0u;
+			if (bHasUppercase)
+			{
+				const std::string_view lowercaseText(lowercase, Text.size());
+				const uint32* existing = Ids.Find(lowercaseText);
+				lowercaseId = existing ? *existing : AddLocked(lowercaseText, 0u);
+			}
+			if (lowercase != stackBuffer)
+			{
+				std::free(lowercase);
+			}
+
+			// Another thread could have added it between the locks
+			if (const uint32* id = Ids.Find(Text))
+			{
+				return *id;
+			}
+			return AddLocked(Text, lowercaseId);
+		}
+
+		const SNameEntry& GetEntry (uint32 Id) const
+		{
+			const SNameEntry* chunk = Chunks[Id >> EntriesPerChunkLog2].load(std::memory_order_acquire);
+			frt_assert(chunk);
+			return chunk[Id & (EntriesPerChunk - 1u)];
+		}
+
+	private:
+		/** 0 for InLowercaseId means the text is lowercase itself */
+		uint32 AddLocked (std::string_view Text, uint32 InLowercaseId)
+		{
+			const uint32 id = Count;
+			const uint32 chunkIndex = id >> EntriesPerChunkLog2;
+			frt_assert(chunkIndex < MaxChunks);
+
+			SNameEntry* chunk = Chunks[chunkIndex].load(std::memory_order_relaxed);
+			if (!chunk)
+			{
+				chunk = (SNameEntry*)std::malloc(sizeof(SNameEntry) * EntriesPerChunk);
+				Chunks[chunkIndex].store(chunk, std::memory_order_release);
+			}
+
+			SNameEntry& entry = chunk[id & (EntriesPerChunk - 1u)];
+			entry.Text = StoreText(Text);
+			entry.Length = (uint32)Text.size();
+			entry.LowercaseId = InLowercaseId != 0u ? InLowercaseId : id;
+			++Count;
+
+			if (id != 0u)
+			{
+				Ids.Add(std::string_view(entry.Text, entry.Length), id);
+			}
+			return id;
+		}
+
+		const char* StoreText (std::string_view Text)
+		{
+			const uint64 size = Text.size() + 1u;
+			if (TextBlockUsed + size > TextBlockCapacity)
+			{
+				TextBlockCapacity = math::Max(TextBlockSize, size);
+				TextBlock = (char*)std::malloc(TextBlockCapacity);
+				TextBlockUsed = 0u;
+			}
+
+			char* text = TextBlock + TextBlockUsed;
+			if (!Text.empty())
+			{
+				std::memcpy(text, Text.data(), Text.size());
+			}
+			text[Text.size()] = '\0';
+			TextBlockUsed += size;
+			return text;
+		}
+
+	private:
+		mutable std::shared_mutex Mutex;
+		THashMap<std::string_view, uint32, SNameTableAllocator> Ids;
+		std::atomic<SNameEntry*> Chunks[MaxChunks] = {};
+		uint32 Count = 0u;
+
+		char* TextBlock = nullptr;
+		uint64 TextBlockUsed = 0u;
+		uint64 TextBlockCapacity = 0u;
+	};
+}
+
+
+SName::SName (std::string_view InText)
+	: Id(CNameTable::Get().FindOrAdd(InText))
+{}
+
+SName SName::Find (std::string_view InText)
+{
+	return SName(CNameTable::Get().Find(InText));
+}
+
+std::string_view SName::ToString () const
+{
+	const SNameEntry& entry = CNameTable::Get().GetEntry(Id);
+	return std::string_view(entry.Text, entry.Length);
+}
+
+const char* SName::GetDebugString () const
+{
+	return CNameTable::Get().GetEntry(Id).Text;
+}
+
+SName SName::GetLowercase () const
+{
+	return SName(CNameTable::Get().GetEntry(Id).LowercaseId);
+}
+}
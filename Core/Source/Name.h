@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "Core.h"
+#include "CoreTypes.h"
+#include "Containers/Hash.h"
+
+
+namespace frt
+{
+/**
+* Interned string, a 32-bit id into the global name table. For names that are compared and looked up all the time,
+* e.g. input actions, shaders, pipeline and material keys. Key points:
+*	- Equality and hashing only look at the id, the text is not touched
+*	- Each distinct spelling is stored once and never freed, so ToString/GetDebugString stay valid for the whole run
+*	- Case-insensitive comparison is O(1) as well: every entry knows the id of its lowercase spelling
+*	- Constructing from text goes through the table (hash + shared lock), so names used every frame should be made once
+*	- The table is thread-safe; adding takes an exclusive lock, reading the text of an existing name takes none
+*	- Default-constructed name is None, which is also what the empty string interns to
+*	- Ids are only stable within a run, never store them in files
+*/
+struct FRT_CORE_API SName
+{
+	SName () = default;
+	explicit SName (std::string_view InText);
+
+	/** Name of InText if it was interned before, None otherwise; never adds to the table. */
+	static SName Find (std::string_view InText);
+
+	uint32 GetId () const { return Id; }
+	bool IsNone () const { return Id == 0u; }
+
+	std::string_view ToString () const;
+	/** Null-terminated text, for logs and the debugger. */
+	const char* GetDebugString () const;
+
+	/** Name of the ASCII-lowercase spelling; the name itself if it's lowercase already. */
+	SName GetLowercase () const;
+	bool EqualsIgnoreCase (SName Other) const { return GetLowercase() == Other.GetLowercase(); }
+
+	bool operator== (const SName&) const = default;
+
+private:
+	explicit SName (uint32 InId) : Id(InId) {}
+
+	uint32 Id = 0u;
+};
+
+
+template <>
+struct THash<SName>
+{
+	uint64 operator() (SName Value) const noexcept { return MixHash(Value.GetId()); }
+};
+
+
+/** Hasher and comparer for tables keyed by SName that should not tell "Foo" from "FOO" */
+struct SNameHashIgnoreCase
+{
+	uint64 operator() (SName Value) const noexcept { return MixHash(Value.GetLowercase().GetId()); }
+};
+
+
+struct SNameEqualIgnoreCase
+{
+	bool operator() (SName A, SName B) const noexcept { return A.EqualsIgnoreCase(B); }
+};
+}
@@ -1,16 +1,20 @@
 ﻿#include "Sys_MeshRenderer.h"
 
 #include <cstring>
-#include <unordered_map>
 
 #include "Exception.h"
 #include "GameInstance.h"
+#include "Sys_TransformHierarchy.h"
 #include "Timer.h"
 #include "Window.h"
+#include "Containers/FlatMap.h"
+#include "Containers/HashMap.h"
+#include "Containers/RadixSort.h"
 #include "Graphics/Camera.h"
 #include "Graphics/DXRUtils.h"
 #include "Graphics/Render/GraphicsCoreTypes.h"
 #include "Graphics/Render/Renderer.h"
+#include "Memory/FrameArena.h"
 
 using namespace frt;
 
@@ -75,14 +79,21 @@ void Sys_MeshRenderer::Present (float DeltaSeconds, ID3D12GraphicsCommandList4*
 	auto& currentFrameResources = Renderer->GetCurrentFrameResource();
 
 	// TODO: assign stable material indices in MaterialLibrary and update constants only when dirty.
-	std::unordered_map<const graphics::SMaterial*, uint32> materialIndices;
-	TArray<graphics::SMaterialConstants> materialConstants;
-	TArray<graphics::CRenderer::SRaytracingMaterialTextureSet> rtMaterialTextureSets;
-	TArray<graphics::CRenderer::SRaytracingHitGroupEntry> rtHitGroupEntries;
+	THashMap<const graphics::SMaterial*, uint32, memory::CFrameArena> materialIndices;
+	TArray<graphics::SMaterialConstants, memory::CFrameArena> materialConstants;
+	TArray<graphics::CRenderer::SRaytracingMaterialTextureSet, memory::CFrameArena> rtMaterialTextureSets;
+	TArray<graphics::CRenderer::SRaytracingHitGroupEntry, memory::CFrameArena> rtHitGroupEntries;
 
-	for (auto RenderModel : RenderModels)
+	CWorldScene& scene = GameInstance::GetInstance().GetWorldScene();
+	scene.ForEachRenderable([&] (
+		uint32, EntityHandle, const Comp_WorldTransform&, graphics::Comp_RenderModel& RenderModel)
 	{
-		graphics::SRenderModel& model = *RenderModel->Model;
+		if (!RenderModel.Model)
+		{
+			return;
+		}
+
+		graphics::SRenderModel& model = *RenderModel.Model;
 		for (const graphics::SRenderSection& section : model.Sections)
 		{
 			if (section.MaterialIndex >= model.Materials.Count())
@@ -93,11 +104,11 @@ void Sys_MeshRenderer::Present (float DeltaSeconds, ID3D12GraphicsCommandList4*
 			graphics::SMaterial* material = model.Materials[section.MaterialIndex].GetRawIgnoringLifetime();
 			frt_assert(material);
 
-			auto it = materialIndices.find(material);
-			if (it == materialIndices.end())
+			const uint32* knownIndex = materialIndices.Find(material);
+			if (!knownIndex)
 			{
 				const uint32 materialIndex = materialConstants.Count();
-				materialIndices.emplace(material, materialIndex);
+				materialIndices.Add(material, materialIndex);
 
 				graphics::SMaterialConstants& constants = materialConstants.Add();
 				constants.DiffuseAlbedo = material->DiffuseAlbedo;
@@ -126,10 +137,10 @@ void Sys_MeshRenderer::Present (float DeltaSeconds, ID3D12GraphicsCommandList4*
 			}
 			else
 			{
-				material->RuntimeIndex = it->second;
+				material->RuntimeIndex = *knownIndex;
 			}
 		}
-	}
+	});
 
 	Renderer->EnsureMaterialConstantCapacity(materialConstants.Count());
 	Renderer->SetRaytracingMaterialTextureSets(rtMaterialTextureSets);
@@ -139,9 +150,8 @@ void Sys_MeshRenderer::Present (float DeltaSeconds, ID3D12GraphicsCommandList4*
 		rtHitGroupEntries.Reset(AsEntities.Count());
 		for (uint32 i = 0; i < AsEntities.Count(); ++i)
 		{
-			const CEntity* entity = AsEntities[i];
 			const graphics::SRenderModel* model = AsModels[i];
-			frt_assert(entity && model && model->VertexBufferGpu && model->IndexBufferGpu);
+			frt_assert(model && model->VertexBufferGpu && model->IndexBufferGpu);
 
 			uint32 materialIndex = 0u;
 			if (!model->Sections.IsEmpty())
@@ -191,47 +201,114 @@ void Sys_MeshRenderer::Present (float DeltaSeconds, ID3D12GraphicsCommandList4*
 
 	memory::TRefWeak<graphics::CRenderer> renderer = GameInstance::GetInstance().GetRenderer();
 
-	auto& ObjectDescriptorHandles = currentFrameResources.ObjectCB.DescriptorHeapHandleGpu;
-	for (uint32 i = 0; i < RenderModels.Count(); ++i)
+	// Sections are drawn sorted by pipeline, then material, then distance to the camera (front to back),
+	// so state is only set where it changes and near geometry fills the depth buffer first.
+	// Sections without a material keep the key maximum and draw last with whatever state is bound.
+	using SDrawKey = TSortKey<uint64, 12, 20, 32>;
+	struct SDrawPacket
 	{
-		const graphics::SRenderModel& model = *RenderModels[i]->Model;
-		if (!model.VertexBufferGpu || !model.IndexBufferGpu)
+		const graphics::SRenderModel* Model;
+		uint32 ObjectIndex;
+		uint32 SectionIndex;
+	};
+
+	const Vector3f cameraPosition = GameInstance::GetInstance().GetCamera()->Transform.GetTranslation();
+
+	TFlatMap<ID3D12PipelineState*, uint32, memory::CFrameArena> pipelineIds;
+	TArray<uint64, memory::CFrameArena> drawKeys;
+	TArray<SDrawPacket, memory::CFrameArena> drawPackets;
+	scene.ForEachRenderable([&] (
+		uint32 ObjectIndex, EntityHandle, const Comp_WorldTransform& WorldTransform,
+		graphics::Comp_RenderModel& RenderModel)
+	{
+		if (!RenderModel.Model)
 		{
-			continue;
+			return;
 		}
 
-		if (i < ObjectDescriptorHandles.size())
+		const graphics::SRenderModel& model = *RenderModel.Model;
+		if (!model.VertexBufferGpu || !model.IndexBufferGpu)
 		{
-			CommandList->SetGraphicsRootDescriptorTable(
-				render::constants::RootParam_ObjectCbv,
-				ObjectDescriptorHandles[i]);
+			return;
 		}
 
+		// Translation row of the world matrix is in engine space, the flip only touches the basis
+		const Vector3f position(WorldTransform.Matrix._41, WorldTransform.Matrix._42, WorldTransform.Matrix._43);
+		const float distanceSquared = Vector3f::DistSquared(position, cameraPosition);
+		const uint32 depthKey = sort::FloatToKey(distanceSquared);
+
+		for (uint32 sectionIndex = 0; sectionIndex < model.Sections.Count(); ++sectionIndex)
 		{
-			D3D12_INDEX_BUFFER_VIEW indexBufferView = {};
-			indexBufferView.BufferLocation = model.IndexBufferGpu->GetGPUVirtualAddress();
-			indexBufferView.SizeInBytes = model.Indices.Count() * sizeof(uint32);
-			indexBufferView.Format = DXGI_FORMAT_R32_UINT;
-			CommandList->IASetIndexBuffer(&indexBufferView);
+			const graphics::SRenderSection& section = model.Sections[sectionIndex];
+
+			uint64 pipelineId = SDrawKey::FieldMask<0>;
+			uint64 materialId = SDrawKey::FieldMask<1>;
+			if (section.MaterialIndex < model.Materials.Count())
+			{
+				const graphics::SMaterial* material = model.Materials[section.MaterialIndex].GetRawIgnoringLifetime();
+				if (material)
+				{
+					ID3D12PipelineState* pipelineState = renderer->GetPipelineStateForMaterial(*material);
+					const uint32* knownId = pipelineIds.Find(pipelineState);
+					pipelineId = knownId ? *knownId : pipelineIds.Add(pipelineState, pipelineIds.Count());
+					materialId = material->RuntimeIndex;
+				}
+			}
+
+			drawKeys.Add(SDrawKey::Pack(pipelineId, materialId, depthKey));
+			drawPackets.Add({ &model, ObjectIndex, sectionIndex });
 		}
+	});
+
+	RadixSortPairs(drawKeys, drawPackets);
+
+	auto& ObjectDescriptorHandles = currentFrameResources.ObjectCB.DescriptorHeapHandleGpu;
+	const auto& materialHandles = currentFrameResources.MaterialCB.DescriptorHeapHandleGpu;
+	uint32 boundObjectIndex = ~0u;
+	const graphics::SMaterial* boundMaterial = nullptr;
+	ID3D12PipelineState* boundPipelineState = nullptr;
+	for (const SDrawPacket& packet : drawPackets)
+	{
+		const graphics::SRenderModel& model = *packet.Model;
+		if (packet.ObjectIndex != boundObjectIndex)
 		{
-			D3D12_VERTEX_BUFFER_VIEW vertexBufferViews[1] = {};
-			vertexBufferViews[0].BufferLocation = model.VertexBufferGpu->GetGPUVirtualAddress();
-			vertexBufferViews[0].SizeInBytes = model.Vertices.Count() * sizeof(graphics::SVertex);
-			vertexBufferViews[0].StrideInBytes = sizeof(graphics::SVertex);
-			CommandList->IASetVertexBuffers(0, 1, vertexBufferViews);
+			boundObjectIndex = packet.ObjectIndex;
+
+			if (packet.ObjectIndex < ObjectDescriptorHandles.size())
+			{
+				CommandList->SetGraphicsRootDescriptorTable(
+					render::constants::RootParam_ObjectCbv,
+					ObjectDescriptorHandles[packet.ObjectIndex]);
+			}
+
+			{
+				D3D12_INDEX_BUFFER_VIEW indexBufferView = {};
+				indexBufferView.BufferLocation = model.IndexBufferGpu->GetGPUVirtualAddress();
+				indexBufferView.SizeInBytes = model.Indices.Count() * sizeof(uint32);
+				indexBufferView.Format = DXGI_FORMAT_R32_UINT;
+				CommandList->IASetIndexBuffer(&indexBufferView);
+			}
+			{
+				D3D12_VERTEX_BUFFER_VIEW vertexBufferViews[1] = {};
+				vertexBufferViews[0].BufferLocation = model.VertexBufferGpu->GetGPUVirtualAddress();
+				vertexBufferViews[0].SizeInBytes = model.Vertices.Count() * sizeof(graphics::SVertex);
+				vertexBufferViews[0].StrideInBytes = sizeof(graphics::SVertex);
+				CommandList->IASetVertexBuffers(0, 1, vertexBufferViews);
+			}
 		}
 
-		for (uint32 sectionIndex = 0; sectionIndex < model.Sections.Count(); ++sectionIndex)
+		const graphics::SRenderSection& section = model.Sections[packet.SectionIndex];
+		if (section.MaterialIndex < model.Materials.Count())
 		{
-			const graphics::SRenderSection& section = model.Sections[sectionIndex];
-			if (section.MaterialIndex < model.Materials.Count())
+			const graphics::SMaterial* material = model.Materials[section.MaterialIndex].GetRawIgnoringLifetime();
+			if (!material || material != boundMaterial)
 			{
-				memory::TRefShared<graphics::SMaterial> material = model.Materials[section.MaterialIndex];
+				boundMaterial = material;
+
 				D3D12_GPU_DESCRIPTOR_HANDLE textureHandle = renderer->GetDefaultWhiteTextureGpu();
-				if (material && material->bHasBaseColorTexture)
+				if (material && material->bHasBaseColorTexture && material->BaseColorTexture.GpuDescriptor)
 				{
-					textureHandle = material->BaseColorTexture.GpuDescriptor;
+					textureHandle = *material->BaseColorTexture.GpuDescriptor;
 				}
 
 				CommandList->SetGraphicsRootDescriptorTable(
@@ -241,13 +318,12 @@ void Sys_MeshRenderer::Present (float DeltaSeconds, ID3D12GraphicsCommandList4*
 				if (material)
 				{
 					ID3D12PipelineState* pipelineState = renderer->GetPipelineStateForMaterial(*material);
-					if (pipelineState)
+					if (pipelineState && pipelineState != boundPipelineState)
 					{
 						CommandList->SetPipelineState(pipelineState);
+						boundPipelineState = pipelineState;
 					}
 
-					graphics::SFrameResources& frameResources = renderer->GetCurrentFrameResource();
-					const auto& materialHandles = frameResources.MaterialCB.DescriptorHeapHandleGpu;
 					if (material->RuntimeIndex < materialHandles.size())
 					{
 						CommandList->SetGraphicsRootDescriptorTable(
@@ -256,14 +332,14 @@ void Sys_MeshRenderer::Present (float DeltaSeconds, ID3D12GraphicsCommandList4*
 					}
 				}
 			}
-
-			CommandList->DrawIndexedInstanced(
-				section.IndexCount,
-				1,
-				section.IndexOffset,
-				section.VertexOffset,
-				0);
 		}
+
+		CommandList->DrawIndexedInstanced(
+			section.IndexCount,
+			1,
+			section.IndexOffset,
+			section.VertexOffset,
+			0);
 	}
 }
 
@@ -354,23 +430,6 @@ void Sys_MeshRenderer::UploadCB (ID3D12GraphicsCommandList4* CommandList)
 }
 #endif
 
-memory::TRefShared<graphics::Comp_RenderModel> Sys_MeshRenderer::SpawnRenderModel ()
-{
-	memory::TRefShared<graphics::Comp_RenderModel> renderModel = memory::NewShared<graphics::Comp_RenderModel>();
-	RenderModels.Add(renderModel);
-	return renderModel;
-}
-
-// memory::TRefShared<CEntity> Sys_MeshRenderer::SpawnEntity ()
-// {
-// 	auto newEntity = memory::NewShared<CEntity>();
-// 	Entities.Add(newEntity);
-// #ifndef FRT_HEADLESS
-// 	bAsTopologyDirty = true;
-// #endif
-// 	return newEntity;
-// }
-
 graphics::raytracing::SAccelerationStructureBuffers Sys_MeshRenderer::CreateBottomLevelAS (
 	const graphics::Comp_RenderModel& RenderModel)
 {
@@ -600,28 +659,30 @@ void Sys_MeshRenderer::CreateAccelerationStructures ()
 	}
 
 	CWorldScene& scene = GameInstance::GetInstance().GetWorldScene();
-	const auto& sceneEntities = scene.GetEntities();
 
 	struct SBuildEntry
 	{
-		const CEntity* Entity = nullptr;
+		EntityHandle Handle;
+		const graphics::Comp_RenderModel* RenderModel = nullptr;
 		const graphics::SRenderModel* Model = nullptr;
 		DirectX::XMFLOAT3X4 Transform = {};
+		DirectX::XMFLOAT4X4 Matrix = {};
 	};
 
-	std::unordered_map<graphics::SMaterial*, uint32> materialIndices;
+	THashMap<graphics::SMaterial*, uint32> materialIndices;
 	TArray<SBuildEntry> buildEntries;
-	buildEntries.SetCapacity(sceneEntities.Count());
+	buildEntries.SetCapacity(scene.GetRenderableCount());
 
-	for (uint32 i = 0; i < sceneEntities.Count(); ++i)
+	// Components stay where they are until the scene changes structurally, so the entries may point at them
+	scene.ForEachRenderable([&] (
+		uint32, EntityHandle Entity, const Comp_WorldTransform& WorldTransform, graphics::Comp_RenderModel& RenderModel)
 	{
-		const CEntity* entity = sceneEntities[i].GetRawIgnoringLifetime();
-		if (!entity || !entity->RenderModel->Model)
+		if (!RenderModel.Model)
 		{
-			continue;
+			return;
 		}
 
-		const graphics::SRenderModel& model = *entity->RenderModel->Model;
+		const graphics::SRenderModel& model = *RenderModel.Model;
 		for (const graphics::SRenderSection& section : model.Sections)
 		{
 			if (section.MaterialIndex >= model.Materials.Count())
@@ -636,25 +697,27 @@ void Sys_MeshRenderer::CreateAccelerationStructures ()
 				continue;
 			}
 
-			auto it = materialIndices.find(material);
-			if (it == materialIndices.end())
+			const uint32* knownIndex = materialIndices.Find(material);
+			if (!knownIndex)
 			{
-				const uint32 materialIndex = materialIndices.size();
-				materialIndices.emplace(material, materialIndex);
+				const uint32 materialIndex = materialIndices.Count();
+				materialIndices.Add(material, materialIndex);
 				material->RuntimeIndex = materialIndex;
 			}
 			else
 			{
-				material->RuntimeIndex = it->second;
+				material->RuntimeIndex = *knownIndex;
 			}
 		}
 
 		SBuildEntry entry = {};
-		entry.Entity = entity;
+		entry.Handle = Entity;
+		entry.RenderModel = &RenderModel;
 		entry.Model = &model;
-		entry.Transform = entity->Transform.GetRaytracingTransform();
+		entry.Transform = math::ToRaytracingTransform(WorldTransform.Matrix);
+		entry.Matrix = WorldTransform.Matrix;
 		buildEntries.Add(entry);
-	}
+	});
 
 	if (buildEntries.IsEmpty())
 	{
@@ -665,14 +728,15 @@ void Sys_MeshRenderer::CreateAccelerationStructures ()
 		AsModels.Clear();
 		AsTransforms.Clear();
 		Instances.Clear();
+		AsWorldFrame = scene.TransformHierarchy->GetFrameIndex();
 		bAsInitialized = true;
 		scene.bSceneTopologyDirty = false;
 		return;
 	}
 
-	if (!materialIndices.empty())
+	if (!materialIndices.IsEmpty())
 	{
-		Renderer->EnsureMaterialConstantCapacity(static_cast<uint32>(materialIndices.size()));
+		Renderer->EnsureMaterialConstantCapacity(materialIndices.Count());
 	}
 
 	TArray<graphics::raytracing::SAccelerationStructureBuffers> bottomLevelBuffers;
@@ -680,7 +744,7 @@ void Sys_MeshRenderer::CreateAccelerationStructures ()
 
 	for (const SBuildEntry& entry : buildEntries)
 	{
-		bottomLevelBuffers.Add(CreateBottomLevelAS(*entry.Entity->GetRenderModel()));
+		bottomLevelBuffers.Add(CreateBottomLevelAS(*entry.RenderModel));
 	}
 
 	Instances.Reset(buildEntries.Count());
@@ -692,9 +756,9 @@ void Sys_MeshRenderer::CreateAccelerationStructures ()
 	{
 		const SBuildEntry& entry = buildEntries[i];
 		Instances.Add({ bottomLevelBuffers[i].Result.Get(), entry.Transform, i, i * 2u });
-		AsEntities.Add(entry.Entity);
+		AsEntities.Add(entry.Handle);
 		AsModels.Add(entry.Model);
-		AsTransforms.Add(entry.Entity->Transform.GetMatrix());
+		AsTransforms.Add(entry.Matrix);
 	}
 
 	CreateTopLevelAS(Instances, false);
@@ -706,6 +770,7 @@ void Sys_MeshRenderer::CreateAccelerationStructures ()
 	}
 
 	Renderer->TopLevelASBuffers = TopLevelASBuffers;
+	AsWorldFrame = scene.TransformHierarchy->GetFrameIndex();
 	bAsInitialized = true;
 	scene.bSceneTopologyDirty = false;
 }
@@ -718,7 +783,6 @@ void Sys_MeshRenderer::UpdateAccelerationStructures ()
 	}
 
 	CWorldScene& scene = GameInstance::GetInstance().GetWorldScene();
-	const auto& sceneEntities = scene.GetEntities();
 
 	if (!bAsInitialized || scene.bSceneTopologyDirty)
 	{
@@ -746,27 +810,26 @@ void Sys_MeshRenderer::UpdateAccelerationStructures ()
 	bool bTopologyChanged = false;
 	bool bInstanceDataChanged = false;
 
-	for (uint32 i = 0; i < sceneEntities.Count(); ++i)
+	scene.ForEachRenderable([&] (
+		uint32, EntityHandle Entity, const Comp_WorldTransform& WorldTransform, graphics::Comp_RenderModel& RenderModel)
 	{
-		const CEntity* entity = sceneEntities[i].GetRawIgnoringLifetime();
-		if (!entity || !entity->RenderModel->Model)
+		if (bTopologyChanged || !RenderModel.Model)
 		{
-			continue;
+			return;
 		}
 
 		if (trackedIndex >= AsEntities.Count() ||
-			AsEntities[trackedIndex] != entity ||
-			AsModels[trackedIndex] != entity->RenderModel->Model.GetRawIgnoringLifetime())
+			AsEntities[trackedIndex] != Entity ||
+			AsModels[trackedIndex] != RenderModel.Model.GetRawIgnoringLifetime())
 		{
 			bTopologyChanged = true;
-			break;
+			return;
 		}
 
-		DirectX::XMFLOAT4X4 currentTransform = entity->GetTransform().GetMatrix();
-		if (!AreMatricesEqual(currentTransform, AsTransforms[trackedIndex]))
+		if (WorldTransform.ChangedFrame > AsWorldFrame)
 		{
-			AsTransforms[trackedIndex] = currentTransform;
-			Instances[trackedIndex].Transform = entity->GetTransform().GetRaytracingTransform();
+			AsTransforms[trackedIndex] = WorldTransform.Matrix;
+			Instances[trackedIndex].Transform = math::ToRaytracingTransform(WorldTransform.Matrix);
 			bInstanceDataChanged = true;
 		}
 
@@ -778,7 +841,7 @@ void Sys_MeshRenderer::UpdateAccelerationStructures ()
 		}
 
 		++trackedIndex;
-	}
+	});
 
 	if (!bTopologyChanged && trackedIndex != AsEntities.Count())
 	{
@@ -797,6 +860,8 @@ void Sys_MeshRenderer::UpdateAccelerationStructures ()
 		return;
 	}
 
+	AsWorldFrame = scene.TransformHierarchy->GetFrameIndex();
+
 	if (!bInstanceDataChanged || Instances.IsEmpty())
 	{
 		return;
@@ -22,6 +22,7 @@ public:
 
 	// System interface
 	virtual SFlags<EUpdatePhase>& GetPhases() override;
+	virtual const char* GetName () const override { return "MeshRenderer"; }
 
 	virtual void Update(const SUpdateContext& Context) override;
 	virtual void Finalize(const SUpdateContext& Context) override;
@@ -38,9 +39,6 @@ public:
 	void UploadCB (ID3D12GraphicsCommandList4* CommandList);
 #endif
 
-	// memory::TRefShared<CEntity> SpawnEntity ();
-	memory::TRefShared<graphics::Comp_RenderModel> SpawnRenderModel ();
-
 private:
 #ifndef FRT_HEADLESS
 	struct SAccelerationInstance;
@@ -53,8 +51,6 @@ public:
 #ifndef FRT_HEADLESS
 	memory::TRefWeak<graphics::CRenderer> Renderer;
 #endif
-	// TArray<memory::TRefShared<CEntity>> Entities;
-	TArray<memory::TRefShared<graphics::Comp_RenderModel>> RenderModels; // TODO: allocate on stack
 
 private:
 	struct SAccelerationInstance
@@ -71,9 +67,11 @@ private:
 	graphics::raytracing::SAccelerationStructureBuffers TopLevelASBuffers;
 	TArray<SAccelerationInstance> Instances;
 
-	TArray<const CEntity*> AsEntities;
+	TArray<EntityHandle> AsEntities;
 	TArray<const graphics::SRenderModel*> AsModels;
 	TArray<DirectX::XMFLOAT4X4> AsTransforms;
+	/** Transform hierarchy frame AsTransforms are up to date with */
+	uint64 AsWorldFrame = 0u;
 	SFlags<EUpdatePhase> Phases;
 
 	bool bAsInitialized = false;
@@ -0,0 +1,30 @@
+#include "Sys_Rotation.h"
+
+#include "Ecs/EntityRegistry.h"
+
+using namespace frt;
+
+
+Sys_Rotation::Sys_Rotation ()
+{
+	Phases.AddFlag(EUpdatePhase::Update);
+}
+
+SSystemAccess Sys_Rotation::GetAccess () const
+{
+	SSystemAccess access;
+	access
+		.Write<math::STransform>()
+		.Read<Comp_RotationSpeed>();
+	return access;
+}
+
+void Sys_Rotation::Update (const SUpdateContext& Context)
+{
+	const float deltaSeconds = Context.DeltaSeconds;
+	Context.Registry->ParallelForEach<math::STransform, const Comp_RotationSpeed>(
+		[deltaSeconds] (math::STransform& Transform, const Comp_RotationSpeed& RotationSpeed)
+		{
+			Transform.RotateBy(RotationSpeed.Speed * deltaSeconds);
+		});
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Entity.h"
+#include "System.h"
+
+
+namespace frt
+{
+/** Spins every entity that has Comp_RotationSpeed. Touches nothing but components, so it runs on workers. */
+class Sys_Rotation : public ISystem
+{
+public:
+	Sys_Rotation ();
+	virtual ~Sys_Rotation () override {}
+
+	// System interface
+	virtual SFlags<EUpdatePhase>& GetPhases () override { return Phases; }
+	virtual const char* GetName () const override { return "Rotation"; }
+	virtual SSystemAccess GetAccess () const override;
+
+	virtual void Update (const SUpdateContext& Context) override;
+	// ~System interface
+
+private:
+	SFlags<EUpdatePhase> Phases;
+};
+}
@@ -0,0 +1,151 @@
+#include "Sys_TransformHierarchy.h"
+
+#include "Containers/RadixSort.h"
+#include "Ecs/EntityRegistry.h"
+#include "Math/TransformBatch.h"
+
+using namespace frt;
+
+
+namespace
+{
+/** Dirty transforms of a chunk are gathered and composed this many at a time */
+constexpr uint32 ComposeBlockSize = 64u;
+}
+
+
+Sys_TransformHierarchy::Sys_TransformHierarchy ()
+{
+	Phases.AddFlag(EUpdatePhase::Finalize);
+}
+
+SSystemAccess Sys_TransformHierarchy::GetAccess () const
+{
+	// Transforms are written to clear their dirty flags
+	SSystemAccess access;
+	access
+		.Write<math::STransform, Comp_WorldTransform>()
+		.Read<Comp_Parent>();
+	return access;
+}
+
+void Sys_TransformHierarchy::Finalize (const SUpdateContext& Context)
+{
+	UpdateWorldTransforms(*Context.Registry);
+}
+
+void Sys_TransformHierarchy::UpdateWorldTransforms (ecs::CEntityRegistry& InRegistry)
+{
+	using namespace DirectX;
+
+	if (OrderVersion != InRegistry.GetStructureVersion())
+	{
+		RebuildOrder(InRegistry);
+	}
+
+	const uint64 frameIndex = ++FrameIndex;
+
+	// Local matrices of children are finished below
+	InRegistry.ParallelForEachChunk<math::STransform, Comp_WorldTransform>(
+		[frameIndex] (uint32, uint32 RowCount, const EntityHandle*,
+			math::STransform* Transforms, Comp_WorldTransform* WorldTransforms)
+		{
+			math::TTransformBlock<ComposeBlockSize> block;
+			uint32 rows[ComposeBlockSize];
+			XMFLOAT4X4 matrices[ComposeBlockSize];
+
+			const auto flush = [&] ()
+			{
+				math::ComposeMatrices(block.GetArrays(), matrices);
+				for (uint32 i = 0; i < block.Count; ++i)
+				{
+					WorldTransforms[rows[i]].Matrix = matrices[i];
+					WorldTransforms[rows[i]].ChangedFrame = frameIndex;
+				}
+				block.Clear();
+			};
+
+			for (uint32 row = 0; row < RowCount; ++row)
+			{
+				math::STransform& transform = Transforms[row];
+				if (!transform.IsDirty())
+				{
+					continue;
+				}
+
+				rows[block.Add(transform.GetTranslation(), transform.GetRotation(), transform.GetScale())] = row;
+				transform.ClearDirty();
+				if (block.IsFull())
+				{
+					flush();
+				}
+			}
+
+			if (!block.IsEmpty())
+			{
+				flush();
+			}
+		});
+
+	// Every matrix carries the LUF to DirectX flip, the one of the parent is undone in between
+	const XMMATRIX lufToDx = XMMatrixScaling(-1.f, 1.f, 1.f);
+
+	const bool bRecomposeAll = bOrderChanged;
+	bOrderChanged = false;
+
+	for (const SChildNode& child : Children)
+	{
+		const bool bLocalChanged = child.World->ChangedFrame == frameIndex;
+		if (!bRecomposeAll && !bLocalChanged && child.ParentWorld->ChangedFrame != frameIndex)
+		{
+			continue;
+		}
+
+		const XMFLOAT4X4 local = bLocalChanged ? child.World->Matrix : child.Local->ComputeMatrix();
+		const XMMATRIX parentWorld = XMMatrixMultiply(lufToDx, XMLoadFloat4x4(&child.ParentWorld->Matrix));
+		XMStoreFloat4x4(&child.World->Matrix, XMMatrixMultiply(XMLoadFloat4x4(&local), parentWorld));
+		child.World->ChangedFrame = frameIndex;
+	}
+}
+
+void Sys_TransformHierarchy::RebuildOrder (ecs::CEntityRegistry& InRegistry)
+{
+	Children.Clear();
+	TArray<uint32> depths;
+
+	InRegistry.ForEach<math::STransform, Comp_WorldTransform, const Comp_Parent>(
+		[&] (math::STransform& Transform, Comp_WorldTransform& WorldTransform, const Comp_Parent& Parent)
+		{
+			const Comp_WorldTransform* parentWorld = InRegistry.Find<Comp_WorldTransform>(Parent.Parent);
+			if (!parentWorld)
+			{
+				// Root from now on, its matrix has to lose the parent's part
+				Transform.MarkDirty();
+				return;
+			}
+
+			// Ancestors without a parent they can inherit from are roots too
+			uint32 depth = 1u;
+			EntityHandle ancestor = Parent.Parent;
+			while (depth < MaxDepth)
+			{
+				const Comp_Parent* ancestorParent = InRegistry.Find<Comp_Parent>(ancestor);
+				if (!ancestorParent || !InRegistry.Has<Comp_WorldTransform>(ancestorParent->Parent))
+				{
+					break;
+				}
+
+				ancestor = ancestorParent->Parent;
+				++depth;
+			}
+
+			depths.Add(depth);
+			Children.Add(SChildNode { &Transform, &WorldTransform, parentWorld });
+		});
+
+	// Stable, so siblings stay in query order
+	RadixSortPairs(depths, Children);
+
+	OrderVersion = InRegistry.GetStructureVersion();
+	bOrderChanged = true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+#include "Core.h"
+#include "CoreTypes.h"
+#include "System.h"
+#include "Containers/Array.h"
+#include "Ecs/Archetype.h"
+#include "Math/Transform.h"
+
+
+namespace frt
+{
+namespace ecs
+{
+class CEntityRegistry;
+}
+
+
+/** Makes the STransform of the entity relative to the world transform of the parent. See CWorldScene::SetParent. */
+struct Comp_Parent
+{
+	EntityHandle Parent;
+};
+
+
+/** World matrix of an entity, kept up to date by Sys_TransformHierarchy. */
+struct Comp_WorldTransform
+{
+	DirectX::XMFLOAT4X4 Matrix = {
+		1.f, 0.f, 0.f, 0.f,
+		0.f, 1.f, 0.f, 0.f,
+		0.f, 0.f, 1.f, 0.f,
+		0.f, 0.f, 0.f, 1.f };
+
+	/** Pass that last changed the matrix (see Sys_TransformHierarchy::GetFrameIndex); 0 if none did yet */
+	uint64 ChangedFrame = 0u;
+};
+
+
+/**
+* Keeps Comp_WorldTransform of every entity in line with its STransform and the ones of its parents.
+* Key points:
+*	- One pass per frame, in Finalize; only dirty transforms are recomposed, and every change reaches all
+*	  entities below it
+*	- Matrices of all dirty entities are recomposed chunk by chunk on the job system, gathered into blocks
+*	  for math::ComposeMatrices; that's already the world matrix for roots, the entities without Comp_Parent
+*	- Children are kept in a flat array sorted by depth (breadth first), so a single linear sweep sees every
+*	  parent before its children. It holds component pointers and is rebuilt only when the registry changes
+*	  structurally or InvalidateOrder is called
+*	- Entities whose parent is gone or has no world transform are treated as roots
+*	- Consumers that keep copies of world matrices (constant buffers, acceleration structures) compare
+*	  Comp_WorldTransform::ChangedFrame with the frame of their copy to re-upload only what changed
+*	- Comp_WorldTransform is expected to be added together with the transform, or with it marked dirty
+*/
+class FRT_CORE_API Sys_TransformHierarchy : public ISystem
+{
+public:
+	/** Deeper chains are cut, which only happens with a parenting cycle */
+	static constexpr uint32 MaxDepth = 64u;
+
+	Sys_TransformHierarchy ();
+	virtual ~Sys_TransformHierarchy () override {}
+
+	// System interface
+	virtual SFlags<EUpdatePhase>& GetPhases () override { return Phases; }
+	virtual const char* GetName () const override { return "TransformHierarchy"; }
+	virtual SSystemAccess GetAccess () const override;
+
+	virtual void Finalize (const SUpdateContext& Context) override;
+	// ~System interface
+
+	/** Recomposes world matrices of dirty transforms and everything below them, starts a new frame. */
+	void UpdateWorldTransforms (ecs::CEntityRegistry& InRegistry);
+
+	/** Has to be called after a Comp_Parent is changed in place; adding or removing one is noticed on its own. */
+	void InvalidateOrder () { OrderVersion = InvalidVersion; }
+
+	/** Frame of the last UpdateWorldTransforms, counted from 1 */
+	uint64 GetFrameIndex () const { return FrameIndex; }
+
+private:
+	struct SChildNode
+	{
+		math::STransform* Local = nullptr;
+		Comp_WorldTransform* World = nullptr;
+		const Comp_WorldTransform* ParentWorld = nullptr;
+	};
+
+	void RebuildOrder (ecs::CEntityRegistry& InRegistry);
+
+private:
+	static constexpr uint64 InvalidVersion = ~0ull;
+
+	SFlags<EUpdatePhase> Phases;
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+	TArray<SChildNode> Children;
+#pragma warning(pop)
+
+	/** Structure version of the registry Children were gathered at */
+	uint64 OrderVersion = InvalidVersion;
+	/** Children changed places or parents since the last pass, all of them have to be recomposed */
+	bool bOrderChanged = false;
+	uint64 FrameIndex = 0u;
+};
+}
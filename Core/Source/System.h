@@ -2,21 +2,30 @@
 
 #include "CoreTypes.h"
 #include "Enum.h"
+#include "Ecs/Component.h"
 #include "Graphics/Render/GraphicsCoreTypes.h"
 
 
 namespace frt
 {
+namespace ecs
+{
+class CEntityRegistry;
+}
+
+
 struct SUpdateContext
 {
-	float DeltaSeconds;
-	double TotalSeconds;
+	float DeltaSeconds = 0.f;
+	double TotalSeconds = 0.0;
+	/** Entities of the scene the system runs in */
+	ecs::CEntityRegistry* Registry = nullptr;
 };
 
 
 struct SDrawUpdateContext : SUpdateContext
 {
-	ID3D12GraphicsCommandList4* CommandList;
+	ID3D12GraphicsCommandList4* CommandList = nullptr;
 };
 
 
@@ -33,6 +42,49 @@ enum class EUpdatePhase : uint8
 FRT_DECLARE_FLAG_ENUM(EUpdatePhase);
 
 
+/**
+* Components a system reads and writes in its phases, the scheduler runs systems that don't conflict concurrently.
+* Exclusive systems may touch anything besides components (renderer, scene, frame arena), so they conflict with
+* every other system and run alone on the game thread.
+*/
+struct SSystemAccess
+{
+	ecs::ComponentMask Reads = 0u;
+	ecs::ComponentMask Writes = 0u;
+	bool bExclusive = false;
+
+	static SSystemAccess Exclusive ()
+	{
+		SSystemAccess access;
+		access.bExclusive = true;
+		return access;
+	}
+
+	template <typename... TComponents>
+	SSystemAccess& Read ()
+	{
+		Reads |= ecs::MakeComponentMask<TComponents...>();
+		return *this;
+	}
+
+	template <typename... TComponents>
+	SSystemAccess& Write ()
+	{
+		Writes |= ecs::MakeComponentMask<TComponents...>();
+		return *this;
+	}
+
+	/** Either one is exclusive or writes components the other one touches */
+	bool ConflictsWith (const SSystemAccess& Other) const
+	{
+		return bExclusive
+			|| Other.bExclusive
+			|| (Writes & (Other.Reads | Other.Writes)) != 0u
+			|| (Reads & Other.Writes) != 0u;
+	}
+};
+
+
 class ISystem
 {
 public:
@@ -44,6 +96,12 @@ public:
 
 	virtual SFlags<EUpdatePhase>& GetPhases () = 0;
 
+	/** Shown in the frame stats */
+	virtual const char* GetName () const = 0;
+
+	/** Exclusive unless overridden. Input, Prepare, Update and Finalize of non-exclusive systems run on workers. */
+	virtual SSystemAccess GetAccess () const { return SSystemAccess::Exclusive(); }
+
 	virtual void Input (const SUpdateContext& Context) {}
 	virtual void Prepare (const SUpdateContext& Context) {}
 	virtual void Update (const SUpdateContext& Context) {}
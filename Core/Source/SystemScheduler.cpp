@@ -0,0 +1,206 @@
+#include "SystemScheduler.h"
+
+#include <atomic>
+#include <chrono>
+
+#include "Asserts.h"
+
+
+namespace frt
+{
+namespace
+{
+/** Weight of the last frame in SSystemStats::AverageMilliseconds */
+constexpr float StatsSmoothing = 0.1f;
+}
+
+
+void CSystemScheduler::AddSystem (ISystem& InSystem)
+{
+	frt_assert(!CurrentContext);
+
+	SSystemEntry& entry = Systems.Add();
+	entry.System = &InSystem;
+}
+
+bool CSystemScheduler::RemoveSystem (ISystem& InSystem)
+{
+	frt_assert(!CurrentContext);
+
+	for (uint32 i = 0u; i < Systems.Count(); ++i)
+	{
+		if (Systems[i].System == &InSystem)
+		{
+			Systems.RemoveAt(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+void CSystemScheduler::BeginFrame ()
+{
+	for (SSystemEntry& entry : Systems)
+	{
+		entry.Stats.LastMilliseconds = entry.FrameMilliseconds;
+		entry.Stats.AverageMilliseconds += (entry.FrameMilliseconds - entry.Stats.AverageMilliseconds) * StatsSmoothing;
+		entry.FrameMilliseconds = 0.f;
+	}
+}
+
+void CSystemScheduler::RunPhase (EUpdatePhase InPhase, const SUpdateContext& InContext)
+{
+	frt_assert(InPhase != EUpdatePhase::Draw);
+
+	jobs::CJobSystem* jobSystem = jobs::CJobSystem::GetPrimaryInstance();
+	if (jobSystem
+		&& (jobSystem->GetWorkerCount() == 0u
+			|| jobSystem->GetCurrentThreadIndex() == jobs::CJobSystem::InvalidThreadIndex))
+	{
+		jobSystem = nullptr;
+	}
+
+	CurrentPhase = InPhase;
+	CurrentContext = &InContext;
+	CurrentJobSystem = jobSystem;
+
+	for (uint32 i = 0u; i < Systems.Count(); ++i)
+	{
+		ISystem& system = *Systems[i].System;
+		if (!(system.GetPhases() && InPhase))
+		{
+			continue;
+		}
+
+		const SSystemAccess access = system.GetAccess();
+		if (access.bExclusive)
+		{
+			RunNodes();
+			RunSystem(i);
+			continue;
+		}
+
+		SNode& node = Nodes.Add();
+		node.Scheduler = this;
+		node.SystemIndex = i;
+		node.Access = access;
+	}
+	RunNodes();
+
+	CurrentContext = nullptr;
+	CurrentJobSystem = nullptr;
+}
+
+void CSystemScheduler::RunDrawPhase (const SDrawUpdateContext& InContext)
+{
+	CurrentPhase = EUpdatePhase::Draw;
+	CurrentContext = &InContext;
+
+	for (uint32 i = 0u; i < Systems.Count(); ++i)
+	{
+		if (Systems[i].System->GetPhases() && EUpdatePhase::Draw)
+		{
+			RunSystem(i);
+		}
+	}
+
+	CurrentContext = nullptr;
+}
+
+void CSystemScheduler::RunNodes ()
+{
+	const uint32 nodeCount = Nodes.Count();
+	if (!CurrentJobSystem || nodeCount <= 1u)
+	{
+		// Order they were added in satisfies all dependencies
+		for (const SNode& node : Nodes)
+		{
+			RunSystem(node.SystemIndex);
+		}
+		Nodes.Clear();
+		return;
+	}
+
+	Dependents.Clear();
+	for (uint32 i = 0u; i < nodeCount; ++i)
+	{
+		SNode& node = Nodes[i];
+		node.FirstDependent = Dependents.Count();
+		for (uint32 j = i + 1u; j < nodeCount; ++j)
+		{
+			if (node.Access.ConflictsWith(Nodes[j].Access))
+			{
+				Dependents.Add(j);
+				++Nodes[j].DependencyCount;
+			}
+		}
+		node.DependentCount = Dependents.Count() - node.FirstDependent;
+
+		node.PendingDependencies = node.DependencyCount;
+		node.Job.Function = &CSystemScheduler::RunNodeJob;
+		node.Job.Data = &node;
+	}
+
+	// Dependency counts are fixed before anything runs, pending ones drop as soon as the first job finishes
+	jobs::CJobCounter counter;
+	CurrentCounter = &counter;
+	for (SNode& node : Nodes)
+	{
+		if (node.DependencyCount == 0u)
+		{
+			CurrentJobSystem->Run(node.Job, counter);
+		}
+	}
+	CurrentJobSystem->Wait(counter);
+	CurrentCounter = nullptr;
+
+	Nodes.Clear();
+}
+
+void CSystemScheduler::RunNodeJob (void* InNode)
+{
+	SNode& node = *static_cast<SNode*>(InNode);
+	CSystemScheduler& scheduler = *node.Scheduler;
+
+	scheduler.RunSystem(node.SystemIndex);
+
+	// Counted before this job is, so the phase can't be seen as done in between
+	for (uint32 i = 0u; i < node.DependentCount; ++i)
+	{
+		SNode& dependent = scheduler.Nodes[scheduler.Dependents[node.FirstDependent + i]];
+		if (std::atomic_ref<uint32>(dependent.PendingDependencies).fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+		{
+			scheduler.CurrentJobSystem->Run(dependent.Job, *scheduler.CurrentCounter);
+		}
+	}
+}
+
+void CSystemScheduler::RunSystem (uint32 InSystemIndex)
+{
+	SSystemEntry& entry = Systems[InSystemIndex];
+	ISystem& system = *entry.System;
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	switch (CurrentPhase)
+	{
+	case EUpdatePhase::Input:
+		system.Input(*CurrentContext);
+		break;
+	case EUpdatePhase::Prepare:
+		system.Prepare(*CurrentContext);
+		break;
+	case EUpdatePhase::Update:
+		system.Update(*CurrentContext);
+		break;
+	case EUpdatePhase::Finalize:
+		system.Finalize(*CurrentContext);
+		break;
+	case EUpdatePhase::Draw:
+		system.Draw(static_cast<const SDrawUpdateContext&>(*CurrentContext));
+		break;
+	}
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	entry.FrameMilliseconds += std::chrono::duration<float, std::milli>(end - start).count();
+}
+}
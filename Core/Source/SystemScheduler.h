@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Core.h"
+#include "CoreTypes.h"
+#include "CoreUtils.h"
+#include "System.h"
+#include "Containers/Array.h"
+#include "Jobs/JobSystem.h"
+
+
+namespace frt
+{
+/**
+* Runs the phases of the systems of a scene, concurrently where their component access allows it. Key points:
+*	- Every phase builds its own dependency graph from the systems that have it: a system depends on each earlier
+*	  added one it conflicts with (see SSystemAccess), so conflicting systems keep the order they were added in
+*	- Systems without pending dependencies run as jobs on the primary job system and release their dependents
+*	  as they finish; without workers they run in order on the calling thread
+*	- Exclusive systems split the phase: everything before them has finished when they start on the calling thread,
+*	  and everything after waits for them
+*	- Draw runs in order on the calling thread, systems record into one command list
+*	- Time of every system is summed over all its phases of a frame; BeginFrame closes the stats of the last one
+*	- Systems are not owned, they must be removed before they are destroyed
+*/
+class FRT_CORE_API CSystemScheduler
+{
+public:
+	struct SSystemStats
+	{
+		/** All phases of the last frame */
+		float LastMilliseconds = 0.f;
+		/** Smoothed over the last frames */
+		float AverageMilliseconds = 0.f;
+	};
+
+	FRT_DELETE_COPY_AND_MOVE_OPS(CSystemScheduler);
+
+	CSystemScheduler () = default;
+
+	// Systems
+	void AddSystem (ISystem& InSystem);
+	/** Returns false if the system wasn't added. */
+	bool RemoveSystem (ISystem& InSystem);
+
+	uint32 GetSystemCount () const { return Systems.Count(); }
+	ISystem& GetSystem (uint32 InIndex) const { return *Systems[InIndex].System; }
+	const SSystemStats& GetStats (uint32 InIndex) const { return Systems[InIndex].Stats; }
+	// ~Systems
+
+	// Running
+	void BeginFrame ();
+
+	/** Input, Prepare, Update or Finalize of all systems that have it; returns when all of them are done. */
+	void RunPhase (EUpdatePhase InPhase, const SUpdateContext& InContext);
+	void RunDrawPhase (const SDrawUpdateContext& InContext);
+	// ~Running
+
+private:
+	struct SSystemEntry
+	{
+		ISystem* System = nullptr;
+		SSystemStats Stats;
+		/** Written only by the job running the system, phases don't overlap */
+		float FrameMilliseconds = 0.f;
+	};
+
+	struct SNode
+	{
+		CSystemScheduler* Scheduler = nullptr;
+		uint32 SystemIndex = 0u;
+		SSystemAccess Access;
+		/** Range in Dependents */
+		uint32 FirstDependent = 0u;
+		uint32 DependentCount = 0u;
+		uint32 DependencyCount = 0u;
+		/** Dependencies that haven't finished yet, accessed atomically while the phase runs */
+		uint32 PendingDependencies = 0u;
+		jobs::SJob Job;
+	};
+
+	/** Runs the nodes gathered since the last exclusive system and clears them. */
+	void RunNodes ();
+	static void RunNodeJob (void* InNode);
+
+	/** Runs the current phase of the system and adds its time to the frame stats. */
+	void RunSystem (uint32 InSystemIndex);
+
+private:
+#pragma warning(push)
+#pragma warning(disable: 4251)
+	TArray<SSystemEntry> Systems;
+
+	// State of the running phase
+	TArray<SNode> Nodes;
+	TArray<uint32> Dependents;
+#pragma warning(pop)
+
+	EUpdatePhase CurrentPhase = EUpdatePhase::Update;
+	const SUpdateContext* CurrentContext = nullptr;
+	jobs::CJobSystem* CurrentJobSystem = nullptr;
+	jobs::CJobCounter* CurrentCounter = nullptr;
+};
+}
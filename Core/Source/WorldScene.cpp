@@ -2,6 +2,13 @@
 
 #include "GameInstance.h"
 #include "Sys_MeshRenderer.h"
+#include "Memory/FrameArena.h"
+
+namespace
+{
+/** More changed runs of object constants than this are uploaded as a whole buffer */
+constexpr frt::uint32 MaxObjectConstantRanges = 64u;
+}
 
 frt::CWorldScene::CWorldScene (GameInstance& InGame)
 	: Game(InGame)
@@ -10,80 +17,209 @@ frt::CWorldScene::CWorldScene (GameInstance& InGame)
 bool frt::CWorldScene::Initialize ()
 {
 	MeshRenderer = memory::NewUnique<Sys_MeshRenderer>(Game.GetRenderer());
+	Rotation = memory::NewUnique<Sys_Rotation>();
+	TransformHierarchy = memory::NewUnique<Sys_TransformHierarchy>();
+
+	Systems.AddSystem(*MeshRenderer);
+	Systems.AddSystem(*Rotation);
+	Systems.AddSystem(*TransformHierarchy);
 	return true;
 }
 
-frt::memory::TRefShared<frt::CEntity> frt::CWorldScene::SpawnEntity ()
+frt::EntityHandle frt::CWorldScene::SpawnEntity ()
 {
-	auto newEntity = memory::NewShared<CEntity>();
-	Entities.Add(newEntity);
-	newEntity->RenderModel = MeshRenderer->SpawnRenderModel();
+	const EntityHandle newEntity =
+		Registry.Create<math::STransform, Comp_WorldTransform, graphics::Comp_RenderModel>();
 	bSceneTopologyDirty = true;
 	return newEntity;
 }
 
-void frt::CWorldScene::RunFrame ()
+bool frt::CWorldScene::DespawnEntity (EntityHandle Entity)
 {
-	SUpdateContext Context;
+	if (!Registry.Destroy(Entity))
+	{
+		return false;
+	}
 
-	const SFlags<EUpdatePhase>& MeshRendererPhases = MeshRenderer->GetPhases();
+	bSceneTopologyDirty = true;
+	return true;
+}
 
-	if (!IsPhasePaused(EUpdatePhase::Prepare) && (MeshRendererPhases && EUpdatePhase::Prepare))
+std::optional<frt::CEntity> frt::CWorldScene::FindEntity (EntityHandle Entity)
+{
+	if (!Registry.IsAlive(Entity))
 	{
-		MeshRenderer->Prepare(Context);
+		return std::nullopt;
 	}
 
-	if (!IsPhasePaused(EUpdatePhase::Update) && (MeshRendererPhases && EUpdatePhase::Update))
+	return CEntity(Registry, Entity);
+}
+
+frt::CEntity frt::CWorldScene::GetEntity (EntityHandle Entity)
+{
+	frt_assert(Registry.IsAlive(Entity));
+	return CEntity(Registry, Entity);
+}
+
+void frt::CWorldScene::SetParent (EntityHandle Child, EntityHandle Parent)
+{
+	frt_assert(Registry.IsAlive(Child));
+
+	if (!Registry.IsAlive(Parent))
 	{
-		MeshRenderer->Update(Context);
+		Registry.Remove<Comp_Parent>(Child);
+	}
+	else
+	{
+		EntityHandle ancestor = Parent;
+		for (uint32 depth = 0u; depth < Sys_TransformHierarchy::MaxDepth; ++depth)
+		{
+			frt_assert(ancestor != Child);
+			const Comp_Parent* ancestorParent = Registry.Find<Comp_Parent>(ancestor);
+			if (!ancestorParent)
+			{
+				break;
+			}
+			ancestor = ancestorParent->Parent;
+		}
+
+		if (Comp_Parent* parent = Registry.Find<Comp_Parent>(Child))
+		{
+			// Not a structural change, the hierarchy wouldn't notice on its own
+			parent->Parent = Parent;
+			TransformHierarchy->InvalidateOrder();
+		}
+		else
+		{
+			Registry.Add<Comp_Parent>(Child).Parent = Parent;
+		}
 	}
 
-	if (!IsPhasePaused(EUpdatePhase::Finalize) && (MeshRendererPhases && EUpdatePhase::Finalize))
+	// Drops the part of the old parent from the world matrix
+	if (math::STransform* transform = Registry.Find<math::STransform>(Child))
 	{
-		MeshRenderer->Finalize(Context);
+		transform->MarkDirty();
 	}
+}
+
+void frt::CWorldScene::RunFrame ()
+{
+	SUpdateContext Context;
+	Context.DeltaSeconds = Game.GetTime().GetDeltaSeconds();
+	Context.TotalSeconds = Game.GetTime().GetTotalSeconds();
+	Context.Registry = &Registry;
 
-	if (!IsPhasePaused(EUpdatePhase::Update))
+	Systems.BeginFrame();
+	for (const EUpdatePhase phase : { EUpdatePhase::Prepare, EUpdatePhase::Update, EUpdatePhase::Finalize })
 	{
-		for (auto& entity : Entities)
+		if (!IsPhasePaused(phase))
 		{
-			entity->Tick(1.f / 60.f);
+			Systems.RunPhase(phase, Context);
 		}
 	}
 
-	// TODO: ideally, CBs should already be stored in one array
-	// TODO: use (when it's implemented) memory pool
-	const uint32 entityCount = Entities.Count();
-	Game.GetRenderer()->EnsureObjectConstantCapacity(entityCount);
+	const uint32 renderableCount = GetRenderableCount();
+	Game.GetRenderer()->EnsureObjectConstantCapacity(renderableCount);
 
 	auto& currentFrameResources = Game.GetRenderer()->GetCurrentFrameResource();
 
-	if (entityCount > 0u)
+	if (renderableCount > 0u)
 	{
-		TArray<graphics::SObjectConstants> objectConstants;
-		objectConstants.SetSizeUninitialized(entityCount);
-		for (uint32 i = 0; i < entityCount; ++i)
+		// Objects keep their index while the structure doesn't change, then only the changed matrices are copied
+		bool bFullUpload = currentFrameResources.ObjectCBLayoutVersion != Registry.GetStructureVersion();
+		if (!bFullUpload)
 		{
-			objectConstants[i].World = Entities[i]->Transform.GetMatrix();
+			bFullUpload = !CopyChangedObjectConstants(currentFrameResources);
 		}
 
-		currentFrameResources.ObjectCB.CopyBunch(
-			objectConstants.GetData(),
-			objectConstants.Count(),
-			currentFrameResources.UploadArena);
+		if (bFullUpload)
+		{
+			TArray<graphics::SObjectConstants, memory::CFrameArena> objectConstants;
+			objectConstants.SetSizeUninitialized(renderableCount);
+
+			// Rows are numbered in query order, the same ForEachRenderable gives them their object index in
+			graphics::SObjectConstants* objectConstantsData = objectConstants.GetData();
+			Registry.ParallelForEachChunk<const Comp_WorldTransform, const graphics::Comp_RenderModel>(
+				[objectConstantsData] (uint32 FirstIndex, uint32 RowCount, const EntityHandle*,
+					const Comp_WorldTransform* WorldTransforms, const graphics::Comp_RenderModel*)
+				{
+					for (uint32 row = 0; row < RowCount; ++row)
+					{
+						objectConstantsData[FirstIndex + row].World = WorldTransforms[row].Matrix;
+					}
+				});
+
+			currentFrameResources.ObjectCB.CopyBunch(
+				objectConstants.GetData(),
+				objectConstants.Count(),
+				currentFrameResources.UploadArena);
+		}
+
+		currentFrameResources.ObjectCBLayoutVersion = Registry.GetStructureVersion();
+		currentFrameResources.ObjectCBFrame = TransformHierarchy->GetFrameIndex();
+	}
+}
+
+bool frt::CWorldScene::CopyChangedObjectConstants (graphics::SFrameResources& FrameResources)
+{
+	struct SRange
+	{
+		uint32 FirstObject;
+		uint32 Count;
+	};
+
+	const uint64 uploadedFrame = FrameResources.ObjectCBFrame;
+
+	// Changed objects are packed in index order, each range takes the next Count of them
+	TArray<graphics::SObjectConstants, memory::CFrameArena> changedConstants;
+	TArray<SRange, memory::CFrameArena> ranges;
+	bool bTooManyRanges = false;
+
+	uint32 objectIndex = 0u;
+	Registry.ForEachChunk<const Comp_WorldTransform, const graphics::Comp_RenderModel>(
+		[&] (uint32 RowCount, const EntityHandle*, const Comp_WorldTransform* WorldTransforms,
+			const graphics::Comp_RenderModel*)
+		{
+			for (uint32 row = 0; row < RowCount && !bTooManyRanges; ++row, ++objectIndex)
+			{
+				if (WorldTransforms[row].ChangedFrame <= uploadedFrame)
+				{
+					continue;
+				}
+
+				if (ranges.IsEmpty() || ranges.Last().FirstObject + ranges.Last().Count != objectIndex)
+				{
+					bTooManyRanges = ranges.Count() == MaxObjectConstantRanges;
+					ranges.Add(SRange { objectIndex, 0u });
+				}
+				++ranges.Last().Count;
+				changedConstants.Add().World = WorldTransforms[row].Matrix;
+			}
+		});
+
+	if (bTooManyRanges)
+	{
+		return false;
 	}
+
+	const graphics::SObjectConstants* data = changedConstants.GetData();
+	for (const SRange& range : ranges)
+	{
+		FrameResources.ObjectCB.CopyRange(data, range.FirstObject, range.Count, FrameResources.UploadArena);
+		data += range.Count;
+	}
+	return true;
 }
 
 void frt::CWorldScene::SubmitFrame (ID3D12GraphicsCommandList4* CommandList)
 {
 	SDrawUpdateContext Context;
+	Context.DeltaSeconds = Game.GetTime().GetDeltaSeconds();
+	Context.TotalSeconds = Game.GetTime().GetTotalSeconds();
+	Context.Registry = &Registry;
 	Context.CommandList = CommandList;
 
-	const SFlags<EUpdatePhase>& MeshRendererPhases = MeshRenderer->GetPhases();
-	if (MeshRendererPhases && EUpdatePhase::Draw)
-	{
-		MeshRenderer->Draw(Context);
-	}
+	Systems.RunDrawPhase(Context);
 }
 
 bool frt::CWorldScene::IsPhasePaused (EUpdatePhase Phase) const
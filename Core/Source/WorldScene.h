@@ -1,7 +1,14 @@
 ﻿#pragma once
 
+#include <optional>
+
+#include "Entity.h"
+#include "Sys_Rotation.h"
+#include "Sys_TransformHierarchy.h"
 #include "System.h"
+#include "SystemScheduler.h"
 #include "Containers/Array.h"
+#include "Ecs/EntityRegistry.h"
 #include "Graphics/Render/GraphicsCoreTypes.h"
 
 
@@ -9,7 +16,6 @@ namespace frt
 {
 class GameInstance;
 class Sys_MeshRenderer;
-class CEntity;
 class ISystem;
 
 
@@ -21,7 +27,19 @@ public:
 
 	bool Initialize ();
 
-	memory::TRefShared<CEntity> SpawnEntity ();
+	EntityHandle SpawnEntity ();
+	/** Returns false if the entity is gone already. */
+	bool DespawnEntity (EntityHandle Entity);
+
+	std::optional<CEntity> FindEntity (EntityHandle Entity);
+	/** Same as FindEntity, but the entity must be alive. */
+	CEntity GetEntity (EntityHandle Entity);
+
+	/**
+	* Makes the transform of Child relative to Parent from the next frame on; an invalid Parent detaches it.
+	* Children of despawned parents stay where they were relative to the world origin.
+	*/
+	void SetParent (EntityHandle Child, EntityHandle Parent);
 
 	void RunFrame ();
 	void SubmitFrame (ID3D12GraphicsCommandList4* CommandList);
@@ -31,10 +49,26 @@ public:
 	void UnpausePhases (SFlags<EUpdatePhase> Phases);
 	bool TogglePhasePause (EUpdatePhase Phase);
 
-	const TArray<memory::TRefShared<CEntity>>& GetEntities () const { return Entities; }
+	ecs::CEntityRegistry& GetRegistry () { return Registry; }
+	const ecs::CEntityRegistry& GetRegistry () const { return Registry; }
+
+	/**
+	* Calls InFunction(uint32 ObjectIndex, EntityHandle, const Comp_WorldTransform&, graphics::Comp_RenderModel&)
+	* for every entity that can be drawn; the i-th one owns the i-th object constant buffer.
+	*/
+	template <typename TFunction>
+	void ForEachRenderable (TFunction&& InFunction);
+
+	uint32 GetRenderableCount () const
+	{
+		return Registry.CountMatching<Comp_WorldTransform, graphics::Comp_RenderModel>();
+	}
 
 	memory::TRefUnique<Sys_MeshRenderer> MeshRenderer;
-	// TArray<memory::TRefUnique<ISystem>> Systems;
+	memory::TRefUnique<Sys_Rotation> Rotation;
+	memory::TRefUnique<Sys_TransformHierarchy> TransformHierarchy;
+	/** Runs the phases of the systems above, in the order they are added where they conflict */
+	CSystemScheduler Systems;
 
 	// Scene-level dirty flags consumed by Sys_MeshRenderer each frame.
 	// Set here because topology and motion are scene knowledge, not renderer knowledge.
@@ -43,9 +77,29 @@ public:
 
 
 private:
-	TArray<memory::TRefShared<CEntity>> Entities; // TODO: allocate on stack
+	/**
+	* Copies the object constants whose world matrix changed since the frame resources were filled.
+	* Returns false without copying anything if they are too scattered, the whole buffer is cheaper then.
+	*/
+	bool CopyChangedObjectConstants (graphics::SFrameResources& FrameResources);
+
+private:
+	ecs::CEntityRegistry Registry;
 
 	SFlags<EUpdatePhase> PausedPhases;
 	GameInstance& Game;
 };
+
+
+template <typename TFunction>
+void CWorldScene::ForEachRenderable (TFunction&& InFunction)
+{
+	uint32 objectIndex = 0u;
+	Registry.ForEach<const Comp_WorldTransform, graphics::Comp_RenderModel>(
+		[&objectIndex, &InFunction] (
+			EntityHandle Entity, const Comp_WorldTransform& WorldTransform, graphics::Comp_RenderModel& RenderModel)
+		{
+			InFunction(objectIndex++, Entity, WorldTransform, RenderModel);
+		});
+}
 }